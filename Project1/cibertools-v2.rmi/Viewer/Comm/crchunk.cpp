@@ -0,0 +1,138 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "crchunk.h"
+
+#include <stdio.h>
+#include <string.h>
+
+CRChunkReceiver::CRChunkReceiver()
+{
+}
+
+/*============================================================================*/
+
+bool CRChunkReceiver::isChunk( const char *msg, int len )
+{
+    return len > 7 && strncmp( msg, "<Chunk ", 7 ) == 0;
+}
+
+/*============================================================================*/
+
+CRChunkReceiver::Transfer *CRChunkReceiver::transfer( const string &object )
+{
+    for (unsigned int i = 0; i < transfers.size(); i++)
+        if (transfers[i].object == object)
+            return &transfers[i];
+
+    Transfer t;
+    t.object = object;
+    t.version = t.count = t.size = t.received = 0;
+    transfers.push_back( t );
+    return &transfers.back();
+}
+
+/*============================================================================*/
+
+bool CRChunkReceiver::add( const char *msg, int len )
+{
+    // the header is short, copy it to have it null terminated
+    char header[160];
+    const char *end = (const char *) memchr( msg, '\n', len < 159 ? len : 159 );
+    if (end == NULL)
+        return false;
+    memcpy( header, msg, end - msg );
+    header[end - msg] = '\0';
+
+    char object[32];
+    unsigned int version, seq, count, size;
+    if (sscanf( header, "<Chunk Object=\"%31[^\"]\" Version=\"%u\" Seq=\"%u\" Count=\"%u\" Size=\"%u\"/>",
+                object, &version, &seq, &count, &size ) != 5)
+        return false;
+
+    if (count == 0 || seq >= count || count > size)
+        return false;
+
+    // all chunks but the last have the same length, given by the header
+    const char *payload = end + 1;
+    unsigned int payloadLen = msg + len - payload;
+    unsigned int chunkLen = size / count + (size % count != 0);
+    unsigned int begin = seq * chunkLen;
+    unsigned int expected = seq + 1 < count ? chunkLen : size - begin;
+    if (begin >= size || payloadLen != expected)
+        return false;
+
+    Transfer *t = transfer( object );
+    if (t->version != version || t->count != count || t->size != size)
+    {
+        // a new message, the chunks of the old one are of no use
+        t->version = version;
+        t->count = count;
+        t->size = size;
+        t->received = 0;
+        t->have.assign( count, false );
+        t->data.assign( size, '\0' );
+    }
+    else if (t->received == count)
+        return false;           // a repeated chunk of a complete message
+
+    if (t->have[seq])
+        return false;
+    t->have[seq] = true;
+    t->data.replace( begin, payloadLen, payload, payloadLen );
+    t->received++;
+
+    if (t->received < count)
+        return false;
+
+    completed = t->data;
+    return true;
+}
+
+/*============================================================================*/
+
+bool CRChunkReceiver::pending( void )
+{
+    for (unsigned int i = 0; i < transfers.size(); i++)
+        if (transfers[i].received < transfers[i].count)
+            return true;
+    return false;
+}
+
+/*============================================================================*/
+
+void CRChunkReceiver::requests( vector<string> &reqs, unsigned int max )
+{
+    char req[128];
+
+    reqs.clear();
+    for (unsigned int i = 0; i < transfers.size(); i++)
+    {
+        Transfer &t = transfers[i];
+        for (unsigned int seq = 0; seq < t.count && reqs.size() < max; seq++)
+        {
+            if (t.have[seq])
+                continue;
+            sprintf( req, "<ChunkReq Object=\"%s\" Version=\"%u\" Seq=\"%u\"/>",
+                     t.object.c_str(), t.version, seq );
+            reqs.push_back( req );
+        }
+    }
+}
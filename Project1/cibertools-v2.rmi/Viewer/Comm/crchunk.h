@@ -0,0 +1,92 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef _CIBER_RATO_CRCHUNK_
+#define _CIBER_RATO_CRCHUNK_
+
+/*! \class CRChunkReceiver
+ *  \brief Puts together the Lab and Grid messages sent in chunks.
+ *
+ *  Labs too large for one datagram are sent by the simulator and by the
+ *  logplayer in chunks, each a datagram with a <Chunk .../> header line
+ *  followed by a part of the message (see simulator/cbchunk.h). The
+ *  receiver keeps one transfer per object, drops the chunks of an older
+ *  version and lists the chunks still missing, to be asked again with
+ *  <ChunkReq .../>.
+ */
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+class CRChunkReceiver
+{
+public:
+	/*! This is the constructor.
+	 */
+	CRChunkReceiver();
+
+	/*! True if the datagram is a chunk.
+	 */
+	static bool isChunk( const char *msg, int len );
+
+	/*! Adds a chunk.
+	 * \param msg the datagram.
+	 * \param len the datagram length.
+	 * \return true if it completes a message, then given by message().
+	 */
+	bool add( const char *msg, int len );
+
+	/*! The last message completed.
+	 */
+	const string &message( void ) { return completed; }
+
+	/*! True while some message lacks chunks.
+	 */
+	bool pending( void );
+
+	/*! Writes the <ChunkReq .../> messages of the missing chunks,
+	 * at most max of them, into requests.
+	 */
+	void requests( vector<string> &requests, unsigned int max );
+
+	/*! Forgets every transfer, to be called when the messages are asked
+	 * again.
+	 */
+	void reset( void ) { transfers.clear(); }
+
+private:
+	struct Transfer
+	{
+		string object;
+		unsigned int version, count, size, received;
+		vector<bool> have;
+		string data;
+	};
+
+	Transfer *transfer( const string &object );
+
+	vector<Transfer> transfers;
+	string completed;
+};
+
+#endif
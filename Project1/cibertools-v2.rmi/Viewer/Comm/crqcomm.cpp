@@ -47,6 +47,7 @@ using namespace std;
 
 CRQComm::CRQComm()
 {
+    capture = NULL;
 
 }
 
@@ -55,7 +56,7 @@ CRQComm::CRQComm()
 CRQComm::CRQComm(CRQLabView *lb, CRQScene *commScene, CRLab *commLab,
   QString h, unsigned short port_, const char c , const char autoC,
   const char autoS)
-    : QUdpSocket(), timer(this)
+    : QUdpSocket(), timer(this), frameTimer(this), chunkTimer(this)
 {
     scoreLayout = lb->findChild<QVBoxLayout *>("scoreLayout");
 	autoConnect = autoC;
@@ -67,8 +68,11 @@ CRQComm::CRQComm(CRQLabView *lb, CRQScene *commScene, CRLab *commLab,
     lab = commLab;		// Lab passed by main
 	cont = 0;
 	host = h;
+	capture = NULL;
+	datagram.reserve(65536);	// largest UDP datagram, never reallocated
 	skinFName = "skins/default/default.skin";
     isConnected = false;
+    robotsDirty = false;
 
     QObject::connect (this, SIGNAL(readyRead()), SLOT(dataControler()));
 
@@ -107,6 +111,38 @@ CRQComm::CRQComm(CRQLabView *lb, CRQScene *commScene, CRLab *commLab,
 
    	// Connect Alarm event
     QObject::connect(&timer, SIGNAL(timeout()), SLOT(SendRequests()));
+
+    // Display frames
+    QObject::connect(&frameTimer, SIGNAL(timeout()), SLOT(renderFrame()));
+    setFrameRate(25);
+
+    // Missing chunks are asked again when none arrived for a while
+    chunkTimer.setInterval(200);
+    QObject::connect(&chunkTimer, SIGNAL(timeout()), SLOT(requestChunks()));
+}
+
+/*============================================================================*/
+
+void CRQComm::setFrameRate(unsigned int fps)
+{
+    if (fps == 0)
+        fps = 1;
+    frameTimer.start(1000 / fps);
+}
+
+/*============================================================================*/
+
+bool CRQComm::setCapture(const char *fileName)
+{
+    if (capture != NULL)
+        fclose(capture);
+    capture = fopen(fileName, "wb");
+    if (capture == NULL)
+    {
+        cerr << "Could not open capture file " << fileName << endl;
+        return false;
+    }
+    return true;
 }
 
 /*============================================================================*/
@@ -210,6 +246,7 @@ void CRQComm::SendRequests()
 #endif
 
     //cerr << "Send requests \n";
+    chunks.reset();
     //Lab Request
     if( writeDatagram( "<LabReq/>", 10, serverAddress, port ) == -1 )
     {
@@ -230,8 +267,23 @@ void CRQComm::SendRequests()
 
 /*============================================================================*/
 
+void CRQComm::requestChunks()
+{
+    vector<string> reqs;
+    chunks.requests( reqs, 16 );
+    for (unsigned int i = 0; i < reqs.size(); i++)
+        writeDatagram( reqs[i].c_str(), reqs[i].size() + 1, serverAddress, port );
+
+    if (!chunks.pending())
+        chunkTimer.stop();
+}
+
+/*============================================================================*/
+
 CRQComm::~CRQComm()
 {
+    if (capture != NULL)
+        fclose(capture);
 
 }
 
@@ -243,11 +295,47 @@ void CRQComm::dataControler() //Called when the socket receive something
 
     while (hasPendingDatagrams())
     {
-        QByteArray datagram;
         datagram.resize(pendingDatagramSize());
-        if (readDatagram( datagram.data(), datagram.size(), &serverAddress, &port) == -1 ) //Read from socket
+        qint64 size = readDatagram( datagram.data(), datagram.size(), &serverAddress, &port); //Read from socket
+        if (size == -1 )
         {
             cerr << "Failure to read socket " << endl;
+            continue;
+        }
+        datagram.resize(size);
+
+        if (capture != NULL)
+        {
+            fwrite(datagram.constData(), 1, qstrnlen(datagram.constData(), size), capture);
+            fputc('\0', capture);
+        }
+
+        // Lab and Grid too large for a datagram come in chunks
+        bool assembled = false;
+        if (CRChunkReceiver::isChunk( datagram.constData(), size ))
+        {
+            bool done = chunks.add( datagram.constData(), size );
+            if (chunks.pending())
+                chunkTimer.start();     // restarted by every chunk
+            else
+                chunkTimer.stop();
+            if (!done)
+                continue;
+            datagram = QByteArray( chunks.message().data(), chunks.message().size() );
+            assembled = true;
+        }
+
+        // Robot messages, one per robot and cycle, skip the XML parser
+        if (!assembled && lab != NULL && robotDecoder.decode( datagram.constData(), size ))
+        {
+            CRRobot *decoded = &robotDecoder.robot();
+
+            // removals are shown at once, the lab forgets the robot
+            if (decoded->state() == CRRobot::REMOVED && dataView != NULL)
+                dataView->update( decoded );
+
+            robotChanged( robotDecoder.apply( lab ) );
+            continue;
         }
 
         QXmlInputSource source;
@@ -307,11 +395,18 @@ void CRQComm::dataControler() //Called when the socket receive something
                 case CRQCommHandler::ROBOT:
                 {
                     robot = commHandler.getRobot(); // Robot given by handler
+                    int id = robot->id();
+
+                    // removals are shown at once, the lab forgets the robot
+                    if (robot->state() == CRRobot::REMOVED && dataView != NULL)
+                        dataView->update( robot );
+
+                    // the lab holds the latest state, drawn in the next frame
                     lab->addRobot( robot );
-                    scene->drawRobot( lab );		// Draw a robot in scene
-                    //scene->update();
-                    if (dataView != NULL)
-                        dataView->update( robot );	// update the info about robot
+                    if (lab->robot( id ) != robot)
+                        delete robot;
+                    robot = lab->robot( id );
+                    robotChanged( robot );
                     break;
                 }
 
@@ -337,6 +432,44 @@ void CRQComm::dataControler() //Called when the socket receive something
     }
 }
 
+//=============================================================================
+void CRQComm::robotChanged(CRRobot *rob)
+{
+    if (rob == NULL)
+        return;
+
+    int id = rob->id();
+    scene->robotUpdated( rob );
+    if ((unsigned int) id > robotDirty.size())
+        robotDirty.resize(id, false);
+    robotDirty[id - 1] = true;
+    robotsDirty = true;
+}
+
+//=============================================================================
+void CRQComm::renderFrame(void)
+{
+    if (!robotsDirty && !scene->moving())
+        return;
+
+    scene->drawRobot( lab );		// Draw the robots in scene
+
+    if (robotsDirty)
+    {
+        for (unsigned int r = 0; r < robotDirty.size(); r++)
+        {
+            if (!robotDirty[r])
+                continue;
+            robotDirty[r] = false;
+
+            CRRobot *rob = lab->robot( r + 1 );
+            if (rob != NULL && dataView != NULL)
+                dataView->update( rob );	// update the info about robot
+        }
+        robotsDirty = false;
+    }
+}
+
 //=============================================================================
 void CRQComm::sendMessage( const char *mensagem )
 {
@@ -41,6 +41,10 @@
 #include "../crqlabview.h"
 #include "crreply.h"
 #include "crqcommhandler.h"
+#include "crrobotdecoder.h"
+#include "crchunk.h"
+
+#include <stdio.h>
 
 #include <QtGui>
 
@@ -88,6 +92,19 @@ public:
 	 */
 	void skin(QString skinFileName);
 
+	/*! Sets how many times per second the scene and the score window
+	 * are redrawn. Robot datagrams received between two frames are
+	 * coalesced into the lab and drawn once.
+	 */
+	void setFrameRate(unsigned int fps);
+
+	/*! Writes every datagram received from the simulator to a file,
+	 * separated by null characters. The file can be replayed by the
+	 * decode benchmark (bench/decodebench).
+	 * \return false if the file could not be created.
+	 */
+	bool setCapture(const char *fileName);
+
     CRQDataView *dataView;
 
 signals:
@@ -107,7 +124,17 @@ public slots:
 	/*! Process the Lab and Grid requests.
 	 */
     void SendRequests(void);
+	/*! Draws the robots updated since the last frame.
+	 */
+    void renderFrame(void);
+	/*! Asks again for the chunks of the Lab and Grid that did not arrive.
+	 */
+    void requestChunks(void);
 private:
+	/*! Marks a robot of the lab as changed, to be drawn in the next frame.
+	 */
+	void robotChanged(CRRobot *rob);
+
     char control; // Aparecimento ou no da janela de controlo (not supported / no need)
 	char autoConnect;
     char autoStart;
@@ -122,6 +149,14 @@ private:
 	CRQCommHandler::Type objectReceived;
 	QString host;
     QTimer timer;
+    QTimer frameTimer;
+    vector<bool> robotDirty;	// robots updated since the last frame, by id-1
+    bool robotsDirty;
+    QByteArray datagram;		// receive buffer, reused for every datagram
+    CRRobotDecoder robotDecoder;	// fast path for the Robot messages
+    CRChunkReceiver chunks;		// Lab and Grid too large for a datagram
+    QTimer chunkTimer;			// runs while chunks are missing
+    FILE *capture;
     QString skinFName;
     QVBoxLayout *scoreLayout;
     bool isConnected;
@@ -0,0 +1,339 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "crrobotdecoder.h"
+
+#include <string.h>
+#include <math.h>
+
+/*
+ * The scanner works on the raw datagram. Values are never copied, an
+ * attribute is a (pointer, length) pair into the datagram. Anything
+ * that needs more than this, entities, comments, other elements, makes
+ * decode return false and the message goes to the generic parser.
+ */
+
+static inline bool isSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static const char *skipSpace(const char *p, const char *end)
+{
+	while (p < end && isSpace(*p))
+		p++;
+	return p;
+}
+
+/* compares the token [p, p+len) with a null terminated string */
+static inline bool same(const char *p, int len, const char *s)
+{
+	return (int) strlen(s) == len && memcmp(p, s, len) == 0;
+}
+
+/* Integer in [p, p+len), all characters must be used */
+static bool parseInt(const char *p, int len, int &value)
+{
+	const char *end = p + len;
+	bool neg = false;
+	if (p < end && (*p == '-' || *p == '+'))
+		neg = *p++ == '-';
+	if (p == end)
+		return false;
+
+	int v = 0;
+	for (; p < end; p++) {
+		if (*p < '0' || *p > '9')
+			return false;
+		v = v * 10 + (*p - '0');
+	}
+	value = neg ? -v : v;
+	return true;
+}
+
+/* Number written by printf %g in [p, p+len). The decimal point is always
+ * '.', whatever the locale set by the application. */
+static bool parseFloat(const char *p, int len, float &value)
+{
+	static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+	                                1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+	const char *end = p + len;
+	bool neg = false;
+	if (p < end && (*p == '-' || *p == '+'))
+		neg = *p++ == '-';
+
+	double v = 0.0;
+	int exp = 0, digits = 0;
+	for (; p < end && *p >= '0' && *p <= '9'; p++, digits++)
+		v = v * 10.0 + (*p - '0');
+	if (p < end && *p == '.') {
+		for (p++; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+			v = v * 10.0 + (*p - '0');
+			exp--;
+		}
+	}
+	if (digits == 0)
+		return false;
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		int e;
+		if (!parseInt(p + 1, end - p - 1, e))
+			return false;
+		exp += e;
+		p = end;
+	}
+	if (p != end)
+		return false;
+
+	if (exp > 0)
+		v *= exp < 16 ? pow10[exp] : pow(10.0, exp);
+	else if (exp < 0)
+		v /= -exp < 16 ? pow10[-exp] : pow(10.0, -exp);
+
+	value = (float) (neg ? -v : v);
+	return true;
+}
+
+/*
+ * Reads the attributes of a start tag, p points after the tag name.
+ * Calls attr(name, nameLen, value, valueLen) for each one. On success p
+ * is left after the '>' and empty tells if the tag was "/>".
+ */
+template <class Handler>
+static bool scanAttributes(const char *&p, const char *end, bool &empty, Handler &attr)
+{
+	for (;;) {
+		const char *start = p;
+		p = skipSpace(p, end);
+		if (p == end)
+			return false;
+		if (*p == '>') {
+			p++;
+			empty = false;
+			return true;
+		}
+		if (*p == '/') {
+			if (p + 1 == end || p[1] != '>')
+				return false;
+			p += 2;
+			empty = true;
+			return true;
+		}
+		if (p == start)		// attributes are separated by spaces
+			return false;
+
+		const char *name = p;
+		while (p < end && *p != '=' && !isSpace(*p) && *p != '>' && *p != '/')
+			p++;
+		int nameLen = p - name;
+		p = skipSpace(p, end);
+		if (nameLen == 0 || p == end || *p != '=')
+			return false;
+		p = skipSpace(p + 1, end);
+		if (p == end || (*p != '"' && *p != '\''))
+			return false;
+
+		char quote = *p++;
+		const char *value = p;
+		while (p < end && *p != quote) {
+			if (*p == '&' || *p == '<')
+				return false;
+			p++;
+		}
+		if (p == end)
+			return false;
+		if (!attr(name, nameLen, value, p - value))
+			return false;
+		p++;
+	}
+}
+
+/* attributes of <Robot> */
+struct RobotAttributes
+{
+	CRRobot &robot;
+	RobotAttributes(CRRobot &r) : robot(r) {}
+
+	bool operator()(const char *name, int nameLen, const char *value, int len)
+	{
+		int v;
+		if (same(name, nameLen, "Name")) {
+			char buff[MAXROBOTNAME];
+			if (len >= MAXROBOTNAME)
+				len = MAXROBOTNAME - 1;
+			memcpy(buff, value, len);
+			buff[len] = '\0';
+			robot.setName(buff);
+		}
+		else if (same(name, nameLen, "Id")) {
+			if (!parseInt(value, len, v)) return false;
+			robot.setId(v);
+		}
+		else if (same(name, nameLen, "Time")) {
+			if (!parseInt(value, len, v)) return false;
+			robot.setCurrentTime(v);
+		}
+		else if (same(name, nameLen, "Score")) {
+			if (!parseInt(value, len, v)) return false;
+			robot.setScore(v);
+		}
+		else if (same(name, nameLen, "ArrivalTime")) {
+			if (!parseInt(value, len, v)) return false;
+			robot.setArrivalTime(v);
+		}
+		else if (same(name, nameLen, "ReturningTime")) {
+			if (!parseInt(value, len, v)) return false;
+			robot.setReturnTime(v);
+		}
+		else if (same(name, nameLen, "Collisions")) {
+			if (!parseInt(value, len, v)) return false;
+			robot.setCollisions(v);
+		}
+		else if (same(name, nameLen, "Collision")) {
+			char buff[8];
+			if (len > 7)
+				return false;
+			memcpy(buff, value, len);
+			buff[len] = '\0';
+			robot.setCollision(buff);
+		}
+		else if (same(name, nameLen, "State")) {
+			if (same(value, len, "Stopped"))
+				robot.setState(CRRobot::STOPPED);
+			else if (same(value, len, "Running"))
+				robot.setState(CRRobot::RUNNING);
+			else if (same(value, len, "Waiting"))
+				robot.setState(CRRobot::WAITINGOTHERS);
+			else if (same(value, len, "Removed"))
+				robot.setState(CRRobot::REMOVED);
+			else if (same(value, len, "Finished"))
+				robot.setState(CRRobot::FINISHED);
+			else if (same(value, len, "Returning"))
+				robot.setState(CRRobot::RETURNING);
+		}
+		// other attributes (VisitedMask) are not used by the viewer
+		return true;
+	}
+};
+
+/* attributes of <Position> */
+struct PositionAttributes
+{
+	CRRobot &robot;
+	PositionAttributes(CRRobot &r) : robot(r) {}
+
+	bool operator()(const char *name, int nameLen, const char *value, int len)
+	{
+		float v;
+		if (same(name, nameLen, "X")) {
+			if (!parseFloat(value, len, v)) return false;
+			robot.setX(v);
+		}
+		else if (same(name, nameLen, "Y")) {
+			if (!parseFloat(value, len, v)) return false;
+			robot.setY(v);
+		}
+		else if (same(name, nameLen, "Dir")) {
+			if (!parseFloat(value, len, v)) return false;
+			robot.setDirection(v);
+		}
+		return true;
+	}
+};
+
+/* true if [p, end) starts with the null terminated string s */
+static inline bool startsWith(const char *p, const char *end, const char *s)
+{
+	int n = strlen(s);
+	return end - p >= n && memcmp(p, s, n) == 0;
+}
+
+CRRobotDecoder::CRRobotDecoder()
+{
+}
+
+bool CRRobotDecoder::decode( const char *msg, int len )
+{
+	const char *end = (const char *) memchr(msg, '\0', len);
+	if (end == NULL)
+		end = msg + len;
+
+	const char *p = skipSpace(msg, end);
+	if (!startsWith(p, end, "<Robot") || p + 6 == end || !isSpace(p[6]))
+		return false;
+	p += 6;
+
+	// same defaults as a robot created by the generic parser
+	decoded.setName( "Player" );
+	decoded.setCollision( "False" );
+	decoded.setId( 0 );
+	decoded.setScore( 0 );
+	decoded.setCollisions( 0 );
+	decoded.setX( 0.0 );
+	decoded.setY( 0.0 );
+	decoded.setDirection( 0.0 );
+	decoded.setCurrentTime( 0 );
+	decoded.setArrivalTime( 0 );
+	decoded.setReturnTime( 0 );
+	decoded.setState( CRRobot::STOPPED );
+
+	bool empty;
+	RobotAttributes robotAttr(decoded);
+	if (!scanAttributes(p, end, empty, robotAttr))
+		return false;
+
+	if (!empty) {
+		p = skipSpace(p, end);
+		if (startsWith(p, end, "<Position") && p + 9 < end &&
+			(isSpace(p[9]) || p[9] == '/' || p[9] == '>')) {
+			p += 9;
+			PositionAttributes positionAttr(decoded);
+			if (!scanAttributes(p, end, empty, positionAttr) || !empty)
+				return false;
+			p = skipSpace(p, end);
+		}
+		if (!startsWith(p, end, "</Robot"))
+			return false;
+		p = skipSpace(p + 7, end);
+		if (p == end || *p != '>')
+			return false;
+		p++;
+	}
+
+	return skipSpace(p, end) == end;
+}
+
+CRRobot *CRRobotDecoder::apply( CRLab *lab )
+{
+	int id = decoded.id();
+	if (lab->robot( id ) != NULL)
+	{
+		lab->addRobot( &decoded );		// update in place, or remove
+		return lab->robot( id );
+	}
+
+	CRRobot *robot = new CRRobot( decoded );
+	lab->addRobot( robot );
+	if (lab->robot( id ) != robot)
+	{
+		delete robot;
+		return NULL;
+	}
+	return robot;
+}
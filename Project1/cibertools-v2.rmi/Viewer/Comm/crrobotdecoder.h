@@ -0,0 +1,68 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef _CIBER_RATO_CRROBOTDECODER_
+#define _CIBER_RATO_CRROBOTDECODER_
+
+/*! \class CRRobotDecoder
+ *  \brief Fast decoder for the robot messages sent by the simulator.
+ *
+ *  The <Robot ...><Position .../></Robot> message is received once per
+ *  robot and per cycle. This decoder scans it in place, without
+ *  allocating memory, and writes the result straight into the robot
+ *  entry of the lab. Lab, Grid and any message it does not fully
+ *  understand are left to CRQCommHandler.
+ */
+
+#include "../Lab/crrobot.h"
+#include "../Lab/crlab.h"
+
+class CRRobotDecoder
+{
+public:
+	/*! This is the constructor.
+	 */
+	CRRobotDecoder();
+
+	/*! Decodes one datagram.
+	 * \param msg the datagram, not necessarily null terminated.
+	 * \param len the datagram length.
+	 * \return true if msg was a robot message and was decoded; false
+	 * if it must be parsed by the generic parser.
+	 */
+	bool decode( const char *msg, int len );
+
+	/*! Copies the last decoded robot into the lab, exactly as
+	 * CRLab::addRobot does with a robot from the generic parser. The lab
+	 * entry is updated in place; it is only allocated the first time the
+	 * robot is seen and deleted when the robot is removed.
+	 * \return the lab entry of the robot, NULL if it is not in the lab.
+	 */
+	CRRobot *apply( CRLab *lab );
+
+	/*! The last decoded robot.
+	 */
+	CRRobot &robot( void ) { return decoded; }
+
+private:
+	CRRobot decoded;
+};
+
+#endif
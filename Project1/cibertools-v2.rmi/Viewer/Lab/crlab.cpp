@@ -154,15 +154,12 @@ int CRLab::addGrid( CRGrid *startGrid )
 
 int CRLab::addRobot( CRRobot* robot )
 {
-	if ( ( (labGrid != NULL) &&
-		 (robot->id() <= grid()->howManyPositions()) &&
-		 (robot->id() > 0) ) ||
-
-		 ( (labGrid == NULL) &&
-		 (robot->id() <= 3) &&
-		 (robot->id() > 0) )
-	   ) //valid robotID?
+	// the simulator may accept more robots than the grid has positions
+	if ( robot->id() > 0 && robot->id() <= CRLAB_MAX_ROBOTS ) //valid robotID?
 		{
+			if ( robot->id() > (int) robotArray.size() )
+				robotArray.resize( robot->id(), NULL );
+
 			if ( robotArray[ robot->id()-1 ] == NULL ) // Add or update?
 			{
 				// We have an addRobot procedure
@@ -186,6 +183,8 @@ int CRLab::addRobot( CRRobot* robot )
 						robotArray[ robot->id() -1 ]->setCollisions( robot->collisions() );
 						robotArray[ robot->id() -1 ]->setCollision( robot->collision() );
 						robotArray[ robot->id() -1 ]->setCurrentTime( robot->currentTime() );
+						robotArray[ robot->id() -1 ]->setArrivalTime( robot->arrivalTime() );
+						robotArray[ robot->id() -1 ]->setReturnTime( robot->returnTime() );
 					}
 
 			}
@@ -265,13 +264,15 @@ CRVertice CRLab::labSize()
 	return labsize;
 }
 
+int CRLab::howManyRobots( void )
+{
+	return robotArray.size();
+}
+
 CRRobot* CRLab::robot( int id )
 {
-	if ( (labGrid != NULL) &&
-		 ( id <= grid()->howManyPositions()) && id > 0 ) //valid robotID?
+	if ( id > 0 && id <= (int) robotArray.size() ) //valid robotID?
 			return robotArray[ id -1 ];
 
-	else if ( (id > 0) && (id <= 3) ) return robotArray[ id -1 ];
-
 	return NULL;
 }
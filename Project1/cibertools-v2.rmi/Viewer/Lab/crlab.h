@@ -32,6 +32,7 @@
 using namespace std;
 
 #define MAXLABNAME 25
+#define CRLAB_MAX_ROBOTS 4096
 
 /*! \class CRLab 
  *  \brief This class stores the real information about the lab. This
@@ -117,8 +118,9 @@ public:
 	 */
 	int addTarget ( CRVertice pos, float radius=2.0 );
 	
-	/*! addRobot adds a robot to the lab. Be careful not to add more robots 
-	 * than the number defined by the grid or 3 by default.
+	/*! addRobot adds a robot to the lab. There is room for as many robots
+	 * as the grid has positions, or 3 by default, and it grows for
+	 * the robots with higher ids, up to CRLAB_MAX_ROBOTS.
 	 * \param robot is the robot object.
 	 * \sa CRRobot
 	 */
@@ -173,6 +175,9 @@ public:
 	 * NULL is returned.
 	 */
 	CRRobot*		  robot( int id );
+	/*! howManyRobots Returns the highest robot id the lab has room for.
+	 */
+	int				  howManyRobots( void );
 
 	/*! labName Returns the lab name.
 	 */
@@ -16,6 +16,8 @@ HEADERS += \
     crqscene.h \
     crqparamhandler.h \
     Comm/crqcomm.h \
+    Comm/crrobotdecoder.h \
+    Comm/crchunk.h \
     crqrobotinfo.h \
     crqlabview.h \
     crqdataview.h
@@ -32,6 +34,8 @@ SOURCES += \
     Lab/crwall.cpp \
     Comm/crqcomm.cpp \
     Comm/crqcommhandler.cpp \
+    Comm/crrobotdecoder.cpp \
+    Comm/crchunk.cpp \
     Comm/crqreplyhandler.cpp \
     crqrobotinfo.cpp \
     crqlabview.cpp \
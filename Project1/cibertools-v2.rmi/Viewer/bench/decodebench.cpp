@@ -0,0 +1,246 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+ * decodebench - compares the generic XML parsing of the robot messages
+ * received by the viewer (QXmlSimpleReader + CRQCommHandler) with the
+ * specialised CRRobotDecoder.
+ *
+ * The messages come from a file captured with "Viewer -capture file"
+ * or, when no file is given, are generated in the simulator format.
+ * Both decoders are applied to a lab, as done by CRQComm, and their
+ * results are compared.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <QString>
+#include <QTime>
+#include <qxml.h>
+
+#include "../Comm/crqcommhandler.h"
+#include "../Comm/crrobotdecoder.h"
+#include "../Lab/crlab.h"
+#include "../Lab/crgrid.h"
+
+using namespace std;
+
+static void CommandLineError()
+{
+	cerr << "SYNOPSIS: decodebench [-robots n] [-cycles n] [-repeat n] [capturefile]\n"
+	        "  without capturefile, robots*cycles messages are generated\n";
+	exit(1);
+}
+
+/* Reads the null separated datagrams of a capture file */
+static bool readCapture(const char *fileName, vector<string> &msgs)
+{
+	FILE *f = fopen(fileName, "rb");
+	if (f == NULL) {
+		cerr << "Could not open " << fileName << "\n";
+		return false;
+	}
+	string msg;
+	int c;
+	while ((c = fgetc(f)) != EOF) {
+		if (c == '\0') {
+			msgs.push_back(msg);
+			msg.clear();
+		}
+		else msg += (char) c;
+	}
+	if (!msg.empty())
+		msgs.push_back(msg);
+	fclose(f);
+	return true;
+}
+
+/* Robot messages as written by cbRobot::toXml */
+static void generate(int nRobots, int nCycles, vector<string> &msgs)
+{
+	char xml[1024];
+	srand(1);
+	for (int t = 1; t <= nCycles; t++)
+		for (int r = 1; r <= nRobots; r++) {
+			double x = 1.0 + (rand() % 26000) / 1000.0;
+			double y = 1.0 + (rand() % 12000) / 1000.0;
+			double dir = (rand() % 360000) / 1000.0 - 180.0;
+			sprintf(xml, "<Robot Name=\"Robot%d\" Id=\"%d\" Time=\"%d\" Score=\"%d\" ArrivalTime=\"%d\""
+			        " ReturningTime=\"0\" Collisions=\"%d\" Collision=\"%s\" VisitedMask=\"0101\""
+			        " State=\"Running\">\n\t<Position X=\"%g\" Y=\"%g\" Dir=\"%g\"/>\n</Robot>\n",
+			        r, r, t, t / 10, t > nCycles / 2 ? nCycles / 2 : 0, t / 50,
+			        t % 50 ? "False" : "True", x, y, dir);
+			msgs.push_back(xml);
+		}
+}
+
+/* Generic path of CRQComm::dataControler, NULL if msg is not a robot */
+static CRRobot *parseGeneric(CRLab *lab, const string &msg)
+{
+	QXmlInputSource source;
+	source.setData( QString( msg.c_str() ) );
+	CRQCommHandler commHandler;
+	QXmlSimpleReader reader;
+	reader.setContentHandler(&commHandler);
+	if (!reader.parse(source) || commHandler.objectType() != CRQCommHandler::ROBOT) {
+		delete commHandler.getLab();
+		delete commHandler.getGrid();
+		return NULL;
+	}
+
+	CRRobot *robot = commHandler.getRobot();
+	int id = robot->id();
+	lab->addRobot( robot );
+	if (lab->robot( id ) != robot)
+		delete robot;
+	return lab->robot( id );
+}
+
+/* A lab with a grid for the robots of the messages */
+static CRLab *makeLab(const vector<string> &msgs, int nRobots)
+{
+	CRLab *lab = new CRLab();
+	CRGrid *grid = NULL;
+
+	// the captured grid, if any
+	for (unsigned int m = 0; m < msgs.size() && grid == NULL; m++) {
+		if (msgs[m].find("<Grid") == string::npos)
+			continue;
+		QXmlInputSource source;
+		source.setData( QString( msgs[m].c_str() ) );
+		CRQCommHandler commHandler;
+		QXmlSimpleReader reader;
+		reader.setContentHandler(&commHandler);
+		if (reader.parse(source) && commHandler.objectType() == CRQCommHandler::GRID)
+			grid = commHandler.getGrid();
+	}
+	if (grid == NULL) {
+		CRGridElement element;
+		element.direction = 0.0;
+		grid = new CRGrid();
+		for (int r = 0; r < nRobots; r++)
+			grid->addPosition( &element );
+	}
+	lab->addGrid( grid );
+	return lab;
+}
+
+static bool same(CRRobot *a, CRRobot *b)
+{
+	if (a == NULL || b == NULL)
+		return a == b;
+	return strcmp(a->name(), b->name()) == 0 && a->id() == b->id() &&
+	       a->score() == b->score() && a->currentTime() == b->currentTime() &&
+	       a->arrivalTime() == b->arrivalTime() && a->returnTime() == b->returnTime() &&
+	       a->collisions() == b->collisions() && strcmp(a->collision(), b->collision()) == 0 &&
+	       a->state() == b->state() &&
+	       a->x() == b->x() && a->y() == b->y() && a->direction() == b->direction();
+}
+
+int main(int argc, char *argv[])
+{
+	int nRobots = 5, nCycles = 2000, repeat = 5;
+	const char *captureFile = NULL;
+
+	for (int p = 1; p < argc; p++) {
+		if (strcmp(argv[p], "-robots") == 0) {
+			if (p+1 < argc && sscanf(argv[p+1], "%d", &nRobots) == 1 && nRobots > 0) p++;
+			else CommandLineError();
+		}
+		else if (strcmp(argv[p], "-cycles") == 0) {
+			if (p+1 < argc && sscanf(argv[p+1], "%d", &nCycles) == 1 && nCycles > 0) p++;
+			else CommandLineError();
+		}
+		else if (strcmp(argv[p], "-repeat") == 0) {
+			if (p+1 < argc && sscanf(argv[p+1], "%d", &repeat) == 1 && repeat > 0) p++;
+			else CommandLineError();
+		}
+		else if (argv[p][0] != '-' && captureFile == NULL) captureFile = argv[p];
+		else CommandLineError();
+	}
+
+	vector<string> all, msgs;
+	if (captureFile != NULL) {
+		if (!readCapture(captureFile, all)) return 1;
+	}
+	else generate(nRobots, nCycles, all);
+
+	// only robot messages are timed
+	for (unsigned int m = 0; m < all.size(); m++)
+		if (all[m].find("<Robot") != string::npos)
+			msgs.push_back(all[m]);
+	if (msgs.empty()) {
+		cerr << "No robot messages to decode\n";
+		return 1;
+	}
+
+	CRLab *genericLab = makeLab(all, nRobots);
+	CRLab *fastLab = makeLab(all, nRobots);
+	CRRobotDecoder decoder;
+
+	// check both paths leave the lab in the same state
+	unsigned int mismatches = 0, fallbacks = 0;
+	for (unsigned int m = 0; m < msgs.size(); m++) {
+		CRRobot *generic = parseGeneric(genericLab, msgs[m]);
+		CRRobot *fast;
+		if (decoder.decode(msgs[m].c_str(), msgs[m].size()))
+			fast = decoder.apply(fastLab);
+		else {
+			fallbacks++;
+			fast = parseGeneric(fastLab, msgs[m]);
+		}
+		if (!same(generic, fast))
+			mismatches++;
+	}
+
+	QTime clock;
+	clock.start();
+	for (int r = 0; r < repeat; r++)
+		for (unsigned int m = 0; m < msgs.size(); m++)
+			parseGeneric(genericLab, msgs[m]);
+	double genericTime = clock.elapsed() / 1000.0;
+
+	clock.start();
+	for (int r = 0; r < repeat; r++)
+		for (unsigned int m = 0; m < msgs.size(); m++)
+			if (decoder.decode(msgs[m].c_str(), msgs[m].size()))
+				decoder.apply(fastLab);
+	double fastTime = clock.elapsed() / 1000.0;
+
+	double n = (double) msgs.size() * repeat;
+	if (genericTime <= 0.0) genericTime = 0.001;
+	if (fastTime <= 0.0) fastTime = 0.001;
+
+	printf("%u robot messages (%s), %d repetitions\n", (unsigned int) msgs.size(),
+	       captureFile != NULL ? captureFile : "generated", repeat);
+	printf("generic parser: %10.0f msg/s %8.0f ns/msg\n", n / genericTime, genericTime * 1e9 / n);
+	printf("robot decoder:  %10.0f msg/s %8.0f ns/msg\n", n / fastTime, fastTime * 1e9 / n);
+	printf("speedup %.1fx, %u mismatches, %u messages left to the generic parser\n",
+	       genericTime / fastTime, mismatches, fallbacks);
+
+	delete genericLab;
+	delete fastLab;
+	return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,20 @@
+TEMPLATE	= app
+CONFIG		+= qt warn_on release console
+
+win32 {
+    DEFINES     += MicWindows
+}
+
+# robot message decoding, generic parser against CRRobotDecoder
+HEADERS		= ../Comm/crqcommhandler.h ../Comm/crrobotdecoder.h\
+		  ../Lab/crlab.h ../Lab/crgrid.h ../Lab/crrobot.h ../Lab/crbeacon.h\
+		  ../Lab/crtarget.h ../Lab/crwall.h ../Lab/crvertice.h
+SOURCES		= decodebench.cpp\
+		  ../Comm/crqcommhandler.cpp ../Comm/crrobotdecoder.cpp\
+		  ../Lab/crlab.cpp ../Lab/crgrid.cpp ../Lab/crrobot.cpp ../Lab/crbeacon.cpp\
+		  ../Lab/crtarget.cpp ../Lab/crwall.cpp ../Lab/crvertice.cpp
+
+TARGET		= decodebench
+
+QT		-= gui
+QT		+= xml
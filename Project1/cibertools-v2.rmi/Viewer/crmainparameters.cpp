@@ -30,6 +30,8 @@ CRMainParameters::CRMainParameters()
 	autoConnect = 'n';
 	control = 'y';
 	autoStart = 'n';
+	frameRate = 25;
+	interpolate = 'n';
 }
 
 CRMainParameters::~CRMainParameters()
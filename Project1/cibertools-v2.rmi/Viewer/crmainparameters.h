@@ -70,6 +70,20 @@ public:
 	char autoConnect;
 
 	char control;
+
+	/*! Scene redraws per second. Robot updates received between frames
+	 * are coalesced.
+	 */
+	unsigned int frameRate;
+
+	/*! 'y' to interpolate robot positions and headings between
+	 * simulation cycles.
+	 */
+	char interpolate;
+
+	/*! File where the received datagrams are saved, none if empty.
+	 */
+	QString capture;
 };
 #endif
 
@@ -54,10 +54,7 @@ CRQDataView::CRQDataView(CRReply *r, CRLab *l, QString skinFName, QWidget *paren
     if( lab->grid() != NULL )		// if grid exist
         nRobots = lab->grid()->howManyPositions();
 
-    usedId = new int[nRobots];
-
-    for ( int n = 0; n < nRobots; n++ )
-        usedId[n] = 0;
+    usedId.assign( nRobots, 0 );
 
     robots.resize( nRobots ); // robot is one vector of CRQRobotInfo
 
@@ -72,9 +69,6 @@ CRQDataView::~CRQDataView()
     cout << "CRQDataView::~CRQDataView\n";
 #endif
 
-    if(usedId != NULL)
-        delete usedId;
-
     for(int i = 0 ; i < 3 ; i++)
         if(robots[i] != NULL)
             delete robots[i];
@@ -116,6 +110,14 @@ void CRQDataView::skin(QString skinFileName)
 
 void CRQDataView::update( CRRobot *rob )
 {
+    // robots registered beyond the positions of the grid
+    if ( rob->id() > nRobots && rob->id() <= CRLAB_MAX_ROBOTS )
+    {
+        nRobots = rob->id();
+        usedId.resize( nRobots, 0 );
+        robots.resize( nRobots, NULL );
+    }
+
     if ( (rob->id() > 0) && (rob->id() < (nRobots + 1) ) )
     {
         if( usedId[ rob->id() - 1] == 0 )
@@ -70,7 +70,7 @@ protected:
 
 private:
     int nRobots; 					 // number of robots
-    int *usedId;					 // used robots ID
+    vector<int> usedId;			 // used robots ID
     CRLab *lab;
     CRReply *reply;
     vector< CRQRobotInfo *> robots;
@@ -34,6 +34,10 @@ CRQLabView::CRQLabView(CRMainParameters *p, QWidget *parent) :
     QString host( param->serverAddr );
     comm = new CRQComm(this, scene, lab, host, param->port,
                        param->control, param->autoConnect, param->autoStart);
+    comm->setFrameRate( param->frameRate );
+    scene->setInterpolation( param->interpolate == 'y' );
+    if ( !param->capture.isEmpty() )
+        comm->setCapture( param->capture.toLocal8Bit().constData() );
 
     ui->graphicsView_lab->setBackgroundBrush( QColor( 128, 128, 128 ));
     ui->graphicsView_lab->setScene(scene);
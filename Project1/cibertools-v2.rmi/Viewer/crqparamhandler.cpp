@@ -81,6 +81,14 @@ bool CRQParamHandler::startElement( const QString&, const QString&,
         if ( !autoS.isNull() )
             paramObject->autoStart = autoS[0].toAscii();
 
+        const QString frameRate = attr.value( QString( "FrameRate" ));
+        if ( !frameRate.isNull() )
+            paramObject->frameRate = frameRate.toUInt();
+
+        const QString interpolate = attr.value( QString( "Interpolate" ));
+        if ( !interpolate.isNull() )
+            paramObject->interpolate = interpolate[0].toAscii();
+
         return true;
     }
 	else
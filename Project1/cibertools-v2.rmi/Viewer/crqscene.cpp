@@ -41,9 +41,10 @@ CRQScene::CRQScene( CRLab *lb, QObject * parent  )
 	robotsVarStatus = 0;
 	nRobots = 5;
 	labStatus = 0;
-	usedId = NULL;
 	bgInitSprite = NULL;
 	bgGameSprite = NULL;
+	interpolate = false;
+	frameClock.start();
 
     if(QSound::isAvailable())
     {
@@ -104,11 +105,8 @@ void CRQScene::drawLab( CRLab * l_b )
 #ifdef DEBUG
     cout << "CRQScene::drawLab\n";
 #endif
-    for(int i = 0 ; i < 10 ; i++)
-    {
-        playSoundFinished[i] = 1;
-        playSoundReturning[i] = 1;
-    }
+    playSoundFinished.assign(playSoundFinished.size(), 1);
+    playSoundReturning.assign(playSoundReturning.size(), 1);
 
 	if(labStatus != 0)
 		this->clear();
@@ -253,31 +251,53 @@ int CRQScene::drawRobot( CRLab * l_b )
 		if( lab->grid() != NULL )		// if grid exist
 			nRobots = lab->grid()->howManyPositions(); 
 
-		usedId = new int[nRobots];   // estado dos robots
-		for ( int n = 0; n < nRobots; n++ )
-			usedId[n] = 0;
-
+		usedId.assign( nRobots, 0 );   // estado dos robots
+		playSoundReturning.assign( nRobots, 1 );
+		playSoundFinished.assign( nRobots, 1 );
 		robots.resize( nRobots );
         robotsVarStatus = 1;
     }
 
+    // robots registered beyond the positions of the grid
+    if ( lab->howManyRobots() > nRobots )
+    {
+        nRobots = lab->howManyRobots();
+        usedId.resize( nRobots, 0 );
+        playSoundReturning.resize( nRobots, 1 );
+        playSoundFinished.resize( nRobots, 1 );
+        robots.resize( nRobots, NULL );
+    }
+
+	int now = frameClock.elapsed();
+
 	// percorre todos os robots existentes no lab
     for( int nRobs=1; nRobs<=nRobots; nRobs++ )
     {
 		rob=lab->robot( nRobs );
         if( rob !=NULL && (rob->id() > 0) && (rob->id() < (nRobots + 1) ) )
         {
-            float dir = rob->direction();
+            // there are images for the first robots, the others reuse them
+            int img = (rob->id() - 1) % robPixmap.size();
+            float x = rob->x(), y = rob->y(), dir = rob->direction();
+            bool updated = true;
+            if( (unsigned int) rob->id() <= poses.size() )
+            {
+                RobotPose &p = poses[rob->id() - 1];
+                currentPose( p, now, x, y, dir );
+                updated = p.updated;
+                p.updated = false;
+            }
             if( dir < 0 )
                 dir += 360;
+
             if( usedId[ rob->id() - 1] == 0 ) // if robot not created
             {
                 QGraphicsPixmapItem *robot = new QGraphicsPixmapItem(0, this);
 
                 if(rob->state() == CRRobot::RETURNING)
-                    robot->setPixmap(*robPixmapReturn[rob->id() - 1]);
+                    robot->setPixmap(*robPixmapReturn[img]);
                 else
-                    robot->setPixmap(*robPixmap[rob->id() - 1]);
+                    robot->setPixmap(*robPixmap[img]);
 
                 assert(!robot->pixmap().isNull());
 
@@ -286,8 +306,8 @@ int CRQScene::drawRobot( CRLab * l_b )
 
                 robot->setTransformOriginPoint(robWidth / 2.0, robHeight / 2.0);
 
-                robot->setX( rob->x() * zoom - robWidth / 2.0);
-                robot->setY( sizeInPixels - rob->y() * zoom - robHeight / 2.0);
+                robot->setX( x * zoom - robWidth / 2.0);
+                robot->setY( sizeInPixels - y * zoom - robHeight / 2.0);
 
                 robot->setVisible( true );
                 robot->setZValue( 5 );
@@ -296,6 +316,17 @@ int CRQScene::drawRobot( CRLab * l_b )
 				robots[rob->id() - 1] = robot; //Add new robot to vector
                 usedId[rob->id() - 1] = 1;	   //Update the var used
             }
+            else if (!updated)	// no news, only the interpolated pose changes
+            {
+                QGraphicsPixmapItem *robot = robots[rob->id() - 1];
+                if (!interpolate)
+                    continue;
+
+                if(strncmp(rob->collision(), "True", 4) != 0)
+                    robot->setRotation(-dir);
+                robot->setPos (x * zoom - robot->pixmap().width() / 2.0,
+                               sizeInPixels - y * zoom - robot->pixmap().height() / 2.0);
+            }
             else		// if robot exist
             {
                 QGraphicsPixmapItem *robot = robots[rob->id() - 1];
@@ -303,14 +334,18 @@ int CRQScene::drawRobot( CRLab * l_b )
                 if (rob->state() == CRRobot::REMOVED)
                     robot->setVisible(false);
 
-                if (rob->state() == CRRobot::RETURNING ||
-                        rob->state() == CRRobot::STOPPED ||
-                        rob->state() == CRRobot::FINISHED)
-                    startP[rob->id() - 1]->setRect(0, 0,
-                                                   1 * zoom, 1 * zoom);
-                else
-                    startP[rob->id() - 1]->setRect(0.25 * zoom, 0.25 * zoom,
-                                                   0.5 * zoom, 0.5 * zoom);
+                // the grid may have been received before the positions added for the robot
+                if ((unsigned int) rob->id() <= startP.size())
+                {
+                    if (rob->state() == CRRobot::RETURNING ||
+                            rob->state() == CRRobot::STOPPED ||
+                            rob->state() == CRRobot::FINISHED)
+                        startP[rob->id() - 1]->setRect(0, 0,
+                                                       1 * zoom, 1 * zoom);
+                    else
+                        startP[rob->id() - 1]->setRect(0.25 * zoom, 0.25 * zoom,
+                                                       0.5 * zoom, 0.5 * zoom);
+                }
 
 
                 // no caso de colisoes:
@@ -318,22 +353,22 @@ int CRQScene::drawRobot( CRLab * l_b )
                 if(strncmp(rob->collision(), "True", 4) == 0 &&
                         rob->state() != CRRobot::REMOVED)
                 {
-                    robot->setPixmap(*robPixmapCollision[rob->id() - 1]);
+                    robot->setPixmap(*robPixmapCollision[img]);
                     if(QSound::isAvailable() && sound == 'y')
                         collisionSound->play();
                 }
                 else
                 {
                     if(rob->state() == CRRobot::RETURNING)
-                        robot->setPixmap(*robPixmapReturn[rob->id() - 1]);
+                        robot->setPixmap(*robPixmapReturn[img]);
                     else
-                        robot->setPixmap(*robPixmap[rob->id() - 1]);
+                        robot->setPixmap(*robPixmap[img]);
 
                     robot->setRotation(-dir);
                 }
 
-                robot->setPos (rob->x() * zoom - robot->pixmap().width() / 2.0,
-                               sizeInPixels - rob->y() * zoom - robot->pixmap().height() / 2.0);
+                robot->setPos (x * zoom - robot->pixmap().width() / 2.0,
+                               sizeInPixels - y * zoom - robot->pixmap().height() / 2.0);
 
                 if(rob->state() == CRRobot::RETURNING &&
                         playSoundReturning[rob->id() - 1])
@@ -360,6 +395,92 @@ int CRQScene::drawRobot( CRLab * l_b )
     return 0;
 }
 
+/*============================================================================*/
+void CRQScene::robotUpdated( CRRobot *rob )
+{
+    if (rob == NULL || rob->id() <= 0)
+        return;
+
+    unsigned int i = rob->id() - 1;
+    if (i >= poses.size())
+    {
+        RobotPose empty;
+        empty.lastUpdate = -1;
+        empty.updated = false;
+        poses.resize(i + 1, empty);
+    }
+
+    int now = frameClock.elapsed();
+    RobotPose &p = poses[i];
+
+    float x = rob->x(), y = rob->y(), dir = rob->direction();
+    if (!interpolate || p.lastUpdate < 0 ||
+            fabs(x - p.toX) > 2.0 || fabs(y - p.toY) > 2.0)	// a jump, not a move
+    {
+        p.fromX = x;
+        p.fromY = y;
+        p.fromDir = dir;
+        p.duration = 100;
+    }
+    else
+    {
+        // continue from the pose being shown
+        currentPose(p, now, p.fromX, p.fromY, p.fromDir);
+
+        int interval = now - p.lastUpdate;
+        if (interval > 1000)
+            interval = 1000;
+        if (interval > 0)
+            p.duration = (3 * p.duration + interval) / 4;
+    }
+    p.toX = x;
+    p.toY = y;
+    p.toDir = dir;
+    p.start = now;
+    p.lastUpdate = now;
+    p.updated = true;
+}
+
+/*============================================================================*/
+void CRQScene::currentPose( RobotPose &p, int now, float &x, float &y, float &dir )
+{
+    if (p.lastUpdate < 0)
+        return;
+
+    float a = 1.0;
+    if (interpolate && p.duration > 0 && now - p.start < p.duration)
+        a = (float) (now - p.start) / p.duration;
+
+    float turn = p.toDir - p.fromDir;	// shortest turn, in degrees
+    while (turn > 180.0)
+        turn -= 360.0;
+    while (turn < -180.0)
+        turn += 360.0;
+
+    x = p.fromX + a * (p.toX - p.fromX);
+    y = p.fromY + a * (p.toY - p.fromY);
+    dir = p.fromDir + a * turn;
+}
+
+/*============================================================================*/
+void CRQScene::setInterpolation( bool on )
+{
+    interpolate = on;
+}
+
+/*============================================================================*/
+bool CRQScene::moving( void )
+{
+    if (!interpolate)
+        return false;
+
+    int now = frameClock.elapsed();
+    for (unsigned int i = 0; i < poses.size(); i++)
+        if (poses[i].lastUpdate >= 0 && now - poses[i].start < poses[i].duration)
+            return true;
+    return false;
+}
+
 /*============================================================================*/
 void CRQScene::clear( void )
 {
@@ -391,11 +512,7 @@ void CRQScene::clear( void )
         bgInitImage = NULL;
     }
 
-    if(usedId != NULL)
-    {
-		delete [] usedId;
-        usedId = NULL;
-    }
+    usedId.clear();
 
     if(lowerWallsFile != NULL)
     {
@@ -415,6 +532,7 @@ void CRQScene::clear( void )
     startPixmap.clear();
 	robots.clear();
 	startP.clear();
+	poses.clear();
 
 	// Initialize status
 	robotsVarStatus = 0;
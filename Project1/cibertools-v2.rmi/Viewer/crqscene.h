@@ -30,6 +30,7 @@
 
 #include <QGraphicsScene>
 #include <QSound>
+#include <QTime>
 #include "./Lab/crlab.h"
 #include "./Lab/crrobot.h"
 
@@ -62,6 +63,18 @@ public:
 	 *  be moved and/or rotated.
 	 */
 	int drawRobot( CRLab * );
+	/*! Records the new pose of a robot received from the simulator. The
+	 *  robot is redrawn in the next call to drawRobot; with interpolation
+	 *  on, it moves smoothly from the pose being shown to the new one
+	 *  over one simulation cycle.
+	 */
+	void robotUpdated( CRRobot * );
+	/*! Turns position and heading interpolation on or off.
+	 */
+	void setInterpolation( bool on );
+	/*! Returns true while some robot is still being interpolated.
+	 */
+	bool moving( void );
     /*! Clear the scene, all elements will be lost.
 	 */
 	void clear( void );
@@ -105,9 +118,27 @@ signals:
 	void newSize(int x, int y);
 
 private:
+	// Pose of a robot, as shown and as received
+	struct RobotPose
+	{
+		float fromX, fromY, fromDir;
+		float toX, toY, toDir;
+		int start;			// ms, when the move started
+		int duration;		// ms, estimated simulation cycle
+		int lastUpdate;		// ms, last update received; -1 if none
+		bool updated;		// state changed since last drawRobot
+	};
+
+	void currentPose( RobotPose &p, int now, float &x, float &y, float &dir );
+
 	// Vector of robots
     vector<QGraphicsPixmapItem *> robots;
 
+    // Poses of the robots, by id-1
+    vector<RobotPose> poses;
+    bool interpolate;
+    QTime frameClock;
+
     // Robot images
     vector<QPixmap *> robPixmap;
     vector<QPixmap *> robPixmapReturn;
@@ -118,7 +149,7 @@ private:
     vector<QGraphicsEllipseItem *> startP;
 
 	// Means that robots already exists
-	int *usedId;
+	vector<int> usedId;
 
 	// Status of the robots construction		
 	int robotsVarStatus;
@@ -148,8 +179,8 @@ private:
 	QSound *collisionSound;
     QSound *returningSound;
     QSound *finishedSound;
-    int playSoundReturning[10];
-    int playSoundFinished[10];
+    vector<int> playSoundReturning;	// by id-1, as usedId
+    vector<int> playSoundFinished;
 };
 
 
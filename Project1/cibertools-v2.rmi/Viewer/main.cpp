@@ -89,6 +89,25 @@ int main( int argc, char **argv )
 			i+=1;
             param->autoConnect = 'y';
         }
+        else if( strcmp(Visualizador.argv()[i], "-framerate") == 0 )
+        {
+			if(Visualizador.argc()<i+2 || Visualizador.argv()[i+1][0]=='-')
+				  ParameterError( Visualizador.argv()[0] ); 
+			sscanf( Visualizador.argv()[i+1], "%u", &(param->frameRate) );
+            i+=2;
+        }
+        else if( strcmp(Visualizador.argv()[i], "-interpolate") == 0 )
+        {
+			i+=1;
+            param->interpolate = 'y';
+        }
+        else if( strcmp(Visualizador.argv()[i], "-capture") == 0 )
+        {
+			if(Visualizador.argc()<i+2 || Visualizador.argv()[i+1][0]=='-')
+				  ParameterError( Visualizador.argv()[0] ); 
+			param->capture = Visualizador.argv()[i+1];
+            i+=2;
+        }
         else if( strcmp(Visualizador.argv()[i], "-paramfile") == 0 )
         {
 			if(Visualizador.argc()<i+2 || Visualizador.argv()[i+1][0]=='-')
@@ -105,6 +124,9 @@ int main( int argc, char **argv )
 			cout << "                   [-nocontrol]\n";
 			cout << "                   [-autoconnect]\n";
 			cout << "                   [-autostart]\n";
+			cout << "                   [-framerate fps]\n";
+			cout << "                   [-interpolate]\n";
+			cout << "                   [-capture file]\n";
 			cout << "                   [-help]\n";
             exit(0);
         }
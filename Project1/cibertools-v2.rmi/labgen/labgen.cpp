@@ -0,0 +1,361 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+ * labgen - writes procedural labs for scaling tests of the simulator.
+ *
+ * The arena is divided in square cells of one corridor plus one wall
+ * thickness. The walls are the sides shared by adjacent cells; a random
+ * spanning tree of the cells (a maze dug with a depth first search) says
+ * which sides are open, and then open random sides until the requested
+ * number of walls is left. Opening sides only adds paths, so every cell
+ * stays reachable from every other one through corridors at least as
+ * wide as the -corridor option, which must let a robot of ROBOT_RADIUS
+ * pass with some clearance. Each wall is a rectangle, a convex polygon
+ * as cbLabHandler requires. A fraction -low of the walls is half as high
+ * as the beacons, so they can be seen over them, the others half as high
+ * again.
+ *
+ * Targets, beacons and start positions are put in distinct cells at a
+ * distance of the walls larger than the robot radius, so the robots start
+ * free and every target can be reached from every start position.
+ * Beacons are put over the first targets, the ones in excess in cells
+ * of their own.
+ *
+ * The same seed and options give the same files. They are written as
+ * <prefix>Lab.xml and <prefix>Grid.xml, to be given to the simulator
+ * with -lab and -grid.
+ */
+
+#include "cbutils.h"
+#include "cbrobotsize.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+using std::vector;
+
+#define CLEARANCE 0.1		// free space kept around a robot
+
+struct Wall {
+	double x0, y0, x1, y1;
+	double height;
+};
+
+struct Options {
+	unsigned long long seed;
+	double width, height;		// 0 to fit the walls
+	unsigned int walls;
+	double corridor, thickness;
+	double beaconHeight, lowFraction;
+	unsigned int beacons, targets;
+	double targetRadius;
+	unsigned int positions, perCell;
+	const char *prefix;
+};
+
+static cbRandom rng;
+
+static unsigned int randIndex(unsigned int n)
+{
+	return (unsigned int) (rng.next() % n);
+}
+
+template <class T> static void shuffle(vector<T> &v)
+{
+	for(unsigned int i = v.size(); i > 1; i--)
+		std::swap(v[i-1], v[randIndex(i)]);
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [-seed n] [-walls n] [-width w] [-height h]\n"
+	        "\t[-corridor c] [-thickness t] [-beaconheight h] [-low fraction]\n"
+	        "\t[-beacons n] [-targets n] [-radius r] [-positions n] [-percell n]\n"
+	        "\t[-o prefix]\n", prog);
+	exit(1);
+}
+
+/*!
+ * Digs a maze on the cols x rows cells and returns the sides left closed,
+ * as the index of the cell and 0 for its right side, 1 for its top side.
+ */
+static void dig(unsigned int cols, unsigned int rows, vector<unsigned int> &closed)
+{
+	unsigned int n = cols*rows;
+	vector<char> open(2*n, 0), visited(n, 0);
+	vector<unsigned int> stack;
+
+	unsigned int start = randIndex(n);
+	visited[start] = 1;
+	stack.push_back(start);
+	while(!stack.empty()) {
+		unsigned int c = stack.back();
+		unsigned int x = c % cols, y = c / cols;
+		unsigned int next[4], side[4], nNext = 0;
+
+		if(x > 0 && !visited[c-1]) { next[nNext] = c-1; side[nNext++] = 2*(c-1); }
+		if(x+1 < cols && !visited[c+1]) { next[nNext] = c+1; side[nNext++] = 2*c; }
+		if(y > 0 && !visited[c-cols]) { next[nNext] = c-cols; side[nNext++] = 2*(c-cols)+1; }
+		if(y+1 < rows && !visited[c+cols]) { next[nNext] = c+cols; side[nNext++] = 2*c+1; }
+
+		if(nNext == 0) {
+			stack.pop_back();
+			continue;
+		}
+		unsigned int k = randIndex(nNext);
+		open[side[k]] = 1;
+		visited[next[k]] = 1;
+		stack.push_back(next[k]);
+	}
+
+	closed.clear();
+	for(unsigned int c = 0; c < n; c++) {
+		if(c % cols + 1 < cols && !open[2*c]) closed.push_back(2*c);
+		if(c / cols + 1 < rows && !open[2*c+1]) closed.push_back(2*c+1);
+	}
+}
+
+static bool writeLab(const char *file, const Options &opt, double width, double height,
+                     const vector<Wall> &walls,
+                     const vector<double> &tx, const vector<double> &ty,
+                     const vector<double> &bx, const vector<double> &by)
+{
+	FILE *fp = fopen(file, "w");
+	if(fp == 0) {
+		fprintf(stderr, "labgen: can not write %s\n", file);
+		return false;
+	}
+
+	fprintf(fp, "<Lab Name=\"labgen seed %llu walls %u\" Width=\"%.2f\" Height=\"%.2f\">\n",
+	        opt.seed, (unsigned int) walls.size(), width, height);
+	for(unsigned int b = 0; b < bx.size(); b++)
+		fprintf(fp, "    <Beacon X=\"%.2f\" Y=\"%.2f\" Height=\"%.2f\"/>\n",
+		        bx[b], by[b], opt.beaconHeight);
+	for(unsigned int t = 0; t < tx.size(); t++)
+		fprintf(fp, "    <Target X=\"%.2f\" Y=\"%.2f\" Radius=\"%.2f\"/>\n",
+		        tx[t], ty[t], opt.targetRadius);
+	for(unsigned int w = 0; w < walls.size(); w++) {
+		const Wall &wl = walls[w];
+		fprintf(fp, "    <Wall Height=\"%.2f\">\n", wl.height);
+		fprintf(fp, "        <Corner X=\"%.2f\" Y=\"%.2f\"/>\n", wl.x0, wl.y0);
+		fprintf(fp, "        <Corner X=\"%.2f\" Y=\"%.2f\"/>\n", wl.x1, wl.y0);
+		fprintf(fp, "        <Corner X=\"%.2f\" Y=\"%.2f\"/>\n", wl.x1, wl.y1);
+		fprintf(fp, "        <Corner X=\"%.2f\" Y=\"%.2f\"/>\n", wl.x0, wl.y1);
+		fprintf(fp, "    </Wall>\n");
+	}
+	fprintf(fp, "</Lab>\n");
+
+	if(fclose(fp) != 0) {
+		fprintf(stderr, "labgen: can not write %s\n", file);
+		return false;
+	}
+	return true;
+}
+
+static bool writeGrid(const char *file, const vector<double> &px,
+                      const vector<double> &py, const vector<double> &pdir)
+{
+	FILE *fp = fopen(file, "w");
+	if(fp == 0) {
+		fprintf(stderr, "labgen: can not write %s\n", file);
+		return false;
+	}
+
+	fprintf(fp, "<Grid>\n");
+	for(unsigned int p = 0; p < px.size(); p++)
+		fprintf(fp, "    <Position X=\"%.2f\" Y=\"%.2f\" Dir=\"%.1f\"/>\n",
+		        px[p], py[p], pdir[p]);
+	fprintf(fp, "</Grid>\n");
+
+	if(fclose(fp) != 0) {
+		fprintf(stderr, "labgen: can not write %s\n", file);
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	Options opt;
+	opt.seed = 1;
+	opt.width = opt.height = 0;
+	opt.walls = 100;
+	opt.corridor = 1.5;
+	opt.thickness = 0.2;
+	opt.beaconHeight = 2.0;
+	opt.lowFraction = 0.5;
+	opt.beacons = 1;
+	opt.targets = 1;
+	opt.targetRadius = 0.5;
+	opt.positions = 10;
+	opt.perCell = 1;
+	opt.prefix = "stress";
+
+	for(int p = 1; p < argc; p++) {
+		if(p+1 >= argc) usage(argv[0]);
+		const char *arg = argv[p], *val = argv[++p];
+		if(strcmp(arg, "-seed") == 0) opt.seed = strtoull(val, 0, 10);
+		else if(strcmp(arg, "-walls") == 0) opt.walls = atoi(val);
+		else if(strcmp(arg, "-width") == 0) opt.width = atof(val);
+		else if(strcmp(arg, "-height") == 0) opt.height = atof(val);
+		else if(strcmp(arg, "-corridor") == 0) opt.corridor = atof(val);
+		else if(strcmp(arg, "-thickness") == 0) opt.thickness = atof(val);
+		else if(strcmp(arg, "-beaconheight") == 0) opt.beaconHeight = atof(val);
+		else if(strcmp(arg, "-low") == 0) opt.lowFraction = atof(val);
+		else if(strcmp(arg, "-beacons") == 0) opt.beacons = atoi(val);
+		else if(strcmp(arg, "-targets") == 0) opt.targets = atoi(val);
+		else if(strcmp(arg, "-radius") == 0) opt.targetRadius = atof(val);
+		else if(strcmp(arg, "-positions") == 0) opt.positions = atoi(val);
+		else if(strcmp(arg, "-percell") == 0) opt.perCell = atoi(val);
+		else if(strcmp(arg, "-o") == 0) opt.prefix = val;
+		else usage(argv[0]);
+	}
+
+	/* the corridor must let a robot pass, the start positions of a cell
+	   must not touch each other */
+	double minCorridor = 2*(ROBOT_RADIUS + CLEARANCE);
+	if(opt.corridor < minCorridor) {
+		fprintf(stderr, "labgen: corridor must be at least %.2f\n", minCorridor);
+		return 1;
+	}
+	if(opt.thickness <= 0.0 || opt.beaconHeight <= 0.0 || opt.targetRadius <= 0.0
+	   || opt.lowFraction < 0.0 || opt.lowFraction > 1.0
+	   || opt.perCell == 0 || opt.targets == 0) {
+		fprintf(stderr, "labgen: invalid option value\n");
+		return 1;
+	}
+	unsigned int side = (unsigned int) floor(opt.corridor / minCorridor);
+	if(opt.perCell > side*side) {
+		fprintf(stderr, "labgen: at most %u positions fit in a cell\n", side*side);
+		return 1;
+	}
+
+	/* a maze of cols x rows cells leaves (cols-1)*(rows-1) walls */
+	double cell = opt.corridor + opt.thickness;
+	unsigned int cols, rows;
+	if(opt.width > 0.0 && opt.height > 0.0) {
+		cols = (unsigned int) floor(opt.width / cell);
+		rows = (unsigned int) floor(opt.height / cell);
+	}
+	else {
+		cols = rows = (unsigned int) ceil(sqrt((double) opt.walls)) + 1;
+		opt.width = cols * cell;
+		opt.height = rows * cell;
+	}
+	if(cols < 2 || rows < 2 || (cols-1)*(rows-1) < opt.walls) {
+		fprintf(stderr, "labgen: %u walls do not fit a %.2f x %.2f arena\n",
+		        opt.walls, opt.width, opt.height);
+		return 1;
+	}
+	unsigned int nCells = cols*rows;
+	unsigned int nBeaconCells = opt.beacons > opt.targets ? opt.beacons - opt.targets : 0;
+	unsigned int nPosCells = (opt.positions + opt.perCell - 1) / opt.perCell;
+	if(opt.targets + nBeaconCells + nPosCells > nCells) {
+		fprintf(stderr, "labgen: %u cells are not enough for the targets, beacons "
+		        "and positions\n", nCells);
+		return 1;
+	}
+
+	rng.seed(opt.seed);
+
+	vector<unsigned int> closed;
+	dig(cols, rows, closed);
+	shuffle(closed);
+	closed.resize(opt.walls);
+	std::sort(closed.begin(), closed.end());
+
+	/* walls run along the shared sides, from post to post, lower than the
+	   beacon or higher than it */
+	vector<Wall> walls(closed.size());
+	double half = opt.thickness / 2;
+	for(unsigned int w = 0; w < closed.size(); w++) {
+		unsigned int c = closed[w] / 2;
+		double x = (c % cols) * cell, y = (c / cols) * cell;
+		Wall &wl = walls[w];
+		if(closed[w] % 2 == 0) {
+			wl.x0 = x + cell - half; wl.x1 = x + cell + half;
+			wl.y0 = y - half; wl.y1 = y + cell + half;
+		}
+		else {
+			wl.x0 = x - half; wl.x1 = x + cell + half;
+			wl.y0 = y + cell - half; wl.y1 = y + cell + half;
+		}
+		wl.x0 = std::max(wl.x0, 0.0); wl.y0 = std::max(wl.y0, 0.0);
+		wl.x1 = std::min(wl.x1, opt.width); wl.y1 = std::min(wl.y1, opt.height);
+		wl.height = rng.uniform() < opt.lowFraction ? opt.beaconHeight * 0.5
+		                                            : opt.beaconHeight * 1.5;
+	}
+
+	/* targets, beacons and start positions in distinct cells */
+	vector<unsigned int> cells(nCells);
+	for(unsigned int c = 0; c < nCells; c++)
+		cells[c] = c;
+	shuffle(cells);
+	unsigned int nextCell = 0;
+
+	vector<double> tx, ty, bx, by;
+	for(unsigned int t = 0; t < opt.targets; t++, nextCell++) {
+		tx.push_back((cells[nextCell] % cols + 0.5) * cell);
+		ty.push_back((cells[nextCell] / cols + 0.5) * cell);
+	}
+	for(unsigned int b = 0; b < opt.beacons; b++) {
+		if(b < opt.targets) {
+			bx.push_back(tx[b]);
+			by.push_back(ty[b]);
+		}
+		else {
+			bx.push_back((cells[nextCell] % cols + 0.5) * cell);
+			by.push_back((cells[nextCell] / cols + 0.5) * cell);
+			nextCell++;
+		}
+	}
+
+	/* positions of a cell on a square grid centered in its free space */
+	unsigned int perSide = (unsigned int) ceil(sqrt((double) opt.perCell));
+	double step = minCorridor;
+	vector<double> px, py, pdir;
+	for(unsigned int p = 0; p < opt.positions; p++) {
+		unsigned int k = p % opt.perCell;
+		if(k == 0 && p > 0) nextCell++;
+		double cx = (cells[nextCell] % cols + 0.5) * cell;
+		double cy = (cells[nextCell] / cols + 0.5) * cell;
+		px.push_back(cx + ((k % perSide) - (perSide - 1) / 2.0) * step);
+		py.push_back(cy + ((k / perSide) - (perSide - 1) / 2.0) * step);
+		pdir.push_back(floor(rng.uniform() * 360.0) - 180.0);
+	}
+
+	char labFile[1024], gridFile[1024];
+	snprintf(labFile, sizeof(labFile), "%sLab.xml", opt.prefix);
+	snprintf(gridFile, sizeof(gridFile), "%sGrid.xml", opt.prefix);
+	if(!writeLab(labFile, opt, opt.width, opt.height, walls, tx, ty, bx, by)
+	   || !writeGrid(gridFile, px, py, pdir))
+		return 1;
+
+	printf("%s: %.2f x %.2f, %u cells, %u walls, %u targets, %u beacons\n",
+	       labFile, opt.width, opt.height, nCells, (unsigned int) walls.size(),
+	       (unsigned int) tx.size(), (unsigned int) bx.size());
+	printf("%s: %u positions\n", gridFile, (unsigned int) px.size());
+	return 0;
+}
@@ -0,0 +1,11 @@
+TEMPLATE	= app
+CONFIG		+= warn_on release console
+CONFIG		-= qt
+
+# procedural stress labs, see labgen.cpp
+INCLUDEPATH	+= ../simulator
+
+HEADERS		= ../simulator/cbutils.h ../simulator/cbrobotsize.h
+SOURCES		= labgen.cpp ../simulator/cbutils.cpp
+
+TARGET		= labgen
@@ -0,0 +1,181 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+/*
+ * class cbLogAnalyzer
+ */
+
+#include "cbloganalyzer.h"
+
+#include <qxml.h>
+#include <qstring.h>
+
+#include <iostream>
+#include <math.h>
+
+#include "cblogsource.h"
+#include "cbloghandler.h"
+#include "cblab.h"
+#include "cbwall.h"
+#include "cbtarget.h"
+#include "cbpoint.h"
+
+using std::cerr;
+
+/* true if p is inside the polygon of the wall */
+static bool insideWall(cbWall *wall, double x, double y)
+{
+	vector<cbPoint> &c = wall->Corners();
+	bool inside = false;
+	for (unsigned int i = 0, j = c.size()-1; i < c.size(); j = i++) {
+		if ((c[i].y > y) != (c[j].y > y) &&
+		    x < (c[j].x - c[i].x) * (y - c[i].y) / (c[j].y - c[i].y) + c[i].x)
+			inside = !inside;
+	}
+	return inside;
+}
+
+/*!
+	Parses the Parameters, Lab and Grid of the log with the logplayer
+	handlers. The caller owns the returned lab.
+*/
+static cbLab *parseLab(const string &preamble)
+{
+	QXmlSimpleReader parser;
+	QXmlInputSource source;
+	source.setData(QString::fromLatin1(("<Log>\n" + preamble + "</Log>\n").c_str()));
+
+	cbLogHandler handler(&parser);
+	parser.setContentHandler(&handler);
+	if (!parser.parse(source)) return 0;
+
+	delete handler.getGrid();
+	delete handler.getParameters();
+	return handler.getLab();
+}
+
+bool cbAnalyzeLog(const string &file, double cellSize, cbLogAnalysis &result)
+{
+	result.file = file;
+	result.ok = false;
+	result.bytes = 0;
+	result.cycles = 0;
+	result.labWidth = result.labHeight = 0.0;
+	result.cellsX = result.cellsY = result.freeCells = 0;
+	result.robots.clear();
+
+	cbLogSource log(4);
+	if (!log.open(file.c_str())) return false;
+
+	cbLab *lab = parseLab(log.preamble());
+	if (lab == 0) {
+		cerr << "ERROR: Error parsing lab of " << file << "\n";
+		return false;
+	}
+
+	/* lab cells, free cells are those whose center is outside every wall */
+	result.labWidth = lab->Width();
+	result.labHeight = lab->Height();
+	result.cellsX = (unsigned int) ceil(result.labWidth / cellSize);
+	result.cellsY = (unsigned int) ceil(result.labHeight / cellSize);
+	for (unsigned int cy = 0; cy < result.cellsY; cy++)
+		for (unsigned int cx = 0; cx < result.cellsX; cx++) {
+			double x = (cx + 0.5) * cellSize, y = (cy + 0.5) * cellSize;
+			bool isFree = true;
+			for (unsigned int w = 1; w < lab->nWalls() && isFree; w++)   // wall 0 is the border
+				isFree = !insideWall(lab->Wall(w), x, y);
+			if (isFree) result.freeCells++;
+		}
+
+	map<unsigned int, unsigned int> robotIndex;   // robot id -> result index
+	vector<double> lastX, lastY;
+
+	const vector<cbRobotSnapshot> *robots;
+	for (unsigned int f = 0; (robots = log.cycle(f)) != 0; f++) {
+		result.cycles++;
+		for (unsigned int r = 0; r < robots->size(); r++) {
+			const cbRobotSnapshot &s = (*robots)[r];
+
+			map<unsigned int, unsigned int>::iterator it = robotIndex.find(s.id);
+			bool first = it == robotIndex.end();
+			if (first) {
+				it = robotIndex.insert(std::make_pair(s.id, (unsigned int) result.robots.size())).first;
+				result.robots.resize(result.robots.size()+1);
+				cbRobotAnalysis &a = result.robots.back();
+				a.id = s.id;
+				a.name = s.name;
+				a.cycles = 0;
+				a.collisionCycles = 0;
+				a.pathLength = 0.0;
+				a.targetTimes.assign(lab->nTargets(), -1);
+				lastX.push_back(s.x);
+				lastY.push_back(s.y);
+			}
+			unsigned int i = it->second;
+			cbRobotAnalysis &a = result.robots[i];
+
+			a.cycles++;
+			a.score = s.score;
+			a.collisions = s.collisions;
+			a.arrivalTime = s.arrivalTime;
+			a.returningTime = s.returningTime;
+			if (s.collision) a.collisionCycles++;
+
+			if (!first) a.pathLength += hypot(s.x - lastX[i], s.y - lastY[i]);
+			lastX[i] = s.x;
+			lastY[i] = s.y;
+
+			if (a.scores.empty() || a.scores.back().second != s.score)
+				a.scores.push_back(std::make_pair(s.time, s.score));
+
+			cbPoint pos(s.x, s.y);
+			for (unsigned int t = 0; t < lab->nTargets(); t++)
+				if (a.targetTimes[t] < 0 && lab->Target(t)->contains(pos, 0.0))
+					a.targetTimes[t] = s.time;
+
+			if (s.x >= 0.0 && s.y >= 0.0) {
+				unsigned int cx = (unsigned int) (s.x / cellSize), cy = (unsigned int) (s.y / cellSize);
+				if (cx < result.cellsX && cy < result.cellsY)
+					a.heat[cy * result.cellsX + cx]++;
+			}
+		}
+	}
+
+	result.bytes = log.fileSize();
+	result.ok = true;
+	delete lab;
+
+	return true;
+}
+
+cbLogAnalyzer::cbLogAnalyzer(const vector<string> &f, vector<cbLogAnalysis> &r,
+                             QAtomicInt &n, double c)
+	: files(f), results(r), next(n)
+{
+	cellSize = c;
+}
+
+void cbLogAnalyzer::run()
+{
+	for (;;) {
+		int i = next.fetchAndAddOrdered(1);
+		if (i >= (int) files.size()) break;
+		cbAnalyzeLog(files[i], cellSize, results[i]);
+	}
+}
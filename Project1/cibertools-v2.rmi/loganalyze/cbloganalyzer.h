@@ -0,0 +1,105 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef _CB_LOG_ANALYZER_
+#define _CB_LOG_ANALYZER_
+
+#include <QThread>
+#include <QAtomicInt>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+using std::map;
+using std::pair;
+using std::string;
+using std::vector;
+
+/**
+ * Results of the analysis of one robot in one log.
+ */
+struct cbRobotAnalysis
+{
+	unsigned int id;
+	string name;
+	unsigned int cycles;			// cycles the robot is present in the log
+	unsigned int score;				// final values of the Scores element
+	unsigned int collisions;
+	unsigned int arrivalTime, returningTime;
+	unsigned int collisionCycles;	// cycles spent in collision
+	double pathLength;
+
+	/*! First time the robot was inside each target of the lab, -1 if never. */
+	vector<int> targetTimes;
+
+	/*! Score timeline, one (time, score) pair for every change of score. */
+	vector< pair<unsigned int, unsigned int> > scores;
+
+	/*! Coverage heatmap, cycles spent in each lab cell (sparse). */
+	map<unsigned int, unsigned int> heat;
+};
+
+/**
+ * Results of the analysis of one log.
+ */
+struct cbLogAnalysis
+{
+	string file;
+	bool ok;
+	unsigned long long bytes;
+	unsigned int cycles;
+
+	double labWidth, labHeight;
+	unsigned int cellsX, cellsY;
+	unsigned int freeCells;			// cells not covered by walls
+
+	vector<cbRobotAnalysis> robots;
+};
+
+/**
+ * Analyses one log, XML or binary, using the logplayer parsing of the
+ * lab, grid and robots.
+ */
+bool cbAnalyzeLog(const string &file, double cellSize, cbLogAnalysis &result);
+
+/**
+ * Worker thread: analyses logs from a shared list until none is left.
+ * Each log is claimed with an atomic counter, results are stored by
+ * index so the output order does not depend on scheduling.
+ */
+class cbLogAnalyzer : public QThread
+{
+public:
+	cbLogAnalyzer(const vector<string> &files, vector<cbLogAnalysis> &results,
+	              QAtomicInt &next, double cellSize);
+
+protected:
+	void run();
+
+private:
+	const vector<string> &files;
+	vector<cbLogAnalysis> &results;
+	QAtomicInt &next;
+	double cellSize;
+};
+
+#endif
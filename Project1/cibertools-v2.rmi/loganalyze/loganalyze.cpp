@@ -0,0 +1,215 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+ * loganalyze - computes statistics of many simulator logs, XML or
+ * binary, using all the cores of the machine.
+ *
+ * Three CSV files are written:
+ *   <prefix>_robots.csv   one line per robot and log: final scores,
+ *                         collisions, time to each target, path length
+ *                         and coverage of the lab
+ *   <prefix>_scores.csv   score timeline, one line per change of score
+ *   <prefix>_heatmap.csv  cycles spent by each robot in each lab cell
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <qdir.h>
+#include <qfileinfo.h>
+#include <qstringlist.h>
+#include <QTime>
+
+#include "cbloganalyzer.h"
+
+using std::cerr;
+using std::string;
+using std::vector;
+
+void CommandLineError()
+{
+	cerr << "SYNOPSIS: loganalyze [-j threads] [-c cellsize] [-o prefix] logfile|directory ...\n"
+	        "  analyses XML and binary (.cblog) logs, directories are searched for *.log and *.cblog\n";
+	exit(1);
+}
+
+/*!
+	Expands directories into the logs they contain, sorted by name.
+*/
+static void addLogs(const char *path, vector<string> &files)
+{
+	QFileInfo info(path);
+	if (!info.isDir()) {
+		files.push_back(path);
+		return;
+	}
+
+	QDir dir(path);
+	QStringList filters;
+	filters << "*.log" << "*.cblog";
+	QStringList logs = dir.entryList(filters, QDir::Files, QDir::Name);
+	for (int l = 0; l < logs.size(); l++)
+		files.push_back(dir.filePath(logs[l]).toLocal8Bit().constData());
+}
+
+/* CSV field, quoted when needed */
+static string csv(const string &s)
+{
+	if (s.find_first_of(",\"\n") == string::npos) return s;
+	string q = "\"";
+	for (unsigned int i = 0; i < s.size(); i++) {
+		if (s[i] == '"') q += '"';
+		q += s[i];
+	}
+	return q + "\"";
+}
+
+static bool writeResults(const string &prefix, const vector<cbLogAnalysis> &results, double cellSize)
+{
+	string robotsName = prefix + "_robots.csv";
+	string scoresName = prefix + "_scores.csv";
+	string heatName = prefix + "_heatmap.csv";
+	FILE *robots = fopen(robotsName.c_str(), "w");
+	FILE *scores = fopen(scoresName.c_str(), "w");
+	FILE *heat = fopen(heatName.c_str(), "w");
+	if (robots == 0 || scores == 0 || heat == 0) {
+		cerr << "ERROR: Could not open output files " << prefix << "_*.csv\n";
+		return false;
+	}
+
+	fprintf(robots, "log,robot_id,name,cycles,score,collisions,collision_cycles,arrival_time,"
+	                "returning_time,path_length,cells_visited,coverage,target_times\n");
+	fprintf(scores, "log,robot_id,time,score\n");
+	fprintf(heat, "log,robot_id,cell_x,cell_y,x,y,cycles\n");
+
+	for (unsigned int l = 0; l < results.size(); l++) {
+		const cbLogAnalysis &log = results[l];
+		if (!log.ok) continue;
+		string name = csv(log.file);
+
+		for (unsigned int r = 0; r < log.robots.size(); r++) {
+			const cbRobotAnalysis &a = log.robots[r];
+
+			string targets;
+			for (unsigned int t = 0; t < a.targetTimes.size(); t++) {
+				char buff[16];
+				sprintf(buff, t == 0 ? "%d" : ";%d", a.targetTimes[t]);
+				targets += buff;
+			}
+			fprintf(robots, "%s,%u,%s,%u,%u,%u,%u,%u,%u,%.3f,%u,%.4f,%s\n",
+			        name.c_str(), a.id, csv(a.name).c_str(), a.cycles, a.score, a.collisions,
+			        a.collisionCycles, a.arrivalTime, a.returningTime, a.pathLength,
+			        (unsigned int) a.heat.size(),
+			        log.freeCells > 0 ? (double) a.heat.size() / log.freeCells : 0.0,
+			        targets.c_str());
+
+			for (unsigned int s = 0; s < a.scores.size(); s++)
+				fprintf(scores, "%s,%u,%u,%u\n", name.c_str(), a.id, a.scores[s].first, a.scores[s].second);
+
+			for (map<unsigned int, unsigned int>::const_iterator h = a.heat.begin(); h != a.heat.end(); h++) {
+				unsigned int cx = h->first % log.cellsX, cy = h->first / log.cellsX;
+				fprintf(heat, "%s,%u,%u,%u,%g,%g,%u\n", name.c_str(), a.id, cx, cy,
+				        (cx + 0.5) * cellSize, (cy + 0.5) * cellSize, h->second);
+			}
+		}
+	}
+
+	bool ok = !ferror(robots) && !ferror(scores) && !ferror(heat);
+	ok = fclose(robots) == 0 && ok;
+	ok = fclose(scores) == 0 && ok;
+	ok = fclose(heat) == 0 && ok;
+	if (!ok) cerr << "ERROR: Could not write output files " << prefix << "_*.csv\n";
+	return ok;
+}
+
+int main(int argc, char *argv[])
+{
+	vector<string> files;
+	string prefix = "loganalyze";
+	int nThreads = QThread::idealThreadCount();
+	double cellSize = 1.0;
+
+	for (int p = 1; p < argc; p++) {
+		if (strcmp(argv[p], "-j") == 0) {
+			if (p+1 < argc && sscanf(argv[p+1], "%d", &nThreads) == 1 && nThreads > 0) p++;
+			else CommandLineError();
+		}
+		else if (strcmp(argv[p], "-c") == 0) {
+			if (p+1 < argc && sscanf(argv[p+1], "%lf", &cellSize) == 1 && cellSize > 0.0) p++;
+			else CommandLineError();
+		}
+		else if (strcmp(argv[p], "-o") == 0) {
+			if (p+1 < argc) prefix = argv[++p];
+			else CommandLineError();
+		}
+		else if (argv[p][0] != '-') addLogs(argv[p], files);
+		else CommandLineError();
+	}
+	if (files.empty()) CommandLineError();
+	if (nThreads < 1) nThreads = 1;
+	if (nThreads > (int) files.size()) nThreads = files.size();
+
+	vector<cbLogAnalysis> results(files.size());
+	QAtomicInt next(0);
+
+	QTime elapsed;
+	elapsed.start();
+	clock_t cpuStart = clock();
+
+	vector<cbLogAnalyzer *> workers;
+	for (int t = 0; t < nThreads; t++) {
+		workers.push_back(new cbLogAnalyzer(files, results, next, cellSize));
+		workers.back()->start();
+	}
+	for (int t = 0; t < nThreads; t++) {
+		workers[t]->wait();
+		delete workers[t];
+	}
+
+	double seconds = elapsed.elapsed() / 1000.0;
+	double cpu = (double) (clock() - cpuStart) / CLOCKS_PER_SEC;
+
+	unsigned int nOk = 0;
+	unsigned long long bytes = 0;
+	for (unsigned int l = 0; l < results.size(); l++) {
+		if (results[l].ok) {
+			nOk++;
+			bytes += results[l].bytes;
+		}
+		else cerr << "ERROR: Could not analyse " << results[l].file << "\n";
+	}
+
+	if (!writeResults(prefix, results, cellSize)) return 1;
+
+	/* throughput; low cpu use per thread means the run was limited by I/O */
+	if (seconds <= 0.0) seconds = 0.001;
+	printf("%u of %u logs analysed in %.2f s with %d threads\n", nOk, (unsigned int) files.size(), seconds, nThreads);
+	printf("%.1f logs/s, %.1f MB/s, cpu use %.0f%% of %d threads%s\n",
+	       nOk / seconds, bytes / seconds / (1024*1024), 100.0 * cpu / seconds / nThreads, nThreads,
+	       cpu / seconds / nThreads < 0.75 ? " (I/O bound)" : "");
+
+	return nOk == files.size() ? 0 : 1;
+}
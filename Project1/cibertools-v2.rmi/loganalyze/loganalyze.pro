@@ -0,0 +1,32 @@
+TEMPLATE	= app
+CONFIG		+= qt warn_on release thread console
+
+win32 {
+    DEFINES     += MicWindows
+}
+
+# logs are read with the logplayer classes
+INCLUDEPATH	+= ../logplayer ../simulator
+DEPENDPATH	+= ../logplayer ../simulator
+
+HEADERS		= cbloganalyzer.h\
+		  ../logplayer/cblogsource.h ../logplayer/cbloghandler.h\
+		  ../logplayer/cblab.h ../logplayer/cblabhandler.h\
+		  ../logplayer/cbgrid.h ../logplayer/cbgridhandler.h\
+		  ../logplayer/cbparameters.h ../logplayer/cbparamhandler.h\
+		  ../logplayer/cbwall.h ../logplayer/cbtarget.h ../logplayer/cbbeacon.h\
+		  ../logplayer/cbpoint.h ../logplayer/cbposition.h ../logplayer/cbrobot.h\
+		  ../simulator/cbbinlog.h
+SOURCES		= cbloganalyzer.cpp loganalyze.cpp\
+		  ../logplayer/cblogsource.cpp ../logplayer/cbloghandler.cpp\
+		  ../logplayer/cblab.cpp ../logplayer/cblabhandler.cpp\
+		  ../logplayer/cbgrid.cpp ../logplayer/cbgridhandler.cpp\
+		  ../logplayer/cbparameters.cpp ../logplayer/cbparamhandler.cpp\
+		  ../logplayer/cbwall.cpp ../logplayer/cbtarget.cpp ../logplayer/cbbeacon.cpp\
+		  ../logplayer/cbpoint.cpp ../logplayer/cbposition.cpp ../logplayer/cbrobot.cpp\
+		  ../simulator/cbbinlog.cpp
+
+TARGET		= loganalyze
+
+QT		-= gui
+QT		+= xml
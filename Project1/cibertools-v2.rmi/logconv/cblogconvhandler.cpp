@@ -0,0 +1,191 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+/*
+ * class cbLogConvHandler
+ */
+
+#include "cblogconvhandler.h"
+
+#include <qstring.h>
+
+bool cbLogConvHandler::startDocument()
+{
+    nCycles = 0;
+    inLogInfo = false;
+    robots.clear();
+
+    return TRUE;
+}
+
+bool cbLogConvHandler::startElement( const QString&, const QString&, const QString& qName,
+                                    const QXmlAttributes& attr)
+{
+	/* process begin tag */
+	const QString &tag = qName;
+	if (tag == "LogInfo")
+	{
+		time = 0;
+		const QString &timeAttr = attr.value(QString("Time"));
+		if (!timeAttr.isNull()) time=timeAttr.toUInt();
+		robots.clear();
+		inLogInfo = true;
+	}
+	else if (!inLogInfo)
+	{
+		/* Parameters, Lab and Grid are copied verbatim */
+	}
+	else if (tag == "Robot")
+	{
+		const QString &idAttr = attr.value(QString("Id"));
+		if (idAttr.isNull()) return FALSE;   // parse error
+		robot.id = idAttr.toUInt();
+
+		robot.name = attr.value(QString("Name")).toLatin1().constData();
+		robot.state = cbBinLogStateName(cbBinLogState(attr.value(QString("State")).toLatin1().constData()));
+
+		robot.x = robot.y = robot.dir = 0.0;
+		robot.score = robot.arrivalTime = robot.returningTime = robot.collisions = 0;
+		robot.collision = false;
+		robot.visitedMask.clear();
+		robot.actions = 0;
+		robot.leftMotor = robot.rightMotor = 0.0;
+		robot.withMeasures = false;
+		robot.time = 0;
+		robot.compass = 0.0;
+		robot.collisionSensor = false;
+		robot.ground = 0;
+		robot.irSensors.clear();
+		robot.beacons.clear();
+		robot.gps = robot.gpsDir = false;
+		robot.gpsX = robot.gpsY = robot.gpsDegrees = 0.0;
+		robot.endLed = robot.returningLed = robot.visitingLed = false;
+		robot.startButton = robot.stopButton = false;
+	}
+	else if (tag == "Pos")
+	{
+		robot.x = attr.value(QString("X")).toDouble();
+		robot.y = attr.value(QString("Y")).toDouble();
+		robot.dir = attr.value(QString("Dir")).toDouble();
+	}
+	else if (tag == "Scores")
+	{
+		robot.score = attr.value(QString("Score")).toUInt();
+		robot.arrivalTime = attr.value(QString("ArrivalTime")).toUInt();
+		robot.returningTime = attr.value(QString("ReturningTime")).toUInt();
+		robot.collisions = attr.value(QString("Collisions")).toUInt();
+		robot.collision = attr.value(QString("Collision")) == "True";
+		robot.visitedMask = attr.value(QString("VisitedMask")).toLatin1().constData();
+	}
+	else if (tag == "Action")
+	{
+		const QString &leftAttr = attr.value(QString("LeftMotor"));
+		if (!leftAttr.isNull()) {
+			robot.actions |= cbLogRobotRecord::LEFT_MOTOR;
+			robot.leftMotor = leftAttr.toDouble();
+		}
+		const QString &rightAttr = attr.value(QString("RightMotor"));
+		if (!rightAttr.isNull()) {
+			robot.actions |= cbLogRobotRecord::RIGHT_MOTOR;
+			robot.rightMotor = rightAttr.toDouble();
+		}
+		const QString &endAttr = attr.value(QString("EndLed"));
+		if (!endAttr.isNull()) {
+			robot.actions |= cbLogRobotRecord::END_LED;
+			robot.endLed = endAttr == "On";
+		}
+		const QString &returningAttr = attr.value(QString("ReturningLed"));
+		if (!returningAttr.isNull()) {
+			robot.actions |= cbLogRobotRecord::RETURNING_LED;
+			robot.returningLed = returningAttr == "On";
+		}
+		const QString &visitingAttr = attr.value(QString("VisitingLed"));
+		if (!visitingAttr.isNull()) {
+			robot.actions |= cbLogRobotRecord::VISITING_LED;
+			robot.visitingLed = visitingAttr == "On";
+		}
+	}
+	else if (tag == "Measures")
+	{
+		robot.withMeasures = true;
+		robot.time = attr.value(QString("Time")).toUInt();
+	}
+	else if (tag == "Sensors")
+	{
+		robot.compass = attr.value(QString("Compass")).toDouble();
+		robot.collisionSensor = attr.value(QString("Collision")) == "Yes";
+		robot.ground = attr.value(QString("Ground")).toInt();
+	}
+	else if (tag == "IRSensor")
+	{
+		unsigned int id = attr.value(QString("Id")).toUInt();
+		if (id >= robot.irSensors.size()) robot.irSensors.resize(id+1, 0.0);
+		robot.irSensors[id] = attr.value(QString("Value")).toDouble();
+	}
+	else if (tag == "BeaconSensor")
+	{
+		cbLogBeaconRecord beacon;
+		beacon.id = attr.value(QString("Id")).toUInt();
+		const QString &valueAttr = attr.value(QString("Value"));
+		beacon.visible = valueAttr != "NotVisible";
+		beacon.degrees = beacon.visible ? valueAttr.toDouble() : 0.0;
+		robot.beacons.push_back(beacon);
+	}
+	else if (tag == "GPS")
+	{
+		robot.gps = true;
+		robot.gpsX = attr.value(QString("X")).toDouble();
+		robot.gpsY = attr.value(QString("Y")).toDouble();
+		const QString &dirAttr = attr.value(QString("Dir"));
+		if (!dirAttr.isNull()) {
+			robot.gpsDir = true;
+			robot.gpsDegrees = dirAttr.toDouble();
+		}
+	}
+	else if (tag == "Leds")
+	{
+		robot.endLed = attr.value(QString("EndLed")) == "On";
+		robot.returningLed = attr.value(QString("ReturningLed")) == "On";
+		robot.visitingLed = attr.value(QString("VisitingLed")) == "On";
+	}
+	else if (tag == "Buttons")
+	{
+		robot.startButton = attr.value(QString("Start")) == "On";
+		robot.stopButton = attr.value(QString("Stop")) == "On";
+	}
+	return TRUE;
+}
+
+bool cbLogConvHandler::endElement( const QString&, const QString&, const QString& qName)
+{
+	/* process end tag */
+	const QString &tag = qName;
+	if (tag == "Robot" && inLogInfo)
+	{
+		robots.resize(robots.size()+1);
+		cbLogWriter::toBinary(robot, robots.back());
+	}
+	else if (tag == "LogInfo")
+	{
+		if (!writer->writeCycle(time, robots)) return FALSE;
+		nCycles++;
+		inLogInfo = false;
+	}
+	return TRUE;
+}
@@ -0,0 +1,62 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef _CB_LOGCONV_HANDLER_
+#define _CB_LOGCONV_HANDLER_
+
+#include <qxml.h>
+
+#include "cblogwriter.h"
+#include "cbbinlog.h"
+
+#include <vector>
+
+using std::vector;
+
+class QString;
+
+/**
+ * Parses the LogInfo items of an XML log and writes them to a binary log.
+ * The Parameters, Lab and Grid elements are skipped: they are copied
+ * verbatim into the binary log header by logconv.
+ */
+class cbLogConvHandler : public QXmlDefaultHandler
+{
+public:
+    cbLogConvHandler(cbBinLogWriter *w) { writer=w; nCycles=0; }
+
+    bool startDocument();
+    bool startElement( const QString&, const QString&, const QString& , const QXmlAttributes& );
+    bool endElement( const QString&, const QString&, const QString& );
+
+    inline unsigned int cycles() { return nCycles; }
+
+private:
+    cbBinLogWriter *writer;
+
+    unsigned int time;
+    unsigned int nCycles;
+    bool inLogInfo;
+
+    cbLogRobotRecord robot;
+    vector<cbBinLogRobot> robots;
+};
+
+#endif
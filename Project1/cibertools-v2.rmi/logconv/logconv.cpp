@@ -0,0 +1,260 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+ * logconv - converts simulator logs between the XML and the binary
+ * (.cblog) formats. The direction is chosen from the input file.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <qxml.h>
+#include <qstring.h>
+#include <qfile.h>
+
+#include "cbbinlog.h"
+#include "cblogwriter.h"
+#include "cblogconvhandler.h"
+
+using std::cerr;
+using std::cout;
+using std::ifstream;
+using std::ofstream;
+using std::ios;
+using std::string;
+
+void CommandLineError()
+{
+	cerr << "SYNOPSIS: logconv [-o outfile] [-k keyframeinterval] logfile\n"
+	        "  converts XML logs to binary logs (.cblog) and binary logs to XML\n";
+	exit(1);
+}
+
+static unsigned long long fileSize(const char *filename)
+{
+	ifstream in(filename, ios::in | ios::binary);
+	in.seekg(0, ios::end);
+	return in ? (unsigned long long) in.tellg() : 0;
+}
+
+/*!
+	Default name of the converted log: the extension is replaced
+	by .cblog or .log.
+*/
+static string outputName(const char *in, bool toBinary)
+{
+	string name = in;
+	string::size_type dot = name.rfind('.');
+	string::size_type slash = name.find_last_of("/\\");
+	if (dot != string::npos && (slash == string::npos || dot > slash))
+		name.erase(dot);
+	return name + (toBinary ? ".cblog" : ".log");
+}
+
+/*!
+	Reads the beginning of an XML log up to the first LogInfo item,
+	extracting the date of the log and the Parameters, Lab and Grid XML.
+*/
+static bool readXmlHeader(const char *filename, bool &hasDate, string &date, string &preamble)
+{
+	ifstream in(filename, ios::in | ios::binary);
+	if (!in) {
+		cerr << "ERROR: Could not open " << filename << "\n";
+		return false;
+	}
+
+	string head;
+	char buff[64*1024];
+	string::size_type end = string::npos;
+	while (in) {
+		in.read(buff, sizeof(buff));
+		head.append(buff, in.gcount());
+		if ((end = head.find("<LogInfo")) != string::npos) break;
+	}
+	if (end == string::npos && (end = head.find("</Log>")) == string::npos) {
+		cerr << "ERROR: " << filename << " is not a simulator log\n";
+		return false;
+	}
+
+	string::size_type log = head.find("<Log");
+	while (log != string::npos && head[log+4] != ' ' && head[log+4] != '>' && head[log+4] != '\t')
+		log = head.find("<Log", log+4);
+	if (log == string::npos || log > end) {
+		cerr << "ERROR: " << filename << " is not a simulator log\n";
+		return false;
+	}
+	string::size_type logEnd = head.find('>', log);
+
+	string tag = head.substr(log, logEnd-log);
+	string::size_type d = tag.find("Date=\"");
+	hasDate = d != string::npos;
+	if (hasDate) {
+		d += 6;
+		date = tag.substr(d, tag.find('"', d) - d);
+	}
+
+	string::size_type begin = logEnd+1;
+	if (begin < end && head[begin] == '\n') begin++;
+	preamble = head.substr(begin, end-begin);
+
+	return true;
+}
+
+/*!
+	Number of elements with the given tag in the Lab element of the preamble.
+*/
+static unsigned int countLabElements(const string &preamble, const char *tag)
+{
+	string::size_type lab = preamble.find("<Lab");
+	if (lab == string::npos) return 0;
+	string::size_type labEnd = preamble.find("</Lab>", lab);
+	if (labEnd == string::npos) labEnd = preamble.size();
+
+	string open = string("<") + tag;
+	unsigned int n = 0;
+	for (string::size_type p = preamble.find(open, lab); p < labEnd; p = preamble.find(open, p+1)) {
+		char next = p + open.size() < preamble.size() ? preamble[p + open.size()] : '\0';
+		if (next == ' ' || next == '\t' || next == '\n' || next == '\r' || next == '/' || next == '>')
+			n++;
+	}
+	return n;
+}
+
+static int xmlToBinary(const char *inName, const char *outName, unsigned int keyInterval)
+{
+	bool hasDate;
+	string date, preamble;
+
+	if (!readXmlHeader(inName, hasDate, date, preamble)) return 1;
+
+	cbBinLogWriter writer(keyInterval);
+	if (!writer.open(outName, hasDate ? date.c_str() : 0, preamble,
+	                 countLabElements(preamble, "Beacon"), countLabElements(preamble, "Target")))
+		return 1;
+
+	QFile file(inName);
+	if (!file.open(QIODevice::ReadOnly)) {
+		cerr << "ERROR: Could not open " << inName << "\n";
+		return 1;
+	}
+	QXmlInputSource source(&file);
+	QXmlSimpleReader parser;
+	cbLogConvHandler handler(&writer);
+	parser.setContentHandler(&handler);
+
+	if (!parser.parse(source)) {
+		cerr << "ERROR: Error parsing log " << inName << "\n";
+		writer.close();
+		return 1;
+	}
+	if (!writer.close()) return 1;
+
+	cout << handler.cycles() << " cycles written to " << outName << "\n";
+	return 0;
+}
+
+static int binaryToXml(const char *inName, const char *outName)
+{
+	cbBinLogReader reader;
+	if (!reader.open(inName)) return 1;
+
+	ofstream out(outName, ios::out | ios::binary | ios::trunc);
+	if (!out) {
+		cerr << "ERROR: Could not open " << outName << " for writing\n";
+		return 1;
+	}
+
+	string xml;
+	if (reader.hasDate()) xml = "<Log Date=\"" + reader.date() + "\" >\n";
+	else xml = "<Log>\n";
+	xml += reader.preamble();
+
+	vector<cbBinLogRobot> robots;
+	cbLogRecord rec;
+	rec.type = cbLogRecord::LOGINFO;
+
+	for (unsigned int f = 0; f < reader.nCycles(); f++) {
+		if (!reader.readCycle(f, robots)) return 1;
+
+		rec.time = reader.cycleTime(f);
+		rec.nRobots = 0;
+		for (unsigned int r = 0; r < robots.size(); r++)
+			cbLogWriter::fromBinary(robots[r], rec.addRobot());
+		cbLogWriter::formatRecord(rec, xml);
+
+		if (xml.size() > 256*1024) {
+			out.write(xml.data(), xml.size());
+			xml.clear();
+		}
+	}
+	xml += "</Log>\n";
+	out.write(xml.data(), xml.size());
+
+	if (!out) {
+		cerr << "ERROR: Could not write " << outName << "\n";
+		return 1;
+	}
+
+	cout << reader.nCycles() << " cycles written to " << outName << "\n";
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *inName = 0;
+	string outName;
+	unsigned int keyInterval = CB_BINLOG_KEY_INTERVAL;
+
+	for (int p = 1; p < argc; p++) {
+		if (strcmp(argv[p], "-o") == 0) {
+			if (p+1 < argc) outName = argv[++p];
+			else CommandLineError();
+		}
+		else if (strcmp(argv[p], "-k") == 0) {
+			if (p+1 < argc && sscanf(argv[p+1], "%u", &keyInterval) == 1 && keyInterval > 0) p++;
+			else CommandLineError();
+		}
+		else if (argv[p][0] != '-' && inName == 0) inName = argv[p];
+		else CommandLineError();
+	}
+	if (inName == 0) CommandLineError();
+
+	bool toBinary = !cbBinLogReader::isBinaryLog(inName);
+	if (outName.empty()) outName = outputName(inName, toBinary);
+	if (outName == inName) {
+		cerr << "ERROR: input and output files are the same\n";
+		return 1;
+	}
+
+	int ret = toBinary ? xmlToBinary(inName, outName.c_str(), keyInterval)
+	                   : binaryToXml(inName, outName.c_str());
+	if (ret != 0) return ret;
+
+	unsigned long long inSize = fileSize(inName), outSize = fileSize(outName.c_str());
+	printf("%s: %llu bytes -> %s: %llu bytes (%.1fx)\n", inName, inSize,
+	       outName.c_str(), outSize, outSize > 0 ? (double) inSize / outSize : 0.0);
+
+	return 0;
+}
@@ -0,0 +1,22 @@
+TEMPLATE	= app
+CONFIG		+= qt warn_on release thread console
+
+win32 {
+    DEFINES     += MicWindows
+}
+
+# the binary log codec and the log formatting are shared with the simulator
+INCLUDEPATH	+= ../simulator
+DEPENDPATH	+= ../simulator
+
+HEADERS		= cblogconvhandler.h\
+		  ../simulator/cbbinlog.h ../simulator/cblogwriter.h\
+		  ../simulator/cbxmlbuilder.h
+SOURCES		= cblogconvhandler.cpp logconv.cpp\
+		  ../simulator/cbbinlog.cpp ../simulator/cblogwriter.cpp\
+		  ../simulator/cbxmlbuilder.cpp
+
+TARGET		= logconv
+
+QT		-= gui
+QT		+= xml
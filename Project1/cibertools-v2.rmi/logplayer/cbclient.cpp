@@ -92,7 +92,7 @@ bool cbClient::Refuse(QHostAddress &a, unsigned short &p)
 /*!
 	Send xml message to client.
 */
-bool cbClient::send(char *xml, unsigned int cnt)
+bool cbClient::send(const char *xml, unsigned int cnt)
 {
     if (writeDatagram(xml, cnt, address, port) != (int)cnt)
 	{
@@ -40,7 +40,7 @@ public:
 	virtual bool Reply(QHostAddress &addr, unsigned short &port, cbParameters *param);
 	virtual bool Refuse(QHostAddress &addr, unsigned short &port);
 
-	bool send(char *, unsigned int);
+	bool send(const char *, unsigned int);
 
 protected:
 	QHostAddress address;
@@ -55,3 +55,20 @@ int cbGrid::toXml(char *xml, int n)
 
 	return cnt;
 }
+
+/*!
+	fill in xml with the grid as xml message, whatever its size.
+*/
+void cbGrid::toXml(string &xml)
+{
+	char line[128];
+	xml = "<Grid>\n";
+	for (int i=0; i<count(); i++)
+	{
+		cbPosition pos = at(i);
+		sprintf(line, "\t<Position X=\"%g\" Y=\"%g\" Dir=\"%g\"/>\n",
+				pos.X(), pos.Y(), pos.directionInDegrees());
+		xml += line;
+	}
+	xml += "</Grid>\n";
+}
@@ -29,6 +29,9 @@
 #include "cbposition.h"
 
 #include <qvector.h>
+#include <string>
+
+using std::string;
 
 /*!
 	\class cbGrid
@@ -42,6 +45,7 @@ public:
 	~cbGrid();
 
 	int toXml(char *buff, int cnt);
+	void toXml(string &xml);
 
 private:
 };
@@ -210,6 +210,44 @@ int cbLab::toXml(char *buff, int n)
 	return cnt;
 }
 
+/*!
+	Fill in xml with the XML representation of the lab, whatever its size.
+*/
+void cbLab::toXml(string &xml)
+{
+	unsigned int i;
+	char line[256];
+	sprintf(line, "<Lab Name=\"%.128s\" Height=\"%g\" Width=\"%g\">\n", name, height, width);
+	xml = line;
+	for (i=0; i<beacons.size(); i++)
+	{
+		cbPoint &p = beacons[i]->Center();
+		sprintf(line, "\t<Beacon X=\"%g\" Y=\"%g\" Height=\"%g\"/>\n", p.X(), p.Y(), beacons[i]->Height());
+		xml += line;
+	}
+	for (i=0; i<targets.size(); i++)
+	{
+		cbPoint &p = targets[i]->Center();
+		sprintf(line, "\t<Target X=\"%g\" Y=\"%g\" Radius=\"%g\"/>\n", p.X(), p.Y(), targets[i]->Radius());
+		xml += line;
+	}
+	for (i=1; i<walls.size(); i++)
+	{
+		cbWall *wall = walls[i];
+		sprintf(line, "\t<Wall Height=\"%g\">\n", wall->Height());
+		xml += line;
+		vector<cbPoint> *corners = &(wall->Corners());
+		for (unsigned int j=0; j<corners->size(); j++)
+		{
+			cbPoint p = (*corners)[j];
+			sprintf(line, "\t\t<Corner X=\"%g\" Y=\"%g\"/>\n", p.X(), p.Y());
+			xml += line;
+		}
+		xml += "\t</Wall>\n";
+	}
+	xml += "</Lab>\n";
+}
+
 bool cbLab::reachable(cbPoint i,cbPoint f)
 {
     double distIF,dirIF,distWall;
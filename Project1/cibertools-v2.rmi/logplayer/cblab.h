@@ -31,7 +31,9 @@
 
 //#include <qarray.h>
 #include <vector>
+#include <string>
 using std::vector;
+using std::string;
 
 /**
  * models the labirinth where robots move
@@ -65,6 +67,7 @@ public:
 	inline cbBeacon *Beacon(int i) { return beacons[i]; }
 
 	int toXml(char *buff, int n);
+	void toXml(string &xml);
 
         bool reachable(cbPoint i, cbPoint f);
         bool reachableRobot(cbPoint i, cbPoint f);
@@ -19,6 +19,9 @@
 */
 /*
  * class cbLogHandler
+ *
+ * Parses the Parameters, Lab and Grid of a log; the LogInfo items
+ * are decoded on demand by cbLogSource.
  */
  
 #include "cblabhandler.h"
@@ -31,8 +34,6 @@
  
 bool cbLogHandler::startDocument()
 {
-    log = 0;
-
     lab=0;
     grid=0;
     param=0;
@@ -76,11 +77,7 @@ bool cbLogHandler::startElement( const QString&, const QString&, const QString&
 {
 	/* process begin tag */
 	const QString &tag = qName;
-	if (tag == "Log")
-	{
-		log = new vector< vector <cbRobot> >;
-	}
-	else if (tag == "Lab")
+	if (tag == "Lab")
 	{
 		type = LAB;			//Next time startElement will process one LAB
 
@@ -101,80 +98,6 @@ bool cbLogHandler::startElement( const QString&, const QString&, const QString&
 		paramHandler = new cbParamHandler( reader, this, attr);
 		reader->setContentHandler(paramHandler);
 	}
-	else if (tag == "LogInfo")
-	{
-		//fprintf(stderr,"pushing robsEmpty\n");
-		vector<cbRobot> robsEmpty;
-		log->push_back(robsEmpty);
-		const QString &timeAttr = attr.value(QString("Time"));
-		if (!timeAttr.isNull()) time=timeAttr.toInt();
-	}
-	else if (tag == "Robot")
-	{
-		//fprintf(stderr,"start Robot tag\n");
-		int robId=-1;
-
-		const QString &idAttr = attr.value(QString("Id"));
-		if (!idAttr.isNull()) { 
-			robId=idAttr.toInt();
-		        robot.setId(robId);
-		}
-		else return FALSE;   // parse error
-
-		robot.setTime(time);
-		const QString &nameAttr = attr.value(QString("Name"));
-		if (!nameAttr.isNull()) { 
-                robot.setName(nameAttr.toAscii());
-		}
-
-		const QString &stateAttr = attr.value(QString("State"));
-		if (!stateAttr.isNull()) { 
-                robot.setState(stateAttr.toAscii());
-		}
-	}
-	else if (tag == "Pos")
-	{
-		double x=0.0, y=0.0, dir=0.0;
-		//fprintf(stderr,"start Pos tag\n");
-
-		const QString &xAttr = attr.value(QString("X"));
-		if (!xAttr.isNull()) x=xAttr.toDouble();
-		const QString &yAttr = attr.value(QString("Y"));
-		if (!yAttr.isNull()) y=yAttr.toDouble();
-		const QString &dirAttr = attr.value(QString("Dir"));
-		if (!dirAttr.isNull()) dir=dirAttr.toDouble()/180.0*M_PI;
-
-		position.set(x,y,dir);
-		robot.setPosition(position);
-	}
-	else if (tag == "Scores")
-	{
-		unsigned int score=0, arrivalTime=0, returningTime=0, collisionCount=0;
-		QString visitedMask;
-		bool collision=false;
-		//fprintf(stderr,"start Scores tag\n");
-
-		const QString &scoreAttr = attr.value(QString("Score"));
-		if (!scoreAttr.isNull()) score=scoreAttr.toInt();
-		const QString &arrivalTimeAttr = attr.value(QString("ArrivalTime"));
-		if (!arrivalTimeAttr.isNull()) arrivalTime=arrivalTimeAttr.toInt();
-		const QString &returningTimeAttr = attr.value(QString("ReturningTime"));
-		if (!returningTimeAttr.isNull()) returningTime=returningTimeAttr.toInt();
-		const QString &collisionsAttr = attr.value(QString("Collisions"));
-		if (!collisionsAttr.isNull()) collisionCount=collisionsAttr.toInt();
-		const QString &collisionAttr = attr.value(QString("Collision"));
-		if (!collisionAttr.isNull()) if(collisionAttr=="True") collision=true;
-		const QString &visitedMaskAttr = attr.value(QString("VisitedMask"));
-		if (!visitedMaskAttr.isNull()) visitedMask=visitedMaskAttr;
-
-		robot.setScore(score);
-		robot.setArrivalTime(arrivalTime);
-		robot.setReturningTime(returningTime);
-		robot.setCollisionCount(collisionCount);
-		if(collision) robot.setCollision();
-		else robot.resetCollision();
-		robot.setVisitedMask(visitedMask);
-	}
         return TRUE;
 }
 
@@ -186,28 +109,9 @@ bool cbLogHandler::endElement( const QString&, const QString&, const QString& qN
 	{
 		//simulator->setLab(lab);
 	}
-	else if (tag == "LogInfo")
-	{
-	}
-	else if (tag == "Robot")
-	{
-		//fprintf(stderr,"pushing new robot into %d\n",log->size()-1);
-		(*log)[log->size()-1].push_back(robot);
-		//fprintf(stderr,"pushed %d robots \n",(*log)[log->size()-1].size());
-	}
-	else if (tag == "Pos")
-	{
-	}
     return TRUE;
 }
 
 void cbLogHandler::setDocumentLocator(QXmlLocator *)
 {
 }
-
-/* extra functions */
-
-vector < vector< cbRobot > > *cbLogHandler::parsedLog()
-{
-	return log;
-}
@@ -22,16 +22,10 @@
 
 #include <qxml.h>
 
-#include "cbposition.h"
-#include "cbrobot.h"
 #include "cblab.h"
 #include "cbgrid.h"
 #include "cbparameters.h"
 
-#include <vector>
-
-using std::vector;
-
 class cbLabHandler;
 class cbGridHandler;
 class cbParamHandler;
@@ -55,8 +49,6 @@ public:
 	void setDocumentLocator(QXmlLocator *);
 
 	/* extra functions */
-    vector< vector <cbRobot> > *parsedLog();
-
 	cbLab * getLab() {return lab;};
 	/*! This function returns one grid.
 	 */
@@ -64,19 +56,12 @@ public:
 	/*! This function returns parsed parameters.
 	 */
 	cbParameters * getParameters(){return param;};
-	/*! This function returns one robot.
-	 */
-	cbRobot * getRobot();
 	/*! This function returns the type of object received.
 	 */
 	Type objectType();
 
 
 private:
-	vector< vector<cbRobot> > *log;
-	cbRobot robot;
-	cbPosition position;
-	int time;	
 	cbLab    *lab;		
 	cbGrid   *grid;		
 	cbParameters  *param;		
@@ -46,7 +46,7 @@
 using std::cerr;
 using std::cout;
 
-cbLogplayer::cbLogplayer()
+cbLogplayer::cbLogplayer() : labXml("Lab"), gridXml("Grid")
 {
 	lab = 0;
 	log = 0;
@@ -57,6 +57,13 @@ cbLogplayer::cbLogplayer()
 	curState = nextState = STOPPED;
 
 	logIndex=0;
+	playPos=0.0;
+	playRate=1.0;
+
+	looping=false;
+	loopBegin=loopEnd=0;
+
+	gui=0;
 }
 
 cbLogplayer::~cbLogplayer()
@@ -66,12 +73,14 @@ cbLogplayer::~cbLogplayer()
 void cbLogplayer::setLab(cbLab *l)
 {
 	lab = l;
+	labXml.clear();
 }
 
 void cbLogplayer::setGrid(cbGrid *g)
 {
 	/* set the new grid */
 	grid = g;
+	gridXml.clear();
 	/* resize robot array to new grid size */
 }
 
@@ -114,11 +123,70 @@ void cbLogplayer::step()
 	ViewCommands();
 	UpdateViews();
 	if(curState==RUNNING) {
-		logIndex++;
+		Advance();
 	}
 	UpdateState();
+	UpdateGUI();
+}
 
-	if(logIndex==log->size()) exit(0);
+/*!
+	Moves playback to the first cycle of the log at or after time.
+*/
+void cbLogplayer::seek(unsigned int time)
+{
+	int frame = log->findCycle(time);
+	logIndex = frame < 0 ? lastCycle() : frame;
+	playPos = logIndex;
+}
+
+/*!
+	Rates above 1 skip cycles, only the cycle reached in each step is sent
+	to the views. Fractional rates repeat cycles.
+*/
+void cbLogplayer::setRate(double r)
+{
+	playRate = r;
+}
+
+/*!
+	Plays the cycles from begin to end, inclusive, over and over.
+*/
+void cbLogplayer::setLoop(unsigned int begin, unsigned int end)
+{
+	if (end <= begin) {
+		clearLoop();
+		return;
+	}
+
+	int frame = log->findCycle(begin);
+	loopBegin = frame < 0 ? lastCycle() : frame;
+	frame = log->findCycle(end+1);
+	loopEnd = frame <= 0 ? lastCycle() : frame-1;
+	looping = loopEnd > loopBegin;
+}
+
+void cbLogplayer::clearLoop()
+{
+	looping = false;
+}
+
+void cbLogplayer::togglePlay()
+{
+	nextState = curState == RUNNING ? STOPPED : RUNNING;
+}
+
+void cbLogplayer::seekFromGUI()
+{
+	if (gui == 0) return;
+	seek(gui->SeekSpin->value());
+}
+
+void cbLogplayer::loopFromGUI()
+{
+	if (gui == 0) return;
+	if (gui->LoopCheck->isChecked())
+		setLoop(gui->LoopBeginSpin->value(), gui->LoopEndSpin->value());
+	else clearLoop();
 }
 
 /*
@@ -167,8 +235,6 @@ void cbLogplayer::CheckIn()
 void cbLogplayer::ViewCommands()
 {
 	cbCommand command;
-	char xml[16*4096];
-	unsigned int cnt;
 	for (unsigned int i=0; i<views.size(); i++)
 	{
 		while (views[i]->readCommand(&command))
@@ -185,17 +251,34 @@ void cbLogplayer::ViewCommands()
 					break;
 				case cbCommand::LABRQ:
 					//cout << "View command = LabReq\n";
-					cnt = lab->toXml(xml, sizeof(xml));
-					views[i]->send(xml, cnt+1);
+					labMessage().sendTo(*views[i]);
 					break;
 				case cbCommand::GRIDRQ:
 					//cout << "View command = GridReq\n";
-					cnt = grid->toXml(xml, sizeof(xml));
-					views[i]->send(xml, cnt+1);
+					gridMessage().sendTo(*views[i]);
+					break;
+				case cbCommand::CHUNKRQ:
+				{
+					const cbChunkedXml &xml = command.chunk.object == cbCommand::LAB
+					                          ? labMessage() : gridMessage();
+					xml.answerRequest(*views[i], command.chunk.version, command.chunk.seq);
 					break;
+				}
 				case cbCommand::ROBOTDEL:
 					//cout << "View command = RobotDel\n";
 					break;
+				case cbCommand::SEEK:
+					//cout << "View command = Seek\n";
+					seek(command.seek.time);
+					break;
+				case cbCommand::RATE:
+					//cout << "View command = Rate\n";
+					setRate(command.rate.value);
+					break;
+				case cbCommand::LOOP:
+					//cout << "View command = Loop\n";
+					setLoop(command.loop.begin, command.loop.end);
+					break;
 				case cbCommand::UNKNOWN:
 					//cout << "View command = Unknown\n";
 					break;
@@ -205,39 +288,113 @@ void cbLogplayer::ViewCommands()
 }
 	
 
+/*!
+	The lab and the grid as sent to the views, serialized again only
+	after they changed.
+*/
+const cbChunkedXml &cbLogplayer::labMessage()
+{
+	if (labXml.empty()) {
+		string xml;
+		lab->toXml(xml);
+		labXml.set(xml);
+	}
+	return labXml;
+}
+
+const cbChunkedXml &cbLogplayer::gridMessage()
+{
+	if (gridXml.empty()) {
+		string xml;
+		grid->toXml(xml);
+		gridXml.set(xml);
+	}
+	return gridXml;
+}
+
 /*!
 	Send status of every robot to every view.
 */
 void cbLogplayer::UpdateViews()
 {
-	char xml[1024];
-	vector <cbRobot> &robots = (*log)[logIndex];
-	for (unsigned int i=0; i<robots.size(); i++)
+	string xml;
+	const vector <cbRobotSnapshot> *robots = log->cycle(logIndex);
+	if (robots == 0) return;
+	for (unsigned int i=0; i<robots->size(); i++)
 	{
-		cbRobot &robot = robots[i];
-		unsigned int n = robot.toXml(xml, sizeof(xml));
+		const cbRobotSnapshot &robot = (*robots)[i];
+		robot.toXml(xml);
 		for (unsigned int j=0; j<views.size(); j++)
 		{
 			cbView *view = views[j];
-			view->send(xml, n+1);
+			view->send(xml.c_str(), xml.size()+1);
 		}
 	}
 }
 
 void cbLogplayer::WriteLog()
 {
-	for (unsigned int i=0; i<(*log).size(); i++) {
+	for (unsigned int i=0; log->hasCycle(i); i++) {
 		fprintf(stderr,"t %d\n",i);
-		for (unsigned int j=0; j<(*log)[i].size(); j++)
+		const vector <cbRobotSnapshot> &robots = *log->cycle(i);
+		for (unsigned int j=0; j<robots.size(); j++)
 		{
 			fprintf(stderr,"id=%d (%f,%f)\n",
-					(*log)[i][j].Id(),
-					(*log)[i][j].X(),(*log)[i][j].Y());
+					robots[j].id,
+					robots[j].x,robots[j].y);
+		}
+	}
+
+}
+
+
+/*!
+	Advance playback position by the current rate, wrapping in the loop
+	range. Playback stops at both ends of the log.
+*/
+void cbLogplayer::Advance()
+{
+	playPos += playRate;
+
+	if (playRate > 0) {
+		if (looping && playPos >= loopEnd + 1.0 && logIndex <= loopEnd)
+			playPos = loopBegin;
+		else if (!log->hasCycle((unsigned int) playPos)) {
+			playPos = lastCycle();
+			nextState = STOPPED;
 		}
 	}
+	else if (playRate < 0) {
+		if (looping && playPos < loopBegin && logIndex >= loopBegin)
+			playPos = loopEnd;
+		else if (playPos < 0.0) {
+			playPos = 0.0;
+			nextState = STOPPED;
+		}
+	}
+
+	logIndex = (unsigned int) playPos;
+}
 
+/*!
+	Index of the last cycle of the log.
+*/
+unsigned int cbLogplayer::lastCycle()
+{
+	unsigned int n = log->nCycles();
+	return n > 0 ? n-1 : 0;
 }
 
+/*!
+	Show current cycle and playback state in the logplayer window.
+*/
+void cbLogplayer::UpdateGUI()
+{
+	if (gui == 0) return;
+
+	gui->CycleLabel->setText(QString("Cycle %1").arg(log->cycleTime(logIndex)));
+	gui->PlayButton->setText(curState == RUNNING ? "Pause" : "Play");
+}
 
 /*!
 	Update state of simulator and update active state of every robot.
@@ -27,7 +27,8 @@
 
 
 #include "ui_logplayerGUI.h"
-#include "cbrobot.h"
+#include "cblogsource.h"
+#include "cbchunk.h"
 
 #include <qobject.h>
 #include <qvector.h>
@@ -58,7 +59,7 @@ public:
 
 	void setLab(cbLab *);
     void setGrid(cbGrid *);
-    void setLog(vector< vector <cbRobot> > *l) { log=l;}
+    void setLog(cbLogSource *l) { log=l;}
 	void setParameters(cbParameters *);
     void setReceptionist(cbReceptionist *);
     void setGUI(Ui_logplayerGUI *g) { gui=g;}
@@ -78,18 +79,29 @@ public:
     inline State state() { return (curState);}
     inline State getNextState() { return (nextState);}
 
+	/* playback control; times are simulation cycles as stored in the log */
+	void seek(unsigned int time);
+	void setLoop(unsigned int begin, unsigned int end);
+	void clearLoop(void);
+	inline double rate() { return playRate;}
+
 public slots:
 	void step();
+	void setRate(double r);		// negative rates play backwards
+	void togglePlay();
+	void seekFromGUI();
+	void loopFromGUI();
 
 private: // data members
 	unsigned int curCycle;		// current simulation cycle
 	unsigned int endCycle;		// last simulation cycle
 	unsigned int cycle;			// length in miliseconds of a cycle
 	
-	vector <vector <cbRobot> > *log;
+	cbLogSource *log;			// cycles of the log, decoded on demand
 	cbLab *lab;					// the lab
 	cbGrid *grid;				// the grid
 	cbParameters *param;		// global simulation parameters
+	cbChunkedXml labXml, gridXml;	// lab and grid sent to the views, empty when changed
 	
 	cbReceptionist *receptionist; // the receptionist
 
@@ -100,16 +112,26 @@ private: // data members
 
     istream *logStream;
 
-	unsigned int logIndex;
+	unsigned int logIndex;		// cycle sent to the views
+	double playPos;				// fractional playback position
+	double playRate;			// cycles advanced per step
+
+	bool looping;
+	unsigned int loopBegin, loopEnd;	// cycles of the loop range
 
     Ui_logplayerGUI *gui;
 	
 private: // member functions
+	const cbChunkedXml &labMessage();
+	const cbChunkedXml &gridMessage();
 	void CheckIn();
 	void ViewCommands();
 	void PanelCommands();
 	void UpdateViews();
 	void UpdateState();
+	void UpdateGUI();
+	void Advance();
+	unsigned int lastCycle();
 };
 
 #endif
@@ -0,0 +1,352 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+/*
+ * class cbLogSource
+ */
+
+#include "cblogsource.h"
+
+#include <QByteArray>
+
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using std::cerr;
+
+/*!
+	Sets xml to the robot state, exactly as cbRobot::toXml.
+*/
+void cbRobotSnapshot::toXml(string &xml) const
+{
+	char buff[1024];
+	unsigned int n;
+
+	xml = "<Robot";
+	/* add attributes */
+	xml += " Name=\"";
+	xml += name;
+	n = sprintf(buff, "\" Id=\"%d\"", id);
+	n += sprintf(buff+n, " Time=\"%u\"", time);
+	n += sprintf(buff+n, " Score=\"%u\"", score);
+	n += sprintf(buff+n, " ArrivalTime=\"%u\"", arrivalTime);
+	n += sprintf(buff+n, " ReturningTime=\"%u\"", returningTime);
+	n += sprintf(buff+n, " Collisions=\"%u\"", collisions);
+	n += sprintf(buff+n, " Collision=\"%s\"", collision ? "True" : "False");
+	n += sprintf(buff+n, " VisitedMask=\"");
+	xml.append(buff, n);
+	xml += visitedMask;
+	n = sprintf(buff, "\" State=\"%s\">\n", cbBinLogStateName(state));
+
+	/* add position */
+	n += sprintf(buff+n, "\t<Position X=\"%g\" Y=\"%g\" Dir=\"%g\"/>\n", x, y, dir);
+	n += sprintf(buff+n, "</Robot>\n");
+	xml.append(buff, n);
+}
+
+/* search str in [from,to) */
+static const unsigned char *find(const unsigned char *from, const unsigned char *to, const char *str)
+{
+	unsigned int len = strlen(str);
+	while(from + len <= to) {
+		const unsigned char *p = (const unsigned char *) memchr(from, str[0], to - from - len + 1);
+		if(p == 0) return 0;
+		if(memcmp(p, str, len) == 0) return p;
+		from = p + 1;
+	}
+	return 0;
+}
+
+/* value of attribute name in the tag [tag,tagEnd), as a byte array that shares the mapped memory */
+static QByteArray attribute(const unsigned char *tag, const unsigned char *tagEnd, const char *name)
+{
+	char pattern[64];
+	sprintf(pattern, " %s=\"", name);
+
+	const unsigned char *p = find(tag, tagEnd, pattern);
+	if(p == 0) return QByteArray();
+	p += strlen(pattern);
+	const unsigned char *q = (const unsigned char *) memchr(p, '"', tagEnd - p);
+	if(q == 0) return QByteArray();
+
+	return QByteArray::fromRawData((const char *) p, q - p);
+}
+
+cbLogSource::cbLogSource(unsigned int windowSize)
+{
+	data = 0;
+	size = 0;
+	binary = false;
+	scanPos = 0;
+	scanDone = true;
+
+	window.resize(windowSize > 0 ? windowSize : 1);
+	for(unsigned int s=0; s < window.size(); s++)
+		window[s].frame = -1;
+}
+
+cbLogSource::~cbLogSource()
+{
+	close();
+}
+
+bool cbLogSource::open(const char *filename)
+{
+	close();
+
+	file.setFileName(filename);
+	if(!file.open(QIODevice::ReadOnly)) {
+		cerr << "Could not open log file " << filename << "\n";
+		return false;
+	}
+	size = file.size();
+	data = size > 0 ? file.map(0, size) : 0;
+	if(data == 0) {
+		cerr << "Could not map log file " << filename << "\n";
+		close();
+		return false;
+	}
+
+	binary = cbBinLogReader::isBinaryLog(data, size);
+	if(binary) {
+		if(!bin.open(data, size, filename)) {
+			close();
+			return false;
+		}
+		logPreamble = bin.preamble();
+		return true;
+	}
+
+	/* XML log: the preamble goes from the Log tag to the first LogInfo */
+	const unsigned char *end = data + size;
+	const unsigned char *log = find(data, end, "<Log");
+	while(log != 0 && log + 4 < end && log[4] != ' ' && log[4] != '>' && log[4] != '\t')
+		log = find(log + 4, end, "<Log");
+	const unsigned char *begin = log ? (const unsigned char *) memchr(log, '>', end - log) : 0;
+	if(begin == 0) {
+		cerr << filename << " is not a simulator log\n";
+		close();
+		return false;
+	}
+	begin++;
+	if(begin < end && *begin == '\n') begin++;
+
+	const unsigned char *first = find(begin, end, "<LogInfo");
+	if(first == 0) first = find(begin, end, "</Log>");
+	if(first == 0) first = end;
+
+	logPreamble.assign((const char *) begin, first - begin);
+	scanPos = first - data;
+	scanDone = false;
+
+	return true;
+}
+
+void cbLogSource::close(void)
+{
+	bin.close();
+	if(data != 0) file.unmap((uchar *) data);
+	if(file.isOpen()) file.close();
+	data = 0;
+	size = 0;
+	binary = false;
+
+	logPreamble.clear();
+	xmlIndex.clear();
+	xmlTimes.clear();
+	scanPos = 0;
+	scanDone = true;
+
+	for(unsigned int s=0; s < window.size(); s++)
+		window[s].frame = -1;
+}
+
+/*!
+	Index LogInfo items of an XML log until frame is found.
+*/
+bool cbLogSource::scanXml(unsigned int frame)
+{
+	const unsigned char *end = data + size;
+
+	while(xmlIndex.size() <= frame && !scanDone) {
+		const unsigned char *p = find(data + scanPos, end, "<LogInfo");
+		if(p == 0 || p + 8 >= end) {
+			scanDone = true;
+			break;
+		}
+		scanPos = p - data + 8;
+		if(p[8] != ' ' && p[8] != '>') continue;
+
+		const unsigned char *tagEnd = (const unsigned char *) memchr(p, '>', end - p);
+		if(tagEnd == 0) {
+			scanDone = true;
+			break;
+		}
+		xmlIndex.push_back(p - data);
+		xmlTimes.push_back(attribute(p, tagEnd, "Time").toUInt());
+	}
+	return frame < xmlIndex.size();
+}
+
+bool cbLogSource::hasCycle(unsigned int frame)
+{
+	if(data == 0) return false;
+	if(binary) return frame < bin.nCycles();
+	return scanXml(frame);
+}
+
+unsigned int cbLogSource::nCycles(void)
+{
+	if(data == 0) return 0;
+	if(binary) return bin.nCycles();
+	scanXml((unsigned int) -1);
+	return xmlIndex.size();
+}
+
+unsigned int cbLogSource::cycleTime(unsigned int frame)
+{
+	if(!hasCycle(frame)) return 0;
+	return binary ? bin.cycleTime(frame) : xmlTimes[frame];
+}
+
+/*!
+	Binary logs are searched in their index. XML logs are indexed up to
+	the requested time the first time it is sought, then searched.
+*/
+int cbLogSource::findCycle(unsigned int time)
+{
+	if(data == 0) return -1;
+	if(binary) return bin.findCycle(time);
+
+	while(!scanDone && (xmlTimes.empty() || xmlTimes.back() < time))
+		scanXml(xmlIndex.size());
+
+	unsigned int lo = 0, hi = xmlTimes.size();
+	while(lo < hi) {
+		unsigned int mid = (lo + hi) / 2;
+		if(xmlTimes[mid] < time) lo = mid + 1;
+		else hi = mid;
+	}
+	return lo < xmlTimes.size() ? (int) lo : -1;
+}
+
+const vector<cbRobotSnapshot> *cbLogSource::cycle(unsigned int frame)
+{
+	Slot &slot = window[frame % window.size()];
+	if(slot.frame == (int) frame) return &slot.robots;
+
+	if(!hasCycle(frame)) return 0;
+
+	slot.frame = -1;
+	bool ok = binary ? decodeBinary(frame, slot.robots) : decodeXml(frame, slot.robots);
+	if(!ok) return 0;
+	slot.frame = frame;
+
+	return &slot.robots;
+}
+
+bool cbLogSource::decodeBinary(unsigned int frame, vector<cbRobotSnapshot> &robots)
+{
+	if(!bin.readCycle(frame, binRobots)) return false;
+
+	robots.resize(binRobots.size());
+	for(unsigned int r=0; r < binRobots.size(); r++) {
+		const cbBinLogRobot &b = binRobots[r];
+		cbRobotSnapshot &s = robots[r];
+
+		s.name = b.name;
+		s.id = b.id;
+		s.time = bin.cycleTime(frame);
+		s.state = b.state;
+		s.x = b.x;
+		s.y = b.y;
+		s.dir = b.dir;
+		s.score = b.score;
+		s.arrivalTime = b.arrivalTime;
+		s.returningTime = b.returningTime;
+		s.collisions = b.collisions;
+		s.collision = (b.flags & cbBinLogRobot::COLLISION) != 0;
+		s.visitedMask = b.visitedMask;
+	}
+	return true;
+}
+
+/*!
+	Decodes the Robot, Pos and Scores elements of one LogInfo item.
+	Actions and measures are not needed by the viewers and are skipped.
+*/
+bool cbLogSource::decodeXml(unsigned int frame, vector<cbRobotSnapshot> &robots)
+{
+	const unsigned char *p = data + xmlIndex[frame];
+	const unsigned char *end = data + size;
+	const unsigned char *infoEnd = find(p, end, "</LogInfo>");
+	if(infoEnd == 0) infoEnd = end;   // log still being written
+
+	robots.clear();
+	for(;;) {
+		const unsigned char *tag = find(p, infoEnd, "<Robot ");
+		if(tag == 0) break;
+		const unsigned char *tagEnd = (const unsigned char *) memchr(tag, '>', infoEnd - tag);
+		if(tagEnd == 0) break;
+		const unsigned char *robotEnd = find(tagEnd, infoEnd, "</Robot>");
+		if(robotEnd == 0) break;   // incomplete robot
+
+		robots.resize(robots.size()+1);
+		cbRobotSnapshot &s = robots.back();
+		s = cbRobotSnapshot();
+		s.time = xmlTimes[frame];
+
+		QByteArray name = attribute(tag, tagEnd, "Name");
+		s.name.assign(name.constData(), name.size());
+		s.id = attribute(tag, tagEnd, "Id").toUInt();
+		/* the attribute shares the mapped log, it does not end in NUL */
+		QByteArray stateName = attribute(tag, tagEnd, "State");
+		int state = cbBinLogState(stateName.constData(), stateName.size());
+		s.state = state < 0 ? 0 : state;
+
+		const unsigned char *pos = find(tagEnd, robotEnd, "<Pos ");
+		if(pos != 0) {
+			const unsigned char *posEnd = (const unsigned char *) memchr(pos, '>', robotEnd - pos);
+			if(posEnd != 0) {
+				s.x = attribute(pos, posEnd, "X").toDouble();
+				s.y = attribute(pos, posEnd, "Y").toDouble();
+				s.dir = attribute(pos, posEnd, "Dir").toDouble();
+			}
+		}
+
+		const unsigned char *scores = find(tagEnd, robotEnd, "<Scores ");
+		if(scores != 0) {
+			const unsigned char *scoresEnd = (const unsigned char *) memchr(scores, '>', robotEnd - scores);
+			if(scoresEnd != 0) {
+				s.score = attribute(scores, scoresEnd, "Score").toUInt();
+				s.arrivalTime = attribute(scores, scoresEnd, "ArrivalTime").toUInt();
+				s.returningTime = attribute(scores, scoresEnd, "ReturningTime").toUInt();
+				s.collisions = attribute(scores, scoresEnd, "Collisions").toUInt();
+				s.collision = attribute(scores, scoresEnd, "Collision") == "True";
+				QByteArray mask = attribute(scores, scoresEnd, "VisitedMask");
+				s.visitedMask.assign(mask.constData(), mask.size());
+			}
+		}
+
+		p = robotEnd;
+	}
+	return true;
+}
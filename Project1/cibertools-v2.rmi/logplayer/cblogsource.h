@@ -0,0 +1,115 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef CBLOGSOURCE_H
+#define CBLOGSOURCE_H
+
+/*! \file cblogsource.h
+	\brief On demand access to the cycles of a simulator log.
+
+	The log file is memory mapped and cycles are decoded only when they
+	are requested. Only a small window of decoded cycles is kept, so
+	memory use does not depend on the length of the log.
+	Both XML logs and binary logs (.cblog) are supported; XML logs are
+	indexed lazily, as playback moves forward.
+*/
+
+#include <QFile>
+
+#include <string>
+#include <vector>
+
+#include "cbbinlog.h"
+
+using std::string;
+using std::vector;
+
+/**
+ * State of a robot in one cycle, as sent to the viewers.
+ */
+struct cbRobotSnapshot
+{
+	string name;
+	unsigned int id;
+	unsigned int time;
+	unsigned int state;
+	double x, y, dir;   // dir in degrees
+	unsigned int score, arrivalTime, returningTime, collisions;
+	bool collision;
+	string visitedMask;
+
+	void toXml(string &xml) const;
+};
+
+class cbLogSource
+{
+public:
+	cbLogSource(unsigned int windowSize=64);
+	~cbLogSource();
+
+	bool open(const char *filename);
+	void close(void);
+
+	inline bool isBinary(void) { return binary; }
+	inline unsigned long long fileSize(void) { return size; }
+
+	/*! Parameters, Lab and Grid XML of the log. */
+	inline const string &preamble(void) { return logPreamble; }
+
+	bool hasCycle(unsigned int frame);        // indexes the log up to frame if needed
+	unsigned int nCycles(void);               // indexes the whole log
+	unsigned int cycleTime(unsigned int frame);
+	int findCycle(unsigned int time);         // first cycle at or after time, -1 if none
+
+	/*! Robots of the given cycle, 0 if the log has no such cycle.
+	    The pointer is valid until the cycle leaves the window. */
+	const vector<cbRobotSnapshot> *cycle(unsigned int frame);
+
+private:
+	struct Slot
+	{
+		int frame;
+		vector<cbRobotSnapshot> robots;
+	};
+
+	bool scanXml(unsigned int frame);
+	bool decodeXml(unsigned int frame, vector<cbRobotSnapshot> &robots);
+	bool decodeBinary(unsigned int frame, vector<cbRobotSnapshot> &robots);
+
+	QFile file;
+	const unsigned char *data;
+	unsigned long long size;
+
+	bool binary;
+	cbBinLogReader bin;
+	vector<cbBinLogRobot> binRobots;
+
+	string logPreamble;
+
+	/* XML logs: offsets of the LogInfo items found so far */
+	vector<unsigned long long> xmlIndex;
+	vector<unsigned int> xmlTimes;
+	unsigned long long scanPos;
+	bool scanDone;
+
+	vector<Slot> window;
+};
+
+#endif
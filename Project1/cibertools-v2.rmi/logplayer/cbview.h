@@ -24,12 +24,13 @@
 #include "cbclient.h"
 #include "cbviewhandler.h"
 #include "cbviewcommand.h"
+#include "cbchunk.h"
 
 /**
   *@author Nuno Lau, Artur Pereira & Andreia Melo, Miguel Rodrigues
   */
 
-class cbView : public cbClient
+class cbView : public cbClient, public cbDatagramSink
 {
 public:
 	cbView();
@@ -37,6 +38,9 @@ public:
 
 	bool readCommand(cbCommand *command);
 
+	/*! Datagrams of the lab and grid messages, see cbchunk.h. */
+	bool sendDatagram(const char *data, unsigned int len) { return send(data, len); }
+
 protected: // class data members
 	cbViewHandler handler;
 
@@ -22,10 +22,15 @@
 
 struct cbCommand
 {
-	enum {UNKNOWN, START, STOP, LABRQ, GRIDRQ, ROBOTDEL} type;
+	enum {UNKNOWN, START, STOP, LABRQ, GRIDRQ, ROBOTDEL, SEEK, RATE, LOOP, CHUNKRQ} type;
+	enum Object {LAB, GRID};
 	union 
 	{
 		struct { int id; } robot;
+		struct { unsigned int time; } seek;
+		struct { double value; } rate;		// negative plays backwards
+		struct { unsigned int begin, end; } loop;	// end <= begin clears the loop
+		struct { Object object; unsigned int version, seq; } chunk;
 	};
 };
 
@@ -71,6 +71,30 @@ bool cbViewHandler::startElement( const QString&, const QString&, const QString&
 	{
 		command.type = cbCommand::GRIDRQ;
 	}
+	else if (tag == "Seek")
+	{
+		command.type = cbCommand::SEEK;
+		command.seek.time = attr.value(QString("Time")).toUInt();
+	}
+	else if (tag == "Rate")
+	{
+		command.type = cbCommand::RATE;
+		const QString &value = attr.value(QString("Value"));
+		command.rate.value = value.isNull() ? 1.0 : value.toDouble();
+	}
+	else if (tag == "Loop")
+	{
+		command.type = cbCommand::LOOP;
+		command.loop.begin = attr.value(QString("Begin")).toUInt();
+		command.loop.end = attr.value(QString("End")).toUInt();
+	}
+	else if (tag == "ChunkReq")
+	{
+		command.type = cbCommand::CHUNKRQ;
+		command.chunk.object = attr.value(QString("Object")) == "Grid" ? cbCommand::GRID : cbCommand::LAB;
+		command.chunk.version = attr.value(QString("Version")).toUInt();
+		command.chunk.seq = attr.value(QString("Seq")).toUInt();
+	}
 	else
 	{
 		command.type = cbCommand::UNKNOWN;
@@ -116,6 +140,38 @@ bool cbViewHandler::endElement( const QString&, const QString&, const QString& q
 			return false;
 		}
 	}
+	else if (tag == "Seek")
+	{
+		if (command.type != cbCommand::SEEK)
+		{
+			cerr << "Missmatched end Seek tag\n";
+			return false;
+		}
+	}
+	else if (tag == "Rate")
+	{
+		if (command.type != cbCommand::RATE)
+		{
+			cerr << "Missmatched end Rate tag\n";
+			return false;
+		}
+	}
+	else if (tag == "Loop")
+	{
+		if (command.type != cbCommand::LOOP)
+		{
+			cerr << "Missmatched end Loop tag\n";
+			return false;
+		}
+	}
+	else if (tag == "ChunkReq")
+	{
+		if (command.type != cbCommand::CHUNKRQ)
+		{
+			cerr << "Missmatched end ChunkReq tag\n";
+			return false;
+		}
+	}
 	else if (tag == "Robot")
 	{
 		if (command.type != cbCommand::ROBOTDEL)
@@ -0,0 +1,156 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+ * replaycheck - checks that the logplayer replays the robots as they
+ * were logged. A small log is written by cbLogWriter, in XML and in the
+ * binary format, then read back with cbLogSource, and the state, pose
+ * and scores of every robot compared with the ones written.
+ *
+ * Prints one line per log and returns 0 if both replay correctly.
+ */
+
+#include "cblogsource.h"
+#include "cblogwriter.h"
+#include "cbbinlog.h"
+
+#include <QDir>
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+#define NCYCLES 40
+
+// every state the simulator logs, see StrState in cbrobot.cpp
+static const char *states[] = { "Stopped", "Running", "Waiting", "Returning", "Finished", "Removed" };
+#define NROBOTS ((int) (sizeof(states)/sizeof(states[0])))
+
+static void fillRobot(cbLogRobotRecord &r, int id, unsigned int cycle)
+{
+	r.name = "robot";
+	r.name += (char) ('A' + id);
+	r.id = id + 1;
+	r.state = states[(id + cycle / 10) % NROBOTS];
+	r.x = 1.5 + id;
+	r.y = 2.0 + 0.1 * cycle;
+	r.dir = -90 + cycle;
+	r.score = 10 * cycle + id;
+	r.arrivalTime = r.returningTime = 0;
+	r.collisions = id;
+	r.collision = false;
+	r.visitedMask = cycle > 20 ? "10" : "00";
+	r.actions = 0;
+	r.leftMotor = r.rightMotor = 0;
+	r.withMeasures = false;
+	r.irSensors.clear();
+	r.beacons.clear();
+	r.endLed = r.returningLed = r.visitingLed = false;
+}
+
+/*!
+	Writes the log, XML or binary, with the simulator writer.
+*/
+static bool writeLog(const string &file, bool binary)
+{
+	string preamble = "<Lab Name=\"check\" Width=\"28\" Height=\"14\">\n"
+	                  "\t<Beacon X=\"3\" Y=\"7\" Height=\"2\"/>\n"
+	                  "\t<Target X=\"3\" Y=\"7\" Radius=\"1\"/>\n"
+	                  "\t<Target X=\"20\" Y=\"7\" Radius=\"1\"/>\n"
+	                  "</Lab>\n";
+	cbLogWriter writer;
+	bool opened = binary ? writer.openBinary(file.c_str(), 0, preamble, 1, 2)
+	                     : writer.open(file.c_str());
+	if(!opened) {
+		fprintf(stderr, "replaycheck: can not write %s\n", file.c_str());
+		return false;
+	}
+	if(!binary) {
+		writer.writeText("<Log>\n");
+		writer.writeText(preamble.c_str());
+	}
+	for(unsigned int c=0; c < NCYCLES; c++) {
+		cbLogRecord *rec = writer.acquire(cbLogRecord::LOGINFO);
+		rec->time = c;
+		for(int id=0; id < NROBOTS; id++)
+			fillRobot(rec->addRobot(), id, c);
+		writer.commit();
+	}
+	if(!binary) writer.writeText("</Log>\n");
+	writer.close();
+	return true;
+}
+
+/*!
+	Replays the log and compares it with what was written.
+	Returns the number of differences, -1 if it can not be read.
+*/
+static int replay(const string &file)
+{
+	cbLogSource log;
+	if(!log.open(file.c_str())) return -1;
+	if(log.nCycles() != NCYCLES) {
+		fprintf(stderr, "%s: %u cycles, %d written\n", file.c_str(), log.nCycles(), NCYCLES);
+		return -1;
+	}
+
+	int errors = 0;
+	cbLogRobotRecord expected;
+	for(unsigned int c=0; c < NCYCLES; c++) {
+		const vector<cbRobotSnapshot> *robots = log.cycle(c);
+		if(robots == 0 || robots->size() != (unsigned int) NROBOTS) {
+			fprintf(stderr, "%s: cycle %u is not complete\n", file.c_str(), c);
+			return -1;
+		}
+		for(int id=0; id < NROBOTS; id++) {
+			const cbRobotSnapshot &s = (*robots)[id];
+			fillRobot(expected, id, c);
+			string state = cbBinLogStateName(s.state);
+			if(state != expected.state || s.name != expected.name || s.id != expected.id
+			   || s.score != expected.score || s.visitedMask != expected.visitedMask
+			   || (float) s.x != (float) expected.x) {
+				if(errors < 10)
+					fprintf(stderr, "%s: cycle %u robot %u replayed %s, logged %s\n",
+					        file.c_str(), c, s.id, state.c_str(), expected.state);
+				errors++;
+			}
+		}
+	}
+	return errors;
+}
+
+int main(void)
+{
+	string dir = QDir::tempPath().toStdString();
+	const char *names[] = { "/replaycheck.log", "/replaycheck.cblog" };
+	int failed = 0;
+
+	for(int b=0; b < 2; b++) {
+		string file = dir + names[b];
+		int errors = writeLog(file, b == 1) ? replay(file) : -1;
+		printf("%s: %s\n", file.c_str(), errors == 0 ? "ok" : errors < 0 ? "unreadable" : "FAILED");
+		if(errors != 0) failed++;
+		QFile::remove(file.c_str());
+	}
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+TEMPLATE	= app
+CONFIG		+= qt warn_on release thread console
+
+# replay check of the logplayer log sources, see replaycheck.cpp
+INCLUDEPATH	+= .. ../../simulator
+DEPENDPATH	+= .. ../../simulator
+
+HEADERS		= ../cblogsource.h ../../simulator/cbbinlog.h\
+		  ../../simulator/cblogwriter.h ../../simulator/cbxmlbuilder.h
+SOURCES		= replaycheck.cpp ../cblogsource.cpp ../../simulator/cbbinlog.cpp\
+		  ../../simulator/cblogwriter.cpp ../../simulator/cbxmlbuilder.cpp
+
+TARGET		= replaycheck
+
+QT		-= gui
@@ -54,6 +54,7 @@
 
 #include "cblogplayer.h"
 #include "cbloghandler.h"
+#include "cblogsource.h"
 #include "cblab.h"
 #include "cblabhandler.h"
 #include "cbgridhandler.h"
@@ -145,27 +146,29 @@ int main(int argc, char *argv[])
 	
 	//cout << " done.\n";
 
-	/* create lab object and parse lab file */
-	//cout << "Creating lab object...";
+	/* map the log; its cycles are decoded on demand */
 	QXmlInputSource *source;
 
     if(logFilename) {
-        QFile srcFile(logFilename);
+        cbLogSource *log = new cbLogSource;
 
-        if(!srcFile.exists())
+        if(!log->open(logFilename))
         {
-            cerr << "Could not open log file " << logFilename << "\n";
             QMessageBox::critical(0,"Error", QString("Could not open log file ") + logFilename,
                                   QMessageBox::Ok,Qt::NoButton,Qt::NoButton);
             return 1;
         }
-        if ((source = new QXmlInputSource(&srcFile)) == 0)
+        logplayer.setLog(log);
+
+        /* only the Parameters, Lab and Grid are parsed here */
+        if ((source = new QXmlInputSource) == 0)
         {
             cerr << "Fail sourcing log file\n";
                         QMessageBox::critical(0,"Error", QString("Failed sourcing log file "),
                                QMessageBox::Ok,Qt::NoButton,Qt::NoButton);
             return 1;
         }
+        source->setData(QString::fromLatin1(("<Log>\n" + log->preamble() + "</Log>\n").c_str()));
 
         cbLogHandler *logHandler = new cbLogHandler(&xmlParser);
         xmlParser.setContentHandler(logHandler);
@@ -177,8 +180,6 @@ int main(int argc, char *argv[])
                                               QMessageBox::Ok,Qt::NoButton,Qt::NoButton);
             return 1;
         }
-        vector< vector <cbRobot> > *log = logHandler->parsedLog();
-        logplayer.setLog(log);
         if(logHandler->getLab()!=0)
             logplayer.setLab(logHandler->getLab());
         else
@@ -245,6 +246,12 @@ int main(int argc, char *argv[])
     ui.setupUi(gui);
 
     QObject::connect(ui.QuitButton,SIGNAL(clicked()),&app,SLOT(quit()));
+    QObject::connect(ui.PlayButton,SIGNAL(clicked()),&logplayer,SLOT(togglePlay()));
+    QObject::connect(ui.RateSpin,SIGNAL(valueChanged(double)),&logplayer,SLOT(setRate(double)));
+    QObject::connect(ui.SeekButton,SIGNAL(clicked()),&logplayer,SLOT(seekFromGUI()));
+    QObject::connect(ui.LoopCheck,SIGNAL(toggled(bool)),&logplayer,SLOT(loopFromGUI()));
+    QObject::connect(ui.LoopBeginSpin,SIGNAL(valueChanged(int)),&logplayer,SLOT(loopFromGUI()));
+    QObject::connect(ui.LoopEndSpin,SIGNAL(valueChanged(int)),&logplayer,SLOT(loopFromGUI()));
     logplayer.setGUI(&ui);
     gui->setMaximumSize(gui->size());
     gui->setMinimumSize(gui->size());
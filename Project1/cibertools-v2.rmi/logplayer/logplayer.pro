@@ -5,6 +5,10 @@ win32 {
     DEFINES     += MicWindows
 }
 
+# the binary log reader and the chunked transfer are shared with the simulator
+INCLUDEPATH	+= ../simulator
+DEPENDPATH	+= ../simulator
+
 HEADERS		= cbbeacon.h cbclient.h\
                   cbgrid.h cbgridhandler.h cblab.h cblabhandler.h\
                   cbparameters.h cbparamhandler.h\
@@ -12,13 +16,15 @@ HEADERS		= cbbeacon.h cbclient.h\
                   cbreceptionist.h\
                   cblogplayer.h cbrobot.h cbtarget.h cbview.h cbviewcommand.h\
                   cbviewhandler.h cbwall.h\
-		  cbloghandler.h
+		  cbloghandler.h cblogsource.h ../simulator/cbbinlog.h\
+		  ../simulator/cbchunk.h
 SOURCES		= cbbeacon.cpp cbclient.cpp\
                   cbgrid.cpp cbgridhandler.cpp cblab.cpp cblabhandler.cpp\
                   cbparameters.cpp cbparamhandler.cpp\
                   cbpoint.cpp cbposition.cpp cbreceptionhandler.cpp cbreceptionist.cpp\
                   cblogplayer.cpp cbrobot.cpp cbtarget.cpp cbview.cpp cbviewhandler.cpp\
-                  cbwall.cpp cbloghandler.cpp logplayer.cpp
+                  cbwall.cpp cbloghandler.cpp cblogsource.cpp logplayer.cpp\
+		  ../simulator/cbbinlog.cpp ../simulator/cbchunk.cpp
 
 TARGET		= logplayer
 
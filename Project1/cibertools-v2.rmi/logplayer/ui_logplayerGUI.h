@@ -15,9 +15,12 @@
 #include <QtGui/QAction>
 #include <QtGui/QApplication>
 #include <QtGui/QButtonGroup>
+#include <QtGui/QCheckBox>
+#include <QtGui/QDoubleSpinBox>
 #include <QtGui/QHeaderView>
 #include <QtGui/QLabel>
 #include <QtGui/QPushButton>
+#include <QtGui/QSpinBox>
 #include <QtGui/QVBoxLayout>
 #include <QtGui/QWidget>
 
@@ -30,13 +33,22 @@ public:
     QVBoxLayout *vlayout1;
     QLabel *TextLabel2;
     QLabel *TextLabel3;
+    QLabel *CycleLabel;
+    QPushButton *PlayButton;
+    QLabel *RateLabel;
+    QDoubleSpinBox *RateSpin;
+    QSpinBox *SeekSpin;
+    QPushButton *SeekButton;
+    QCheckBox *LoopCheck;
+    QSpinBox *LoopBeginSpin;
+    QSpinBox *LoopEndSpin;
     QPushButton *QuitButton;
 
     void setupUi(QWidget *logplayerGUI)
     {
         if (logplayerGUI->objectName().isEmpty())
             logplayerGUI->setObjectName(QString::fromUtf8("logplayerGUI"));
-        logplayerGUI->resize(350, 144);
+        logplayerGUI->resize(350, 245);
         Layout3 = new QWidget(logplayerGUI);
         Layout3->setObjectName(QString::fromUtf8("Layout3"));
         Layout3->setGeometry(QRect(10, 10, 272, 65));
@@ -57,9 +69,43 @@ public:
 
         vlayout1->addWidget(TextLabel3);
 
+        CycleLabel = new QLabel(logplayerGUI);
+        CycleLabel->setObjectName(QString::fromUtf8("CycleLabel"));
+        CycleLabel->setGeometry(QRect(10, 80, 150, 25));
+        PlayButton = new QPushButton(logplayerGUI);
+        PlayButton->setObjectName(QString::fromUtf8("PlayButton"));
+        PlayButton->setGeometry(QRect(180, 80, 80, 25));
+        RateLabel = new QLabel(logplayerGUI);
+        RateLabel->setObjectName(QString::fromUtf8("RateLabel"));
+        RateLabel->setGeometry(QRect(10, 115, 55, 25));
+        RateSpin = new QDoubleSpinBox(logplayerGUI);
+        RateSpin->setObjectName(QString::fromUtf8("RateSpin"));
+        RateSpin->setGeometry(QRect(70, 115, 90, 25));
+        RateSpin->setMinimum(-64);
+        RateSpin->setMaximum(64);
+        RateSpin->setSingleStep(0.5);
+        RateSpin->setValue(1);
+        SeekSpin = new QSpinBox(logplayerGUI);
+        SeekSpin->setObjectName(QString::fromUtf8("SeekSpin"));
+        SeekSpin->setGeometry(QRect(180, 115, 90, 25));
+        SeekSpin->setMaximum(999999);
+        SeekButton = new QPushButton(logplayerGUI);
+        SeekButton->setObjectName(QString::fromUtf8("SeekButton"));
+        SeekButton->setGeometry(QRect(275, 115, 65, 25));
+        LoopCheck = new QCheckBox(logplayerGUI);
+        LoopCheck->setObjectName(QString::fromUtf8("LoopCheck"));
+        LoopCheck->setGeometry(QRect(10, 150, 55, 25));
+        LoopBeginSpin = new QSpinBox(logplayerGUI);
+        LoopBeginSpin->setObjectName(QString::fromUtf8("LoopBeginSpin"));
+        LoopBeginSpin->setGeometry(QRect(70, 150, 90, 25));
+        LoopBeginSpin->setMaximum(999999);
+        LoopEndSpin = new QSpinBox(logplayerGUI);
+        LoopEndSpin->setObjectName(QString::fromUtf8("LoopEndSpin"));
+        LoopEndSpin->setGeometry(QRect(180, 150, 90, 25));
+        LoopEndSpin->setMaximum(999999);
         QuitButton = new QPushButton(logplayerGUI);
         QuitButton->setObjectName(QString::fromUtf8("QuitButton"));
-        QuitButton->setGeometry(QRect(140, 100, 80, 35));
+        QuitButton->setGeometry(QRect(140, 200, 80, 35));
 
         retranslateUi(logplayerGUI);
 
@@ -71,6 +117,12 @@ public:
         logplayerGUI->setWindowTitle(QApplication::translate("logplayerGUI", "CiberRato Logplayer", 0, QApplication::UnicodeUTF8));
         TextLabel2->setText(QApplication::translate("logplayerGUI", "Universidade de Aveiro - 2011", 0, QApplication::UnicodeUTF8));
         TextLabel3->setText(QApplication::translate("logplayerGUI", "http://microrato.ua.pt", 0, QApplication::UnicodeUTF8));
+        CycleLabel->setText(QApplication::translate("logplayerGUI", "Cycle 0", 0, QApplication::UnicodeUTF8));
+        PlayButton->setText(QApplication::translate("logplayerGUI", "Play", 0, QApplication::UnicodeUTF8));
+        RateLabel->setText(QApplication::translate("logplayerGUI", "Rate", 0, QApplication::UnicodeUTF8));
+        RateSpin->setSuffix(QApplication::translate("logplayerGUI", "x", 0, QApplication::UnicodeUTF8));
+        SeekButton->setText(QApplication::translate("logplayerGUI", "Seek", 0, QApplication::UnicodeUTF8));
+        LoopCheck->setText(QApplication::translate("logplayerGUI", "Loop", 0, QApplication::UnicodeUTF8));
         QuitButton->setText(QApplication::translate("logplayerGUI", "Quit", 0, QApplication::UnicodeUTF8));
     } // retranslateUi
 
@@ -0,0 +1,213 @@
+/* robsampleplugin.c
+ *
+ * Basic Robot Agent, as an in-process controller of the simulator
+ * (see simulator/cbcontroller.h). The behaviour is the one of mainRob.c
+ * and robfunc.c, with the sensor readings taken from cbcMeasures and the
+ * static variables moved to the state of each robot.
+ *
+ *   simulator -plugin librobsampleplugin.so@5
+ *
+ * For more information about the CiberRato Robot Simulator 
+ * please see http://microrato.ua.pt/ or contact us.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "cbcontroller.h"
+
+#define RUN         1
+#define STOP        2
+#define WAIT        3
+#define RETURN      4
+
+#define CENTER 0
+#define LEFT   1
+#define RIGHT  2
+
+#if defined(_WIN32)
+#define EXPORT __declspec(dllexport)
+#else
+#define EXPORT
+#endif
+
+struct robsample
+{
+    char name[20];
+    int nBeacons;
+    int state, stoppedState;
+    int beaconToFollow;
+    int finished;
+
+    /* statics of DetermineAction */
+    int counter;
+    int beaconVisible;
+    double beaconDir;
+    float left, right, center;
+    int ground;
+    int collision;
+};
+
+/* Calculate the power of left and right motors */
+static void DetermineAction(struct robsample *r, const struct cbcMeasures *m,
+                            int beaconToFollow, float *lPow, float *rPow)
+{
+    int beaconReady;
+
+    if(m->irReady[LEFT])
+        r->left=     m->ir[LEFT];
+    if(m->irReady[RIGHT])
+        r->right=    m->ir[RIGHT];
+    if(m->irReady[CENTER])
+        r->center=   m->ir[CENTER];
+
+    beaconReady = beaconToFollow < m->nBeacons && m->beaconReady[beaconToFollow];
+    if(beaconReady) {
+       r->beaconVisible = m->beaconVisible[beaconToFollow];
+       r->beaconDir = m->beaconDir[beaconToFollow];
+    }
+
+    if(m->groundReady)
+        r->ground=    m->ground;
+    if(m->collisionReady)
+        r->collision= m->collision;
+
+    if(r->center>4.5 || r->right>4.5 || r->left>4.5 || r->collision) { /* Close Obstacle - Rotate */
+        if(r->counter % 400 < 200) {
+           *lPow=0.06;
+           *rPow=-0.06; }
+        else {
+           *lPow=-0.06;
+           *rPow=0.06; }
+    }
+    else if(r->right>1.5) { /* Obstacle Near - Avoid */
+        *lPow=0.0;
+        *rPow=0.05;
+    }
+    else if(r->left>1.5) {
+        *lPow=0.05;
+        *rPow=0.0;
+    }
+    else { 
+        if(beaconReady && r->beaconVisible && r->beaconDir>20.0) { /* turn to Beacon */
+           *lPow=0.0;
+           *rPow=0.1;
+        }
+        else if(beaconReady && r->beaconVisible && r->beaconDir<-20.0) {
+           *lPow=0.1;
+           *rPow=0.0;
+        }
+        else { /* Full Speed Ahead */
+           *lPow=0.1;
+           *rPow=0.1;
+        }
+    }
+
+    r->counter++;
+}
+
+static void DriveMotors(struct cbcActions *a, float lPow, float rPow)
+{
+    a->leftMotorSet = a->rightMotorSet = 1;
+    a->leftMotor = lPow;
+    a->rightMotor = rPow;
+}
+
+static void Request(struct cbcActions *a, const char *sensor)
+{
+    if(a->nRequests < CBC_MAX_REQUESTS) {
+        strncpy(a->requests[a->nRequests], sensor, CBC_SENSOR_ID_LEN-1);
+        a->nRequests++;
+    }
+}
+
+EXPORT int cb_controller_api(void)
+{
+    return CB_CONTROLLER_API;
+}
+
+EXPORT void *cb_controller_create(const char *name, int id, const struct cbcParameters *param)
+{
+    struct robsample *r = (struct robsample *) calloc(1, sizeof(struct robsample));
+    if(r == NULL) return NULL;
+
+    strncpy(r->name, name, 19);
+    r->nBeacons = param->nBeacons;
+    r->state = STOP;
+    r->stoppedState = RUN;
+    r->beaconToFollow = 0;
+
+    printf( "%s Connected (position %d)\n", r->name, id );
+    return r;
+}
+
+EXPORT void cb_controller_step(void *ctrl, const struct cbcMeasures *m, struct cbcActions *a)
+{
+    struct robsample *r = (struct robsample *) ctrl;
+    float lPow,rPow;
+    char sensor[CBC_SENSOR_ID_LEN];
+
+    if(r->finished) return;
+
+    if(r->state==STOP && m->start) r->state=r->stoppedState;  /* Restart     */
+    if(r->state!=STOP && m->stop)  {
+        r->stoppedState=r->state;
+        r->state=STOP; /* Interrupt */
+    }
+
+    switch (r->state) { 
+        case RUN:    /* Go */
+            if( m->visitingLed ) r->state = WAIT;
+            if(m->ground==0) {         /* Visit Target */
+                a->visitingLedSet = 1;
+                a->visitingLed = 1;
+                printf("%s visited target at %u\n", r->name, m->time);
+            }
+            else {
+                DetermineAction(r,m,0,&lPow,&rPow);
+                DriveMotors(a,lPow,rPow);
+            }
+            break;
+        case WAIT: /* Wait for others to visit target */
+            if(m->returningLed) r->state = RETURN;
+
+            DriveMotors(a,0.0,0.0);
+            break;
+        case RETURN: /* Return to home area */
+            if(m->ground==1) { /* Finish */
+                a->endLedSet = 1;
+                a->endLed = 1;
+                r->finished = 1;
+                printf("%s found home at %u\n", r->name, m->time);
+            }
+            else {
+                DetermineAction(r,m,1,&lPow,&rPow);
+                DriveMotors(a,lPow,rPow);
+            }
+            break;
+    }
+
+    strncpy(a->say, r->name, CBC_MAX_SAY-1);
+
+    /* Request Sensors for next cycle */
+    if(m->time % 2 == 0) {
+        Request(a, "IRSensor0");
+
+        if(m->time % 8 == 0 || r->beaconToFollow == r->nBeacons)
+            Request(a, "Ground");
+        else {
+            sprintf(sensor, "Beacon%d", r->beaconToFollow);
+            Request(a, sensor);
+        }
+    }
+    else {
+        Request(a, "IRSensor1");
+        Request(a, "IRSensor2");
+    }
+}
+
+EXPORT void cb_controller_destroy(void *ctrl)
+{
+    free(ctrl);
+}
@@ -0,0 +1,12 @@
+TEMPLATE = lib
+CONFIG += plugin release
+CONFIG -= qt
+
+TARGET = robsampleplugin
+
+# only the header of the controller interface is needed
+INCLUDEPATH += $$PWD/../../simulator
+
+# Input
+HEADERS += ../../simulator/cbcontroller.h
+SOURCES += robsampleplugin.c
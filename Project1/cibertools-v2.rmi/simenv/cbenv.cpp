@@ -0,0 +1,351 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "cbenv.h"
+
+#include "cbsimulator.h"
+#include "cbrobot.h"
+#include "cbrobotaction.h"
+#include "cbcontroller.h"
+#include "cbgrid.h"
+
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+
+#include <string.h>
+#include <iostream>
+#include <vector>
+
+using std::cerr;
+using std::vector;
+
+/**
+ * Robot of an environment: its actions come from the action array and
+ * its measures go to the observation array, nothing is serialized.
+ */
+class cbEnvRobot : public cbRobot
+{
+public:
+	cbEnvRobot() : cbRobot(irSensorDefaultAngles), hasPending(false)
+	{ memset(&measures, 0, sizeof(measures)); }
+
+	void setAction(const float *a);
+	void observe(float *obs);
+
+	virtual bool readAction(cbRobotAction *);
+	virtual void sendSensors();
+
+private:
+	cbcMeasures measures;
+	cbRobotAction pending;
+	bool hasPending;
+};
+
+/*!
+	Take the action of the next cycle; motors are always set.
+*/
+void cbEnvRobot::setAction(const float *a)
+{
+	pending.reset();
+	pending.leftMotorChanged = true;
+	pending.leftMotor = a[CBENV_ACT_LEFT];
+	pending.rightMotorChanged = true;
+	pending.rightMotor = a[CBENV_ACT_RIGHT];
+	pending.endLedChanged = pending.endLed = a[CBENV_ACT_END_LED] > 0.5;
+	pending.returningLedChanged = pending.returningLed = a[CBENV_ACT_RETURNING_LED] > 0.5;
+	pending.visitingLedChanged = pending.visitingLed = a[CBENV_ACT_VISITING_LED] > 0.5;
+	hasPending = true;
+}
+
+bool cbEnvRobot::readAction(cbRobotAction *action)
+{
+	if (!hasPending) return false;
+	hasPending = false;
+
+	*action = pending;
+	return true;
+}
+
+void cbEnvRobot::sendSensors()
+{
+	fillMeasures(measures);
+}
+
+/*!
+	Write the measures of the last cycle, see cbenv.h for the layout.
+*/
+void cbEnvRobot::observe(float *obs)
+{
+	const cbcMeasures &m = measures;
+
+	obs[CBENV_OBS_COLLISION] = m.collision;
+	obs[CBENV_OBS_COMPASS] = m.compass;
+	obs[CBENV_OBS_GROUND] = m.ground;
+	for (int i = 0; i < 4; i++)
+		obs[CBENV_OBS_IR0+i] = m.ir[i];
+	obs[CBENV_OBS_X] = m.x;
+	obs[CBENV_OBS_Y] = m.y;
+	obs[CBENV_OBS_DIR] = m.dir;
+	obs[CBENV_OBS_END_LED] = m.endLed;
+	obs[CBENV_OBS_RETURNING_LED] = m.returningLed;
+	obs[CBENV_OBS_VISITING_LED] = m.visitingLed;
+	for (int b = 0; b < CBENV_MAX_BEACONS; b++) {
+		bool there = b < m.nBeacons;
+		obs[CBENV_OBS_BEACON+2*b] = there ? m.beaconVisible[b] : 0;
+		obs[CBENV_OBS_BEACON+2*b+1] = there ? m.beaconDir[b] : 0;
+	}
+}
+
+/**
+ * One simulator of the environment and its robots.
+ */
+struct cbEnvInstance
+{
+	cbSimulator *sim;
+	vector<cbEnvRobot *> robots;     // robot r has id r+1
+	vector<unsigned int> scores;     // scores after the previous cycle
+	cbSimState state;                // buffer of cbenv_save and cbenv_restore
+
+	bool reset(int nRobots, float *obs);
+	void step(const float *actions, float *obs, float *rewards, unsigned char *dones);
+	bool done(unsigned int r);
+	void observe(float *obs);
+};
+
+/*!
+	Restart the simulation with new robots and run it up to the first
+	cycle with the robots running.
+*/
+bool cbEnvInstance::reset(int nRobots, float *obs)
+{
+	sim->reset();   // deletes the robots
+
+	robots.assign(nRobots, 0);
+	scores.assign(nRobots, 0);
+	for (int r = 0; r < nRobots; r++) {
+		cbEnvRobot *robot = new cbEnvRobot;
+		robot->setId(r+1);
+		if (!sim->registerRobot(robot)) {
+			delete robot;
+			return false;
+		}
+		robot->setName(QString("Env%1").arg(r+1).toLatin1().constData());
+		robots[r] = robot;
+	}
+
+	sim->step();    // leave INIT
+	sim->start();
+	sim->step();    // robots enter RUNNING
+
+	for (int r = 0; r < nRobots; r++)
+		scores[r] = robots[r]->Score();
+	if (obs != 0) observe(obs);
+	return true;
+}
+
+bool cbEnvInstance::done(unsigned int r)
+{
+	cbEnvRobot *robot = robots[r];
+	return sim->state() == cbSimulator::FINISHED
+	       || robot->hasFinished() || robot->isRemoved();
+}
+
+void cbEnvInstance::observe(float *obs)
+{
+	for (unsigned int r = 0; r < robots.size(); r++)
+		robots[r]->observe(obs + r * CBENV_OBS_SIZE);
+}
+
+void cbEnvInstance::step(const float *actions, float *obs, float *rewards, unsigned char *dones)
+{
+	unsigned int r, nDone = 0;
+	for (r = 0; r < robots.size(); r++)
+		if (done(r)) nDone++;
+
+	if (nDone < robots.size()) {
+		for (r = 0; r < robots.size(); r++)
+			robots[r]->setAction(actions + r * CBENV_ACT_SIZE);
+		sim->step();
+	}
+
+	for (r = 0; r < robots.size(); r++) {
+		unsigned int score = robots[r]->Score();
+		rewards[r] = (float) ((double) scores[r] - (double) score);
+		scores[r] = score;
+		dones[r] = done(r) ? 1 : 0;
+	}
+	observe(obs);
+}
+
+/**
+ * Steps a range of instances, one per pool thread.
+ */
+class cbEnvShard : public QRunnable
+{
+public:
+	cbEnvShard() { setAutoDelete(false); }
+	virtual void run();
+
+	cbEnv *env;
+	int first, last;
+};
+
+struct cbEnv
+{
+	int nInstances, nRobots;
+	vector<cbEnvInstance> instances;
+	QThreadPool pool;
+	vector<cbEnvShard *> shards;
+
+	// arrays of the step running
+	const float *actions;
+	float *obs, *rewards;
+	unsigned char *dones;
+};
+
+void cbEnvShard::run()
+{
+	int R = env->nRobots;
+	for (int k = first; k < last; k++)
+		env->instances[k].step(env->actions + k * R * CBENV_ACT_SIZE,
+		                       env->obs + k * R * CBENV_OBS_SIZE,
+		                       env->rewards + k * R, env->dones + k * R);
+}
+
+cbEnv *cbenv_create(int nInstances, int nRobots, const char *paramFile,
+                    const char *labFile, const char *gridFile, int nThreads)
+{
+	if (nInstances <= 0 || nRobots <= 0) return 0;
+
+	cbEnv *env = new cbEnv;
+	env->nInstances = nInstances;
+	env->nRobots = nRobots;
+	env->instances.resize(nInstances);
+
+	bool ok = true;
+	for (int k = 0; k < nInstances; k++) {
+		cbSimulator *sim = env->instances[k].sim = new cbSimulator;
+		if (!ok) continue;
+
+		if (paramFile) ok = ok && sim->changeParameters(paramFile);
+		if (labFile) ok = ok && sim->changeLab(labFile);
+		if (gridFile) ok = ok && sim->changeGrid(gridFile);
+		if (!ok) continue;
+
+		// robots beyond the grid start at sampled free positions
+		sim->setCapacity(nRobots);
+
+		sim->buildGraph();
+		sim->setDistMaxFromGridToTarget();
+		sim->robotConfig().showActions = false;
+		sim->robotConfig().showMeasures = false;
+		sim->randomGenerator().seed(k+1);
+		sim->setHistory(0);
+		ok = env->instances[k].reset(nRobots, 0);
+	}
+	if (!ok) {
+		cbenv_destroy(env);
+		return 0;
+	}
+
+	if (nThreads <= 0) nThreads = QThread::idealThreadCount();
+	if (nThreads > nInstances) nThreads = nInstances;
+	env->pool.setMaxThreadCount(nThreads);
+	for (int s = 0; s < nThreads; s++) {
+		cbEnvShard *shard = new cbEnvShard;
+		shard->env = env;
+		shard->first = nInstances * s / nThreads;
+		shard->last = nInstances * (s+1) / nThreads;
+		env->shards.push_back(shard);
+	}
+	return env;
+}
+
+int cbenv_reset(cbEnv *env, int instance, float *obs)
+{
+	if (instance < 0 || instance >= env->nInstances) return -1;
+	return env->instances[instance].reset(env->nRobots, obs) ? 0 : -1;
+}
+
+void cbenv_reset_all(cbEnv *env, float *obs)
+{
+	for (int k = 0; k < env->nInstances; k++)
+		env->instances[k].reset(env->nRobots, obs + k * env->nRobots * CBENV_OBS_SIZE);
+}
+
+void cbenv_step_all(cbEnv *env, const float *actions, float *obs,
+                    float *rewards, unsigned char *dones)
+{
+	env->actions = actions;
+	env->obs = obs;
+	env->rewards = rewards;
+	env->dones = dones;
+
+	// the calling thread runs the first shard
+	for (unsigned int s = 1; s < env->shards.size(); s++)
+		env->pool.start(env->shards[s]);
+	env->shards[0]->run();
+	env->pool.waitForDone();
+}
+
+int cbenv_save(cbEnv *env, int instance, char *buf, int len)
+{
+	if (instance < 0 || instance >= env->nInstances) return -1;
+
+	cbEnvInstance &inst = env->instances[instance];
+	inst.sim->snapshot(inst.state);
+	if (buf == 0) return inst.state.size();
+	if ((int) inst.state.size() > len) return -1;
+
+	memcpy(buf, inst.state.bytes(), inst.state.size());
+	return inst.state.size();
+}
+
+int cbenv_restore(cbEnv *env, int instance, const char *buf, int len, float *obs)
+{
+	if (instance < 0 || instance >= env->nInstances || len <= 0) return -1;
+
+	cbEnvInstance &inst = env->instances[instance];
+	inst.state.setBytes(buf, len);
+	if (!inst.sim->restore(inst.state)) return -1;
+
+	// the measures of the restored cycle are in the sensor FIFOs
+	for (unsigned int r = 0; r < inst.robots.size(); r++) {
+		inst.robots[r]->sendSensors();
+		inst.scores[r] = inst.robots[r]->Score();
+	}
+	if (obs != 0) inst.observe(obs);
+	return 0;
+}
+
+void cbenv_destroy(cbEnv *env)
+{
+	env->pool.waitForDone();
+	for (unsigned int s = 0; s < env->shards.size(); s++)
+		delete env->shards[s];
+	for (unsigned int k = 0; k < env->instances.size(); k++) {
+		cbEnvInstance &inst = env->instances[k];
+		for (unsigned int r = 0; r < inst.robots.size(); r++)
+			if (inst.robots[r] != 0) inst.sim->deleteRobot(r+1);
+		delete inst.sim;
+	}
+	delete env;
+}
@@ -0,0 +1,125 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef CBENV_H
+#define CBENV_H
+
+/*! \file cbenv.h
+	\brief Batched simulation environment, for learning controllers.
+
+	A cbEnv owns K independent simulators, each with its own lab, grid
+	and parameters, no GUI and no sockets, and R robots in each of them.
+	cbenv_step_all runs one cycle of every simulator, spread over a pool
+	of threads, taking the actions of all robots from one flat array and
+	writing the observations, rewards and dones to flat arrays:
+
+	  actions  float[K][R][CBENV_ACT_SIZE]
+	  obs      float[K][R][CBENV_OBS_SIZE]
+	  rewards  float[K][R]
+	  dones    unsigned char[K][R]
+
+	The observation of a robot is what a networked robot would receive
+	in its <Measures>; sensors without a reading hold 0, the ground
+	sensor -1. The reward is the decrease of the robot score in the
+	cycle: the score counts penalties, lower is better.
+
+	A robot is done when it finished or was removed, or the time of its
+	simulator is over. A simulator whose robots are all done stays as
+	it is until cbenv_reset.
+
+	Each simulator has its own random generator, simulator k is seeded
+	with k+1: runs are reproducible whatever the number of threads.
+	cbenv_save and cbenv_restore copy the complete state of a simulator
+	(see cbsimstate.h), to branch a run from the middle.
+*/
+
+#define CBENV_MAX_BEACONS 4
+
+/* offsets in the observation of a robot */
+enum {
+	CBENV_OBS_COLLISION,
+	CBENV_OBS_COMPASS,            /* degrees */
+	CBENV_OBS_GROUND,
+	CBENV_OBS_IR0,                /* 4 obstacle sensors */
+	CBENV_OBS_X = CBENV_OBS_IR0 + 4,
+	CBENV_OBS_Y,
+	CBENV_OBS_DIR,                /* degrees */
+	CBENV_OBS_END_LED,
+	CBENV_OBS_RETURNING_LED,
+	CBENV_OBS_VISITING_LED,
+	CBENV_OBS_BEACON,             /* visible, direction of each beacon */
+	CBENV_OBS_SIZE = CBENV_OBS_BEACON + 2 * CBENV_MAX_BEACONS
+};
+
+/* offsets in the action of a robot; a led is switched on by a value
+   above 0.5, other values leave it as it is */
+enum {
+	CBENV_ACT_LEFT,
+	CBENV_ACT_RIGHT,
+	CBENV_ACT_END_LED,
+	CBENV_ACT_RETURNING_LED,
+	CBENV_ACT_VISITING_LED,
+	CBENV_ACT_SIZE
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct cbEnv cbEnv;
+
+/*! Creates nInstances simulators with nRobots robots each, and resets
+    them. Files not given (0) are the defaults of the simulator. Steps
+    run on nThreads threads, 0 for one per core.
+    Robots beyond the positions of the grid start at free positions
+    sampled in the lab. Returns 0 if the files can not be read or the
+    lab has no room for nRobots robots. */
+cbEnv *cbenv_create(int nInstances, int nRobots, const char *paramFile,
+                    const char *labFile, const char *gridFile, int nThreads);
+
+/*! Restarts one simulator, writes the first observations of its
+    robots to obs, float[R][CBENV_OBS_SIZE]. Returns -1 on failure. */
+int cbenv_reset(cbEnv *env, int instance, float *obs);
+
+/*! Restarts all simulators, obs is float[K][R][CBENV_OBS_SIZE]. */
+void cbenv_reset_all(cbEnv *env, float *obs);
+
+/*! Runs one cycle of all simulators. */
+void cbenv_step_all(cbEnv *env, const float *actions, float *obs,
+                    float *rewards, unsigned char *dones);
+
+/*! Writes the state of one simulator to buf and returns its size.
+    With buf 0 nothing is written, only the size is returned. Returns
+    -1 on failure, or if the len bytes of buf can not hold the state. */
+int cbenv_save(cbEnv *env, int instance, char *buf, int len);
+
+/*! Puts back a state written by cbenv_save for the same instance,
+    or another created with the same files, and writes the observations
+    of its robots to obs, float[R][CBENV_OBS_SIZE], if not 0.
+    Returns -1 on failure. */
+int cbenv_restore(cbEnv *env, int instance, const char *buf, int len, float *obs);
+
+void cbenv_destroy(cbEnv *env);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,55 @@
+TEMPLATE	= lib
+CONFIG		+= qt warn_on release thread
+
+win32 {
+    DEFINES     += MicWindows
+    LIBS        += -lws2_32
+}
+
+unix:!macx {
+    LIBS        += -lrt
+}
+
+# the simulation kernel is the one of the simulator, without simulator.cpp
+DEFINES		+= CB_NO_ALLOC_COUNT
+INCLUDEPATH	+= ../simulator
+DEPENDPATH	+= ../simulator
+
+KERNEL = \
+    cbactionhandler cbbeacon cbbutton cbclient\
+    cbgrid cbgridhandler cblab cblabhandler\
+    cbmotor cbpanel cbparameters cbparamhandler\
+    cbpoint cbposition cbreceptionhandler cbreceptionist\
+    cbrobot cbrobotaction cbsensor\
+    cbsimulator cbtarget cbview cbviewhandler\
+    cbwall cbgraph cbrobotbeacon\
+    cbutils cbparamdialog cbsimulatorGUI cbcontrolpanel\
+    cbmanagerobots cbrobotinfo cblabdialog cblogwriter\
+    cbscheduler cbprofiler cbprofilerpanel cbtracer\
+    cbrobotplugin cbrobotconfig cbbinlog cbxmlbuilder\
+    cbmessageboard cbchunk cbpool cbdiagnostics
+
+for(f, KERNEL) {
+    HEADERS += ../simulator/$${f}.h
+    SOURCES += ../simulator/$${f}.cpp
+}
+
+HEADERS		+= ../simulator/cbreceptionform.h ../simulator/cbviewcommand.h\
+		   ../simulator/cbsnapshot.h ../simulator/cbcontroller.h\
+		   ../simulator/cbsimstate.h ../simulator/cbrobotsize.h\
+		   cbenv.h
+SOURCES		+= cbenv.cpp
+
+TARGET		= cbenv
+
+QT              += network xml
+
+FORMS           += \
+    ../simulator/cbsimulatorGUI.ui \
+    ../simulator/cbcontrolpanel.ui \
+    ../simulator/cbmanagerobots.ui \
+    ../simulator/cbparamdialogbase.ui \
+    ../simulator/cbrobotinfo.ui \
+    ../simulator/cblabdialog.ui
+
+RESOURCES   += ../simulator/default.qrc
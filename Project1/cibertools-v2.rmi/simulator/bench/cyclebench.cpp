@@ -0,0 +1,491 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+	End to end cycle benchmark of the simulator with synthetic robots.
+
+	For each number of robots N of the sweep, starts a simulator without
+	GUI on the loopback, in a lab and grid made to fit N robots, and
+	drives N robots from a few threads, over UDP as libRobSock does:
+	each robot registers, then answers every sensor message with a
+	scripted action that turns it in place and requests two sensors.
+	After a warm up, during the given number of seconds, it counts:
+
+	    cycles/s        Time of the sensor messages over wall time
+	    action latency  from the arrival of a sensor message in the
+	                    socket (kernel time stamp) to the action sent,
+	                    p50 and p99, in us
+	    dropped actions sensor messages not answered because the next
+	                    one had already arrived
+	    missed frames   sensor messages that never arrived
+
+	and asks the simulator for its <Stats/>, the cost of each phase of
+	the cycle since the simulator started. Everything goes to stdout as a
+	<CycleBench> document, a summary per N to stderr.
+
+	    cyclebench [-sim path] [-n 1,2,5,...] [-threads t] [-seconds s]
+	               [-cycle ms] [-port p]
+	        (defaults ../simulator, 1,2,5,10,20,50,100,200,500, 4, 10,
+	         50 and 7100)
+
+	Linux only, it needs nothing but the simulator binary.
+*/
+
+#include <QAtomicInt>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+using std::vector;
+using std::string;
+
+enum Phase { REGISTER, WARMUP, MEASURE, STOP };
+static QAtomicInt phase(REGISTER);	// written by the main thread only
+
+static double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);	// same clock as the socket time stamps
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+struct Robot
+{
+	int fd;
+	int id;
+	struct sockaddr_in sim;		// the receptionist, then the robot socket
+	QAtomicInt registered;		// set by its worker, read by the main thread
+	unsigned int firstTime, lastTime;	// of the sensor messages in the window
+};
+
+struct Worker
+{
+	pthread_t thread;
+	vector<Robot> robots;
+	vector<float> latencies;	// us, in the window
+	unsigned long frames, actions, dropped, missed;
+	QAtomicInt failed;
+};
+
+static int udpSocket()
+{
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (fd < 0) return -1;
+	int on = 1;
+	setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on));
+	int size = 1 << 20;
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+		close(fd);
+		return -1;
+	}
+	fcntl(fd, F_SETFL, O_NONBLOCK);
+	return fd;
+}
+
+/* reads a datagram, its source and the time it arrived in the socket */
+static int receive(int fd, char *buff, int len, struct sockaddr_in *from, double *stamp)
+{
+	char control[256];
+	struct iovec iov = { buff, (size_t) len - 1 };
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_name = from;
+	msg.msg_namelen = sizeof(*from);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	int n = recvmsg(fd, &msg, 0);
+	if (n < 0) return -1;
+	buff[n] = '\0';
+
+	*stamp = now();
+	for (struct cmsghdr *c = CMSG_FIRSTHDR(&msg); c != 0; c = CMSG_NXTHDR(&msg, c))
+		if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+			struct timespec ts;
+			memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+			*stamp = ts.tv_sec + ts.tv_nsec * 1e-9;
+		}
+	return n;
+}
+
+static void registerRobot(Robot &r)
+{
+	char xml[256];
+	int n = sprintf(xml, "<Robot Name=\"bench%d\" Id=\"%d\"></Robot>", r.id, r.id);
+	sendto(r.fd, xml, n+1, 0, (struct sockaddr *) &r.sim, sizeof(r.sim));
+}
+
+static void *work(void *arg)
+{
+	Worker &w = *(Worker *) arg;
+	vector<struct pollfd> fds(w.robots.size());
+	for (unsigned int i = 0; i < w.robots.size(); i++) {
+		fds[i].fd = w.robots[i].fd;
+		fds[i].events = POLLIN;
+		// once, the robots queued in the receptionist are refused if sent again
+		registerRobot(w.robots[i]);
+	}
+
+	char buff[16384];
+	while (phase.fetchAndAddAcquire(0) != STOP) {
+		if (poll(&fds[0], fds.size(), 100) <= 0) continue;
+
+		for (unsigned int i = 0; i < fds.size(); i++) {
+			if ((fds[i].revents & POLLIN) == 0) continue;
+			Robot &r = w.robots[i];
+
+			// only the last sensor message pending is answered
+			struct sockaddr_in from;
+			double stamp = 0;
+			unsigned int time = 0, pending = 0;
+			bool measures = false;
+			int n;
+			while ((n = receive(r.fd, buff, sizeof(buff), &from, &stamp)) >= 0) {
+				if (strncmp(buff, "<Reply", 6) == 0) {
+					if (strstr(buff, "Status=\"Ok\"") == 0) {
+						fprintf(stderr, "Robot %d refused\n", r.id);
+						w.failed.fetchAndStoreRelease(1);
+						continue;
+					}
+					r.sim = from;	// actions go to the robot socket
+					r.registered.fetchAndStoreRelease(1);
+					continue;
+				}
+				unsigned int t;
+				if (sscanf(buff, "<Measures Time=\"%u\"", &t) != 1) continue;
+				if (phase.fetchAndAddAcquire(0) == MEASURE) {
+					if (r.firstTime == 0) r.firstTime = t;
+					else if (t > r.lastTime + 1) w.missed += t - r.lastTime - 1;
+					r.lastTime = t;
+					w.frames++;
+				}
+				time = t;
+				pending++;
+				measures = true;
+			}
+			if (!measures) continue;
+
+			double lpow = (time / 20) % 2 == 0 ? 0.05 : -0.05;
+			n = sprintf(buff, "<Actions LeftMotor=\"%g\" RightMotor=\"%g\">"
+			            "<SensorRequests IRSensor0=\"Yes\" Ground=\"Yes\"/></Actions>", lpow, -lpow);
+			sendto(r.fd, buff, n+1, 0, (struct sockaddr *) &r.sim, sizeof(r.sim));
+
+			if (phase.fetchAndAddAcquire(0) == MEASURE) {
+				w.latencies.push_back((float) ((now() - stamp) * 1e6));
+				w.actions++;
+				w.dropped += pending - 1;
+			}
+		}
+	}
+	return 0;
+}
+
+static bool writeFile(const string &name, const string &text)
+{
+	FILE *f = fopen(name.c_str(), "w");
+	if (f == 0) return false;
+	fputs(text.c_str(), f);
+	fclose(f);
+	return true;
+}
+
+/* lab, grid and parameters for n robots, in dir */
+static bool writeSetup(const string &dir, unsigned int n, unsigned int cycle)
+{
+	const double spacing = 1.5;
+	unsigned int cols = (unsigned int) ceil(sqrt(2.0 * n));
+	unsigned int rows = (n + cols - 1) / cols;
+	double width = cols * spacing + 6, height = rows * spacing + 2;
+	if (height < 6) height = 6;
+
+	char line[256];
+	sprintf(line, "<Lab Name=\"Cycle bench\" Width=\"%g\" Height=\"%g\">\n", width, height);
+	string lab = line;
+	sprintf(line, "\t<Beacon X=\"%g\" Y=\"%g\" Height=\"2.0\"/>\n\t<Target X=\"%g\" Y=\"%g\" Radius=\"1.0\"/>\n</Lab>\n",
+	        width - 2, height / 2, width - 2, height / 2);
+	lab += line;
+
+	string grid = "<Grid>\n";
+	for (unsigned int i = 0; i < n; i++) {
+		sprintf(line, "\t<Position X=\"%g\" Y=\"%g\" Dir=\"0\"/>\n",
+		        1.5 + spacing * (i % cols), 1.5 + spacing * (i / cols));
+		grid += line;
+	}
+	grid += "</Grid>\n";
+
+	// long enough never to finish during the run
+	sprintf(line, "<Parameters SimTime=\"1000000\" CycleTime=\"%u\" NRequestsPerCycle=\"4\"/>\n", cycle);
+
+	return writeFile(dir + "/lab.xml", lab) && writeFile(dir + "/grid.xml", grid)
+	    && writeFile(dir + "/param.xml", line);
+}
+
+static pid_t startSimulator(const string &sim, const string &dir, unsigned int n, int port)
+{
+	char sport[16], sn[16];
+	sprintf(sport, "%d", port);
+	sprintf(sn, "%u", n);
+	string lab = dir + "/lab.xml", grid = dir + "/grid.xml", param = dir + "/param.xml";
+
+	pid_t pid = fork();
+	if (pid == 0) {
+		int null = open("/dev/null", O_WRONLY);
+		dup2(null, 1);
+		dup2(null, 2);
+		execl(sim.c_str(), sim.c_str(), "-nogui", "-lab", lab.c_str(), "-grid", grid.c_str(),
+		      "-param", param.c_str(), "-port", sport, "-autostart", sn, (char *) 0);
+		_exit(127);
+	}
+	return pid;
+}
+
+/* the <Stats> dump of the simulator, empty if it does not answer */
+static string simulatorStats(int port)
+{
+	int fd = udpSocket();
+	if (fd < 0) return "";
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(port);
+
+	string stats;
+	char buff[16384];
+	for (int attempt = 0; attempt < 3 && stats.empty(); attempt++) {
+		sendto(fd, "<Stats/>", 9, 0, (struct sockaddr *) &addr, sizeof(addr));
+		struct pollfd p = { fd, POLLIN, 0 };
+		if (poll(&p, 1, 1000) <= 0) continue;
+		struct sockaddr_in from;
+		double stamp;
+		if (receive(fd, buff, sizeof(buff), &from, &stamp) > 0 && strncmp(buff, "<Stats", 6) == 0)
+			stats = buff;
+	}
+	close(fd);
+	return stats;
+}
+
+static float percentile(vector<float> &v, double p)
+{
+	if (v.empty()) return 0;
+	unsigned int k = (unsigned int) (p / 100.0 * (v.size() - 1));
+	std::nth_element(v.begin(), v.begin() + k, v.end());
+	return v[k];
+}
+
+static bool run(const string &sim, const string &dir, unsigned int n, unsigned int nThreads,
+                unsigned int seconds, unsigned int cycle, int port)
+{
+	if (!writeSetup(dir, n, cycle)) {
+		fprintf(stderr, "Can not write the lab in %s\n", dir.c_str());
+		return false;
+	}
+
+	pid_t pid = startSimulator(sim, dir, n, port);
+	if (pid < 0) {
+		perror("fork");
+		return false;
+	}
+
+	// the simulator answers once its kernel runs
+	bool ready = false;
+	for (double start = now(); !ready && now() - start < 30; ) {
+		ready = !simulatorStats(port).empty();
+		if (waitpid(pid, 0, WNOHANG) == pid) break;
+	}
+	if (!ready) {
+		fprintf(stderr, "The simulator %s did not start\n", sim.c_str());
+		kill(pid, SIGTERM);
+		waitpid(pid, 0, 0);
+		return false;
+	}
+
+	if (nThreads > n) nThreads = n;
+	vector<Worker> workers(nThreads);
+	for (unsigned int t = 0; t < nThreads; t++) {
+		workers[t].frames = workers[t].actions = workers[t].dropped = workers[t].missed = 0;
+		workers[t].failed = 0;
+		workers[t].latencies.reserve((size_t) n / nThreads * seconds * 1000 / cycle + 1024);
+	}
+	for (unsigned int i = 0; i < n; i++) {
+		Robot r;
+		memset(&r.sim, 0, sizeof(r.sim));
+		r.registered = 0;
+		r.firstTime = r.lastTime = 0;
+		r.fd = udpSocket();
+		if (r.fd < 0) {
+			perror("socket");
+			kill(pid, SIGTERM);
+			waitpid(pid, 0, 0);
+			return false;
+		}
+		r.id = i + 1;
+		r.sim.sin_family = AF_INET;
+		r.sim.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		r.sim.sin_port = htons(port);
+		workers[i % nThreads].robots.push_back(r);
+	}
+
+	phase.fetchAndStoreRelease(REGISTER);
+	for (unsigned int t = 0; t < nThreads; t++)
+		pthread_create(&workers[t].thread, 0, work, &workers[t]);
+
+	// all registered, or give up after 30 s
+	bool registered = false;
+	bool failed = false;
+	for (double start = now(); !registered && !failed && now() - start < 30; ) {
+		usleep(100000);
+		registered = true;
+		for (unsigned int t = 0; t < nThreads; t++) {
+			failed = failed || workers[t].failed.fetchAndAddAcquire(0);
+			for (unsigned int i = 0; i < workers[t].robots.size(); i++)
+				registered = registered && workers[t].robots[i].registered.fetchAndAddAcquire(0);
+		}
+		if (waitpid(pid, 0, WNOHANG) == pid) {
+			fprintf(stderr, "The simulator %s exited\n", sim.c_str());
+			pid = -1;
+			failed = true;
+		}
+	}
+
+	string stats;
+	double elapsed = 0;
+	if (registered && !failed) {
+		phase.fetchAndStoreRelease(WARMUP);
+		sleep(1);
+		phase.fetchAndStoreRelease(MEASURE);
+		double start = now();
+		sleep(seconds);
+		elapsed = now() - start;
+		stats = simulatorStats(port);
+	}
+	else if (!failed)
+		fprintf(stderr, "%u robots: registration timed out\n", n);
+
+	phase.fetchAndStoreRelease(STOP);
+	for (unsigned int t = 0; t < nThreads; t++)
+		pthread_join(workers[t].thread, 0);
+	if (pid > 0) {
+		kill(pid, SIGTERM);
+		waitpid(pid, 0, 0);
+	}
+
+	unsigned long frames = 0, actions = 0, dropped = 0, missed = 0;
+	vector<float> latencies;
+	for (unsigned int t = 0; t < nThreads; t++) {
+		frames += workers[t].frames;
+		actions += workers[t].actions;
+		dropped += workers[t].dropped;
+		missed += workers[t].missed;
+		latencies.insert(latencies.end(), workers[t].latencies.begin(), workers[t].latencies.end());
+		for (unsigned int i = 0; i < workers[t].robots.size(); i++)
+			close(workers[t].robots[i].fd);
+	}
+	if (!registered || failed) return false;
+
+	const Robot &first = workers[0].robots[0];
+	unsigned int cycles = first.firstTime > 0 ? first.lastTime - first.firstTime + 1 : 0;
+	double rate = elapsed > 0 ? cycles / elapsed : 0;
+	float p50 = percentile(latencies, 50), p99 = percentile(latencies, 99);
+
+	printf("<Run Robots=\"%u\" Threads=\"%u\" Seconds=\"%.2f\" Cycles=\"%u\" CyclesPerSec=\"%.2f\""
+	       " Frames=\"%lu\" Actions=\"%lu\" ActionP50=\"%.1f\" ActionP99=\"%.1f\""
+	       " DroppedActions=\"%lu\" MissedFrames=\"%lu\">\n",
+	       n, nThreads, elapsed, cycles, rate, frames, actions, p50, p99, dropped, missed);
+	fputs(stats.c_str(), stdout);
+	printf("</Run>\n");
+	fflush(stdout);
+
+	fprintf(stderr, "%4u robots: %7.2f cycles/s (%.2f nominal), action p50 %8.1f us p99 %8.1f us, %lu dropped, %lu missed%s\n",
+	        n, rate, 1000.0 / cycle, p50, p99, dropped, missed, stats.empty() ? ", no stats" : "");
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	string sim = "../simulator";
+	string sweep = "1,2,5,10,20,50,100,200,500";
+	unsigned int nThreads = 4, seconds = 10, cycle = 50;
+	int port = 7100;
+
+	for (int a = 1; a < argc; a++) {
+		if (strcmp(argv[a], "-sim") == 0 && a+1 < argc) sim = argv[++a];
+		else if (strcmp(argv[a], "-n") == 0 && a+1 < argc) sweep = argv[++a];
+		else if (strcmp(argv[a], "-threads") == 0 && a+1 < argc) nThreads = atoi(argv[++a]);
+		else if (strcmp(argv[a], "-seconds") == 0 && a+1 < argc) seconds = atoi(argv[++a]);
+		else if (strcmp(argv[a], "-cycle") == 0 && a+1 < argc) cycle = atoi(argv[++a]);
+		else if (strcmp(argv[a], "-port") == 0 && a+1 < argc) port = atoi(argv[++a]);
+		else nThreads = 0;
+	}
+	if (nThreads == 0 || seconds == 0 || cycle == 0 || port <= 0) {
+		fprintf(stderr, "usage: cyclebench [-sim path] [-n 1,2,5,...] [-threads t] [-seconds s] [-cycle ms] [-port p]\n");
+		return 1;
+	}
+	if (access(sim.c_str(), X_OK) != 0) {
+		fprintf(stderr, "Build simulator/simulator.pro first, or give its path with -sim\n");
+		return 1;
+	}
+
+	char dir[] = "/tmp/cyclebenchXXXXXX";
+	if (mkdtemp(dir) == 0) {
+		perror("mkdtemp");
+		return 1;
+	}
+	signal(SIGPIPE, SIG_IGN);
+
+	printf("<CycleBench CycleTime=\"%u\" Unit=\"us\">\n", cycle);
+	bool ok = true;
+	const char *p = sweep.c_str();
+	while (*p != '\0') {
+		unsigned int n = strtoul(p, (char **) &p, 10);
+		if (*p == ',') p++;
+		if (n == 0) break;
+		// a port per run, the previous simulator may still hold its own
+		ok = run(sim, dir, n, nThreads, seconds, cycle, port++) && ok;
+	}
+	printf("</CycleBench>\n");
+
+	string rm = string("rm -rf ") + dir;
+	if (system(rm.c_str()) != 0) fprintf(stderr, "Could not remove %s\n", dir);
+	return ok ? 0 : 1;
+}
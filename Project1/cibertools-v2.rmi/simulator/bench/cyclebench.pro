@@ -0,0 +1,10 @@
+TEMPLATE	= app
+CONFIG		+= warn_on release console thread
+QT		-= gui
+
+# end to end cycle benchmark with synthetic robots, see cyclebench.cpp
+SOURCES		= cyclebench.cpp
+
+TARGET		= cyclebench
+
+LIBS		+= -lpthread -lrt
@@ -0,0 +1,337 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+	Geometry microbenchmark over the labs of the Labs directory.
+
+	Loads every lab file found under the directory and, in each one,
+	times the geometry used by the sensors and the scores on queries at
+	points and rays sampled in the free space of the lab:
+
+	    wallDistance            distance from a point to the walls
+	    wallDistanceRay         distance to the walls along a ray
+	    wallDistanceAboveHeight the same, walls above the beacon only
+	    cornerDistance          distance to the corners in a cone, IR
+	    reachableRobot          segment between two free points
+	    buildCornerGraph        visibility graph of the lab
+	    graphDist               final point added to a copy of the graph
+	                            of 8 start points, and path length
+
+	The queries come from a generator seeded with the given seed, the
+	same for every run. The results go to stdout as a <GeometryBench>
+	document, times in ns, one <Kernel> per lab and kernel; Check is the
+	sum of the results, it changes if the geometry does. Cache misses
+	are counted with perf events on Linux, -1 where they are not
+	available.
+
+	    geometry [-labs dir] [-queries n] [-seed s]
+	        (defaults ../../Labs, 1000000 and 1)
+*/
+
+#include "cblab.h"
+#include "cblabhandler.h"
+#include "cbgraph.h"
+#include "cbpoint.h"
+#include "cbbeacon.h"
+#include "cbrobot.h"
+#include "cbutils.h"
+
+#include <QFile>
+#include <QDir>
+#include <QDirIterator>
+#include <QStringList>
+#include <QXmlSimpleReader>
+#include <QXmlInputSource>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using std::vector;
+
+static double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* hardware cache misses of the calling thread, -1 if not counted */
+class MissCounter
+{
+public:
+	MissCounter() : fd(-1)
+	{
+#if defined(__linux__)
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = PERF_COUNT_HW_CACHE_MISSES;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+	}
+	~MissCounter()
+	{
+#if defined(__linux__)
+		if (fd >= 0) close(fd);
+#endif
+	}
+
+	void start()
+	{
+#if defined(__linux__)
+		if (fd < 0) return;
+		ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+	}
+
+	long long stop()
+	{
+#if defined(__linux__)
+		if (fd < 0) return -1;
+		ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+		long long count;
+		if (read(fd, &count, sizeof(count)) != sizeof(count)) return -1;
+		return count;
+#else
+		return -1;
+#endif
+	}
+
+private:
+	int fd;
+};
+
+/* times one kernel and prints its <Kernel> element */
+class Timing
+{
+public:
+	Timing(const char *kernelName, unsigned int queries) : name(kernelName), n(queries)
+	{
+		misses.start();
+		t0 = now();
+	}
+
+	void stop(double check)
+	{
+		double secs = now() - t0;
+		long long m = misses.stop();
+		double ns = n > 0 ? secs * 1e9 / n : 0.0;
+		printf("\t\t<Kernel Name=\"%s\" Queries=\"%u\" Ns=\"%.1f\" QueriesPerSec=\"%.0f\" CacheMisses=\"%.3f\" Check=\"%.6g\"/>\n",
+		       name, n, ns, secs > 0 ? n / secs : 0.0, m >= 0 && n > 0 ? (double) m / n : -1.0, check);
+		fprintf(stderr, "  %-24s %10.1f ns %14.0f q/s\n", name, ns, secs > 0 ? n / secs : 0.0);
+	}
+
+private:
+	const char *name;
+	unsigned int n;
+	double t0;
+	MissCounter misses;
+};
+
+static cbLab *loadLab(const QString &file)
+{
+	QFile srcFile(file);
+	if (!srcFile.open(QIODevice::ReadOnly)) return 0;
+	// grids and parameters are in the same directories
+	if (!srcFile.peek(1024).contains("<Lab")) return 0;
+
+	QXmlInputSource source(&srcFile);
+	QXmlSimpleReader xmlParser;
+	cbLabHandler labHandler;
+	xmlParser.setContentHandler(&labHandler);
+	if (!xmlParser.parse(source)) {
+		fprintf(stderr, "Error parsing %s\n", file.toLatin1().constData());
+		return 0;
+	}
+	return labHandler.parsedLab();
+}
+
+/* point at least a robot radius away from the walls, false if none found */
+static bool freePoint(cbLab *lab, cbRandom &rng, cbPoint &p)
+{
+	for (int attempt = 0; attempt < 10000; attempt++) {
+		p.set(rng.uniform() * lab->Width(), rng.uniform() * lab->Height());
+		if (lab->freeSpace(p, ROBOT_RADIUS)) return true;
+	}
+	return false;
+}
+
+static void benchLab(const QString &file, cbLab *lab, unsigned int n, unsigned long long seed)
+{
+	cbRandom rng;
+	rng.seed(seed);
+
+	unsigned int nPoints = n < 65536 ? n : 65536;	// reused, as the robots revisit places
+	vector<cbPoint> points(nPoints), others(nPoints);
+	vector<double> dirs(nPoints);
+	for (unsigned int i = 0; i < nPoints; i++) {
+		if (!freePoint(lab, rng, points[i]) || !freePoint(lab, rng, others[i])) {
+			fprintf(stderr, "%s: no free space\n", file.toLatin1().constData());
+			return;
+		}
+		dirs[i] = (rng.uniform() * 2 - 1) * M_PI;
+	}
+	double height = lab->nBeacons() > 0 ? lab->Beacon(0)->Height() : 1.0;
+
+	unsigned int corners = 0;
+	for (unsigned int w = 0; w < lab->nWalls(); w++)
+		corners += lab->Wall(w)->Corners().size();
+
+	printf("\t<Lab File=\"%s\" Name=\"%s\" Walls=\"%u\" Corners=\"%u\" Width=\"%g\" Height=\"%g\">\n",
+	       file.toLatin1().constData(), lab->Name(), lab->nWalls(), corners, lab->Width(), lab->Height());
+	fprintf(stderr, "%s (%u walls)\n", file.toLatin1().constData(), lab->nWalls());
+
+	unsigned int i;
+	double check;
+	{
+		check = 0;
+		Timing t("wallDistance", n);
+		for (i = 0; i < n; i++)
+			check += lab->wallDistance(points[i % nPoints]);
+		t.stop(check);
+	}
+	{
+		check = 0;
+		Timing t("wallDistanceRay", n);
+		for (i = 0; i < n; i++)
+			check += lab->wallDistance(points[i % nPoints], dirs[i % nPoints]);
+		t.stop(check);
+	}
+	{
+		check = 0;
+		Timing t("wallDistanceAboveHeight", n);
+		for (i = 0; i < n; i++)
+			check += lab->wallDistanceAboveHeight(points[i % nPoints], dirs[i % nPoints], height);
+		t.stop(check);
+	}
+	{
+		check = 0;
+		Timing t("cornerDistance", n);
+		for (i = 0; i < n; i++)
+			check += lab->cornerDistance(points[i % nPoints], dirs[i % nPoints], M_PI/6);
+		t.stop(check);
+	}
+	{
+		unsigned int m = n / 10 > 0 ? n / 10 : 1;
+		check = 0;
+		Timing t("reachableRobot", m);
+		for (i = 0; i < m; i++)
+			check += lab->reachableRobot(points[i % nPoints], others[i % nPoints]);
+		t.stop(check);
+	}
+
+	{
+		unsigned int m = n / 200000 > 0 ? n / 200000 : 1;
+		check = 0;
+		Timing t("buildCornerGraph", m);
+		for (i = 0; i < m; i++) {
+			cbGraph graph;
+			graph.setLab(lab);
+			graph.buildCornerGraph();
+			check += i;
+		}
+		t.stop(check);
+	}
+
+	{
+		// like cbSimulator::calcDistMaxFromGridTo, for one start point
+		const unsigned int starts = 8;
+		cbGraph base;
+		base.setLab(lab);
+		base.buildCornerGraph();
+		for (i = 0; i < starts; i++)
+			base.addInitPoint(points[i % nPoints]);
+
+		unsigned int m = n / 20000 > 0 ? n / 20000 : 1;
+		check = 0;
+		Timing t("graphDist", m);
+		for (i = 0; i < m; i++) {
+			cbGraph graph = base;
+			unsigned int id = 1 + i % starts;
+			graph.addFinalPoint(id, others[i % nPoints]);
+			check += graph.dist(id);
+		}
+		t.stop(check);
+	}
+
+	printf("\t</Lab>\n");
+}
+
+int main(int argc, char *argv[])
+{
+	QString labsDir("../../Labs");
+	unsigned int queries = 1000000;
+	unsigned long long seed = 1;
+
+	for (int a = 1; a < argc; a++) {
+		if (strcmp(argv[a], "-labs") == 0 && a+1 < argc)
+			labsDir = argv[++a];
+		else if (strcmp(argv[a], "-queries") == 0 && a+1 < argc)
+			queries = atoi(argv[++a]);
+		else if (strcmp(argv[a], "-seed") == 0 && a+1 < argc)
+			seed = strtoull(argv[++a], 0, 10);
+		else
+			queries = 0;
+	}
+	if (queries == 0) {
+		fprintf(stderr, "usage: geometry [-labs dir] [-queries n] [-seed s]\n");
+		return 1;
+	}
+
+	QStringList files;
+	QDirIterator it(labsDir, QStringList("*.xml"), QDir::Files, QDirIterator::Subdirectories);
+	while (it.hasNext())
+		files << it.next();
+	files.sort();
+	if (files.isEmpty()) {
+		fprintf(stderr, "No lab files under %s\n", labsDir.toLatin1().constData());
+		return 1;
+	}
+
+	printf("<GeometryBench Seed=\"%llu\" Queries=\"%u\">\n", seed, queries);
+	unsigned int labs = 0;
+	for (int f = 0; f < files.size(); f++) {
+		cbLab *lab = loadLab(files[f]);
+		if (lab == 0) continue;
+		benchLab(QDir(labsDir).relativeFilePath(files[f]), lab, queries, seed);
+		delete lab;
+		labs++;
+	}
+	printf("</GeometryBench>\n");
+
+	fprintf(stderr, "%u labs\n", labs);
+	return labs > 0 ? 0 : 1;
+}
@@ -0,0 +1,21 @@
+TEMPLATE	= app
+CONFIG		+= qt warn_on release console
+
+# geometry microbenchmark over the Labs directory, see geometry.cpp
+INCLUDEPATH	+= ..
+DEPENDPATH	+= ..
+
+HEADERS		= ../cblab.h ../cblabhandler.h ../cbgraph.h ../cbwall.h\
+		  ../cbtarget.h ../cbbeacon.h ../cbpoint.h ../cbutils.h\
+		  ../cbxmlbuilder.h
+SOURCES		= geometry.cpp ../cblab.cpp ../cblabhandler.cpp ../cbgraph.cpp\
+		  ../cbwall.cpp ../cbtarget.cpp ../cbbeacon.cpp ../cbpoint.cpp\
+		  ../cbutils.cpp ../cbxmlbuilder.cpp
+
+TARGET		= geometry
+
+QT		+= network xml
+
+unix:!macx {
+    LIBS	+= -lrt
+}
@@ -0,0 +1,40 @@
+#!/bin/bash
+#
+# Cycle rate of the simulator with 1 to 100 in-process robots.
+#
+# Every run registers N robsample controllers (robsample/plugin) in an
+# open lab and runs the cycles back to back with -bench, without GUI.
+#
+#   pluginbench.sh [cycles]      (default 2000)
+
+CYCLES=${1:-2000}
+HERE=$(cd "$(dirname "$0")" && pwd)
+SIM=$HERE/../simulator
+PLUGIN=$HERE/../../robsample/plugin/librobsampleplugin.so
+TMP=$(mktemp -d)
+trap "rm -rf $TMP" EXIT
+
+if [ ! -x $SIM ] || [ ! -f $PLUGIN ]; then
+    echo "Build simulator/simulator.pro and robsample/plugin/robsampleplugin.pro first"
+    exit 1
+fi
+
+cat > $TMP/lab.xml <<LAB
+<Lab Name="Plugin bench" Width="28" Height="14">
+	<Beacon X="3" Y="7" Height="2.0"/>
+	<Target X="3" Y="7" Radius="1.0"/>
+</Lab>
+LAB
+
+# 10x10 positions, 1.2 apart, in the right half of the lab
+awk 'BEGIN {
+    print "<Grid>"
+    for (i = 0; i < 100; i++)
+        printf "\t<Position X=\"%g\" Y=\"%g\" Dir=\"180\"/>\n", 14.5 + 1.2 * (i % 10), 1.5 + 1.2 * int(i / 10)
+    print "</Grid>"
+}' > $TMP/grid.xml
+
+for N in 1 2 5 10 20 50 100; do
+    $SIM -lab $TMP/lab.xml -grid $TMP/grid.xml -port $((7000 + N)) \
+         -nogui -plugin $PLUGIN@$N -bench $CYCLES 2>/dev/null | grep "^Bench:"
+done
@@ -0,0 +1,168 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+	Formatting microbenchmark of cbXmlBuilder.
+
+	Writes the numbers of the simulator messages, and a whole sensor
+	message, with sprintf and with cbXmlBuilder, checks that both give
+	the same bytes and prints the time per call of each.
+
+	    xmlbench [iterations]      (default 1000000)
+*/
+
+#include "cbxmlbuilder.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <vector>
+
+using std::vector;
+
+static double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* values like the ones of the simulator: positions, angles, sensor
+   readings with noise, and some of any magnitude */
+static double value(unsigned int i)
+{
+	double u = rand() / (RAND_MAX + 1.0);
+	switch (i % 4) {
+	case 0: return u * 28.0;
+	case 1: return u * 360.0 - 180.0;
+	case 2: return floor(u * 100.0) / 10.0;
+	default: return (u - 0.5) * pow(10.0, (int) (rand() % 40) - 20);
+	}
+}
+
+static int sprintfMeasures(char *xml, const double *v, unsigned int t)
+{
+	int n = sprintf(xml, "<Measures Time=\"%u\">\n", t);
+	n += sprintf(xml+n, "\t<Sensors Collision=\"%s\" Compass=\"%g\" Ground=\"%d\">\n", "No", v[0], -1);
+	for (int i = 0; i < 4; i++)
+		n += sprintf(xml+n, "\t\t<IRSensor Id=\"%d\" Value=\"%g\"/>\n", i, v[1+i]);
+	n += sprintf(xml+n, "\t\t<BeaconSensor Id=\"%d\" Value=\"%g\"/>\n", 0, v[5]);
+	n += sprintf(xml+n, "\t\t<GPS X=\"%g\" Y=\"%g\"  Dir=\"%g\" />\n", v[6], v[7], v[8]);
+	n += sprintf(xml+n, "\t</Sensors>\n");
+	n += sprintf(xml+n, "\t<Leds EndLed=\"%s\" ReturningLed=\"%s\" VisitingLed=\"%s\"/>\n", "Off", "Off", "Off");
+	n += sprintf(xml+n, "\t<Buttons Start=\"%s\" Stop=\"%s\"/>\n", "On", "Off");
+	n += sprintf(xml+n, "</Measures>\n");
+	return n;
+}
+
+static int builderMeasures(char *xml, unsigned int len, const double *v, unsigned int t)
+{
+	cbXmlBuilder x(xml, len);
+	x << "<Measures Time=\"" << t << "\">\n";
+	x << "\t<Sensors Collision=\"" << "No" << "\" Compass=\"" << v[0] << "\" Ground=\"" << -1 << "\">\n";
+	for (int i = 0; i < 4; i++)
+		x << "\t\t<IRSensor Id=\"" << i << "\" Value=\"" << v[1+i] << "\"/>\n";
+	x << "\t\t<BeaconSensor Id=\"" << 0 << "\" Value=\"" << v[5] << "\"/>\n";
+	x << "\t\t<GPS X=\"" << v[6] << "\" Y=\"" << v[7] << "\"  Dir=\"" << v[8] << "\" />\n";
+	x << "\t</Sensors>\n";
+	x << "\t<Leds EndLed=\"" << "Off" << "\" ReturningLed=\"" << "Off" << "\" VisitingLed=\"" << "Off" << "\"/>\n";
+	x << "\t<Buttons Start=\"" << "On" << "\" Stop=\"" << "Off" << "\"/>\n";
+	x << "</Measures>\n";
+	return x.length();
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int iterations = argc > 1 ? atoi(argv[1]) : 1000000;
+	if (iterations == 0) {
+		fprintf(stderr, "usage: xmlbench [iterations]\n");
+		return 1;
+	}
+
+	srand(1);
+	vector<double> values(iterations);
+	for (unsigned int i = 0; i < iterations; i++)
+		values[i] = value(i);
+
+	/* same bytes as %g, %d and %u */
+	char a[64], b[64];
+	unsigned int mismatches = 0;
+	for (unsigned int i = 0; i < iterations; i++) {
+		sprintf(a, "%g", values[i]);
+		cbFormatDouble(b, values[i]);
+		if (strcmp(a, b) != 0 && mismatches++ < 10)
+			fprintf(stderr, "%.17g: sprintf \"%s\", builder \"%s\"\n", values[i], a, b);
+		int k = rand() - RAND_MAX / 2;
+		sprintf(a, "%d", k);
+		b[cbFormatInt(b, k)] = '\0';
+		if (strcmp(a, b) != 0 && mismatches++ < 10)
+			fprintf(stderr, "%d: sprintf \"%s\", builder \"%s\"\n", k, a, b);
+	}
+
+	/* numbers */
+	volatile int sink = 0;
+	double t0 = now();
+	for (unsigned int i = 0; i < iterations; i++)
+		sink += sprintf(a, "%g", values[i]);
+	double t1 = now();
+	for (unsigned int i = 0; i < iterations; i++)
+		sink += cbFormatDouble(b, values[i]);
+	double t2 = now();
+	for (unsigned int i = 0; i < iterations; i++)
+		sink += sprintf(a, "%u", i * 2654435761u);
+	double t3 = now();
+	for (unsigned int i = 0; i < iterations; i++)
+		sink += cbFormatUInt(b, i * 2654435761u);
+	double t4 = now();
+
+	printf("%%g      sprintf %7.1f ns  builder %7.1f ns  x%.1f\n",
+	       (t1 - t0) * 1e9 / iterations, (t2 - t1) * 1e9 / iterations, (t1 - t0) / (t2 - t1));
+	printf("%%u      sprintf %7.1f ns  builder %7.1f ns  x%.1f\n",
+	       (t3 - t2) * 1e9 / iterations, (t4 - t3) * 1e9 / iterations, (t3 - t2) / (t4 - t3));
+
+	/* whole sensor messages, 9 values each */
+	unsigned int messages = iterations / 9;
+	char xa[2048], xb[2048];
+	for (unsigned int m = 0; m < messages; m++) {
+		int na = sprintfMeasures(xa, &values[m*9], m);
+		int nb = builderMeasures(xb, sizeof(xb), &values[m*9], m);
+		if ((na != nb || memcmp(xa, xb, na) != 0) && mismatches++ < 10)
+			fprintf(stderr, "message %u differs:\n%s\n%s\n", m, xa, xb);
+	}
+	t0 = now();
+	for (unsigned int m = 0; m < messages; m++)
+		sink += sprintfMeasures(xa, &values[m*9], m);
+	t1 = now();
+	for (unsigned int m = 0; m < messages; m++)
+		sink += builderMeasures(xb, sizeof(xb), &values[m*9], m);
+	t2 = now();
+	if (messages > 0)
+		printf("Measures sprintf %7.1f ns  builder %7.1f ns  x%.1f\n",
+		       (t1 - t0) * 1e9 / messages, (t2 - t1) * 1e9 / messages, (t1 - t0) / (t2 - t1));
+
+	if (mismatches > 0) {
+		printf("%u mismatches\n", mismatches);
+		return 1;
+	}
+	printf("Output identical to sprintf\n");
+	return 0;
+}
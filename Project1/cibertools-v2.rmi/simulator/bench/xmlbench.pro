@@ -0,0 +1,16 @@
+TEMPLATE	= app
+CONFIG		+= warn_on release console
+CONFIG		-= qt
+
+# microbenchmark of the message formatting, see xmlbench.cpp
+INCLUDEPATH	+= ..
+DEPENDPATH	+= ..
+
+HEADERS		= ../cbxmlbuilder.h
+SOURCES		= xmlbench.cpp ../cbxmlbuilder.cpp
+
+TARGET		= xmlbench
+
+unix:!macx {
+    LIBS	+= -lrt
+}
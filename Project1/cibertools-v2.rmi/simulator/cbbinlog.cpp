@@ -0,0 +1,789 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "cbbinlog.h"
+
+#include <iostream>
+#include <fstream>
+#include <string.h>
+#include <stdio.h>
+
+using std::cerr;
+using std::ifstream;
+using std::ios;
+
+#define BINLOG_MAGIC    "CBBINLOG"
+#define BINLOG_ENDMAGIC "CBLOGEND"
+#define BINLOG_VERSION  2
+
+#define FRAME_KEY   'K'
+#define FRAME_DELTA 'D'
+
+#define FRAME_HEADER_SIZE 7       // type, time, number of robots
+#define HEADER_SIZE       25      // up to the length of the date
+#define RECORD_FIXED_SIZE 82      // record without targets and beacons
+#define INDEX_ENTRY_SIZE  16
+#define TRAILER_SIZE      20
+
+#define FLUSH_SIZE (256*1024)
+
+// must be compatible with StrState in the simulator cbrobot.cpp
+static const char *StrState[] =
+{
+    "Stopped", "Running", "Waiting", "Returning", "Finished", "Removed"
+};
+
+const char *cbBinLogStateName(unsigned int state)
+{
+	if(state >= sizeof(StrState)/sizeof(StrState[0])) return "Unknown";
+	return StrState[state];
+}
+
+int cbBinLogState(const char *name)
+{
+	return cbBinLogState(name, strlen(name));
+}
+
+int cbBinLogState(const char *name, unsigned int len)
+{
+	for(unsigned int s=0; s < sizeof(StrState)/sizeof(StrState[0]); s++)
+		if(strlen(StrState[s]) == len && memcmp(name, StrState[s], len) == 0) return s;
+	return -1;
+}
+
+/* little endian encoding */
+
+static inline void put16(unsigned char *p, unsigned int v)
+{
+	p[0] = v; p[1] = v >> 8;
+}
+
+static inline void put32(unsigned char *p, unsigned int v)
+{
+	p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static inline void put64(unsigned char *p, unsigned long long v)
+{
+	put32(p, (unsigned int) v);
+	put32(p+4, (unsigned int) (v >> 32));
+}
+
+static inline void putFloat(unsigned char *p, float f)
+{
+	unsigned int v;
+	memcpy(&v, &f, 4);
+	put32(p, v);
+}
+
+static inline unsigned int get16(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static inline unsigned int get32(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int) p[3] << 24);
+}
+
+static inline unsigned long long get64(const unsigned char *p)
+{
+	return get32(p) | ((unsigned long long) get32(p+4) << 32);
+}
+
+static inline float getFloat(const unsigned char *p)
+{
+	unsigned int v = get32(p);
+	float f;
+	memcpy(&f, &v, 4);
+	return f;
+}
+
+/*!
+	Size of the records of a log with the given number of beacons and
+	targets: the fixed part, one bit per target, one ready and one visible
+	bit and a float per beacon.
+*/
+static unsigned int recordSizeFor(unsigned int nBeacons, unsigned int nTargets)
+{
+	return RECORD_FIXED_SIZE + (nTargets + 7) / 8 + 2 * ((nBeacons + 7) / 8) + 4 * nBeacons;
+}
+
+void cbBinLogRobot::clear(void)
+{
+	name.clear();
+	id = 0;
+	state = flags = buttons = actions = 0;
+	ground = 0;
+	x = y = dir = 0;
+	score = arrivalTime = returningTime = collisions = 0;
+	visitedMask.clear();
+	leftMotor = rightMotor = 0;
+	time = 0;
+	compass = 0;
+	nIRSensors = 0;
+	for(int i=0; i < CB_BINLOG_IR_SENSORS; i++)
+		irSensors[i] = 0;
+	gpsX = gpsY = gpsDir = 0;
+	beacons.clear();
+}
+
+/*!
+	Encodes r in recordSize bytes at p. Returns false, with an error,
+	if r has more targets or beacons than the log.
+*/
+bool cbBinLogWriter::encodeRecord(const cbBinLogRobot &r, unsigned char *p)
+{
+	if(r.visitedMask.size() > nTargets) {
+		cerr << "ERROR: Robot " << r.name << " has " << r.visitedMask.size()
+		     << " targets, the binary log was opened for " << nTargets << "\n";
+		return false;
+	}
+	if(r.nIRSensors > CB_BINLOG_IR_SENSORS) {
+		cerr << "ERROR: Robot " << r.name << " has " << (int) r.nIRSensors
+		     << " IR sensors, the binary log has room for " << CB_BINLOG_IR_SENSORS << "\n";
+		return false;
+	}
+	for(unsigned int b=0; b < r.beacons.size(); b++)
+		if(r.beacons[b].id >= nBeacons) {
+			cerr << "ERROR: Robot " << r.name << " has beacon sensor " << r.beacons[b].id
+			     << ", the binary log was opened for " << nBeacons << " beacons\n";
+			return false;
+		}
+
+	memset(p, 0, recordSize);
+	put16(p, r.id);
+	p[2] = r.state;
+	p[3] = r.flags;
+	p[4] = r.buttons;
+	p[5] = r.actions;
+	p[6] = (unsigned char) r.ground;
+	p[7] = r.nIRSensors;
+	put16(p+8, r.visitedMask.size());
+	p += 10;
+
+	putFloat(p, r.x); putFloat(p+4, r.y); putFloat(p+8, r.dir);
+	p += 12;
+	put32(p, r.score); put32(p+4, r.arrivalTime); put32(p+8, r.returningTime);
+	put32(p+12, r.collisions);
+	p += 16;
+	putFloat(p, r.leftMotor); putFloat(p+4, r.rightMotor);
+	p += 8;
+	put32(p, r.time);
+	putFloat(p+4, r.compass);
+	p += 8;
+	for(int i=0; i < CB_BINLOG_IR_SENSORS; i++, p += 4)
+		putFloat(p, r.irSensors[i]);
+	putFloat(p, r.gpsX); putFloat(p+4, r.gpsY); putFloat(p+8, r.gpsDir);
+	p += 12;
+
+	for(unsigned int t=0; t < r.visitedMask.size(); t++)
+		if(r.visitedMask[t] == '1') p[t/8] |= 1 << (t%8);
+	p += (nTargets + 7) / 8;
+
+	unsigned int maskBytes = (nBeacons + 7) / 8;
+	unsigned char *ready = p, *visible = p + maskBytes;
+	p += 2 * maskBytes;
+	for(unsigned int b=0; b < r.beacons.size(); b++) {
+		unsigned int id = r.beacons[b].id;
+		ready[id/8] |= 1 << (id%8);
+		if(r.beacons[b].visible) {
+			visible[id/8] |= 1 << (id%8);
+			putFloat(p + 4*id, r.beacons[b].degrees);
+		}
+	}
+	return true;
+}
+
+void cbBinLogReader::decodeRecord(const unsigned char *p, cbBinLogRobot &r)
+{
+	r.id = get16(p);
+	r.state = p[2];
+	r.flags = p[3];
+	r.buttons = p[4];
+	r.actions = p[5];
+	r.ground = (signed char) p[6];
+	r.nIRSensors = p[7] < CB_BINLOG_IR_SENSORS ? p[7] : CB_BINLOG_IR_SENSORS;
+	unsigned int maskLength = get16(p+8);
+	if(maskLength > nTargets) maskLength = nTargets;
+	p += 10;
+
+	r.x = getFloat(p); r.y = getFloat(p+4); r.dir = getFloat(p+8);
+	p += 12;
+	r.score = get32(p); r.arrivalTime = get32(p+4); r.returningTime = get32(p+8);
+	r.collisions = get32(p+12);
+	p += 16;
+	r.leftMotor = getFloat(p); r.rightMotor = getFloat(p+4);
+	p += 8;
+	r.time = get32(p);
+	r.compass = getFloat(p+4);
+	p += 8;
+	for(int i=0; i < CB_BINLOG_IR_SENSORS; i++, p += 4)
+		r.irSensors[i] = getFloat(p);
+	r.gpsX = getFloat(p); r.gpsY = getFloat(p+4); r.gpsDir = getFloat(p+8);
+	p += 12;
+
+	r.visitedMask.resize(maskLength);
+	for(unsigned int t=0; t < maskLength; t++)
+		r.visitedMask[t] = (p[t/8] >> (t%8)) & 1 ? '1' : '0';
+	p += (nTargets + 7) / 8;
+
+	unsigned int maskBytes = (nBeacons + 7) / 8;
+	const unsigned char *ready = p, *visible = p + maskBytes;
+	p += 2 * maskBytes;
+	r.beacons.clear();
+	for(unsigned int id=0; id < nBeacons; id++) {
+		if(!((ready[id/8] >> (id%8)) & 1)) continue;
+		cbBinLogBeacon beacon;
+		beacon.id = id;
+		beacon.visible = ((visible[id/8] >> (id%8)) & 1) != 0;
+		beacon.degrees = beacon.visible ? getFloat(p + 4*id) : 0.0f;
+		r.beacons.push_back(beacon);
+	}
+}
+
+/*!
+	Appends cur XOR prev, records of size bytes, as a sequence of
+	(zero run, literal run, literals).
+*/
+static void encodeDelta(const unsigned char *prev, const unsigned char *cur,
+                        unsigned int size, string &out)
+{
+	unsigned char lits[255];
+	unsigned int i = 0;
+
+	while(i < size) {
+		unsigned int zeros = 0, nLits = 0;
+		while(i < size && zeros < 255 && prev[i] == cur[i]) {
+			zeros++; i++;
+		}
+		while(i < size && nLits < 255 && prev[i] != cur[i]) {
+			lits[nLits++] = prev[i] ^ cur[i]; i++;
+		}
+		out += (char) zeros;
+		out += (char) nLits;
+		out.append((const char *) lits, nLits);
+	}
+}
+
+/*!
+	Applies a delta to rec. Returns the number of bytes consumed, 0 on error.
+*/
+static unsigned int decodeDelta(const unsigned char *p, unsigned long long avail,
+                                unsigned char *rec, unsigned int size)
+{
+	unsigned int i = 0, n = 0;
+
+	while(i < size) {
+		if(n + 2 > avail) return 0;
+		unsigned int zeros = p[n], nLits = p[n+1];
+		n += 2;
+		i += zeros;
+		if(i + nLits > size || n + nLits > avail) return 0;
+		for(unsigned int l=0; l < nLits; l++)
+			rec[i++] ^= p[n++];
+	}
+	return i == size ? n : 0;
+}
+
+/* cbBinLogWriter */
+
+cbBinLogWriter::cbBinLogWriter(unsigned int keyInt)
+{
+	keyInterval = keyInt > 0 ? keyInt : 1;
+	opened = false;
+	offset = 0;
+	nWrites = 0;
+	lastKeyframe = 0;
+	nBeacons = nTargets = 0;
+	recordSize = recordSizeFor(0, 0);
+}
+
+cbBinLogWriter::~cbBinLogWriter()
+{
+	close();
+}
+
+bool cbBinLogWriter::open(const char *filename, const char *date, const string &preamble,
+                          unsigned int beacons, unsigned int targets)
+{
+	unsigned char b[8];
+
+	if(opened) close();
+
+	if(beacons > CB_BINLOG_MAX_COUNT || targets > CB_BINLOG_MAX_COUNT) {
+		cerr << "ERROR: Could not open " << filename << ", a binary log has room for "
+		     << CB_BINLOG_MAX_COUNT << " beacons and targets\n";
+		return false;
+	}
+
+	out.clear();
+	out.open(filename, ios::out | ios::binary | ios::trunc);
+	if(!out.is_open()) {
+		cerr << "ERROR: Could not open " << filename << " for writing\n";
+		return false;
+	}
+	opened = true;
+
+	buffer.clear();
+	offset = 0;
+	nWrites = 0;
+	index.clear();
+	prevIds.clear();
+	prevNames.clear();
+	prevRecords.clear();
+	nBeacons = beacons;
+	nTargets = targets;
+	recordSize = recordSizeFor(nBeacons, nTargets);
+
+	append(BINLOG_MAGIC, 8);
+	put32(b, BINLOG_VERSION);
+	put32(b+4, keyInterval);
+	append(b, 8);
+	put32(b, nBeacons);
+	put32(b+4, nTargets);
+	append(b, 8);
+
+	string dateStr = date ? date : "";
+	b[0] = date ? 1 : 0;
+	put32(b+1, dateStr.size());
+	append(b, 5);
+	append(dateStr.data(), dateStr.size());
+
+	put32(b, preamble.size());
+	append(b, 4);
+	append(preamble.data(), preamble.size());
+
+	return flush();
+}
+
+void cbBinLogWriter::append(const void *data, unsigned int len)
+{
+	buffer.append((const char *) data, len);
+	offset += len;
+}
+
+bool cbBinLogWriter::flush(void)
+{
+	if(buffer.empty()) return true;
+
+	out.write(buffer.data(), buffer.size());
+	nWrites++;
+	buffer.clear();
+
+	if(!out) {
+		cerr << "ERROR: Could not write binary log\n";
+		return false;
+	}
+	return true;
+}
+
+/*!
+	Adds one LogInfo item to the log.
+	A keyframe is written every keyInterval frames and whenever the set
+	of robots changes, otherwise only the changes to each record are written.
+*/
+bool cbBinLogWriter::writeCycle(unsigned int time, const vector<cbBinLogRobot> &robots)
+{
+	unsigned char b[FRAME_HEADER_SIZE];
+	unsigned int n = robots.size();
+
+	if(!opened) return false;
+
+	curRecords.resize(n * recordSize);
+	for(unsigned int r=0; r < n; r++) {
+		if(robots[r].name.size() > CB_BINLOG_MAX_COUNT) {
+			cerr << "ERROR: Robot " << robots[r].id << " has a name of "
+			     << robots[r].name.size() << " characters, too long for a binary log\n";
+			return false;
+		}
+		if(!encodeRecord(robots[r], &curRecords[r * recordSize])) return false;
+	}
+
+	bool key = index.empty() || index.size() - lastKeyframe >= keyInterval
+	           || n != prevIds.size();
+	for(unsigned int r=0; r < n && !key; r++)
+		key = robots[r].id != prevIds[r] || prevNames[r] != robots[r].name;
+
+	IndexEntry entry;
+	entry.time = time;
+	entry.offset = offset;
+	if(key) lastKeyframe = index.size();
+	entry.keyframe = lastKeyframe;
+	index.push_back(entry);
+
+	b[0] = key ? FRAME_KEY : FRAME_DELTA;
+	put32(b+1, time);
+	put16(b+5, n);
+	append(b, FRAME_HEADER_SIZE);
+
+	if(key) {
+		prevIds.resize(n);
+		prevNames.resize(n);
+		for(unsigned int r=0; r < n; r++) {
+			put16(b, robots[r].name.size());
+			append(b, 2);
+			append(robots[r].name.data(), robots[r].name.size());
+			append(&curRecords[r * recordSize], recordSize);
+			prevIds[r] = robots[r].id;
+			prevNames[r] = robots[r].name;
+		}
+	}
+	else {
+		string delta;
+		for(unsigned int r=0; r < n; r++)
+			encodeDelta(&prevRecords[r * recordSize],
+			            &curRecords[r * recordSize], recordSize, delta);
+		append(delta.data(), delta.size());
+	}
+	prevRecords.swap(curRecords);
+
+	if(buffer.size() >= FLUSH_SIZE) return flush();
+	return true;
+}
+
+bool cbBinLogWriter::close(void)
+{
+	unsigned char b[TRAILER_SIZE];
+
+	if(!opened) return true;
+
+	unsigned long long indexOffset = offset;
+	for(unsigned int f=0; f < index.size(); f++) {
+		put32(b, index[f].time);
+		put32(b+4, index[f].keyframe);
+		put64(b+8, index[f].offset);
+		append(b, INDEX_ENTRY_SIZE);
+	}
+	put64(b, indexOffset);
+	put32(b+8, index.size());
+	memcpy(b+12, BINLOG_ENDMAGIC, 8);
+	append(b, TRAILER_SIZE);
+
+	bool ok = flush();
+	out.close();
+	opened = false;
+
+	return ok;
+}
+
+/* cbBinLogReader */
+
+cbBinLogReader::cbBinLogReader()
+{
+	data = 0;
+	size = 0;
+	curFrame = -1;
+	withDate = false;
+	keyInterval = 0;
+	framesOffset = 0;
+	nBeacons = nTargets = 0;
+	recordSize = recordSizeFor(0, 0);
+}
+
+cbBinLogReader::~cbBinLogReader()
+{
+	close();
+}
+
+bool cbBinLogReader::isBinaryLog(const char *filename)
+{
+	char magic[8];
+	ifstream in(filename, ios::in | ios::binary);
+
+	if(!in.read(magic, 8)) return false;
+	return memcmp(magic, BINLOG_MAGIC, 8) == 0;
+}
+
+bool cbBinLogReader::isBinaryLog(const unsigned char *mem, unsigned long long len)
+{
+	return len >= 8 && memcmp(mem, BINLOG_MAGIC, 8) == 0;
+}
+
+bool cbBinLogReader::open(const char *filename)
+{
+	close();
+
+	ifstream in(filename, ios::in | ios::binary);
+	if(!in) {
+		cerr << "ERROR: Could not open " << filename << "\n";
+		return false;
+	}
+	in.seekg(0, ios::end);
+	unsigned long long len = in.tellg();
+	in.seekg(0, ios::beg);
+	buffer.resize(len);
+	if(len > 0 && !in.read((char *) &buffer[0], len)) {
+		cerr << "ERROR: Could not read " << filename << "\n";
+		close();
+		return false;
+	}
+
+	data = len > 0 ? &buffer[0] : 0;
+	size = len;
+	if(!parseHeader(filename)) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+/*!
+	Reads a log already in memory, e.g. a memory mapped file.
+	The memory must remain valid until close.
+*/
+bool cbBinLogReader::open(const unsigned char *mem, unsigned long long len, const char *name)
+{
+	close();
+
+	data = mem;
+	size = len;
+	if(!parseHeader(name)) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+bool cbBinLogReader::parseHeader(const char *name)
+{
+	if(size < HEADER_SIZE + 4 || memcmp(data, BINLOG_MAGIC, 8) != 0) {
+		cerr << "ERROR: " << name << " is not a binary log\n";
+		return false;
+	}
+	if(get32(data+8) != BINLOG_VERSION) {
+		cerr << "ERROR: " << name << " has unsupported version " << get32(data+8) << "\n";
+		return false;
+	}
+	keyInterval = get32(data+12);
+	nBeacons = get32(data+16);
+	nTargets = get32(data+20);
+	if(nBeacons > CB_BINLOG_MAX_COUNT || nTargets > CB_BINLOG_MAX_COUNT) {
+		cerr << "ERROR: " << name << " has " << nBeacons << " beacons and "
+		     << nTargets << " targets, more than a binary log can hold\n";
+		return false;
+	}
+	recordSize = recordSizeFor(nBeacons, nTargets);
+	withDate = data[24] != 0;
+
+	unsigned long long pos = HEADER_SIZE;
+	unsigned int len = get32(data+pos);
+	pos += 4;
+	if(pos + len + 4 > size) {
+		cerr << "ERROR: " << name << " has a truncated header\n";
+		return false;
+	}
+	logDate.assign((const char *) data+pos, len);
+	pos += len;
+
+	len = get32(data+pos);
+	pos += 4;
+	if(pos + len > size) {
+		cerr << "ERROR: " << name << " has a truncated header\n";
+		return false;
+	}
+	logPreamble.assign((const char *) data+pos, len);
+	pos += len;
+
+	framesOffset = pos;
+
+	if(!readIndex()) {
+		cerr << "WARNING: " << name << " has no valid index, rebuilding it\n";
+		rebuildIndex(framesOffset);
+	}
+
+	return true;
+}
+
+void cbBinLogReader::close(void)
+{
+	buffer.clear();
+	data = 0;
+	size = 0;
+	index.clear();
+	cur.clear();
+	curRecords.clear();
+	curFrame = -1;
+}
+
+bool cbBinLogReader::readIndex(void)
+{
+	if(size < framesOffset + TRAILER_SIZE) return false;
+
+	const unsigned char *t = data + size - TRAILER_SIZE;
+	if(memcmp(t+12, BINLOG_ENDMAGIC, 8) != 0) return false;
+
+	unsigned long long indexOffset = get64(t);
+	unsigned int nFrames = get32(t+8);
+	if(indexOffset < framesOffset
+	   || indexOffset + (unsigned long long) nFrames * INDEX_ENTRY_SIZE + TRAILER_SIZE != size)
+		return false;
+
+	index.resize(nFrames);
+	const unsigned char *p = data + indexOffset;
+	for(unsigned int f=0; f < nFrames; f++, p += INDEX_ENTRY_SIZE) {
+		index[f].time = get32(p);
+		index[f].keyframe = get32(p+4);
+		index[f].offset = get64(p+8);
+		if(index[f].offset >= indexOffset || index[f].keyframe > f) {
+			index.clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+/*!
+	Parses the frame at pos without decoding it, leaving pos after it.
+	Returns false if the frame is not complete.
+*/
+bool cbBinLogReader::skipFrame(unsigned long long &pos, unsigned int &time, bool &keyframe)
+{
+	unsigned long long p = pos;
+
+	if(p + FRAME_HEADER_SIZE > size) return false;
+	if(data[p] != FRAME_KEY && data[p] != FRAME_DELTA) return false;
+	keyframe = data[p] == FRAME_KEY;
+	time = get32(data+p+1);
+	unsigned int n = get16(data+p+5);
+	p += FRAME_HEADER_SIZE;
+
+	scratch.resize(recordSize);
+	for(unsigned int r=0; r < n; r++) {
+		if(keyframe) {
+			if(p + 2 > size) return false;
+			p += 2 + get16(data+p) + recordSize;
+			if(p > size) return false;
+		}
+		else {
+			unsigned int used = decodeDelta(data+p, size-p, &scratch[0], recordSize);
+			if(used == 0) return false;
+			p += used;
+		}
+	}
+	pos = p;
+	return true;
+}
+
+bool cbBinLogReader::rebuildIndex(unsigned long long from)
+{
+	unsigned long long pos = from;
+	unsigned int time, lastKey = 0;
+	bool key, first = true;
+
+	index.clear();
+	for(;;) {
+		IndexEntry entry;
+		entry.offset = pos;
+		if(!skipFrame(pos, time, key)) break;
+		if(first && !key) break;   // a log always starts with a keyframe
+		if(key) lastKey = index.size();
+		entry.time = time;
+		entry.keyframe = lastKey;
+		index.push_back(entry);
+		first = false;
+	}
+	return !index.empty();
+}
+
+int cbBinLogReader::findCycle(unsigned int time)
+{
+	unsigned int lo = 0, hi = index.size();
+
+	while(lo < hi) {
+		unsigned int mid = (lo + hi) / 2;
+		if(index[mid].time < time) lo = mid + 1;
+		else hi = mid;
+	}
+	return lo < index.size() ? (int) lo : -1;
+}
+
+/*!
+	Applies the frame at offset p to the current decoding state.
+*/
+bool cbBinLogReader::applyFrame(unsigned long long p)
+{
+	if(p + FRAME_HEADER_SIZE > size) return false;
+
+	bool key = data[p] == FRAME_KEY;
+	unsigned int n = get16(data+p+5);
+	p += FRAME_HEADER_SIZE;
+
+	if(key) {
+		cur.resize(n);
+		curRecords.resize(n * recordSize);
+		for(unsigned int r=0; r < n; r++) {
+			if(p + 2 > size) return false;
+			unsigned int len = get16(data+p);
+			p += 2;
+			if(p + len + recordSize > size) return false;
+			cur[r].name.assign((const char *) data+p, len);
+			p += len;
+			memcpy(&curRecords[r * recordSize], data+p, recordSize);
+			p += recordSize;
+		}
+	}
+	else {
+		if(n != cur.size()) return false;
+		for(unsigned int r=0; r < n; r++) {
+			unsigned int used = decodeDelta(data+p, size-p, &curRecords[r * recordSize], recordSize);
+			if(used == 0) return false;
+			p += used;
+		}
+	}
+	return true;
+}
+
+/*!
+	Decodes frame into cur, starting from its keyframe unless a previous
+	frame of the same group is the one currently decoded.
+*/
+bool cbBinLogReader::decodeFrame(unsigned int frame)
+{
+	if(frame >= index.size()) return false;
+	if((int) frame == curFrame) return true;
+
+	unsigned int f = index[frame].keyframe;
+	if(curFrame >= 0 && (unsigned int) curFrame >= f && (unsigned int) curFrame < frame)
+		f = curFrame + 1;
+
+	for(; f <= frame; f++) {
+		if(!applyFrame(index[f].offset)) {
+			curFrame = -1;
+			return false;
+		}
+		curFrame = f;
+	}
+
+	for(unsigned int r=0; r < cur.size(); r++)
+		decodeRecord(&curRecords[r * recordSize], cur[r]);
+
+	return true;
+}
+
+bool cbBinLogReader::readCycle(unsigned int frame, vector<cbBinLogRobot> &robots)
+{
+	if(!decodeFrame(frame)) {
+		cerr << "ERROR: Could not decode cycle " << frame << " of binary log\n";
+		return false;
+	}
+	robots = cur;
+	return true;
+}
@@ -0,0 +1,219 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef CBBINLOG_H
+#define CBBINLOG_H
+
+/*! \file cbbinlog.h
+	\brief Binary simulator log (.cblog).
+
+	Layout of a .cblog file (all integers little endian):
+	<ul>
+		<li> header: magic "CBBINLOG", version, keyframe interval,
+		     number of beacons and targets of the lab, log date and the
+		     XML preamble (Parameters, Lab and Grid) exactly as it
+		     appears in the XML log </li>
+		<li> one frame per LogInfo item: keyframes hold the names and
+		     the full record of every robot, the frames in between hold
+		     each record XORed with the one of the previous frame and
+		     run-length encoded </li>
+		<li> index: time, keyframe and file offset of every frame </li>
+		<li> trailer: index offset, number of frames and magic "CBLOGEND" </li>
+	</ul>
+	A log without index (e.g. the simulator was killed) is still readable,
+	the index is rebuilt by scanning the frames.
+
+	All records of a log have the same size: a fixed part, then the
+	visited targets and the beacon sensors, with one slot per target and
+	beacon of the header. A record that does not fit them (e.g. a beacon
+	id beyond the number of beacons) is refused with an error.
+
+	Values are stored as floats, which keep the 6 significant digits
+	written in the XML log, so XML -> binary -> XML is lossless.
+*/
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+using std::ofstream;
+using std::string;
+using std::vector;
+
+#define CB_BINLOG_IR_SENSORS   4
+#define CB_BINLOG_MAX_COUNT    65535  // beacons, targets and name length
+#define CB_BINLOG_KEY_INTERVAL 32
+
+struct cbBinLogBeacon
+{
+	unsigned int id;
+	bool visible;
+	float degrees;
+};
+
+/**
+ * State of one robot in one LogInfo item.
+ */
+struct cbBinLogRobot
+{
+	enum Flags { COLLISION=1, MEASURES=2, GPS=4, GPS_DIR=8, COLLISION_SENSOR=16,
+	             END_LED=32, RETURNING_LED=64, VISITING_LED=128 };
+	enum Buttons { START=1, STOP=2 };
+	// same values as cbLogRobotRecord::ActionFlags
+	enum Actions { LEFT_MOTOR=1, RIGHT_MOTOR=2, ACT_END_LED=4,
+	               ACT_RETURNING_LED=8, ACT_VISITING_LED=16 };
+
+	void clear(void);
+
+	string name;
+
+	unsigned short id;
+	unsigned char  state;        // index in cbBinLogStateName
+	unsigned char  flags;
+	unsigned char  buttons;
+	unsigned char  actions;
+	signed char    ground;
+
+	float x, y, dir;
+	unsigned int score, arrivalTime, returningTime, collisions;
+	string visitedMask;          // as in the XML log, '1' for visited targets
+
+	float leftMotor, rightMotor;
+
+	unsigned int time;           // Measures time
+	float compass;
+	unsigned char nIRSensors;
+	float irSensors[CB_BINLOG_IR_SENSORS];
+	float gpsX, gpsY, gpsDir;
+	vector<cbBinLogBeacon> beacons;   // only beacons that are ready, by id
+};
+
+/* robot state names, as used in the XML log */
+const char *cbBinLogStateName(unsigned int state);
+int cbBinLogState(const char *name);   // returns -1 if unknown
+int cbBinLogState(const char *name, unsigned int len);   // name need not end in NUL
+
+/**
+ * Writes a binary log.
+ */
+class cbBinLogWriter
+{
+public:
+	cbBinLogWriter(unsigned int keyInterval=CB_BINLOG_KEY_INTERVAL);
+	~cbBinLogWriter();
+
+	/* date may be 0, as in the logs written under windows; the robots
+	   may have up to nBeacons beacon sensors and nTargets targets */
+	bool open(const char *filename, const char *date, const string &preamble,
+	          unsigned int nBeacons, unsigned int nTargets);
+	/* returns false, with an error, if a robot does not fit the log */
+	bool writeCycle(unsigned int time, const vector<cbBinLogRobot> &robots);
+	bool close(void);  // writes the index and trailer
+
+	inline bool isOpen(void) { return opened; }
+	inline unsigned long long bytesWritten(void) { return offset; }
+	inline unsigned long writes(void) { return nWrites; }
+
+private:
+	struct IndexEntry { unsigned int time, keyframe; unsigned long long offset; };
+
+	void append(const void *data, unsigned int len);
+	bool flush(void);
+	bool encodeRecord(const cbBinLogRobot &r, unsigned char *p);
+
+	ofstream out;
+	bool opened;
+	unsigned int keyInterval;
+	unsigned int nBeacons, nTargets, recordSize;
+
+	string buffer;
+	unsigned long long offset;  // file offset of the end of buffer
+	unsigned long nWrites;
+
+	vector<IndexEntry> index;
+	unsigned int lastKeyframe;
+	vector<unsigned short> prevIds;
+	vector<string> prevNames;
+	vector<unsigned char> prevRecords;
+	vector<unsigned char> curRecords;
+};
+
+/**
+ * Reads a binary log, giving random access to its frames.
+ * Sequential reads only decode one delta frame each.
+ */
+class cbBinLogReader
+{
+public:
+	cbBinLogReader();
+	~cbBinLogReader();
+
+	bool open(const char *filename);
+	bool open(const unsigned char *data, unsigned long long size, const char *name);
+	void close(void);
+
+	static bool isBinaryLog(const char *filename);
+	static bool isBinaryLog(const unsigned char *data, unsigned long long size);
+
+	inline bool hasDate(void) { return withDate; }
+	inline const string &date(void) { return logDate; }
+	inline const string &preamble(void) { return logPreamble; }
+	inline unsigned int keyframeInterval(void) { return keyInterval; }
+	inline unsigned int beacons(void) { return nBeacons; }
+	inline unsigned int targets(void) { return nTargets; }
+
+	inline unsigned int nCycles(void) { return index.size(); }
+	inline unsigned int cycleTime(unsigned int frame) { return index[frame].time; }
+	inline unsigned int cycleKeyframe(unsigned int frame) { return index[frame].keyframe; }
+	int findCycle(unsigned int time);  // first frame with time >= given time, -1 if none
+
+	bool readCycle(unsigned int frame, vector<cbBinLogRobot> &robots);
+
+private:
+	struct IndexEntry { unsigned int time, keyframe; unsigned long long offset; };
+
+	bool parseHeader(const char *name);
+	bool readIndex(void);
+	bool rebuildIndex(unsigned long long from);
+	bool decodeFrame(unsigned int frame);
+	bool applyFrame(unsigned long long offset);
+	bool skipFrame(unsigned long long &pos, unsigned int &time, bool &keyframe);
+
+	vector<unsigned char> buffer;
+	const unsigned char *data;
+	unsigned long long size;
+	unsigned long long framesOffset;
+
+	void decodeRecord(const unsigned char *p, cbBinLogRobot &r);
+
+	bool withDate;
+	string logDate, logPreamble;
+	unsigned int keyInterval;
+	unsigned int nBeacons, nTargets, recordSize;
+
+	vector<IndexEntry> index;
+
+	int curFrame;                      // last decoded frame
+	vector<cbBinLogRobot> cur;
+	vector<unsigned char> curRecords;
+	vector<unsigned char> scratch;     // record skipped by skipFrame
+};
+
+#endif
@@ -0,0 +1,86 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "cbchunk.h"
+
+#include <stdio.h>
+#include <string.h>
+
+cbChunkedXml::cbChunkedXml(const char *object)
+{
+	obj = object;
+	ver = 0;
+}
+
+void cbChunkedXml::set(const string &xml)
+{
+	msg = xml;
+	ver++;
+}
+
+unsigned int cbChunkedXml::count() const
+{
+	return (msg.size() + CHUNK_PAYLOAD - 1) / CHUNK_PAYLOAD;
+}
+
+int cbChunkedXml::chunk(unsigned int seq, char *buff) const
+{
+	unsigned int n = count();
+	if (seq >= n) return -1;
+
+	// the same size for all but the last one, see cbchunk.h
+	unsigned int size = (msg.size() + n - 1) / n;
+	unsigned int begin = seq * size;
+	unsigned int len = msg.size() - begin;
+	if (len > size) len = size;
+
+	int cnt = sprintf(buff, "<Chunk Object=\"%s\" Version=\"%u\" Seq=\"%u\" Count=\"%u\" Size=\"%u\"/>\n",
+	                  obj, ver, seq, count(), (unsigned int) msg.size());
+	memcpy(buff + cnt, msg.data() + begin, len);
+	return cnt + len;
+}
+
+bool cbChunkedXml::sendTo(cbDatagramSink &sink) const
+{
+	if (single())
+		return sink.sendDatagram(msg.c_str(), msg.size()+1);
+
+	bool ok = true;
+	for (unsigned int seq=0; seq<count(); seq++)
+		ok = sendChunk(sink, seq) && ok;
+	return ok;
+}
+
+bool cbChunkedXml::answerRequest(cbDatagramSink &sink, unsigned int version, unsigned int seq) const
+{
+	if (single())
+		return sendTo(sink);
+	if (version == ver && seq < count())
+		return sendChunk(sink, seq);
+	// the message changed, the chunk starts the new version
+	return sendChunk(sink, 0);
+}
+
+bool cbChunkedXml::sendChunk(cbDatagramSink &sink, unsigned int seq) const
+{
+	char buff[CHUNK_HEADER+CHUNK_PAYLOAD];
+	int cnt = chunk(seq, buff);
+	return cnt > 0 && sink.sendDatagram(buff, cnt);
+}
@@ -0,0 +1,109 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef CBCHUNK_H
+#define CBCHUNK_H
+
+/*! \file cbchunk.h
+	\brief Transfer of XML messages larger than a datagram.
+
+	The lab and grid are sent to the viewers in one datagram, which
+	bounds their size. Messages of up to CHUNK_SINGLE bytes still go
+	that way, so the older viewers keep working with the usual labs.
+	Larger messages are split in Count chunks of at most CHUNK_PAYLOAD
+	bytes, each in a datagram of its own that starts with the header
+
+		<Chunk Object="Lab" Version="3" Seq="0" Count="12" Size="191002"/>
+
+	and a newline, followed by the raw bytes of that part of the
+	message. Every chunk but the last holds (Size + Count - 1) / Count
+	bytes, so the receiver places a chunk from its header alone and
+	does not depend on CHUNK_PAYLOAD. The version changes whenever the
+	message does, so that chunks of two versions are never put together.
+	The receiver asks again for the chunks that did not arrive with
+
+		<ChunkReq Object="Lab" Version="3" Seq="5"/>
+
+	and has the message when it holds all Count chunks.
+*/
+
+#include <string>
+
+using std::string;
+
+#define CHUNK_SINGLE 60000		// longest message sent in one datagram
+#define CHUNK_PAYLOAD 16384		// bytes of the message per chunk
+#define CHUNK_HEADER 128		// room for the header of a chunk
+
+/**
+ * Where the datagrams of a cbChunkedXml go: a viewer of the simulator
+ * or of the logplayer.
+ */
+class cbDatagramSink
+{
+public:
+	virtual ~cbDatagramSink() {}
+	virtual bool sendDatagram(const char *data, unsigned int len) = 0;
+};
+
+/**
+ * Serialized message, as sent to the viewers, cached until it changes.
+ */
+class cbChunkedXml
+{
+public:
+	cbChunkedXml(const char *object);
+
+	/*! Replaces the message, the version changes. */
+	void set(const string &xml);
+	/*! Drops the message, to be set again before it is sent. */
+	inline void clear() { msg.clear(); }
+	inline bool empty() const { return msg.empty(); }
+
+	inline const string &message() const { return msg; }
+	inline const char *object() const { return obj; }
+	inline unsigned int version() const { return ver; }
+
+	/*! True if the message goes in one datagram, without chunks. */
+	inline bool single() const { return msg.size() + 1 <= CHUNK_SINGLE; }
+	unsigned int count() const;
+
+	/*! Writes the datagram of chunk seq, header and payload, into buff,
+	    of at least CHUNK_HEADER+CHUNK_PAYLOAD bytes.
+	    \return its length, -1 if there is no such chunk. */
+	int chunk(unsigned int seq, char *buff) const;
+
+	/*! Sends the message in one datagram, or in chunks if it is too
+	    large. */
+	bool sendTo(cbDatagramSink &sink) const;
+	/*! Answers a <ChunkReq/> of the given version and chunk: that chunk,
+	    the whole message if it goes in one datagram, or the first chunk
+	    of the current version if the message changed since. */
+	bool answerRequest(cbDatagramSink &sink, unsigned int version, unsigned int seq) const;
+
+private:
+	bool sendChunk(cbDatagramSink &sink, unsigned int seq) const;
+
+	const char *obj;
+	unsigned int ver;
+	string msg;
+};
+
+#endif
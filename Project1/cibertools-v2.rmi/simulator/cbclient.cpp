@@ -19,6 +19,7 @@
 */
 
 #include "cbclient.h"
+#include "cbprofiler.h"
 
 #include <QUdpSocket>
 #include <QHostAddress>
@@ -28,8 +29,6 @@
 
 using std::cerr;
 
-#define REPLYMAXSIZE 4096
-
 cbClient::cbClient() : QUdpSocket()
 {
     bind();
@@ -42,7 +41,8 @@ cbClient::~cbClient()
 /*!
 	Send the OK reply message to client.
 */
-bool cbClient::Reply(QHostAddress &a, unsigned short &p, cbParameters *param)
+bool cbClient::Reply(QHostAddress &a, unsigned short &p, cbParameters *param,
+                     const char *reply, int len)
 {
     //cout.form("Sending reply for client to %s:%hd\n", a.toString().toLatin1().constData(), p);
     /* set peer address and peer port */
@@ -50,22 +50,33 @@ bool cbClient::Reply(QHostAddress &a, unsigned short &p, cbParameters *param)
 	port = p;
 
 	/* constructing reply message */
-	char reply[REPLYMAXSIZE];
-	int cnt;
-	cnt = sprintf(reply, "<Reply Status=\"Ok\">\n\t");
-	cnt += param->toXml(reply+cnt, REPLYMAXSIZE-cnt);
-	cnt += sprintf(reply+cnt, "</Reply>\n");
+	char buff[REPLYMAXSIZE];
+	if (reply == 0)
+	{
+		len = replyXml(buff, REPLYMAXSIZE, param) + 1;
+		reply = buff;
+	}
 
     /* send reply to client */
-    if (writeDatagram(reply, cnt+1, address, port) != cnt+1)
+    if (writeDatagram(reply, len, address, port) != len)
 	{
 		cerr << "Fail replying to client\n";
 		return false;
     }
+    cbProfiler::countOut(len);
     //cout << "Reply sent\n" << reply;
 	return true;
 }
 
+int cbClient::replyXml(char *buff, int len, cbParameters *param)
+{
+	int cnt;
+	cnt = sprintf(buff, "<Reply Status=\"Ok\">\n\t");
+	cnt += param->toXml(buff+cnt, len-cnt);
+	cnt += sprintf(buff+cnt, "</Reply>\n");
+	return cnt;
+}
+
 /*!
 	Send the Refused reply message to client.
 */
@@ -87,6 +98,7 @@ bool cbClient::Refuse(QHostAddress &a, unsigned short &p)
 		cerr << "Fail replying to client\n";
 		return false;
     }
+    cbProfiler::countOut(cnt+1);
     //cout << "Reply sent\n" << reply;
 	return true;
 }
@@ -103,6 +115,7 @@ bool cbClient::send(const char *xml, unsigned int cnt)
 		//cerr << xml;
 		return false;
     }
+    cbProfiler::countOut(cnt);
 
 	return true;
 }
@@ -27,6 +27,8 @@
 
 #include "cbparameters.h"
 
+#define REPLYMAXSIZE 4096
+
 /**
  * base class of all representations of clients in the simulator.
  * 
@@ -39,11 +41,17 @@ public:
 	cbClient();
 	virtual ~cbClient();
 
-	virtual bool Reply(QHostAddress &addr, unsigned short &port, cbParameters *param);
+	/*! Sends the OK reply with the parameters. reply, if given, is the
+	    message already built by replyXml, len bytes with the final NUL. */
+	virtual bool Reply(QHostAddress &addr, unsigned short &port, cbParameters *param,
+	                   const char *reply=0, int len=0);
 	virtual bool Refuse(QHostAddress &addr, unsigned short &port);
 
 	bool send(const char *, unsigned int);
 
+	/*! Builds the OK reply, returns its length without the final NUL. */
+	static int replyXml(char *buff, int len, cbParameters *param);
+
 protected:
 	QHostAddress address;
 	unsigned short port;
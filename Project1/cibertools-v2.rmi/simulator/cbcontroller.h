@@ -0,0 +1,144 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef CBCONTROLLER_H
+#define CBCONTROLLER_H
+
+/*! \file cbcontroller.h
+	\brief C interface of the in-process robot controllers.
+
+	A controller is a shared library (.so, .dll) loaded by the simulator
+	with -plugin. Each instance is registered as a robot, exactly like a
+	robot that registers through the receptionist, but it exchanges plain
+	structures with the simulator instead of XML over UDP.
+
+	Every cycle, where a networked robot would be sent its <Measures>,
+	cb_controller_step is called with the same measures: a sensor is
+	"ready" in cbcMeasures exactly when it would have been included in the
+	XML message, and its value went through the same noise and latency.
+	Sensors that are not ready hold the defaults of libRobSock: ground is
+	-1, everything else 0.
+	The actions returned are applied when the simulator reads robot
+	actions at the start of the next cycle, as if they had arrived by UDP
+	just in time; sensor requests count against the same quota.
+
+	The library exports, with C linkage:
+
+	  int   cb_controller_api(void);
+	        returns CB_CONTROLLER_API
+
+	  void *cb_controller_create(const char *name, int id,
+	                             const struct cbcParameters *param);
+	        creates the state of one robot, NULL on error
+
+	  void  cb_controller_step(void *ctrl, const struct cbcMeasures *m,
+	                           struct cbcActions *a);
+	        a is cleared before each call; set the fields to change
+
+	  void  cb_controller_destroy(void *ctrl);
+
+	The functions are called from the simulation thread only.
+*/
+
+#define CB_CONTROLLER_API 1
+
+#define CBC_NUM_IR_SENSORS  4
+#define CBC_MAX_BEACONS     8
+#define CBC_MAX_MESSAGES    32
+#define CBC_MAX_SAY         101   /* Say messages up to 100 characters */
+#define CBC_MAX_REQUESTS    16
+#define CBC_SENSOR_ID_LEN   16
+#define CBC_MAX_TARGETS     32
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* simulation parameters, as in the registration reply */
+struct cbcParameters
+{
+	unsigned int simTime, cycleTime, keyTime;
+	int nBeacons;
+	double compassNoise, beaconNoise, obstacleNoise, motorsNoise;
+	int nReqPerCycle;
+	int gpsOn, scoreSensorOn;
+};
+
+struct cbcMessage
+{
+	int from;                 /* robot id */
+	const char *text;         /* valid during cb_controller_step only */
+};
+
+struct cbcMeasures
+{
+	unsigned int time;
+
+	int collisionReady, collision;
+	int compassReady;
+	double compass;
+	int groundReady, ground;
+
+	int irReady[CBC_NUM_IR_SENSORS];
+	double ir[CBC_NUM_IR_SENSORS];
+
+	int nBeacons;
+	int beaconReady[CBC_MAX_BEACONS];
+	int beaconVisible[CBC_MAX_BEACONS];
+	double beaconDir[CBC_MAX_BEACONS];
+
+	int gpsReady, gpsDirReady;
+	double x, y, dir;
+
+	int nMessages;
+	struct cbcMessage messages[CBC_MAX_MESSAGES];
+
+	int scoreReady;
+	int score, arrivalTime, returningTime, collisions, collisionFlag;
+	char visitedMask[CBC_MAX_TARGETS+1];
+
+	int endLed, returningLed, visitingLed;
+	int start, stop;          /* buttons */
+};
+
+struct cbcActions
+{
+	int leftMotorSet, rightMotorSet;
+	double leftMotor, rightMotor;
+	int endLedSet, returningLedSet, visitingLedSet;
+	int endLed, returningLed, visitingLed;
+
+	char say[CBC_MAX_SAY];    /* sent if not empty */
+
+	/* sensor ids, as in <SensorRequests>: IRSensor0, Beacon1, Ground... */
+	int nRequests;
+	char requests[CBC_MAX_REQUESTS][CBC_SENSOR_ID_LEN];
+};
+
+typedef int (*cbcApiFunction)(void);
+typedef void *(*cbcCreateFunction)(const char *name, int id, const struct cbcParameters *param);
+typedef void (*cbcStepFunction)(void *ctrl, const struct cbcMeasures *m, struct cbcActions *a);
+typedef void (*cbcDestroyFunction)(void *ctrl);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -42,7 +42,7 @@ cbControlPanel::cbControlPanel(cbSimulator *sim, QStringListModel *agents, QWidg
     connect(actionStop, SIGNAL(triggered()), simulator, SLOT(stop()));
 
     connect(ui->pushButton_StartStop, SIGNAL(clicked()), SLOT(triggerStartStop()));
-    connect(ui->pushButton_Reset, SIGNAL(clicked()), simulator, SLOT(reset()));
+    connect(ui->pushButton_Reset, SIGNAL(clicked()), SIGNAL(resetRequested()));
 
     ui->pushButton_Time->setChecked(simulator->isTimed());
     ui->pushButton_Lock->setChecked(simulator->isRegistrationAllowed());
@@ -63,6 +63,7 @@ cbControlPanel::cbControlPanel(cbSimulator *sim, QStringListModel *agents, QWidg
     ui->spinBox_Robot->setMinimum(1);
     ui->spinBox_Robot->setMaximum(simulator->Robots().size());
     connect(simulator, SIGNAL(gridChanged(int)), SLOT(resetRobSpinBox(int)));
+    connect(simulator, SIGNAL(robotCapacityChanged(int)), SLOT(resetRobSpinBox(int)));
 
     manRobWidget = new cbManageRobots(simulator, agents);
     ui->gridLayout->addWidget(manRobWidget,1,0,1,2);
@@ -115,6 +116,7 @@ void cbControlPanel::on_pushButton_Remove_clicked()
     unsigned int id = ui->spinBox_Robot->value();
     if (id >= 1 && id <= simulator->Robots().size())
     {
+        QMutexLocker lock(simulator->cycleLock());
         cbRobot *rob = simulator->Robots()[id-1];
         if (rob != 0)
             rob->remove();
@@ -51,6 +51,7 @@ public:
 
 signals:
     void closed();
+    void resetRequested();
 
 protected:
     virtual void closeEvent(QCloseEvent *);
@@ -0,0 +1,108 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "cbdiagnostics.h"
+
+#include <QMutexLocker>
+#include <string.h>
+
+cbDiagnostics::cbDiagnostics(unsigned int events, unsigned int textSize)
+	: subscription(0), ring(events), text(textSize), seq(0), textHead(0)
+{
+}
+
+void cbDiagnostics::subscribe(unsigned int types, int robot)
+{
+	subscription.fetchAndStoreRelaxed((int) ((types & 0xff) | (robot << 8)));
+}
+
+void cbDiagnostics::record(Type t, unsigned int time, int robot, const char *name,
+                           const char *txt, unsigned int length)
+{
+	QMutexLocker lock(&mutex);
+
+	if (length > text.size()) length = text.size();
+
+	cbDiagEvent &e = ring[seq % ring.size()];
+	e.seq = seq++;
+	e.time = time;
+	e.type = t;
+	e.robot = robot;
+	strncpy(e.name, name != 0 ? name : "", DIAG_NAME_SIZE - 1);
+	e.name[DIAG_NAME_SIZE - 1] = '\0';
+	e.pos = textHead;
+	e.length = length;
+
+	unsigned int at = (unsigned int) (textHead % text.size());
+	unsigned int first = text.size() - at;
+	if (first > length) first = length;
+	memcpy(&text[at], txt, first);
+	memcpy(&text[0], txt + first, length - first);
+	textHead += length;
+}
+
+unsigned int cbDiagnostics::read(unsigned int &next, vector<cbDiagEvent> &events,
+                                 vector<char> &texts, unsigned int max)
+{
+	events.clear();
+	texts.clear();
+
+	QMutexLocker lock(&mutex);
+
+	unsigned int dropped = 0;
+	if (seq - next > ring.size()) {
+		dropped = seq - next - ring.size();
+		next = seq - ring.size();
+	}
+
+	for (; next != seq && events.size() < max; next++) {
+		const cbDiagEvent &e = ring[next % ring.size()];
+		// the text was written over by newer messages
+		if (textHead - e.pos > text.size()) {
+			dropped++;
+			continue;
+		}
+
+		events.push_back(e);
+		events.back().pos = texts.size();
+
+		unsigned int at = (unsigned int) (e.pos % text.size());
+		unsigned int first = text.size() - at;
+		if (first > e.length) first = e.length;
+		texts.insert(texts.end(), text.begin() + at, text.begin() + at + first);
+		texts.insert(texts.end(), text.begin(), text.begin() + (e.length - first));
+		texts.push_back('\0');
+	}
+	return dropped;
+}
+
+QString cbDiagnostics::format(const cbDiagEvent &e, const char *txt)
+{
+	QString name = QString::fromLatin1(e.name);
+	switch (e.type) {
+	case MEASURES:
+		return "Measures sent to " + name + "(robot " + QString::number(e.robot) + "):\n" + txt;
+	case ACTION:
+		return name + " : " + txt;
+	case POSITION:
+		return "Position of " + name + " (robot " + QString::number(e.robot) + ") sent to Viewer(s):\n" + txt;
+	}
+	return QString(txt);
+}
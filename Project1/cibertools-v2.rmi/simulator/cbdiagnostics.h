@@ -0,0 +1,99 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef CBDIAGNOSTICS_H
+#define CBDIAGNOSTICS_H
+
+/*! \file cbdiagnostics.h
+	\brief Messages of the robots shown on the board of the GUI.
+
+	The kernel used to build the text of every measure, action and
+	position message for the GUI, and queue it to the GUI thread, before
+	the GUI looked at its check boxes. cbDiagnostics records them only
+	while a subscriber wants that type of message from that robot: the
+	check is one atomic load, and a recorded message is a copy of its
+	XML into a bounded ring, with no allocation. The text shown is built
+	by format(), when the GUI reads the ring at its own pace; the oldest
+	messages are dropped when it does not keep up.
+*/
+
+#include <QMutex>
+#include <QAtomicInt>
+#include <QString>
+#include <vector>
+
+using std::vector;
+
+#define DIAG_NAME_SIZE 32
+
+struct cbDiagEvent
+{
+	unsigned int seq;		// number of the message, from 0
+	unsigned int time;		// cycle of the simulation
+	int type;				// cbDiagnostics::Type
+	int robot;				// id of the robot
+	char name[DIAG_NAME_SIZE];	// of the robot, may be cut
+	unsigned long long pos;	// of the text, in bytes written to the ring
+	unsigned int length;	// of the text
+};
+
+class cbDiagnostics
+{
+public:
+	enum Type { MEASURES, ACTION, POSITION, NTYPES };
+
+	cbDiagnostics(unsigned int events = 1024, unsigned int textSize = 1 << 18);
+
+	/*! Messages of the given types (bit 1 << Type) and robot, 0 for all,
+	    are recorded from now on; a mask of 0 records nothing. */
+	void subscribe(unsigned int types, int robot);
+
+	inline bool wanted(Type t, int robot)
+	{
+		int s = subscription.fetchAndAddRelaxed(0);
+		return (s & (1 << t)) != 0 && ((s >> 8) == 0 || (s >> 8) == robot);
+	}
+
+	/*! Keeps a copy of the text, see wanted(). */
+	void record(Type t, unsigned int time, int robot, const char *name,
+	            const char *text, unsigned int length);
+
+	/*! Copies the messages from number next on, at most max of them:
+	    their header in events and their text, null terminated, in texts,
+	    where the pos of each event becomes the offset of its text.
+	    Advances next and returns the number of messages dropped before
+	    they could be read. */
+	unsigned int read(unsigned int &next, vector<cbDiagEvent> &events,
+	                  vector<char> &texts, unsigned int max);
+
+	/*! Text of the message as shown on the board. */
+	static QString format(const cbDiagEvent &e, const char *text);
+
+private:
+	QAtomicInt subscription;	// type mask in the low byte, robot above
+
+	QMutex mutex;
+	vector<cbDiagEvent> ring;
+	vector<char> text;
+	unsigned int seq;			// number of the next message
+	unsigned long long textHead;	// bytes written to text
+};
+
+#endif
@@ -19,9 +19,13 @@
 */
 
 #include "cbgrid.h"
+#include "cbxmlbuilder.h"
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <vector>
+
+using std::vector;
 
 cbGrid::cbGrid()
 {
@@ -37,20 +41,44 @@ cbGrid::~cbGrid()
 */
 int cbGrid::toXml(char *xml, int n)
 {
-    int cnt;
-    cnt = sprintf(xml, "<Grid>\n");
-    for (int i=0; i<count(); i++)
-	{
-		cbPosition pos = at(i);
-        cnt += sprintf(xml+cnt, "\t<Position X=\"%g\" Y=\"%g\" Dir=\"%g\"/>\n",
-                       pos.X(), pos.Y(), pos.directionInDegrees());
-	}
-    cnt += sprintf(xml+cnt, "</Grid>\n");
+    cbXmlBuilder x(xml, n);
+    write(x);
+    int cnt = x.length();
 
-    if(cnt>n) {
+    if(x.overflow()) {
         fprintf(stderr,"cbGrid::toXml message too long\n");
         abort();
     }
               
 	return cnt;
 }
+
+/*!
+	fill in xml with the grid as xml message, whatever its size.
+*/
+void cbGrid::toXml(string &xml)
+{
+	vector<char> buff(16*1024);
+	for (;;)
+	{
+		cbXmlBuilder x(&buff[0], buff.size());
+		write(x);
+		if (!x.overflow()) {
+			xml.assign(x.data(), x.length());
+			return;
+		}
+		buff.resize(buff.size()*2);
+	}
+}
+
+void cbGrid::write(cbXmlBuilder &x)
+{
+    x << "<Grid>\n";
+    for (int i=0; i<count(); i++)
+	{
+		cbPosition pos = at(i);
+        x << "\t<Position X=\"" << pos.X() << "\" Y=\"" << pos.Y()
+          << "\" Dir=\"" << pos.directionInDegrees() << "\"/>\n";
+	}
+    x << "</Grid>\n";
+}
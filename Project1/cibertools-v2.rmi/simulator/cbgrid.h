@@ -29,6 +29,11 @@
 #include "cbposition.h"
 
 #include <QVector>
+#include <string>
+
+using std::string;
+
+class cbXmlBuilder;
 
 /*!
 	\class cbGrid
@@ -42,8 +47,10 @@ public:
 	~cbGrid();
 
 	int toXml(char *buff, int cnt);
+	void toXml(string &xml);
 
 private:
+	void write(cbXmlBuilder &x);
 };
 
 #endif
@@ -22,6 +22,7 @@
 #include "cbtarget.h"
 #include "cbrobot.h"
 #include "cblab.h"
+#include "cbxmlbuilder.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -109,6 +110,16 @@ double cbLab::wallDistance(cbPoint &p)
 	return min;
 }
 
+bool cbLab::freeSpace(cbPoint &p, double clearance)
+{
+	if (p.X() < clearance || p.X() > width - clearance
+	    || p.Y() < clearance || p.Y() > height - clearance)
+		return false;
+	for (unsigned int i=1; i<walls.size(); i++)
+		if (walls[i]->contains(p)) return false;
+	return wallDistance(p) >= clearance;
+}
+
 /*!
 	Determine and return minimum distance from given
 	point, in given direction to any wall in lab.
@@ -174,41 +185,65 @@ double cbLab::cornerDistance(cbPoint &p, double dir, double range)
 	Returns the number of positions filled in.
 */
 int cbLab::toXml(char *buff, int n)
+{
+	cbXmlBuilder x(buff, n);
+	write(x);
+	int cnt = x.length();
+
+        if(x.overflow()) {
+             fprintf(stderr,"cbLab::toXml message too long\n");
+             abort();
+        }
+	return cnt;
+}
+
+/*!
+	Fill in xml with the XML representation of the lab, whatever its size.
+*/
+void cbLab::toXml(string &xml)
+{
+	vector<char> buff(64*1024);
+	for (;;)
+	{
+		cbXmlBuilder x(&buff[0], buff.size());
+		write(x);
+		if (!x.overflow()) {
+			xml.assign(x.data(), x.length());
+			return;
+		}
+		buff.resize(buff.size()*2);
+	}
+}
+
+void cbLab::write(cbXmlBuilder &x)
 {
 	unsigned int i;
-	int cnt = 0;
-	cnt += sprintf(buff, "<Lab Name=\"%s\" Height=\"%g\" Width=\"%g\">\n", name, height, width);
+	x << "<Lab Name=\"" << name << "\" Height=\"" << height << "\" Width=\"" << width << "\">\n";
 	for (i=0; i<beacons.size(); i++)
 	{
 		cbPoint &p = beacons[i]->Center();
 		double h = beacons[i]->Height();
-		cnt += sprintf(buff+cnt, "\t<Beacon X=\"%g\" Y=\"%g\" Height=\"%g\"/>\n", p.X(), p.Y(), h);
+		x << "\t<Beacon X=\"" << p.X() << "\" Y=\"" << p.Y() << "\" Height=\"" << h << "\"/>\n";
 	}
 	for (i=0; i<targets.size(); i++)
 	{
 		cbPoint &p = targets[i]->Center();
 		double r = targets[i]->Radius();
-		cnt += sprintf(buff+cnt, "\t<Target X=\"%g\" Y=\"%g\" Radius=\"%g\"/>\n", p.X(), p.Y(), r);
+		x << "\t<Target X=\"" << p.X() << "\" Y=\"" << p.Y() << "\" Radius=\"" << r << "\"/>\n";
 	}
 	for (i=1; i<walls.size(); i++)
 	{
 		cbWall *wall = walls[i];
-		cnt += sprintf(buff+cnt, "\t<Wall Height=\"%g\">\n", wall->Height());
+		x << "\t<Wall Height=\"" << wall->Height() << "\">\n";
 		vector<cbPoint> *corners = &(wall->Corners());
 		for (unsigned int j=0; j<corners->size(); j++)
 		{
 			cbPoint p = (*corners)[j];
-			cnt += sprintf(buff+cnt, "\t\t<Corner X=\"%g\" Y=\"%g\"/>\n", p.X(), p.Y());
+			x << "\t\t<Corner X=\"" << p.X() << "\" Y=\"" << p.Y() << "\"/>\n";
 		}
-		cnt += sprintf(buff+cnt, "\t</Wall>\n");
+		x << "\t</Wall>\n";
 	}
-	cnt += sprintf(buff+cnt, "</Lab>\n");
-
-        if(cnt>n-1) {
-             fprintf(stderr,"cbLab::toXml message too long\n");
-             abort();
-        }
-	return cnt;
+	x << "</Lab>\n";
 }
 
 bool cbLab::reachable(cbPoint i,cbPoint f)
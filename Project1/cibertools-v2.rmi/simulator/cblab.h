@@ -30,7 +30,11 @@
 #include "cbbeacon.h"
 
 #include <vector>
+#include <string>
 using std::vector;
+using std::string;
+
+class cbXmlBuilder;
 
 /**
  * models the labirinth where robots move
@@ -57,6 +61,9 @@ public:
 	void addWall(cbWall *wall);
 
 	double wallDistance(cbPoint &);
+	/*! True if p is inside the border, out of every wall and at least
+	    clearance away from them. */
+	bool freeSpace(cbPoint &p, double clearance);
     double wallDistance(cbPoint &, double);
     double wallDistanceAboveHeight(cbPoint &p, double dir, double height);
 	double cornerDistance(cbPoint &, double, double);
@@ -65,6 +72,7 @@ public:
 	inline cbBeacon *Beacon(int i) { return beacons[i]; }
 
 	int toXml(char *buff, int n);
+	void toXml(string &xml);
 
     bool reachable(cbPoint i, cbPoint f);
     bool reachableRobot(cbPoint i, cbPoint f);
@@ -72,6 +80,7 @@ public:
     unsigned int    nWalls(void) { return walls.size();}
     cbWall * Wall(int index) { return walls[index];}
 private:
+	void write(cbXmlBuilder &x);
 	
     const char *name;		// the name of the lab (default "NO NAME LAB")
 	double height, width;	// the height and width (default 16.0 for both)
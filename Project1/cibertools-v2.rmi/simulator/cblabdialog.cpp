@@ -252,6 +252,8 @@ void cbLabDialog::restoreDefaults(void)
 
 void cbLabDialog::accept()
 {
+    QMutexLocker lock(simulator->cycleLock());
+
     if (labFileName.isEmpty())
     {
         simulator->setDefaultLab();
@@ -0,0 +1,491 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "cblogwriter.h"
+#include "cbxmlbuilder.h"
+
+#include <QTime>
+
+#include <iostream>
+#include <stdio.h>
+#include <string.h>
+
+using std::cerr;
+
+cbLogRobotRecord &cbLogRecord::addRobot()
+{
+	if(nRobots == robots.size())
+		robots.push_back(cbLogRobotRecord());
+	return robots[nRobots++];
+}
+
+cbLogWriter::cbLogWriter(unsigned int capacity, unsigned int bSize)
+{
+	unsigned int size = 1;
+	while(size < capacity) size <<= 1;
+
+	ring.resize(size);
+	mask = size - 1;
+	batchSize = bSize;
+	opened = false;
+	binary = false;
+	binFailed = false;
+
+	head = 0;
+	tail = 0;
+	stopping = 0;
+	writerSleeping = 0;
+	producerSleeping = 0;
+
+	memset(&st, 0, sizeof(st));
+	st.capacity = size;
+}
+
+cbLogWriter::~cbLogWriter()
+{
+	close();
+}
+
+bool cbLogWriter::open(const char *filename)
+{
+	if(opened) close();
+
+	out.clear();
+	out.open(filename);
+	if(!out.is_open()) return false;
+
+	binary = false;
+	startWriter();
+
+	return true;
+}
+
+/*!
+	Opens a binary log. Text written with writeText is ignored, the log
+	header is given here: date (0 if none) and the Parameters, Lab and
+	Grid XML, and the number of beacons and targets of the lab.
+*/
+bool cbLogWriter::openBinary(const char *filename, const char *date, const string &preamble,
+                             unsigned int nBeacons, unsigned int nTargets)
+{
+	if(opened) close();
+
+	if(!bin.open(filename, date, preamble, nBeacons, nTargets)) return false;
+	binFailed = false;
+
+	binary = true;
+	startWriter();
+
+	return true;
+}
+
+void cbLogWriter::startWriter(void)
+{
+	head = 0;
+	tail = 0;
+	stopping = 0;
+	writerSleeping = 0;
+	producerSleeping = 0;
+	memset(&st, 0, sizeof(st));
+	st.capacity = ring.size();
+
+	opened = true;
+	QThread::start();
+}
+
+void cbLogWriter::close(void)
+{
+	if(!opened) return;
+
+	stopping.fetchAndStoreRelease(1);
+	mutex.lock();
+	dataAvailable.wakeOne();
+	mutex.unlock();
+	wait();
+
+	if(binary) bin.close();
+	else out.close();
+	opened = false;
+
+	if(binary) {
+		st.bytes = bin.bytesWritten();
+		st.writes = bin.writes();
+	}
+}
+
+/*!
+	Returns the next free slot of the queue, already reset to the given type.
+	If the writer has fallen behind and the queue is full the simulation
+	waits for a free slot: no record is ever dropped, the stall is only
+	accounted for in the statistics.
+*/
+cbLogRecord *cbLogWriter::acquire(cbLogRecord::Type type)
+{
+	unsigned int h = (unsigned int) head.fetchAndAddAcquire(0);
+	unsigned int queued = h - (unsigned int) tail.fetchAndAddAcquire(0);
+
+	if(queued >= ring.size()) {
+		QTime t;
+		t.start();
+
+		producerSleeping.fetchAndStoreOrdered(1);
+		mutex.lock();
+		while((queued = h - (unsigned int) tail.fetchAndAddOrdered(0)) >= ring.size())
+			spaceAvailable.wait(&mutex, 10);
+		mutex.unlock();
+		producerSleeping.fetchAndStoreRelease(0);
+
+		st.stalls++;
+		st.stallTime += t.elapsed();
+	}
+	if(queued + 1 > st.highWater) st.highWater = queued + 1;
+
+	cbLogRecord *rec = &ring[h & mask];
+	rec->type = type;
+	rec->text.clear();
+	rec->time = 0;
+	rec->nRobots = 0;
+
+	return rec;
+}
+
+/*!
+	Publishes the slot returned by acquire. The mutex is only taken when
+	the writer said it is going to sleep: it sets writerSleeping before
+	checking head again under the mutex, so either it sees the new head
+	or the wake is done after it started to wait.
+*/
+void cbLogWriter::commit(void)
+{
+	head.fetchAndAddOrdered(1);
+	if(writerSleeping.fetchAndAddOrdered(0)) {
+		mutex.lock();
+		dataAvailable.wakeOne();
+		mutex.unlock();
+	}
+}
+
+void cbLogWriter::writeText(const char *text)
+{
+	cbLogRecord *rec = acquire(cbLogRecord::TEXT);
+	rec->text = text;
+	commit();
+}
+
+cbLogWriterStats cbLogWriter::stats(void)
+{
+	cbLogWriterStats s = st;
+
+	statsMutex.lock();
+	s.records = st.records;
+	s.bytes = st.bytes;
+	s.writes = st.writes;
+	statsMutex.unlock();
+
+	return s;
+}
+
+void cbLogWriter::run()
+{
+	string batch;
+	batch.reserve(batchSize + 64*1024);
+
+	for(;;) {
+		unsigned int t = (unsigned int) tail.fetchAndAddAcquire(0);
+		unsigned int h = (unsigned int) head.fetchAndAddAcquire(0);
+
+		if(t == h) {
+			if(!batch.empty()) flush(batch);
+			if(stopping.fetchAndAddAcquire(0)) {
+				/* producer may have committed before setting stopping */
+				if((unsigned int) head.fetchAndAddAcquire(0) == t) break;
+				continue;
+			}
+			writerSleeping.fetchAndStoreOrdered(1);
+			mutex.lock();
+			if((unsigned int) head.fetchAndAddOrdered(0) == t)
+				dataAvailable.wait(&mutex, 20);
+			mutex.unlock();
+			writerSleeping.fetchAndStoreRelease(0);
+			continue;
+		}
+
+		unsigned int nRecords = 0;
+		while(t != h) {
+			if(binary) encode(ring[t & mask]);
+			else formatRecord(ring[t & mask], batch);
+			t++;
+			nRecords++;
+			tail.fetchAndStoreOrdered(t);
+			/* same handshake as commit, the producer waits for a free slot */
+			if(producerSleeping.fetchAndAddOrdered(0)) {
+				mutex.lock();
+				spaceAvailable.wakeOne();
+				mutex.unlock();
+			}
+
+			if(batch.size() >= batchSize) break;
+		}
+
+		statsMutex.lock();
+		st.records += nRecords;
+		statsMutex.unlock();
+
+		if(batch.size() >= batchSize) flush(batch);
+	}
+
+	if(!binary) out.flush();
+}
+
+void cbLogWriter::encode(const cbLogRecord &rec)
+{
+	if(rec.type != cbLogRecord::LOGINFO) return;
+
+	binRobots.resize(rec.nRobots);
+	for(unsigned int i=0; i < rec.nRobots; i++)
+		toBinary(rec.robots[i], binRobots[i]);
+	/* the writer already said why; stop there rather than leave holes */
+	if(!binFailed && !bin.writeCycle(rec.time, binRobots)) {
+		cerr << "ERROR: Binary log stopped at time " << rec.time << "\n";
+		binFailed = true;
+	}
+
+	statsMutex.lock();
+	st.bytes = bin.bytesWritten();
+	st.writes = bin.writes();
+	statsMutex.unlock();
+}
+
+void cbLogWriter::flush(string &batch)
+{
+	out.write(batch.data(), batch.size());
+
+	statsMutex.lock();
+	st.bytes += batch.size();
+	st.writes++;
+	statsMutex.unlock();
+
+	batch.clear();
+}
+
+/*!
+	Appends the log entry of one robot to out.
+	The output is the same that was produced by streaming the robot state
+	into an ostream: doubles use the default stream format, that is %g.
+*/
+void cbLogWriter::formatRobot(const cbLogRobotRecord &r, string &out)
+{
+	char xml[1024*16];
+	cbXmlBuilder x(xml, sizeof(xml));
+
+	out += "\t<Robot Name=\"";
+	out += r.name;
+	x << "\" Id=\"" << r.id << "\" State=\"" << r.state << "\">\n";
+	x << "\t\t<Pos X=\"" << r.x << "\" Y=\"" << r.y << "\" Dir=\"" << r.dir << "\"/>\n";
+	x << "\t\t<Scores Score=\"" << r.score << "\" ArrivalTime=\"" << r.arrivalTime
+	  << "\" ReturningTime=\"" << r.returningTime << "\" Collisions=\"" << r.collisions
+	  << "\" Collision=\"" << (r.collision ? "True" : "False") << "\" VisitedMask=\"";
+	out.append(xml, x.length());
+	out += r.visitedMask;
+	out += "\"/>\n";
+
+	if(r.actions) {
+		x.clear();
+		x << "\t\t<Action";
+		if(r.actions & cbLogRobotRecord::LEFT_MOTOR)
+			x << " LeftMotor=\"" << r.leftMotor << '"';
+		if(r.actions & cbLogRobotRecord::RIGHT_MOTOR)
+			x << " RightMotor=\"" << r.rightMotor << '"';
+		if(r.actions & cbLogRobotRecord::END_LED)
+			x << " EndLed=\"" << (r.endLed ? "On" : "Off") << '"';
+		if(r.actions & cbLogRobotRecord::RETURNING_LED)
+			x << " ReturningLed=\"" << (r.returningLed ? "On" : "Off") << '"';
+		if(r.actions & cbLogRobotRecord::VISITING_LED)
+			x << " VisitingLed=\"" << (r.visitingLed ? "On" : "Off") << '"';
+		x << " />\n";
+		out.append(xml, x.length());
+	}
+
+	if(r.withMeasures) {
+		x.clear();
+		x << "<Measures Time=\"" << r.time << "\">\n";
+		/* add sensor information */
+		x << "\t<Sensors";
+		x << " Compass=\"" << r.compass << '"';
+		x << " Collision=\"" << (r.collisionSensor ? "Yes" : "No") << '"';
+		x << " Ground=\"" << r.ground << "\">\n";
+
+		for(unsigned int i=0; i < r.irSensors.size(); i++)
+			x << "\t\t<IRSensor Id=\"" << i << "\" Value=\"" << r.irSensors[i] << "\"/>\n";
+
+		for(unsigned int b=0; b < r.beacons.size(); b++) {
+			x << "\t\t<BeaconSensor Id=\"" << (int) r.beacons[b].id << "\" Value=";
+			if(r.beacons[b].visible)
+				x << '"' << r.beacons[b].degrees << '"';
+			else
+				x << "\"NotVisible\"";
+			x << "/>\n";
+			if(x.length() > sizeof(xml) - 1024) {
+				out.append(xml, x.length());
+				x.clear();
+			}
+		}
+
+		if(r.gps) {
+			x << "\t\t<GPS X=\"" << r.gpsX << "\" Y=\"" << r.gpsY << "\" ";
+			if(r.gpsDir) x << " Dir=\"" << r.gpsDegrees << "\" ";
+			x << "/>\n";
+		}
+
+		x << "\t</Sensors>\n";
+		/* add end led information */
+		x << "\t<Leds EndLed=\"" << (r.endLed ? "On" : "Off") << "\" ReturningLed=\""
+		  << (r.returningLed ? "On" : "Off") << "\" VisitingLed=\"" << (r.visitingLed ? "On" : "Off") << "\"/>\n";
+		/* add buttons information */
+		x << "\t<Buttons Start=\"" << (r.startButton ? "On" : "Off")
+		  << "\" Stop=\"" << (r.stopButton ? "On" : "Off") << "\"/>\n";
+		x << "</Measures>\n";
+		out.append(xml, x.length());
+	}
+
+	out += "\t</Robot>\n";
+}
+
+void cbLogWriter::formatRecord(const cbLogRecord &rec, string &out)
+{
+	char buff[64];
+
+	if(rec.type == cbLogRecord::TEXT) {
+		out += rec.text;
+		return;
+	}
+
+	cbXmlBuilder x(buff, sizeof(buff));
+	x << "<LogInfo Time=\"" << rec.time << "\">\n";
+	out.append(buff, x.length());
+	for(unsigned int i=0; i < rec.nRobots; i++)
+		formatRobot(rec.robots[i], out);
+	out += "</LogInfo>\n";
+}
+
+void cbLogWriter::toBinary(const cbLogRobotRecord &r, cbBinLogRobot &b)
+{
+	b.clear();
+
+	b.name = r.name;
+	b.id = r.id;
+	int state = cbBinLogState(r.state);
+	b.state = state < 0 ? 0 : state;
+
+	b.x = r.x; b.y = r.y; b.dir = r.dir;
+	b.score = r.score;
+	b.arrivalTime = r.arrivalTime;
+	b.returningTime = r.returningTime;
+	b.collisions = r.collisions;
+	if(r.collision) b.flags |= cbBinLogRobot::COLLISION;
+
+	b.visitedMask = r.visitedMask;
+
+	b.actions = r.actions;
+	b.leftMotor = r.leftMotor;
+	b.rightMotor = r.rightMotor;
+
+	if(r.endLed) b.flags |= cbBinLogRobot::END_LED;
+	if(r.returningLed) b.flags |= cbBinLogRobot::RETURNING_LED;
+	if(r.visitingLed) b.flags |= cbBinLogRobot::VISITING_LED;
+
+	if(!r.withMeasures) return;
+
+	b.flags |= cbBinLogRobot::MEASURES;
+	b.time = r.time;
+	b.compass = r.compass;
+	if(r.collisionSensor) b.flags |= cbBinLogRobot::COLLISION_SENSOR;
+	b.ground = r.ground;
+	/* more IR sensors than the log has room for are refused by the writer */
+	b.nIRSensors = r.irSensors.size() < 255 ? r.irSensors.size() : 255;
+	for(unsigned int i=0; i < r.irSensors.size() && i < CB_BINLOG_IR_SENSORS; i++)
+		b.irSensors[i] = r.irSensors[i];
+	b.beacons.resize(r.beacons.size());
+	for(unsigned int i=0; i < r.beacons.size(); i++) {
+		b.beacons[i].id = r.beacons[i].id;
+		b.beacons[i].visible = r.beacons[i].visible;
+		b.beacons[i].degrees = r.beacons[i].visible ? r.beacons[i].degrees : 0.0;
+	}
+	if(r.gps) {
+		b.flags |= cbBinLogRobot::GPS;
+		b.gpsX = r.gpsX;
+		b.gpsY = r.gpsY;
+		if(r.gpsDir) {
+			b.flags |= cbBinLogRobot::GPS_DIR;
+			b.gpsDir = r.gpsDegrees;
+		}
+	}
+	if(r.startButton) b.buttons |= cbBinLogRobot::START;
+	if(r.stopButton) b.buttons |= cbBinLogRobot::STOP;
+}
+
+void cbLogWriter::fromBinary(const cbBinLogRobot &b, cbLogRobotRecord &r)
+{
+	r.name = b.name;
+	r.id = b.id;
+	r.state = cbBinLogStateName(b.state);
+
+	r.x = b.x; r.y = b.y; r.dir = b.dir;
+	r.score = b.score;
+	r.arrivalTime = b.arrivalTime;
+	r.returningTime = b.returningTime;
+	r.collisions = b.collisions;
+	r.collision = (b.flags & cbBinLogRobot::COLLISION) != 0;
+
+	r.visitedMask = b.visitedMask;
+
+	r.actions = b.actions;
+	r.leftMotor = b.leftMotor;
+	r.rightMotor = b.rightMotor;
+
+	r.endLed = (b.flags & cbBinLogRobot::END_LED) != 0;
+	r.returningLed = (b.flags & cbBinLogRobot::RETURNING_LED) != 0;
+	r.visitingLed = (b.flags & cbBinLogRobot::VISITING_LED) != 0;
+
+	r.withMeasures = (b.flags & cbBinLogRobot::MEASURES) != 0;
+	r.irSensors.clear();
+	r.beacons.clear();
+	if(!r.withMeasures) return;
+
+	r.time = b.time;
+	r.compass = b.compass;
+	r.collisionSensor = (b.flags & cbBinLogRobot::COLLISION_SENSOR) != 0;
+	r.ground = b.ground;
+	r.irSensors.assign(b.irSensors, b.irSensors + b.nIRSensors);
+	for(unsigned int i=0; i < b.beacons.size(); i++) {
+		cbLogBeaconRecord beacon;
+		beacon.id = b.beacons[i].id;
+		beacon.visible = b.beacons[i].visible;
+		beacon.degrees = b.beacons[i].degrees;
+		r.beacons.push_back(beacon);
+	}
+	r.gps = (b.flags & cbBinLogRobot::GPS) != 0;
+	r.gpsDir = (b.flags & cbBinLogRobot::GPS_DIR) != 0;
+	r.gpsX = b.gpsX;
+	r.gpsY = b.gpsY;
+	r.gpsDegrees = b.gpsDir;
+	r.startButton = (b.buttons & cbBinLogRobot::START) != 0;
+	r.stopButton = (b.buttons & cbBinLogRobot::STOP) != 0;
+}
@@ -0,0 +1,184 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef CBLOGWRITER_H
+#define CBLOGWRITER_H
+
+/*! \file cblogwriter.h
+	\brief Asynchronous writer of simulator logs.
+
+	The simulation thread only captures a compact record of the state of
+	each robot (cbLogRobotRecord) into a preallocated single producer /
+	single consumer ring. A background thread formats the records into
+	the usual XML log, or encodes them into a binary log (cbbinlog.h),
+	and writes them to disk in large batches.
+*/
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "cbbinlog.h"
+
+using std::ofstream;
+using std::string;
+using std::vector;
+
+struct cbLogBeaconRecord
+{
+	unsigned int id;
+	bool visible;
+	double degrees;
+};
+
+/**
+ * State of one robot in one cycle, as needed to write its log entry.
+ */
+struct cbLogRobotRecord
+{
+	enum ActionFlags { LEFT_MOTOR=1, RIGHT_MOTOR=2, END_LED=4,
+	                   RETURNING_LED=8, VISITING_LED=16 };
+
+	string name;
+	unsigned int id;
+	const char *state;
+
+	double x, y, dir;
+
+	unsigned int score, arrivalTime, returningTime, collisions;
+	bool collision;
+	string visitedMask;
+
+	unsigned int actions;   // ActionFlags of the received action, 0 if none
+	double leftMotor, rightMotor;
+
+	bool withMeasures;
+	unsigned int time;
+	double compass;
+	bool collisionSensor;
+	int ground;
+	vector<double> irSensors;
+	vector<cbLogBeaconRecord> beacons;  // only beacons that are ready
+	bool gps, gpsDir;
+	double gpsX, gpsY, gpsDegrees;
+	bool endLed, returningLed, visitingLed;
+	bool startButton, stopButton;
+};
+
+/**
+ * One slot of the writer queue: either a piece of literal text
+ * (log header and trailer) or a full LogInfo item.
+ */
+struct cbLogRecord
+{
+	enum Type { TEXT, LOGINFO };
+
+	Type type;
+	string text;
+	unsigned int time;
+	unsigned int nRobots;          // robots[0..nRobots-1] are valid
+	vector<cbLogRobotRecord> robots;
+
+	/* returns the next robot record, reusing previously allocated ones */
+	cbLogRobotRecord &addRobot();
+};
+
+/**
+ * Back-pressure statistics of the writer.
+ */
+struct cbLogWriterStats
+{
+	unsigned long records;   // records written
+	unsigned long bytes;     // bytes written
+	unsigned long writes;    // write calls to the stream
+	unsigned long stalls;    // times the simulation waited for a free slot
+	double        stallTime; // total time waited, in ms
+	unsigned int  highWater; // max number of queued records
+	unsigned int  capacity;  // size of the queue
+};
+
+class cbLogWriter : public QThread
+{
+public:
+	cbLogWriter(unsigned int capacity=256, unsigned int batchSize=256*1024);
+	~cbLogWriter();
+
+	bool open(const char *filename);  // returns false in case of error
+	bool openBinary(const char *filename, const char *date, const string &preamble,
+	                unsigned int nBeacons, unsigned int nTargets);
+	void close(void);                 // flushes every queued record
+	inline bool isOpen(void) { return opened; }
+	inline bool isBinary(void) { return binary; }
+
+	/* producer side, to be used only by the simulation thread */
+	cbLogRecord *acquire(cbLogRecord::Type type);
+	void commit(void);
+	void writeText(const char *text);
+
+	cbLogWriterStats stats(void);
+
+	/* formatting, shared with cbRobot::Log */
+	static void formatRobot(const cbLogRobotRecord &rec, string &out);
+	static void formatRecord(const cbLogRecord &rec, string &out);
+
+	/* conversion to and from the binary log records */
+	static void toBinary(const cbLogRobotRecord &rec, cbBinLogRobot &bin);
+	static void fromBinary(const cbBinLogRobot &bin, cbLogRobotRecord &rec);
+
+protected:
+	void run();
+
+private:
+	void startWriter(void);
+	void flush(string &batch);
+	void encode(const cbLogRecord &rec);
+
+	ofstream out;
+	bool opened;
+
+	bool binary;
+	cbBinLogWriter bin;
+	bool binFailed;    // a cycle did not fit the binary log, nothing more is written
+	vector<cbBinLogRobot> binRobots;
+
+	vector<cbLogRecord> ring;
+	unsigned int mask;
+	unsigned int batchSize;
+
+	QAtomicInt head;   // next slot to be filled by the producer
+	QAtomicInt tail;   // next slot to be formatted by the writer
+	QAtomicInt stopping;
+	QAtomicInt writerSleeping;    // set by the writer before it waits for data
+	QAtomicInt producerSleeping;  // set by the producer before it waits for space
+
+	QMutex mutex;      // only taken by a side that sleeps, or that wakes a sleeper
+	QWaitCondition dataAvailable;
+	QWaitCondition spaceAvailable;
+
+	QMutex statsMutex;
+	cbLogWriterStats st;
+};
+
+#endif
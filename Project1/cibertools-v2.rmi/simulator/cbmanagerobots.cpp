@@ -40,6 +40,7 @@ cbManageRobots::cbManageRobots(cbSimulator *sim, QStringListModel *agents, QWidg
     connect(simulator, SIGNAL(toggleRegistrations(bool)), SLOT(tryEnableAddRobot(bool)));
 
     connect(simulator, SIGNAL(gridChanged(int)), SLOT(resetRobWidgets(int)));
+    connect(simulator, SIGNAL(robotCapacityChanged(int)), SLOT(growRobWidgets(int)));
 
     connect(ui->listView_Agents->selectionModel(),
             SIGNAL(currentRowChanged(QModelIndex,QModelIndex)), SLOT(currentAgentChanged(QModelIndex,QModelIndex)));
@@ -93,10 +94,38 @@ void cbManageRobots::resetRobWidgets(int size)
 
 }
 
+/*!
+	Adds the rows of the positions added beyond the grid.
+*/
+void cbManageRobots::growRobWidgets(int size)
+{
+    if (size <= nRobots) return;
+
+    ui->tableWidget_Robots->setRowCount(size);
+    for (int i = nRobots; i < size; i++)
+    {
+        QTableWidgetItem *idItem = new QTableWidgetItem(QString::number(i+1));
+        idItem->setFlags(Qt::ItemIsSelectable);
+        QTableWidgetItem *nameItem = new QTableWidgetItem("--Free--");
+        nameItem->setFlags(Qt::ItemIsSelectable);
+
+        ui->tableWidget_Robots->setItem(i, 0, idItem);
+        ui->tableWidget_Robots->setItem(i, 1, nameItem);
+
+        QLabel *state = new QLabel("");
+        state->setEnabled(false);
+        ui->tableWidget_Robots->setCellWidget(i,2,state);
+    }
+    nRobots = size;
+
+    refreshPosComboBox();
+}
+
 void cbManageRobots::addRobWidget(int id)
 {
-    cbRobot *robot = simulator->Robots()[id-1];
-    if (id >= 1 && id <= nRobots && robot != 0)
+    QMutexLocker lock(simulator->cycleLock());
+    cbRobot *robot = id >= 1 && id <= nRobots ? simulator->Robots()[id-1] : 0;
+    if (robot != 0)
     {
         ui->tableWidget_Robots->item(id-1,0)->setFlags(Qt::ItemIsSelectable |  Qt::ItemIsEnabled);
         ui->tableWidget_Robots->item(id-1,1)->setText(QString(robot->Name()));
@@ -113,6 +142,7 @@ void cbManageRobots::addRobWidget(int id)
 
 void cbManageRobots::removeRobWidget(int id)
 {
+    QMutexLocker lock(simulator->cycleLock());
     if (id >= 1 && id <= nRobots && simulator->Robots()[id-1] == 0)
     {
         ui->tableWidget_Robots->item(id-1,0)->setFlags(Qt::ItemIsSelectable);
@@ -129,6 +159,7 @@ void cbManageRobots::removeRobWidget(int id)
 void cbManageRobots::refreshPosComboBox(void)
 {
     ui->comboBox_Position->clear();
+    QMutexLocker lock(simulator->cycleLock());
     for (int i = 0; i < nRobots; i++)
     {
         if (simulator->Robots()[i] == 0)
@@ -226,8 +257,8 @@ void cbManageRobots::on_pushButton_DeleteRobot_clicked()
     for (int i = 0; i < ui->tableWidget_Robots->rowCount(); i++)
     {
         QTableWidgetItem *curItem = ui->tableWidget_Robots->item(i,0);
-        if (curItem->isSelected())
-            simulator->deleteRobot(i+1);
+        if (curItem->isSelected())   // robots are deleted by the kernel thread
+            QMetaObject::invokeMethod(simulator, "deleteRobot", Qt::QueuedConnection, Q_ARG(uint, i+1));
     }
     ui->tableWidget_Robots->clearSelection();
 }
@@ -54,6 +54,7 @@ protected:
     
 private slots:
     void resetRobWidgets(int);
+    void growRobWidgets(int);
     void refreshPosComboBox();
 
     void addRobWidget(int id);
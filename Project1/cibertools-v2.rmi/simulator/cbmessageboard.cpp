@@ -0,0 +1,124 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "cbmessageboard.h"
+#include "cbrobot.h"
+#include "cbpoint.h"
+
+#include <QByteArray>
+#include <algorithm>
+#include <math.h>
+
+cbMessageBoard::cbMessageBoard()
+	: range(MESSAGE_DIST_LIMIT), cellSize(MESSAGE_DIST_LIMIT), minX(0), minY(0), cols(0), rows(0)
+{
+}
+
+void cbMessageBoard::post(const vector<cbRobot *> &robots, double r)
+{
+	messages.clear();
+	texts.clear();
+	range = r;
+
+	double maxX = 0, maxY = 0;
+	for (unsigned int i = 0; i < robots.size(); i++) {
+		cbRobot *robot = robots[i];
+		if (robot == 0) continue;
+		const QString &say = robot->getSayMessage();
+		if (say.isEmpty()) continue;
+
+		Message m;
+		m.from = i + 1;
+		m.x = robot->Center().X();
+		m.y = robot->Center().Y();
+		QByteArray latin = say.toLatin1();
+		m.offset = texts.size();
+		m.length = latin.size();
+		texts.insert(texts.end(), latin.constData(), latin.constData() + latin.size() + 1);
+
+		if (messages.empty() || m.x < minX) minX = m.x;
+		if (messages.empty() || m.y < minY) minY = m.y;
+		if (messages.empty() || m.x > maxX) maxX = m.x;
+		if (messages.empty() || m.y > maxY) maxY = m.y;
+		messages.push_back(m);
+	}
+
+	unsigned int n = messages.size();
+	if (n == 0) {
+		cols = rows = 0;
+		return;
+	}
+
+	/* cells as large as the range, larger if the speakers are few and
+	   far apart, so that the grid stays in proportion to the messages */
+	cellSize = range > 0 ? range : 1.0;
+	for (;;) {
+		cols = (int) ((maxX - minX) / cellSize) + 1;
+		rows = (int) ((maxY - minY) / cellSize) + 1;
+		if ((double) cols * rows <= 4.0 * n + 64) break;
+		cellSize *= 2;
+	}
+
+	/* counting sort of the messages by cell, robot order kept in each cell */
+	cellStart.assign(cols * rows + 1, 0);
+	for (unsigned int i = 0; i < n; i++) {
+		Message &m = messages[i];
+		m.cell = (int) ((m.y - minY) / cellSize) * cols + (int) ((m.x - minX) / cellSize);
+		cellStart[m.cell + 1]++;
+	}
+	for (int c = 0; c < cols * rows; c++)
+		cellStart[c + 1] += cellStart[c];
+	order.resize(n);
+	vector<unsigned int> fill(cellStart.begin(), cellStart.end() - 1);
+	for (unsigned int i = 0; i < n; i++)
+		order[fill[messages[i].cell]++] = i;
+}
+
+unsigned int cbMessageBoard::heard(cbPoint &p, vector<unsigned int> &out, unsigned int maxBytes) const
+{
+	out.clear();
+	if (messages.empty()) return 0;
+
+	int cx = (int) floor((p.X() - minX) / cellSize);
+	int cy = (int) floor((p.Y() - minY) / cellSize);
+	int x0 = std::max(cx - 1, 0), x1 = std::min(cx + 1, cols - 1);
+	int y0 = std::max(cy - 1, 0), y1 = std::min(cy + 1, rows - 1);
+
+	for (int y = y0; y <= y1; y++)
+		for (int x = x0; x <= x1; x++) {
+			int c = y * cols + x;
+			for (unsigned int k = cellStart[c]; k < cellStart[c + 1]; k++) {
+				const Message &m = messages[order[k]];
+				if (p.distance(m.x, m.y) < range)
+					out.push_back(order[k]);
+			}
+		}
+	std::sort(out.begin(), out.end());
+
+	if (maxBytes > 0) {
+		unsigned int bytes = 0, i;
+		for (i = 0; i < out.size(); i++) {
+			bytes += messages[out[i]].length;
+			if (bytes > maxBytes) break;
+		}
+		out.resize(i);
+	}
+	return out.size();
+}
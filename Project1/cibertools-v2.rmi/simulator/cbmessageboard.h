@@ -0,0 +1,86 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef CBMESSAGEBOARD_H
+#define CBMESSAGEBOARD_H
+
+/*! \file cbmessageboard.h
+	\brief The Say messages of one cycle, and who hears them.
+
+	A robot hears the messages said in the cycle by the robots, itself
+	included, that are less than MESSAGE_DIST_LIMIT away. Every robot
+	used to go through all the others and encode their messages again,
+	n^2 string copies per cycle.
+
+	cbSimulator::SendSensors now posts the messages once per cycle: each
+	one is encoded in Latin-1 into a flat buffer and its speaker is put
+	in a uniform grid of cells at least as large as the range, so the
+	messages heard at a point are found in the 3x3 cells around it.
+*/
+
+#include <vector>
+
+using std::vector;
+
+class cbRobot;
+class cbPoint;
+
+#define MESSAGE_DIST_LIMIT 8.0
+
+class cbMessageBoard
+{
+public:
+	cbMessageBoard();
+
+	/*! Takes the messages said by the robots in this cycle; the ones of
+	    the previous cycle are dropped. */
+	void post(const vector<cbRobot *> &robots, double range = MESSAGE_DIST_LIMIT);
+
+	/*! Fills out with the messages heard at p, in the order of the robots
+	    that said them. Stops before the total text would exceed maxBytes,
+	    0 is no limit. Returns the number of messages. */
+	unsigned int heard(cbPoint &p, vector<unsigned int> &out, unsigned int maxBytes = 0) const;
+
+	inline unsigned int count() const { return messages.size(); }
+	/*! Id of the robot that said message i. */
+	inline unsigned int from(unsigned int i) const { return messages[i].from; }
+	/*! Latin-1 text of message i, null terminated. */
+	inline const char *text(unsigned int i) const { return &texts[messages[i].offset]; }
+	inline unsigned int length(unsigned int i) const { return messages[i].length; }
+
+private:
+	struct Message {
+		unsigned int from;
+		double x, y;
+		unsigned int offset, length;	// text in texts
+		unsigned int cell;
+	};
+
+	vector<Message> messages;	// in robot order
+	vector<char> texts;
+
+	/* grid: the messages of cell c are order[cellStart[c]..cellStart[c+1]-1] */
+	double range, cellSize, minX, minY;
+	int cols, rows;
+	vector<unsigned int> cellStart;
+	vector<unsigned int> order;
+};
+
+#endif
@@ -50,10 +50,11 @@ void cbMotor::setInPower(double p)
 
 
 /*!
- * Determines and returns the power of the motor in each cycle.
+ * Determines and returns the power of the motor in each cycle, noise
+ * being the standard deviation in percent of the power.
  * Should be called only once per cycle!
  */
-double cbMotor::outPower()
+double cbMotor::outPower(double noise)
 {
 	double noisepow = randNormal(100.0, noise) / 100.0;
 
@@ -32,16 +32,19 @@
 */
 class cbMotor
 {
-public:	// class data members
-	static double noise;
+public:
         cbMotor(void);
 
 public:	// member functions
 	void setInPower(double);
-	double outPower();
+	double outPower(double noise);
 	inline double lastOutPower() { return outpower; }
 	inline double inPower() { return inpower; }
 
+	/*! Powers, as in, out, previous, to save them in a cbSimState. */
+	inline void getState(double s[3]) const { s[0] = inpower; s[1] = outpower; s[2] = prevpower; }
+	inline void setState(const double s[3]) { inpower = s[0]; outpower = s[1]; prevpower = s[2]; }
+
 private:	// object data members
 	double inpower, outpower;
 	double prevpower;
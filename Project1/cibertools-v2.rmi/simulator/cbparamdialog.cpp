@@ -126,6 +126,8 @@ void cbParamDialog::accept(void)
 	double valf; 
 	char   ch;
 
+	QMutexLocker lock(simulator->cycleLock());
+
     if(sscanf(lnEditSimTime->text().toAscii(),"%d%c",&vali,&ch)==1)
         currentParam->simTime = vali;
     if(sscanf(lnEditKeyTime->text().toAscii(),"%d%c",&vali,&ch)==1)
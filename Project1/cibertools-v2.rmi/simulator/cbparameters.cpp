@@ -22,9 +22,8 @@
  */
 
 #include "cbparameters.h"
-#include "cbmotor.h"
-#include "cbsensor.h"
-#include "cbrobot.h"
+#include "cbposition.h"
+#include "cbxmlbuilder.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -37,44 +36,45 @@ cbParameters::cbParameters()
 	simTime        = 2000;   
 	cycleTime      = 50;     
 	keyTime        = 1500;  
-	GPSOn          = cbRobot::GPSOn;
-	scoreSensorOn  = cbRobot::scoreSensorOn;
-	showActions    = cbRobot::showActions;
+	GPSOn          = true;
+	scoreSensorOn  = false;
+	showActions    = true;
 
 	//Noise
-	motorsNoise           = cbMotor::noise;
-    compassNoise          = cbCompassSensor::noise;
-    beaconNoise           = cbBeaconSensor::noise;
-    obstacleNoise         = cbIRSensor::noise;
-    gpsLinNoise           = cbGPSSensor::noiseLin;
-    gpsDirNoise           = cbGPSSensor::noiseAng;
+	motorsNoise           = 0.0;
+    compassNoise          = 0.0;
+    beaconNoise           = 0.0;
+    obstacleNoise         = 0.0;
+    gpsLinNoise           = 0.5;
+    gpsDirNoise           = 5.0;
 
 	//Requests
 	nReqPerCycle=4;
-	obstacleRequestable   = cbIRSensor::sensorRequestable; 
-	beaconRequestable     = cbBeaconSensor::sensorRequestable; 
-	compassRequestable    = cbCompassSensor::sensorRequestable; 
-	groundRequestable     = cbGroundSensor::sensorRequestable;
-	collisionRequestable  = cbCollisionSensor::sensorRequestable;
-	gpsRequestable        = cbGPSSensor::sensorRequestable;
+	obstacleRequestable   = false; 
+	beaconRequestable     = false; 
+	compassRequestable    = false; 
+	groundRequestable     = false;
+	collisionRequestable  = false;
+	gpsRequestable        = false;
 
 	//Latencies
-	obstacleLatency    = cbIRSensor::sensorLatency; 
-	beaconLatency      = cbBeaconSensor::sensorLatency; 
-	compassLatency     = cbCompassSensor::sensorLatency; 
-	groundLatency      = cbGroundSensor::sensorLatency;
-	collisionLatency   = cbCollisionSensor::sensorLatency;
-	gpsLatency         = cbGPSSensor::sensorLatency;
+	obstacleLatency    = 0; 
+	beaconLatency      = 0; 
+	compassLatency     = 0; 
+	groundLatency      = 0;
+	collisionLatency   = 0;
+	gpsLatency         = 0;
 
-	beaconAperture = cbBeaconSensor::sensorAperture;
+	beaconAperture = M_PI;
+	maxMessageBytes = 4096;
 
     //Scores
-    returnTimePenalty = cbRobot::returnTimePenalty;
-    arrivalTimePenalty = cbRobot::arrivalTimePenalty;
-    collisionWallPenalty = cbRobot::collisionWallPenalty;
-    collisionRobotPenalty = cbRobot::collisionRobotPenalty;
-    targetReward = cbRobot::targetReward;
-    homeReward = cbRobot::homeReward;
+    returnTimePenalty = 25;
+    arrivalTimePenalty = 100;
+    collisionWallPenalty = 2;
+    collisionRobotPenalty = 2;
+    targetReward = 100;
+    homeReward = 100;
 }
 
 cbParameters::~cbParameters()
@@ -83,56 +83,45 @@ cbParameters::~cbParameters()
 
 int cbParameters::toXml(char *buff, int len)
 {
-	int cnt = sprintf(buff, "<Parameters SimTime=\"%u\" CycleTime=\"%u\"\n"
-			"\t\tCompassNoise=\"%g\" BeaconNoise=\"%g\" ObstacleNoise=\"%g\"\n"
-			"\t\tMotorsNoise=\"%g\" KeyTime=\"%u\"\n"
-			"\t\tGPS=\"%s\" GPSLinNoise=\"%g\" GPSDirNoise=\"%g\" \n"
-                        "\t\tScoreSensor=\"%s\" ShowActions=\"%s\" NBeacons=\"%d\" \n",
-			simTime, cycleTime, 
-			compassNoise, beaconNoise, obstacleNoise, motorsNoise,
-			keyTime, (GPSOn?"On":"Off"), gpsLinNoise, gpsDirNoise,
-                        (scoreSensorOn?"On":"Off"),(showActions?"True":"False"),
-			nBeacons);
-
-	cnt = cnt + sprintf(buff+cnt, 
-			"\t\tNRequestsPerCycle=\"%d\" \n"
-			"\t\tObstacleRequestable=\"%s\" BeaconRequestable=\"%s\" \n"
-			"\t\tGroundRequestable=\"%s\" CompassRequestable=\"%s\"\n"
-			"\t\tCollisionRequestable=\"%s\"\n",
-			nReqPerCycle,
-			(obstacleRequestable?"On":"Off"), (beaconRequestable?"On":"Off"),
-			(groundRequestable?"On":"Off"), (compassRequestable?"On":"Off"),
-			(collisionRequestable?"On":"Off"));
-
-	cnt = cnt + sprintf(buff+cnt, 
-			"\t\tObstacleLatency=\"%d\" BeaconLatency=\"%d\" \n"
-			"\t\tGroundLatency=\"%d\" CompassLatency=\"%d\"\n"
-			"\t\tCollisionLatency=\"%d\"\n",
-			obstacleLatency, beaconLatency,
-			groundLatency, compassLatency, collisionLatency);
-
-	cnt = cnt + sprintf(buff+cnt, 
-			"\t\tBeaconAperture=\"%f\"\n",
-			beaconAperture);
-
-    cnt = cnt + sprintf(buff+cnt,
-            "\t\tReturnTimePenalty=\"%d\" ArrivalTimePenalty=\"%d\" \n"
-            "\t\tCollisionWallPenalty=\"%d\" CollisionRobotPenalty=\"%d\" \n"
-            "\t\tTargetReward=\"%d\" HomeReward=\"%d\"\n",
-            returnTimePenalty, arrivalTimePenalty,
-            collisionWallPenalty, collisionRobotPenalty,
-            targetReward, homeReward);
+	cbXmlBuilder x(buff, len);
+	x << "<Parameters SimTime=\"" << simTime << "\" CycleTime=\"" << cycleTime << "\"\n"
+	  << "\t\tCompassNoise=\"" << compassNoise << "\" BeaconNoise=\"" << beaconNoise
+	  << "\" ObstacleNoise=\"" << obstacleNoise << "\"\n"
+	  << "\t\tMotorsNoise=\"" << motorsNoise << "\" KeyTime=\"" << keyTime << "\"\n"
+	  << "\t\tGPS=\"" << (GPSOn?"On":"Off") << "\" GPSLinNoise=\"" << gpsLinNoise
+	  << "\" GPSDirNoise=\"" << gpsDirNoise << "\" \n"
+	  << "\t\tScoreSensor=\"" << (scoreSensorOn?"On":"Off") << "\" ShowActions=\"" << (showActions?"True":"False")
+	  << "\" NBeacons=\"" << nBeacons << "\" \n";
+
+	x << "\t\tNRequestsPerCycle=\"" << nReqPerCycle << "\" \n"
+	  << "\t\tObstacleRequestable=\"" << (obstacleRequestable?"On":"Off")
+	  << "\" BeaconRequestable=\"" << (beaconRequestable?"On":"Off") << "\" \n"
+	  << "\t\tGroundRequestable=\"" << (groundRequestable?"On":"Off")
+	  << "\" CompassRequestable=\"" << (compassRequestable?"On":"Off") << "\"\n"
+	  << "\t\tCollisionRequestable=\"" << (collisionRequestable?"On":"Off") << "\"\n";
+
+	x << "\t\tObstacleLatency=\"" << obstacleLatency << "\" BeaconLatency=\"" << beaconLatency << "\" \n"
+	  << "\t\tGroundLatency=\"" << groundLatency << "\" CompassLatency=\"" << compassLatency << "\"\n"
+	  << "\t\tCollisionLatency=\"" << collisionLatency << "\"\n";
+
+	x.format("\t\tBeaconAperture=\"%f\"\n", beaconAperture);
+	x << "\t\tMaxMessageBytes=\"" << maxMessageBytes << "\"\n";
+
+    x << "\t\tReturnTimePenalty=\"" << returnTimePenalty << "\" ArrivalTimePenalty=\"" << arrivalTimePenalty << "\" \n"
+      << "\t\tCollisionWallPenalty=\"" << collisionWallPenalty
+      << "\" CollisionRobotPenalty=\"" << collisionRobotPenalty << "\" \n"
+      << "\t\tTargetReward=\"" << targetReward << "\" HomeReward=\"" << homeReward << "\"\n";
 
     if(!labFilename.isNull())
-        cnt = cnt + sprintf(buff + cnt, "\t\tLab=\"%s\"\n", labFilename.toLatin1().constData());;
+        x << "\t\tLab=\"" << labFilename.toLatin1().constData() << "\"\n";
     if(!gridFilename.isNull())
-        cnt = cnt + sprintf(buff + cnt, "\t\tGrid=\"%s\"\n", gridFilename.toLatin1().constData());;
+        x << "\t\tGrid=\"" << gridFilename.toLatin1().constData() << "\"\n";
 
-	cnt = cnt + sprintf(buff + cnt, "/>\n"); 
+	x << "/>\n";
 
-    if(cnt > len -1 ) {
+    if(x.overflow()) {
         fprintf(stderr,"cbParameters::toXml message too long\n");
         abort();
     }
-	return cnt;
+	return x.length();
 }
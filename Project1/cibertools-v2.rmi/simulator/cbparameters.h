@@ -62,6 +62,7 @@ public:
     int homeReward;
 	
 	double beaconAperture;
+	unsigned int maxMessageBytes;	// Say messages sent to a robot in a cycle
 
 	bool   GPSOn;
 	bool   scoreSensorOn;
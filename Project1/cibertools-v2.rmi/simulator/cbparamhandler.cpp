@@ -120,6 +120,8 @@ bool cbParamHandler::startElement( const QString&, const QString&, const QString
 
 		const QString &beaconAperture = attr.value(QString("BeaconAperture"));
 		if (!beaconAperture.isNull()) param->beaconAperture = beaconAperture.toDouble();
+		const QString &maxMessageBytes = attr.value(QString("MaxMessageBytes"));
+		if (!maxMessageBytes.isNull()) param->maxMessageBytes = maxMessageBytes.toUInt();
 
         //Scores
         const QString &returnTimePenalty = attr.value(QString("ReturnTimePenalty"));
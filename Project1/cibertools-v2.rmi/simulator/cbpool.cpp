@@ -0,0 +1,94 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "cbpool.h"
+#include "cbsensor.h"
+#include "cbrobot.h"
+
+#include <new>
+
+cbSensorPool::cbSensorPool()
+	: irSensors(32 * NUM_IR_SENSORS),
+	  collisionId("Collision"), groundId("Ground"), compassId("Compass"), gpsId("GPS")
+{
+	for (int i = 0; i < NUM_IR_SENSORS; i++)
+		irIds.push_back(QString("IRSensor") + QString::number(i));
+}
+
+cbCollisionSensor *cbSensorPool::collision(cbRobot *rob)
+{
+	return new (collisionSensors.take()) cbCollisionSensor(rob, collisionId);
+}
+
+cbGroundSensor *cbSensorPool::ground(cbRobot *rob)
+{
+	return new (groundSensors.take()) cbGroundSensor(rob, groundId);
+}
+
+cbCompassSensor *cbSensorPool::compass(cbRobot *rob)
+{
+	return new (compassSensors.take()) cbCompassSensor(rob, compassId);
+}
+
+cbIRSensor *cbSensorPool::ir(cbRobot *rob, unsigned int i)
+{
+	return new (irSensors.take()) cbIRSensor(rob, irIds[i]);
+}
+
+cbGPSSensor *cbSensorPool::gps(cbRobot *rob)
+{
+	return new (gpsSensors.take()) cbGPSSensor(rob, gpsId);
+}
+
+cbBeaconSensor *cbSensorPool::beacon(cbRobot *rob, unsigned int b)
+{
+	while (beaconIds.size() <= b)
+		beaconIds.push_back(QString("Beacon") + QString::number(beaconIds.size()));
+	return new (beaconSensors.take()) cbBeaconSensor(rob, beaconIds[b]);
+}
+
+void cbSensorPool::release(cbCollisionSensor *s) { collisionSensors.give(s); }
+void cbSensorPool::release(cbGroundSensor *s) { groundSensors.give(s); }
+void cbSensorPool::release(cbCompassSensor *s) { compassSensors.give(s); }
+void cbSensorPool::release(cbIRSensor *s) { irSensors.give(s); }
+void cbSensorPool::release(cbGPSSensor *s) { gpsSensors.give(s); }
+void cbSensorPool::release(cbBeaconSensor *s) { beaconSensors.give(s); }
+
+void cbSensorPool::reserve(unsigned int nRobots, unsigned int nBeacons)
+{
+	collisionSensors.reserve(nRobots);
+	groundSensors.reserve(nRobots);
+	compassSensors.reserve(nRobots);
+	irSensors.reserve(nRobots * NUM_IR_SENSORS);
+	gpsSensors.reserve(nRobots);
+	beaconSensors.reserve(nRobots * nBeacons);
+}
+
+unsigned int cbSensorPool::size() const
+{
+	return collisionSensors.size() + groundSensors.size() + compassSensors.size()
+	     + irSensors.size() + gpsSensors.size() + beaconSensors.size();
+}
+
+unsigned int cbSensorPool::capacity() const
+{
+	return collisionSensors.capacity() + groundSensors.capacity() + compassSensors.capacity()
+	     + irSensors.capacity() + gpsSensors.capacity() + beaconSensors.capacity();
+}
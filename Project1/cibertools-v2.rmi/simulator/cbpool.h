@@ -0,0 +1,149 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef CBPOOL_H
+#define CBPOOL_H
+
+/*! \file cbpool.h
+	\brief Storage of the sensors of the robots.
+
+	The sensors of the robots are taken from the pool of their simulator,
+	which keeps every sensor type in blocks of its own: the sensors of
+	the robots registered one after the other lie next to each other, and
+	registering robots again after others were removed reuses the storage
+	they left instead of allocating.
+
+	Like the robots, the pool is used by the kernel thread or under the
+	cycle lock only.
+*/
+
+#include <QString>
+#include <vector>
+
+using std::vector;
+
+class cbRobot;
+class cbCollisionSensor;
+class cbGroundSensor;
+class cbCompassSensor;
+class cbIRSensor;
+class cbGPSSensor;
+class cbBeaconSensor;
+
+/**
+ * Objects of type T in blocks of contiguous storage, with a free list.
+ * take() gives the storage of an object, to be built with placement new,
+ * give() destroys it and keeps its storage for the next take().
+ */
+template <class T> class cbPool
+{
+public:
+	cbPool(unsigned int block = 32) : blockSize(block), used(0) {}
+	/*! Frees the blocks, the objects taken must have been given back. */
+	~cbPool()
+	{
+		for (unsigned int b = 0; b < blocks.size(); b++)
+			::operator delete(blocks[b]);
+	}
+
+	void *take()
+	{
+		if (freeList.empty()) grow();
+		T *p = freeList.back();
+		freeList.pop_back();
+		used++;
+		return p;
+	}
+
+	void give(T *obj)
+	{
+		obj->~T();
+		freeList.push_back(obj);
+		used--;
+	}
+
+	void reserve(unsigned int n) { while (capacity() < n) grow(); }
+
+	inline unsigned int size() const { return used; }
+	inline unsigned int capacity() const { return blocks.size() * blockSize; }
+
+private:
+	cbPool(const cbPool &);
+	cbPool &operator=(const cbPool &);
+
+	void grow()
+	{
+		T *b = static_cast<T *>(::operator new(sizeof(T) * blockSize));
+		blocks.push_back(b);
+		freeList.reserve(capacity());
+		// taken in the order of the addresses
+		for (unsigned int i = blockSize; i > 0; i--)
+			freeList.push_back(b + i - 1);
+	}
+
+	unsigned int blockSize;
+	unsigned int used;
+	vector<T *> blocks;
+	vector<T *> freeList;
+};
+
+/**
+ * Sensor pools of a simulator, one per sensor type. The ids of the
+ * sensors are kept here too, the sensors share them.
+ */
+class cbSensorPool
+{
+public:
+	cbSensorPool();
+
+	cbCollisionSensor *collision(cbRobot *rob);
+	cbGroundSensor *ground(cbRobot *rob);
+	cbCompassSensor *compass(cbRobot *rob);
+	cbIRSensor *ir(cbRobot *rob, unsigned int i);
+	cbGPSSensor *gps(cbRobot *rob);
+	cbBeaconSensor *beacon(cbRobot *rob, unsigned int b);
+
+	void release(cbCollisionSensor *s);
+	void release(cbGroundSensor *s);
+	void release(cbCompassSensor *s);
+	void release(cbIRSensor *s);
+	void release(cbGPSSensor *s);
+	void release(cbBeaconSensor *s);
+
+	/*! Makes room for the sensors of the given number of robots. */
+	void reserve(unsigned int nRobots, unsigned int nBeacons);
+
+	/*! Sensors in use and room for sensors. */
+	unsigned int size() const;
+	unsigned int capacity() const;
+
+private:
+	cbPool<cbCollisionSensor> collisionSensors;
+	cbPool<cbGroundSensor> groundSensors;
+	cbPool<cbCompassSensor> compassSensors;
+	cbPool<cbIRSensor> irSensors;
+	cbPool<cbGPSSensor> gpsSensors;
+	cbPool<cbBeaconSensor> beaconSensors;
+
+	QString collisionId, groundId, compassId, gpsId;
+	vector<QString> irIds, beaconIds;
+};
+
+#endif
@@ -0,0 +1,220 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+/*
+ * classes cbHistogram and cbProfiler
+ */
+
+#include "cbprofiler.h"
+#include "cbscheduler.h"
+#include "cbtracer.h"
+#include "cbutils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#if __cplusplus >= 201103L
+#define CB_THROW_BAD_ALLOC
+#define CB_NOTHROW noexcept
+#else
+#define CB_THROW_BAD_ALLOC throw(std::bad_alloc)
+#define CB_NOTHROW throw()
+#endif
+
+/*
+ * Allocations are counted per thread, the kernel only reads its own.
+ * Libraries built from these sources define CB_NO_ALLOC_COUNT, they must
+ * not replace the operator new of the program that loads them.
+ */
+static CB_THREAD_LOCAL unsigned long threadAllocations = 0;
+
+#ifndef CB_NO_ALLOC_COUNT
+void *operator new(size_t size) CB_THROW_BAD_ALLOC
+{
+	threadAllocations++;
+	void *p = malloc(size == 0 ? 1 : size);
+	if (p == 0) throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void *p) CB_NOTHROW
+{
+	free(p);
+}
+#endif
+
+unsigned long cbProfiler::allocations()
+{
+	return threadAllocations;
+}
+
+/* bucket of v: exact below 2*HIST_SUB, then HIST_SUB buckets per power of 2 */
+static inline unsigned int bucketOf(unsigned long long v)
+{
+	if (v < 2 * HIST_SUB) return (unsigned int) v;
+	unsigned int msb = 0;
+#if defined(__GNUC__)
+	msb = 63 - __builtin_clzll(v);
+#else
+	for (unsigned long long x = v; x > 1; x >>= 1) msb++;
+#endif
+	if (msb >= HIST_MAX_BITS) return HIST_BUCKETS - 1;
+	unsigned int shift = msb - HIST_SUB_BITS;
+	return HIST_SUB * shift + (unsigned int) (v >> shift);
+}
+
+/* largest value that falls in bucket b */
+static inline unsigned long long bucketTop(unsigned int b)
+{
+	if (b < 2 * HIST_SUB) return b;
+	unsigned int shift = b / HIST_SUB - 1;
+	unsigned long long top = b - HIST_SUB * shift;
+	return ((top + 1) << shift) - 1;
+}
+
+void cbHistogram::reset()
+{
+	memset(buckets, 0, sizeof(buckets));
+	n = 0;
+	maxValue = 0;
+	sum = 0;
+}
+
+void cbHistogram::record(unsigned long long v)
+{
+	buckets[bucketOf(v)]++;
+	n++;
+	sum += v;
+	if (v > maxValue) maxValue = v;
+}
+
+double cbHistogram::mean() const
+{
+	return n > 0 ? (double) sum / n : 0.0;
+}
+
+unsigned long long cbHistogram::percentile(double p) const
+{
+	if (n == 0) return 0;
+	unsigned int rank = (unsigned int) (p / 100.0 * n + 0.5);
+	if (rank < 1) rank = 1;
+	if (rank > n) rank = n;
+
+	unsigned int seen = 0;
+	for (unsigned int b = 0; b < HIST_BUCKETS; b++) {
+		seen += buckets[b];
+		if (seen >= rank) {
+			unsigned long long v = bucketTop(b);
+			return v < maxValue ? v : maxValue;
+		}
+	}
+	return maxValue;
+}
+
+CB_THREAD_LOCAL unsigned int cbProfiler::cycleCounters[cbProfiler::NCOUNTERS];
+
+cbProfiler::cbProfiler()
+{
+	clear();
+	lastAllocations = 0;
+}
+
+const char *cbProfiler::phaseName(int p)
+{
+	static const char *names[NPHASES] = {
+		"RobotActions", "Log", "CheckIn", "ViewCommands", "PanelCommands",
+		"NextPositions", "CheckCollisions", "Commit", "UpdateSensors",
+		"UpdateScores", "SendSensors", "UpdateViews", "UpdateState",
+		"History", "Publish", "Cycle" };
+	return names[p];
+}
+
+const char *cbProfiler::counterName(int c)
+{
+	static const char *names[NCOUNTERS] = {
+		"DatagramsIn", "DatagramsOut", "BytesIn", "BytesOut",
+		"Allocations", "ParseFailures" };
+	return names[c];
+}
+
+long long cbProfiler::lap(Phase p, long long start)
+{
+	long long t = cbScheduler::now();
+	phases[p].record(t - start);
+	CB_TRACE_COMPLETE(phaseName(p), "phase", start, t, -1);
+	return t;
+}
+
+void cbProfiler::endCycle()
+{
+	unsigned long allocs = allocations();
+	cycleCounters[ALLOCATIONS] = (unsigned int) (allocs - lastAllocations);
+	lastAllocations = allocs;
+
+	for (int c = 0; c < NCOUNTERS; c++) {
+		counters[c].record(cycleCounters[c]);
+		totals[c] += cycleCounters[c];
+		last[c] = cycleCounters[c];
+		cycleCounters[c] = 0;
+	}
+	cycles++;
+}
+
+void cbProfiler::clear()
+{
+	cycles = 0;
+	for (int p = 0; p < NPHASES; p++) phases[p].reset();
+	for (int c = 0; c < NCOUNTERS; c++) {
+		counters[c].reset();
+		totals[c] = 0;
+		last[c] = 0;
+	}
+}
+
+/*!
+	Clears the statistics and the counters of the running cycle, to be
+	called by the kernel thread or under its cycle lock.
+*/
+void cbProfiler::reset()
+{
+	clear();
+	for (int c = 0; c < NCOUNTERS; c++) cycleCounters[c] = 0;
+	lastAllocations = allocations();
+}
+
+int cbProfiler::toXml(char *buff, int len) const
+{
+	int cnt = snprintf(buff, len, "<Stats Cycles=\"%u\" Unit=\"ns\">\n", cycles);
+	for (int p = 0; p < NPHASES && cnt < len; p++)
+		cnt += snprintf(buff+cnt, len-cnt,
+				"\t<Phase Name=\"%s\" Count=\"%u\" Mean=\"%.0f\" P50=\"%llu\" P99=\"%llu\" Max=\"%llu\"/>\n",
+				phaseName(p), phases[p].count(), phases[p].mean(),
+				phases[p].percentile(50), phases[p].percentile(99), phases[p].max());
+	for (int c = 0; c < NCOUNTERS && cnt < len; c++)
+		cnt += snprintf(buff+cnt, len-cnt,
+				"\t<Counter Name=\"%s\" Last=\"%u\" Total=\"%llu\" Mean=\"%.2f\" P50=\"%llu\" P99=\"%llu\" Max=\"%llu\"/>\n",
+				counterName(c), last[c], totals[c], counters[c].mean(),
+				counters[c].percentile(50), counters[c].percentile(99), counters[c].max());
+	if (cnt < len)
+		cnt += snprintf(buff+cnt, len-cnt, "</Stats>\n");
+
+	return cnt < len ? cnt : -1;
+}
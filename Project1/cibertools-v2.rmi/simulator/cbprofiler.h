@@ -0,0 +1,121 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef CBPROFILER_H
+#define CBPROFILER_H
+
+/*! \file cbprofiler.h
+	\brief Per phase timing and per cycle counters of the simulation kernel.
+
+	cbSimulator::step times each of its phases with the monotonic clock of
+	cbScheduler and records the durations into log linear histograms,
+	like HDR histograms: values are kept with 5 significant bits, about
+	3% of error, from 1 ns up to some minutes, in a fixed array of counts.
+	Recording is a few shifts and an increment, with no allocation.
+
+	The sockets of the kernel count the datagrams and bytes they move and
+	the XML messages they fail to parse; allocations made by the kernel
+	thread are counted by the global operator new. At the end of each
+	cycle these counts go into histograms of their own.
+
+	All of it is written by the kernel thread only; the GUI copies the
+	profiler while holding the cycle lock.
+*/
+
+#include "cbutils.h"
+
+#define HIST_SUB_BITS 5
+#define HIST_SUB (1 << HIST_SUB_BITS)
+#define HIST_MAX_BITS 42
+#define HIST_BUCKETS (HIST_SUB * (HIST_MAX_BITS - HIST_SUB_BITS + 1))
+
+class cbHistogram
+{
+public:
+	cbHistogram() { reset(); }
+
+	void reset();
+	void record(unsigned long long v);
+
+	inline unsigned int count() const { return n; }
+	inline unsigned long long max() const { return maxValue; }
+	double mean() const;
+	/*! Value below which are p percent of the recorded values. */
+	unsigned long long percentile(double p) const;
+
+private:
+	unsigned int buckets[HIST_BUCKETS];
+	unsigned int n;
+	unsigned long long maxValue;
+	unsigned long long sum;
+};
+
+class cbProfiler
+{
+public:
+	enum Phase { ROBOT_ACTIONS, LOG, CHECK_IN, VIEW_COMMANDS, PANEL_COMMANDS,
+	             NEXT_POSITIONS, CHECK_COLLISIONS, COMMIT, UPDATE_SENSORS,
+	             UPDATE_SCORES, SEND_SENSORS, UPDATE_VIEWS, UPDATE_STATE,
+	             HISTORY, PUBLISH, CYCLE, NPHASES };
+	enum Counter { DATAGRAMS_IN, DATAGRAMS_OUT, BYTES_IN, BYTES_OUT,
+	               ALLOCATIONS, PARSE_FAILURES, NCOUNTERS };
+
+	cbProfiler();
+
+	static const char *phaseName(int p);
+	static const char *counterName(int c);
+
+	/*! Records the time since start as a sample of phase p.
+	    \return the current time, start of the next phase. */
+	long long lap(Phase p, long long start);
+
+	/*! Moves the counters of the cycle that ended into the histograms. */
+	void endCycle();
+	void reset();
+
+	/*! Writes the machine readable <Stats> dump, times in ns.
+	    \return the length of the dump, -1 if it does not fit. */
+	int toXml(char *buff, int len) const;
+
+	/* counters of the running cycle, one set per thread so that each
+	   kernel thread counts its own cycles */
+	static inline void countIn(int bytes)
+	{ cycleCounters[DATAGRAMS_IN]++; cycleCounters[BYTES_IN] += bytes; }
+	static inline void countOut(int bytes)
+	{ cycleCounters[DATAGRAMS_OUT]++; cycleCounters[BYTES_OUT] += bytes; }
+	static inline void countParseFailure() { cycleCounters[PARSE_FAILURES]++; }
+
+	/*! Allocations made so far by the calling thread. */
+	static unsigned long allocations();
+
+	unsigned int cycles;
+	cbHistogram phases[NPHASES];
+	cbHistogram counters[NCOUNTERS];
+	unsigned long long totals[NCOUNTERS];
+	unsigned int last[NCOUNTERS];       // counters of the last cycle
+
+private:
+	void clear();
+
+	static CB_THREAD_LOCAL unsigned int cycleCounters[NCOUNTERS];
+	unsigned long lastAllocations;
+};
+
+#endif
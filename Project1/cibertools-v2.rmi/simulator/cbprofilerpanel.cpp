@@ -0,0 +1,131 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "cbprofilerpanel.h"
+#include "cbprofiler.h"
+#include "cbsimulator.h"
+
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QMutexLocker>
+
+static const char *columns[] = { "Count", "Mean", "P50", "P99", "Max" };
+#define NCOLUMNS 5
+
+cbProfilerPanel::cbProfilerPanel(cbSimulator *sim, QWidget *parent, Qt::WFlags fl) :
+    QWidget(parent, fl), simulator(sim)
+{
+    setWindowTitle("Cycle Profiler");
+
+    // the profiler is big, keep the copy off the stack
+    copy = new cbProfiler;
+
+    table = new QTableWidget(cbProfiler::NPHASES + cbProfiler::NCOUNTERS, NCOLUMNS, this);
+    QStringList rows, cols;
+    for (int p = 0; p < cbProfiler::NPHASES; p++)
+        rows << QString(cbProfiler::phaseName(p)) + " (us)";
+    for (int c = 0; c < cbProfiler::NCOUNTERS; c++)
+        rows << cbProfiler::counterName(c);
+    for (int c = 0; c < NCOLUMNS; c++)
+        cols << columns[c];
+    table->setVerticalHeaderLabels(rows);
+    table->setHorizontalHeaderLabels(cols);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    for (int r = 0; r < table->rowCount(); r++)
+        for (int c = 0; c < NCOLUMNS; c++) {
+            QTableWidgetItem *item = new QTableWidgetItem;
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            table->setItem(r, c, item);
+        }
+
+    cyclesLabel = new QLabel(this);
+    QPushButton *reset = new QPushButton("Reset", this);
+    connect(reset, SIGNAL(clicked()), SLOT(resetProfiler()));
+
+    QHBoxLayout *bottom = new QHBoxLayout;
+    bottom->addWidget(cyclesLabel, 1);
+    bottom->addWidget(reset);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(table);
+    layout->addLayout(bottom);
+
+    resize(560, 560);
+
+    connect(&refreshTimer, SIGNAL(timeout()), SLOT(refresh()));
+}
+
+cbProfilerPanel::~cbProfilerPanel()
+{
+    delete copy;
+}
+
+void cbProfilerPanel::showEvent(QShowEvent *)
+{
+    refresh();
+    refreshTimer.start(500);
+}
+
+void cbProfilerPanel::hideEvent(QHideEvent *)
+{
+    refreshTimer.stop();
+}
+
+void cbProfilerPanel::refresh()
+{
+    {
+        QMutexLocker lock(simulator->cycleLock());
+        *copy = simulator->profiler();
+    }
+
+    cyclesLabel->setText(QString("%1 cycles").arg(copy->cycles));
+
+    for (int p = 0; p < cbProfiler::NPHASES; p++) {
+        const cbHistogram &h = copy->phases[p];
+        table->item(p, 0)->setText(QString::number(h.count()));
+        table->item(p, 1)->setText(QString::number(h.mean() / 1000.0, 'f', 1));
+        table->item(p, 2)->setText(QString::number(h.percentile(50) / 1000.0, 'f', 1));
+        table->item(p, 3)->setText(QString::number(h.percentile(99) / 1000.0, 'f', 1));
+        table->item(p, 4)->setText(QString::number(h.max() / 1000.0, 'f', 1));
+    }
+    for (int c = 0; c < cbProfiler::NCOUNTERS; c++) {
+        const cbHistogram &h = copy->counters[c];
+        int r = cbProfiler::NPHASES + c;
+        // counters show their total in the count column
+        table->item(r, 0)->setText(QString::number(copy->totals[c]));
+        table->item(r, 1)->setText(QString::number(h.mean(), 'f', 2));
+        table->item(r, 2)->setText(QString::number(h.percentile(50)));
+        table->item(r, 3)->setText(QString::number(h.percentile(99)));
+        table->item(r, 4)->setText(QString::number(h.max()));
+    }
+}
+
+void cbProfilerPanel::resetProfiler()
+{
+    {
+        QMutexLocker lock(simulator->cycleLock());
+        simulator->profiler().reset();
+    }
+    refresh();
+}
@@ -0,0 +1,63 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef CBPROFILERPANEL_H
+#define CBPROFILERPANEL_H
+
+#include <QWidget>
+#include <QTimer>
+
+class QTableWidget;
+class QLabel;
+class cbSimulator;
+class cbProfiler;
+
+/*!
+    \class cbProfilerPanel
+    \brief Shows the phase timings and the per cycle counters of the kernel.
+
+    Times are in microseconds. The profiler is copied under the cycle
+    lock twice a second, while the panel is visible.
+*/
+class cbProfilerPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit cbProfilerPanel(cbSimulator *sim, QWidget *parent = 0, Qt::WFlags fl = 0);
+    ~cbProfilerPanel();
+
+protected:
+    void showEvent(QShowEvent *);
+    void hideEvent(QHideEvent *);
+
+private slots:
+    void refresh();
+    void resetProfiler();
+
+private:
+    cbSimulator *simulator;
+    cbProfiler *copy;
+    QTableWidget *table;
+    QLabel *cyclesLabel;
+    QTimer refreshTimer;
+};
+
+#endif // CBPROFILERPANEL_H
@@ -93,6 +93,10 @@ bool cbReceptionHandler::startElement( const QString&, const QString&, const QSt
 		const QString &height = attr.value(QString("Height"));
 		if (!height.isNull()) robotBeacon->setHeight(height.toDouble());
 	}
+	else if (tag == "Stats")
+	{
+		type = STATS;
+	}
 	else if (tag == "IRSensor")
 	{
 		unsigned int id=0;
@@ -164,6 +168,7 @@ bool cbReceptionHandler::endElement( const QString&, const QString&, const QStri
 		}
 	}
 	else if (tag == "IRSensor") {}
+	else if (tag == "Stats") {}
 	else
 	{
 		cerr << "Unknown tag\n";
@@ -37,7 +37,7 @@ class cbPanel;
 class cbReceptionHandler : public QXmlDefaultHandler
 {
 public:
-	enum Type { UNKNOWN, VIEW, PANEL, ROBOT, ROBOTBEACON};
+	enum Type { UNKNOWN, VIEW, PANEL, ROBOT, ROBOTBEACON, STATS};
 	cbReceptionHandler(QXmlSimpleReader *xmlParser);
 
     bool parse(void *data, int datasize);
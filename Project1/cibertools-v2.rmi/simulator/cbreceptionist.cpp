@@ -26,10 +26,14 @@
 
 #include "cbreceptionform.h"
 #include "cbreceptionhandler.h"
+#include "cbrobot.h"
+#include "cbrobotbeacon.h"
+#include "cbview.h"
+#include "cbpanel.h"
+#include "cbprofiler.h"
 
 #include <QHostAddress>
 #include <QString>
-#include <QMessageBox>
 #include <qxml.h>
 
 #include <string.h>
@@ -42,8 +46,12 @@ using std::cout;
 	Create socket and bind it with machine address and given port.
 	Set the socket non-blocking.
 */
-cbReceptionist::cbReceptionist(unsigned int port) : QUdpSocket()
+cbReceptionist::cbReceptionist(unsigned int port) : QUdpSocket(), receptionThread(this)
 {
+    xmlParser = 0;
+    consumer = 0;
+    stopping = 0;
+
     QHostAddress address;
     address.setAddress(QString("0.0.0.0"));     // this way any address is accepted
 	/* bind local address */
@@ -61,10 +69,11 @@ cbReceptionist::cbReceptionist(unsigned int port) : QUdpSocket()
 }
 
 /*!	
-	Does nothing.
+	Stops the reception thread.
 */
 cbReceptionist::~cbReceptionist()
 {
+	stop();
 }
 
 /*!
@@ -98,92 +107,203 @@ void cbReceptionist::setXmlParser(QXmlSimpleReader *parser)
 //
 //
 /*!
-	Check input port for an incoming xml message.
-	If one, parse it, fill in the check-in form and return true;
+	Take the next checked in message, reading the input port first when
+	the reception thread is not running.
+	If one, fill in the check-in form and return true;
 	Otherwise returns false.
 */
 bool cbReceptionist::CheckIn()
 {
     //cout << "Entering checkIn\n";
 	/* check if parser is set */
-	int datasize;
 	if (xmlParser == 0) 
 	{
         cerr << "Parser was not setup\n";
-        QMessageBox::critical(0,"Error",
-                              "Error in parser",
-                              QMessageBox::Ok, Qt::NoButton, Qt::NoButton);
         exit (1);
 	}
-	
-	/* look for an incoming message */
-    if (!hasPendingDatagrams())
-        return false;
 
-    if ((datasize=readDatagram(xmlBuff, XMLMAX-1, &form.addr, &form.port)) < 0)
-    {
-        cerr << "Error no. " << error() << " reading from the socket!\n";
-        QMessageBox::critical(0,"Error",
-                              QString("Error no. ")+QString::number(error())+ " reading from socket",
-                              QMessageBox::Ok, Qt::NoButton, Qt::NoButton);
-		return false;
+	if (consumer == 0) receive();
+
+	QMutexLocker lock(&mutex);
+	while (!forms.empty())
+	{
+		form = forms.front();
+		forms.pop_front();
+
+		// counted here, the profiler counts the cycles of the kernel thread
+		if (form.bytes >= 0) cbProfiler::countIn(form.bytes);
+		if (form.type != cbClientForm::NOBODY) return true;
+		cbProfiler::countParseFailure();
 	}
-	else xmlBuff[datasize]='\0';
+	return false;
+}
+
+/*!
+	Read every message waiting at the input port, parse it and queue its
+	check-in form. Messages that do not parse are queued as NOBODY forms,
+	to be counted and dropped by CheckIn.
+*/
+void cbReceptionist::receive()
+{
+	int datasize;
+	cbClientForm f;
+
+	/* look for incoming messages */
+    while (hasPendingDatagrams())
+    {
+        if ((datasize=readDatagram(xmlBuff, XMLMAX-1, &f.addr, &f.port)) < 0)
+        {
+            // no message box here, it may run on the reception thread
+            cerr << "Error no. " << error() << " reading from the socket!\n";
+            return;
+        }
+        xmlBuff[datasize]='\0';
+        f.bytes = datasize;
+
+        //cout << xmlBuff << endl;
+
+        /* parse xml message, the client is constructed by the handler */
+        cbReceptionHandler handler(xmlParser);
+
+        if (!handler.parse(xmlBuff,datasize))
+        {
+            cerr << "Fail parsing xml message\n" << xmlBuff << "\n";
+            f.type = cbClientForm::NOBODY;
+        }
+        else switch (handler.objectType())
+        {
+            case cbReceptionHandler::ROBOT:
+                f.type = cbClientForm::ROBOT;
+                f.client.robot = handler.robotObject();
+                if (consumer) f.client.robot->moveToThread(consumer);
+                cout << "Robot is requesting registration\n";
+                break;
+            case cbReceptionHandler::ROBOTBEACON:
+                f.type = cbClientForm::ROBOTBEACON;
+                f.client.robotBeacon = handler.robotBeaconObject();
+                if (consumer) f.client.robotBeacon->moveToThread(consumer);
+                cout << "RobotBeacon is requesting registration\n";
+                break;
+            case cbReceptionHandler::VIEW:
+                f.type = cbClientForm::VIEW;
+                f.client.view = handler.viewObject();
+                if (consumer) f.client.view->moveToThread(consumer);
+                cout << "Viewer is requesting registration\n";
+                break;
+            case cbReceptionHandler::PANEL:
+                f.type = cbClientForm::PANEL;
+                f.client.panel = handler.panelObject();
+                if (consumer) f.client.panel->moveToThread(consumer);
+                cout << "Panel is requesting registration\n";
+                break;
+            case cbReceptionHandler::STATS:
+                f.type = cbClientForm::STATS;
+                break;
+            default:
+                f.type = cbClientForm::UNKNOWN;
+                break;
+        }
+
+        QMutexLocker lock(&mutex);
+        forms.push_back(f);
+    }
+}
+
+/*!
+	Returns the last filled check-in (client) form.
+*/
+cbClientForm &cbReceptionist::Form()
+{
+	return form;
+}
 
-    //cout << xmlBuff << endl;
+void cbReceptionist::putBack()
+{
+	QMutexLocker lock(&mutex);
+	form.bytes = -1;		// already counted
+	forms.push_front(form);
+}
+
+/*!
+	Send msg to the sender of the last check-in message. With the
+	reception thread running, the answer is queued and sent by it.
+*/
+bool cbReceptionist::Answer(const char *msg, int len)
+{
+	if (consumer != 0)
+	{
+		cbPendingAnswer a;
+		a.addr = form.addr;
+		a.port = form.port;
+		a.msg.assign(msg, len);
 
-	/* parse xml message */
-	cbReceptionHandler handler(xmlParser);
+		QMutexLocker lock(&mutex);
+		answers.push_back(a);
+		cbProfiler::countOut(len);
+		return true;
+	}
 
-	if (!handler.parse(xmlBuff,datasize))
+	if (writeDatagram(msg, len, form.addr, form.port) != len)
 	{
-		cerr << "Fail parsing xml message\n" << xmlBuff << "\n";
+		cerr << "Fail answering to " << form.addr.toString().toStdString() << "\n";
 		return false;
 	}
+	cbProfiler::countOut(len);
+	return true;
+}
 
-	//xmlParser->setContentHandler(&handler);
-	//xmlSource.setData(xmlBuff);
-	//if (!xmlParser->parse(xmlSource))
-	//{
-	//	cerr.form("Fail parsing xml message\n");
-	//	return false;
-	//}
-	
-    /* process request */
+void cbReceptionist::sendAnswers()
+{
+	deque<cbPendingAnswer> out;
+	mutex.lock();
+	out.swap(answers);
+	mutex.unlock();
 
-	switch (handler.objectType())
+	for (unsigned int i=0; i<out.size(); i++)
 	{
-		case cbReceptionHandler::ROBOT:
-			form.type = cbClientForm::ROBOT;
-			form.client.robot = handler.robotObject();
-			cout << "Robot is requesting registration\n";
-			break;
-		case cbReceptionHandler::ROBOTBEACON:
-			form.type = cbClientForm::ROBOTBEACON;
-			form.client.robotBeacon = handler.robotBeaconObject();
-			cout << "RobotBeacon is requesting registration\n";
-			break;
-		case cbReceptionHandler::VIEW:
-			form.type = cbClientForm::VIEW;
-			form.client.view = handler.viewObject();
-            cout << "Viewer is requesting registration\n";
-			break;
-		case cbReceptionHandler::PANEL:
-			form.type = cbClientForm::PANEL;
-			form.client.panel = handler.panelObject();
-			cout << "Panel is requesting registration\n";
-			break;
-		default:
-			form.type = cbClientForm::UNKNOWN;
-			break;
+		int len = out[i].msg.size();
+		if (writeDatagram(out[i].msg.data(), len, out[i].addr, out[i].port) != len)
+			cerr << "Fail answering to " << out[i].addr.toString().toStdString() << "\n";
 	}
-	return true;
+}
+
+void cbReceptionist::start(QThread *c)
+{
+	if (consumer != 0 || bad()) return;
+
+	consumer = c;
+	stopping = 0;
+	moveToThread(&receptionThread);
+	receptionThread.start();
+}
+
+void cbReceptionist::stop()
+{
+	if (consumer == 0) return;
+
+	stopping.fetchAndStoreRelease(1);
+	receptionThread.wait();
+	consumer = 0;
 }
 
 /*!
-	Returns the last filled check-in (client) form.
+	Wait for messages and check them in, sending the queued answers in
+	between, until stop is called. The socket is then handed over to the
+	consumer thread, that reads it again in CheckIn.
 */
-cbClientForm &cbReceptionist::Form()
+void cbReceptionist::serve()
 {
-	return form;
+	while (!stopping.fetchAndAddAcquire(0))
+	{
+		if (waitForReadyRead(20)) receive();
+		sendAnswers();
+	}
+	sendAnswers();
+
+	moveToThread(consumer);
+}
+
+void cbReceptionThread::run()
+{
+	receptionist->serve();
 }
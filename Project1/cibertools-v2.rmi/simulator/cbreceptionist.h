@@ -28,15 +28,30 @@
 	xml message.
 	Depending on the initial tag, an appropriate parser handler is assigned to
 	the xml parser.
+
+	Once started, the socket is served by a thread of its own: the arriving
+	messages are parsed and their clients (robots with their sockets and
+	sensors, views, panels) constructed there, and the filled forms are
+	queued. CheckIn then only takes the next queued form, so a burst of
+	registrations does not hold the simulation cycle. Without the thread,
+	CheckIn reads the socket itself, as before.
 */
 
 #define XMLMAX 1024
 
 #include <QUdpSocket>
 #include <QHostAddress>
+#include <QThread>
+#include <QMutex>
+#include <QAtomicInt>
 #include <qxml.h>
 
 #include <iostream>
+#include <deque>
+#include <string>
+
+using std::deque;
+using std::string;
 
 class QXmlSimpleReader;
 
@@ -44,10 +59,11 @@ class cbRobot;
 class cbRobotBeacon;
 class cbView;
 class cbPanel;
+class cbReceptionist;
 
 struct cbClientForm
 {
-	enum {NOBODY, VIEW, PANEL, ROBOT, ROBOTBEACON, UNKNOWN} type;
+	enum {NOBODY, VIEW, PANEL, ROBOT, ROBOTBEACON, STATS, UNKNOWN} type;
 	union 
 	{
 		cbRobot *robot;
@@ -57,6 +73,30 @@ struct cbClientForm
 	} client;
 	QHostAddress addr;
 	unsigned short port;
+	int bytes;		// size of the message
+};
+
+/**
+ * Answer queued by the consumer thread, sent by the reception thread.
+ */
+struct cbPendingAnswer
+{
+	QHostAddress addr;
+	unsigned short port;
+	string msg;
+};
+
+/**
+ * Thread serving the socket of a cbReceptionist, runs cbReceptionist::serve.
+ */
+class cbReceptionThread : public QThread
+{
+public:
+	cbReceptionThread(cbReceptionist *r) : receptionist(r) {}
+protected:
+	void run();
+private:
+	cbReceptionist *receptionist;
 };
 
 class cbReceptionist : public QUdpSocket
@@ -69,16 +109,42 @@ public:
 	/* added functionality */
 	bool CheckIn(void);
 	cbClientForm &Form();
+	/*! Puts the last checked in form back at the head of the queue, to be
+	    taken again by the next CheckIn. */
+	void putBack();
+	bool Answer(const char *msg, int len);
 	bool bad();
 	//void setXmlParser(QXmlSimpleReader *);
 	//void setXmlSource(QXmlInputSource *);
 
+	/*! Serves the socket on a thread of its own. The clients of the forms
+	    are moved to the consumer thread, the one calling CheckIn. To be
+	    called from the thread that owns the receptionist. */
+	void start(QThread *consumer);
+	/*! Stops the thread, the receptionist stays with it; call it before
+	    the consumer thread goes away. */
+	void stop();
+
+	/*! Loop of the reception thread. */
+	void serve();
+
+private: // member functions
+	void receive();
+	void sendAnswers();
+
 private: // data members
 	char xmlBuff[XMLMAX];		// buffer for xml messages
 	bool status;
 	QXmlSimpleReader *xmlParser;
 	QXmlInputSource xmlSource;
 	cbClientForm form;
+
+	cbReceptionThread receptionThread;
+	QThread *consumer;			// thread taking the forms, 0 when not started
+	QAtomicInt stopping;
+	QMutex mutex;				// guards forms and answers
+	deque<cbClientForm> forms;	// checked in, waiting for CheckIn
+	deque<cbPendingAnswer> answers;		// waiting to be sent by the thread
 };
 
 #endif
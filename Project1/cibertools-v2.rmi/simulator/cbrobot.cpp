@@ -20,14 +20,24 @@
 
 #include "cbrobot.h"
 #include "cbsensor.h"
+#include "cbpool.h"
 #include "cbtarget.h"
 #include "cbsimulator.h"
 #include "cblab.h"
 #include "cbgraph.h"
+#include "cblogwriter.h"
+#include "cbsnapshot.h"
+#include "cbprofiler.h"
+#include "cbtracer.h"
+#include "cbcontroller.h"
+#include "cbsimstate.h"
+#include "cbxmlbuilder.h"
+#include "cbmessageboard.h"
 
 #include <iostream>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include <QTime>
 
 #include <QTextEdit>
@@ -47,46 +57,18 @@ cbRobot::cbRobot(const double irSensorAngle[]) : cbClient()
 {
 	int i;
 
-	collisionSensor = new cbCollisionSensor(this, "Collision");
-	sensors.push_back(collisionSensor);
-
-	collisionSensor->setRequestable(false);
-
-	collisionSensor->setRequestable(cbCollisionSensor::sensorRequestable); 
-	collisionSensor->setFifoLatency(cbCollisionSensor::sensorLatency);
-
-	groundSensor    = new cbGroundSensor(this, "Ground");
-	sensors.push_back(groundSensor);
-
-	groundSensor->setRequestable(cbGroundSensor::sensorRequestable); 
-	groundSensor->setFifoLatency(cbGroundSensor::sensorLatency);
-
-	compassSensor   = new cbCompassSensor(this, "Compass");
-	sensors.push_back(compassSensor);
-
-	compassSensor->setRequestable(cbCompassSensor::sensorRequestable); 
-	compassSensor->setFifoLatency(cbCompassSensor::sensorLatency);
-
-	/* init IR sensor relative positions */
+	/* the sensors are taken from the pool of the simulator, in setSimulator */
+	collisionSensor = 0;
+	groundSensor = 0;
+	compassSensor = 0;
 	for(i=0; i < NUM_IR_SENSORS ; i++) {
-	   irSensors[i] = new cbIRSensor(this, QString("IRSensor") + QString::number(i));
-	   sensors.push_back(irSensors[i]);
-
-	   irSensors[i]->setRequestable(cbIRSensor::sensorRequestable); 
-	   irSensors[i]->setFifoLatency(cbIRSensor::sensorLatency);
-
-	   irSensors[i]->setPosition(ROBOT_RADIUS, irSensorAngle[i]);
+	   irSensors[i] = 0;
+	   irAngles[i] = irSensorAngle[i];
 	}
-
-	GPSOn = true;
-	GPSDirOn = false;
-	GPSSensor   = new cbGPSSensor(this, "GPS");
-	sensors.push_back(GPSSensor);
-
-    GPSSensor->setRequestable(cbGPSSensor::sensorRequestable);
-	GPSSensor->setFifoLatency(cbGPSSensor::sensorLatency);
+	GPSSensor = 0;
 
     simulator = 0;
+    conf = 0;
     name = 0;
 	id = 0;
 	score = 0;
@@ -120,10 +102,41 @@ cbRobot::cbRobot(const double irSensorAngle[]) : cbClient()
 
 cbRobot::~cbRobot()
 {
+	releaseSensors();
+	free(name);
+}
+
+/*!
+	Give the sensors back to the pool of the simulator.
+*/
+void cbRobot::releaseSensors()
+{
+	if (simulator == 0 || collisionSensor == 0) return;
+
+	cbSensorPool &pool = simulator->sensorPool();
+	pool.release(collisionSensor);
+	pool.release(groundSensor);
+	pool.release(compassSensor);
+	// in reverse, the next robot takes them in order
+	for(int i=NUM_IR_SENSORS-1; i >= 0 ; i--)
+	   pool.release(irSensors[i]);
+	pool.release(GPSSensor);
+	for(int b=beaconSensors.size()-1; b >= 0; b--)
+		pool.release(beaconSensors[b]);
+
+	collisionSensor = 0;
+	groundSensor = 0;
+	compassSensor = 0;
+	for(int i=0; i < NUM_IR_SENSORS ; i++)
+	   irSensors[i] = 0;
+	GPSSensor = 0;
+	beaconSensors.clear();
+	sensors.clear();
 }
 
 void cbRobot::setName(const char *nm)
 {
+	free(name);
 	name = strdup(nm);
 }
 
@@ -149,17 +162,60 @@ const char *cbRobot::curStateAsString()
 
 void cbRobot::setSimulator(cbSimulator *s)
 {
+	releaseSensors();
 	simulator = s; 
+	conf = &simulator->robotConfig();
+
+	cbSensorPool &pool = simulator->sensorPool();
+	sensors.reserve(3 + NUM_IR_SENSORS + 1 + simulator->Lab()->nBeacons());
+
+	collisionSensor = pool.collision(this);
+	sensors.push_back(collisionSensor);
+
+	groundSensor    = pool.ground(this);
+	sensors.push_back(groundSensor);
+
+	compassSensor   = pool.compass(this);
+	sensors.push_back(compassSensor);
+
+	/* init IR sensor relative positions */
+	for(int i=0; i < NUM_IR_SENSORS ; i++) {
+	   irSensors[i] = pool.ir(this, i);
+	   sensors.push_back(irSensors[i]);
+
+	   irSensors[i]->setPosition(ROBOT_RADIUS, irAngles[i]);
+	}
+
+	GPSSensor   = pool.gps(this);
+	sensors.push_back(GPSSensor);
+
+	// requests and latencies of the sensors
+	collisionSensor->setRequestable(conf->collisionRequestable); 
+	collisionSensor->setFifoLatency(conf->collisionLatency);
+
+	groundSensor->setRequestable(conf->groundRequestable); 
+	groundSensor->setFifoLatency(conf->groundLatency);
+
+	compassSensor->setRequestable(conf->compassRequestable); 
+	compassSensor->setFifoLatency(conf->compassLatency);
+
+	for(int i=0; i < NUM_IR_SENSORS ; i++) {
+	   irSensors[i]->setRequestable(conf->obstacleRequestable); 
+	   irSensors[i]->setFifoLatency(conf->obstacleLatency);
+	}
+
+    GPSSensor->setRequestable(conf->gpsRequestable);
+	GPSSensor->setFifoLatency(conf->gpsLatency);
 
 	// Set the number of beacon sensors
 	beaconSensors.resize(simulator->Lab()->nBeacons());
 	for(unsigned int b=0; b<beaconSensors.size();b++) {
-		beaconSensors[b] = new cbBeaconSensor(this, QString("Beacon")+QString::number(b));
+		beaconSensors[b] = pool.beacon(this, b);
 		sensors.push_back(beaconSensors[b]);
 
 		beaconSensors[b]->setBeaconToFollow(b);
-        beaconSensors[b]->setFifoLatency(cbBeaconSensor::sensorLatency);
-        beaconSensors[b]->setRequestable(cbBeaconSensor::sensorRequestable);
+        beaconSensors[b]->setFifoLatency(conf->beaconLatency);
+        beaconSensors[b]->setRequestable(conf->beaconRequestable);
 
 	}
 
@@ -167,13 +223,15 @@ void cbRobot::setSimulator(cbSimulator *s)
 	targetVisited.resize(simulator->Lab()->nTargets(), false);
 
     //scorePenalties = 100 * simulator->Lab()->nTargets(); //100 for each target area + 100 for returning
-    scorePenalties = targetReward * (simulator->Lab()->nTargets() - 1) + homeReward;
+    scorePenalties = conf->targetReward * (simulator->Lab()->nTargets() - 1) + conf->homeReward;
 	
 }
 
 void cbRobot::setIRSensorAngle(unsigned int irId, double irAngle)
 {
-	irSensors[irId]->setPosition(ROBOT_RADIUS, irAngle);
+	irAngles[irId] = irAngle;
+	if (irSensors[irId] != 0)
+		irSensors[irId]->setPosition(ROBOT_RADIUS, irAngle);
 }
 
 void cbRobot::setLeftMotor(double p)
@@ -233,7 +291,7 @@ void cbRobot::requestSensor(QString sensorStrId)
 { 
 	unsigned int s;
 
-	if (nSensorsRequested == maxSensorsRequested) {
+	if (nSensorsRequested == conf->maxSensorsRequested) {
 		cerr << "Robot " << id << " trying to request more sensors than permitted\n";
 		return;	
 	}
@@ -281,13 +339,14 @@ bool cbRobot::readAction(cbRobotAction *action)
 		return false;
 	}
 	else xmlBuff[xmlSize]='\0';
+	cbProfiler::countIn(xmlSize);
 
 #ifdef DEBUG_ROBOT
 	cerr << "cbRobot: " << xmlBuff << "\n";
 #endif
 
-    if (showActions)
-        simulator->GUI()->writeOnBoard(QString(name) + " : " + xmlBuff, (int) id, 1);
+    if (conf->showActions && simulator->diagnostics().wanted(cbDiagnostics::ACTION, id))
+        simulator->diagnostics().record(cbDiagnostics::ACTION, simulator->curTime(), id, name, xmlBuff, xmlSize);
 
 	/* parse xml message */
     parser.setContentHandler(&handler);
@@ -295,8 +354,11 @@ bool cbRobot::readAction(cbRobotAction *action)
 	if (!parser.parse(source))
 	{
         cerr << "cbRobot::Fail parsing xml action message: \"" << xmlBuff << "\"\n";
-        simulator->GUI()->appendMessage( "cbRobot: Fail parsing xml action message:" , true);
-        simulator->GUI()->appendMessage( QString(" \"")+xmlBuff+"\"" , true);
+        cbProfiler::countParseFailure();
+        if (simulator->GUI()) {
+            simulator->GUI()->appendMessage( "cbRobot: Fail parsing xml action message:" , true);
+            simulator->GUI()->appendMessage( QString(" \"")+xmlBuff+"\"" , true);
+        }
 
 		return false;
 	}
@@ -312,7 +374,7 @@ void cbRobot::computeNextPosition()
 {
 	if (_state == REMOVED) return;
 
-	vel = (rightMotor.outPower() + leftMotor.outPower()) / 2.0;
+	vel = (rightMotor.outPower(conf->motorsNoise) + leftMotor.outPower(conf->motorsNoise)) / 2.0;
 	double rot = (rightMotor.lastOutPower() - leftMotor.lastOutPower()) / (2.0 * ROBOT_RADIUS); // outPower should be called only once per cycle
 
 	double theta = curPos.Direction();
@@ -499,7 +561,7 @@ unsigned int cbRobot::distFromInitScore(void)
      simulator->grAux->addFinalPoint(id,curPos.Coord());
      // determine distance score, id determines initial position
      //return (unsigned int)(100*simulator->grAux->dist(id)/distAtArrival);
-     return (unsigned int)(arrivalTimePenalty*simulator->grAux->dist(id)/distAtArrival);
+     return (unsigned int)(conf->arrivalTimePenalty*simulator->grAux->dist(id)/distAtArrival);
 }
 
 /*!
@@ -513,7 +575,7 @@ unsigned int cbRobot::returnTimeScore(void)
 	if(returningTime<distHomeToTarget/0.15)
 		return 0;
 	
-    return (int)(returningTime-((int)(distHomeToTarget/0.15)))/returnTimePenalty;
+    return (int)(returningTime-((int)(distHomeToTarget/0.15)))/conf->returnTimePenalty;
 }
 
 //#define ARRIVALTIMEPENALTY 100
@@ -525,7 +587,7 @@ unsigned int cbRobot::arrivalTimeScore(void)
 	if(arrivalTime<distGridToBeacon/0.15)
 		return 0;
 	
-    return (int)(arrivalTime-((int)(distGridToBeacon/0.15)))/arrivalTimePenalty;
+    return (int)(arrivalTime-((int)(distGridToBeacon/0.15)))/conf->arrivalTimePenalty;
 }
 
 /*!
@@ -547,10 +609,8 @@ void cbRobot::updateScore()
         //double distCol=simulator->grAux->dist(id);
         //cerr << simulator->curTime() << ": R" << id << " distCol=" << distCol <<"\n";
         //scorePenalties += COLLISION_PENALTY;
-        scorePenalties += (collisionWallPenalty * hasCollideWall()) + (collisionRobotPenalty * hasCollideRobot());
+        scorePenalties += (conf->collisionWallPenalty * hasCollideWall()) + (conf->collisionRobotPenalty * hasCollideRobot());
         collisionCount++;
-
-        emit robCollisionsChanged((int) collisionCount);
     }
     //collisionPrevCycle=collision;
     collisionPrevCycle = hasCollide();
@@ -577,10 +637,10 @@ void cbRobot::updateScore()
                 if(simulator->curTime() < simulator->keyTime()
                         || simulator->keyTime()>=simulator->simTime())
                     //scorePenalties -= 100;
-                    scorePenalties -= targetReward;
+                    scorePenalties -= conf->targetReward;
                 else
                     //scorePenalties -= 50 + 50 * (simulator->simTime() - simulator->curTime())/(simulator->simTime()-simulator->keyTime());
-                    scorePenalties -= targetReward/2 + targetReward/2 * (simulator->simTime() - simulator->curTime())/(simulator->simTime()-simulator->keyTime());
+                    scorePenalties -= conf->targetReward/2 + conf->targetReward/2 * (simulator->simTime() - simulator->curTime())/(simulator->simTime()-simulator->keyTime());
 
                 simulator->grAux->addFinalPoint(id,curPos.Coord());
                 //cerr << simulator->curTime()<< ": R" << id << " distAtArrival=" << distAtArrival << "\n";
@@ -602,7 +662,7 @@ void cbRobot::updateScore()
 
 		        targetVisited[targetAtPos()] = true;
                 //scorePenalties -= 100;
-                scorePenalties -= homeReward;
+                scorePenalties -= conf->homeReward;
 
 		    }
 		    score = scorePenalties + returnTimeScore();  
@@ -611,10 +671,6 @@ void cbRobot::updateScore()
 	   default:
 		    break;
     }
-
-    emit robArrivalTimeChanged((int) arrivalTime);
-    emit robReturnTimeChanged((int) returningTime);
-    emit robScoreChanged((int) score);
 }
 
 /*!
@@ -632,28 +688,28 @@ void cbRobot::updateSensors()
 */
 void cbRobot::sendSensors()
 {
+	CB_TRACE_MARK(traceStart);
 	char xml[16*1024];
-	unsigned int n;
-	n = sprintf(xml, "<Measures Time=\"%u\">\n", simulator->curTime());
+	cbXmlBuilder x(xml, sizeof(xml));
+	x << "<Measures Time=\"" << simulator->curTime() << "\">\n";
 	/* add sensor information */
-	n += sprintf(xml+n, "\t<Sensors");
+	x << "\t<Sensors";
 
 	if(!collisionSensor->requestable || collisionSensor->requested)
-	     n += sprintf(xml+n, " Collision=\"%s\"", collisionSensor->Value()?"Yes":"No");
+	     x << " Collision=\"" << (collisionSensor->Value()?"Yes":"No") << '"';
 
 	if(!compassSensor->requestable || compassSensor->requested)
-	     n += sprintf(xml+n, " Compass=\"%g\"", compassSensor->Degrees());
+	     x << " Compass=\"" << compassSensor->Degrees() << '"';
 
 	if(!groundSensor->requestable || groundSensor->requested)
-	     n += sprintf(xml+n, " Ground=\"%d\"", groundSensor->Value());
+	     x << " Ground=\"" << groundSensor->Value() << '"';
 
-	n += sprintf(xml+n, ">\n"); //end of attributes
+	x << ">\n"; //end of attributes
 
 	//IRSensors
 	for(int i=0; i < NUM_IR_SENSORS; i++) {
 		if(!irSensors[i]->requestable ||irSensors[i]->requested) {
-		    n += sprintf(xml+n,"\t\t<IRSensor Id=\"%d\" Value=\"%g\"/>\n",
-				i, irSensors[i]->Value());
+		    x << "\t\t<IRSensor Id=\"" << i << "\" Value=\"" << irSensors[i]->Value() << "\"/>\n";
 		}
 	}
 
@@ -662,37 +718,38 @@ void cbRobot::sendSensors()
 	{
 	    if(!beaconSensors[b]->requestable || beaconSensors[b]->requested) {
 	        if(beaconSensors[b]->Ready()){
-		    n += sprintf(xml+n, "\t\t<BeaconSensor Id=\"%d\" Value=", b);
+		    x << "\t\t<BeaconSensor Id=\"" << b << "\" Value=";
 	            if(beaconSensors[b]->BeaconVisible())
-	                n += sprintf(xml+n, "\"%g\"", beaconSensors[b]->Degrees());
+	                x << '"' << beaconSensors[b]->Degrees() << '"';
 	            else
-	                n += sprintf(xml+n, "\"NotVisible\"");
-		    n += sprintf(xml+n, "/>\n");
+	                x << "\"NotVisible\"";
+		    x << "/>\n";
 	        }
 	    }
     }
 
     //GPS
-    if(GPSOn) {
+    if(conf->GPSOn) {
 	   if(!GPSSensor->requestable || GPSSensor->requested) {
-	       n += sprintf(xml+n, "\t\t<GPS X=\"%g\" Y=\"%g\" ", GPSSensor->X(), GPSSensor->Y());
-	       if(GPSDirOn)
-	           n += sprintf(xml+n, " Dir=\"%g\" ", GPSSensor->Degrees());
-	       n += sprintf(xml+n, "/>\n"); 
+	       x << "\t\t<GPS X=\"" << GPSSensor->X() << "\" Y=\"" << GPSSensor->Y() << "\" ";
+	       if(conf->GPSDirOn)
+	           x << " Dir=\"" << GPSSensor->Degrees() << "\" ";
+	       x << "/>\n";
        }
     }
 
     //Message
-    unsigned int nRobots=simulator->Robots().size();
-    for(unsigned int r=0; r < nRobots; r++) {
-        if(simulator->Robots()[r]
-            && simulator->Robots()[r]->Center().distance(curPos.Coord()) < 8.0  // MESSAGE_DIST_LIMIT
-            && simulator->Robots()[r]->getSayMessage()!="")
-            n += sprintf(xml+n, "\t\t<Message From=\"%d\"><![CDATA[%s]]></Message>\n" ,
-                         r+1, simulator->Robots()[r]->getSayMessage().toLatin1().constData());
+    const cbMessageBoard &board = simulator->messageBoard();
+    board.heard(curPos.Coord(), heardMessages, conf->maxMessageBytes);
+    for(unsigned int m=0; m < heardMessages.size(); m++) {
+        unsigned int i = heardMessages[m];
+        if(x.length() + board.length(i) + 1024 > sizeof(xml)) break;  // room for the end of the message
+        x << "\t\t<Message From=\"" << board.from(i) << "\"><![CDATA[";
+        x.append(board.text(i), board.length(i));
+        x << "]]></Message>\n";
     }
 
-    if(scoreSensorOn) {
+    if(conf->scoreSensorOn) {
 	   char visitedMask[256];
 	   int t;
 	   //determine visitedMask
@@ -700,34 +757,99 @@ void cbRobot::sendSensors()
 	        visitedMask[t]= '0' + (targetVisited[t] ? 1: 0);
 	   }
      	   visitedMask[t]='\0';
-	   n += sprintf(xml+n, "\t\t<Score Score=\"%d\" ArrivalTime=\"%d\" ReturningTime=\"%d\" "
-			                  "Collisions=\"%d\" Collision=\"%s\" VisitedMask=\"%s\" />\n", 
-                    score, arrivalTime,returningTime,collisionCount, (hasCollide()?"True":"False"), visitedMask);
+	   x << "\t\t<Score Score=\"" << (int) score << "\" ArrivalTime=\"" << (int) arrivalTime
+	     << "\" ReturningTime=\"" << (int) returningTime << "\" Collisions=\"" << (int) collisionCount
+	     << "\" Collision=\"" << (hasCollide()?"True":"False") << "\" VisitedMask=\"" << visitedMask << "\" />\n";
     }
 
-	n += sprintf(xml+n, "\t</Sensors>\n");
+	x << "\t</Sensors>\n";
 	/* add end led information */
-	n += sprintf(xml+n, "\t<Leds EndLed=\"%s\" ReturningLed=\"%s\" VisitingLed=\"%s\"/>\n", 
-			    endLed?"On":"Off", returningLed?"On":"Off", visitingLed?"On":"Off");
+	x << "\t<Leds EndLed=\"" << (endLed?"On":"Off") << "\" ReturningLed=\"" << (returningLed?"On":"Off")
+	  << "\" VisitingLed=\"" << (visitingLed?"On":"Off") << "\"/>\n";
 	/* add buttons information */
-	n += sprintf(xml+n, "\t<Buttons Start=\"%s\" Stop=\"%s\"/>\n",
-			simulator->getNextState()==cbSimulator::RUNNING?"On":"Off",
-                        simulator->getNextState()==cbSimulator::STOPPED?"On":"Off");
-	n += sprintf(xml+n, "</Measures>\n");
+	x << "\t<Buttons Start=\"" << (simulator->getNextState()==cbSimulator::RUNNING?"On":"Off")
+	  << "\" Stop=\"" << (simulator->getNextState()==cbSimulator::STOPPED?"On":"Off") << "\"/>\n";
+	x << "</Measures>\n";
+	CB_TRACE_SINCE("FormatXml", "robot", traceStart, (int) id);
+
+	if(x.overflow()) {
+		fprintf(stderr,"cbRobot::sendSensors message too long\n");
+		return;
+	}
 
 	/* send XML message to client */
-	send(xml, n+1);
+	{
+		CB_TRACE_SPAN("Send", "robot", (int) id);
+		send(xml, x.length()+1);
+	}
 	
 #ifdef DEBUG_ROBOT
 	cerr << "Measures sent to robot " << id << "\n" << xml;
 #endif
 
-    if (showMeasures)
-        simulator->GUI()->writeOnBoard("Measures sent to " + QString(name) + "(robot " + QString::number(id) + ")" + ":\n" + xml, (int) id, 0);
+    if (conf->showMeasures && simulator->diagnostics().wanted(cbDiagnostics::MEASURES, id))
+        simulator->diagnostics().record(cbDiagnostics::MEASURES, simulator->curTime(), id, name, xml, x.length());
 
 }
 
 
+/*!
+	Fill in m with the measures sendSensors writes in XML, except the
+	messages, and without rounding the values to the 6 digits of %g.
+	Sensors that are not sent hold the defaults of libRobSock.
+*/
+void cbRobot::fillMeasures(cbcMeasures &m)
+{
+	m.time = simulator->curTime();
+
+	m.collisionReady = !collisionSensor->requestable || collisionSensor->requested;
+	m.collision = m.collisionReady ? collisionSensor->Value() : 0;
+
+	m.compassReady = !compassSensor->requestable || compassSensor->requested;
+	m.compass = m.compassReady ? compassSensor->Degrees() : 0.0;
+
+	m.groundReady = !groundSensor->requestable || groundSensor->requested;
+	m.ground = m.groundReady ? groundSensor->Value() : -1;
+
+	for (int i = 0; i < NUM_IR_SENSORS; i++) {
+		m.irReady[i] = !irSensors[i]->requestable || irSensors[i]->requested;
+		m.ir[i] = m.irReady[i] ? irSensors[i]->Value() : 0.0;
+	}
+
+	m.nBeacons = (int) beaconSensors.size() < CBC_MAX_BEACONS ? (int) beaconSensors.size() : CBC_MAX_BEACONS;
+	for (int b = 0; b < m.nBeacons; b++) {
+		m.beaconReady[b] = (!beaconSensors[b]->requestable || beaconSensors[b]->requested)
+		                   && beaconSensors[b]->Ready();
+		m.beaconVisible[b] = m.beaconReady[b] && beaconSensors[b]->BeaconVisible();
+		m.beaconDir[b] = m.beaconVisible[b] ? beaconSensors[b]->Degrees() : 0.0;
+	}
+
+	m.gpsReady = conf->GPSOn && (!GPSSensor->requestable || GPSSensor->requested);
+	m.gpsDirReady = m.gpsReady && conf->GPSDirOn;
+	m.x = m.gpsReady ? GPSSensor->X() : 0.0;
+	m.y = m.gpsReady ? GPSSensor->Y() : 0.0;
+	m.dir = m.gpsDirReady ? GPSSensor->Degrees() : 0.0;
+
+	m.scoreReady = conf->scoreSensorOn;
+	if (conf->scoreSensorOn) {
+		m.score = score;
+		m.arrivalTime = arrivalTime;
+		m.returningTime = returningTime;
+		m.collisions = collisionCount;
+		m.collisionFlag = hasCollide();
+		int t;
+		for (t = 0; t < (int) simulator->Lab()->nTargets() && t < CBC_MAX_TARGETS; t++)
+			m.visitedMask[t] = '0' + (targetVisited[t] ? 1 : 0);
+		m.visitedMask[t] = '\0';
+	}
+
+	m.endLed = endLed;
+	m.returningLed = returningLed;
+	m.visitingLed = visitingLed;
+	m.start = simulator->getNextState() == cbSimulator::RUNNING;
+	m.stop = simulator->getNextState() == cbSimulator::STOPPED;
+}
+
 /*!
 	Fill in given xml buffer with robot state, that is, name, id, 
 	score, number of collisions, the collision state, removed states, and current position.
@@ -735,34 +857,34 @@ void cbRobot::sendSensors()
 */
 unsigned int cbRobot::toXml(char *xml, unsigned int len) // len = buffer size not used
 {
-	unsigned int n;
 	int t;
-	n = sprintf(xml, "<Robot");
+	cbXmlBuilder x(xml, len);
+	x << "<Robot";
 	/* add attributes */
-	n += sprintf(xml+n, " Name=\"%s\"", name);
-	n += sprintf(xml+n, " Id=\"%d\"", id);
-	n += sprintf(xml+n, " Time=\"%u\"", simulator->curTime());
-	n += sprintf(xml+n, " Score=\"%u\"", score);
-	n += sprintf(xml+n, " ArrivalTime=\"%u\"", arrivalTime);
-	n += sprintf(xml+n, " ReturningTime=\"%u\"", returningTime);
-	n += sprintf(xml+n, " Collisions=\"%u\"", collisionCount);
-    n += sprintf(xml+n, " Collision=\"%s\"", hasCollide() ? "True" : "False");
-
-	n += sprintf(xml+n, " VisitedMask=\"");
+	x << " Name=\"" << name << '"';
+	x << " Id=\"" << (int) id << '"';
+	x << " Time=\"" << simulator->curTime() << '"';
+	x << " Score=\"" << score << '"';
+	x << " ArrivalTime=\"" << arrivalTime << '"';
+	x << " ReturningTime=\"" << returningTime << '"';
+	x << " Collisions=\"" << collisionCount << '"';
+    x << " Collision=\"" << (hasCollide() ? "True" : "False") << '"';
+
+	x << " VisitedMask=\"";
 	for(t = 0; t < (int) simulator->Lab()->nTargets(); t++) {
-	    n += sprintf(xml+n, "%d", targetVisited[t] ? 1: 0);
+	    x << (targetVisited[t] ? '1' : '0');
 	}
-	n += sprintf(xml+n, "\"");
+	x << '"';
 
-	n += sprintf(xml+n, " State=\"%s\">\n", StrState[_state]);
+	x << " State=\"" << StrState[_state] << "\">\n";
 
 	/* add position */
 	double dir = curPos.directionInDegrees();
-	n += sprintf(xml+n, "\t<Position X=\"%g\" Y=\"%g\" Dir=\"%g\"/>\n", curPos.X(), 
-			curPos.Y(), dir);
-	n += sprintf(xml+n, "</Robot>\n");
+	x << "\t<Position X=\"" << curPos.X() << "\" Y=\"" << curPos.Y() << "\" Dir=\"" << dir << "\"/>\n";
+	x << "</Robot>\n";
+	unsigned int n = x.length();
 
-    if(n > len-1) {
+    if(x.overflow()) {
         fprintf(stderr,"cbRobot::toXml message is too long\n");
         abort();
     }
@@ -820,97 +942,254 @@ void cbRobot::showAllAttributes()
 	cout << xml;
 }
 
+/*!
+	Capture the state of the robot shown by the GUI, see cbSimulator::PublishSnapshot.
+*/
+void cbRobot::snapshot(cbRobotStatus &st)
+{
+	st.id = id;
+	strncpy(st.name, name, SNAPSHOT_NAME_LEN-1);
+	st.name[SNAPSHOT_NAME_LEN-1] = '\0';
+	st.state = _state;
+	st.score = score;
+	st.collisions = collisionCount;
+	st.arrivalTime = arrivalTime;
+	st.returningTime = returningTime;
+	st.collision = hasCollide();
+	st.x = X();
+	st.y = Y();
+	st.dir = Degrees();
+}
+
+/*
+ * fixed part of the state of a robot in a cbSimState
+ */
+struct cbRobotStateRecord
+{
+	int state, unstoppedState;
+	unsigned int score, scorePenalties, arrivalTime, startReturningTime, returningTime;
+	unsigned int collisionCount, nSensorsRequested;
+	double distAtArrival, distGridToBeacon, distHomeToTarget;
+	double cur[3], next[3], vel;
+	double motors[2][3];
+	unsigned char returningLed, visitingLed, endLed, removed;
+	unsigned char collisionWall, collisionRobot, collisionPrevCycle;
+	unsigned short nTargets, nSensors, sayLength;
+};
+
+/*!
+	Save everything that changes while the robot runs, see cbsimstate.h.
+*/
+void cbRobot::saveState(cbSimState &st)
+{
+	cbRobotStateRecord r;
+	r.state = _state;
+	r.unstoppedState = _unstoppedState;
+	r.score = score;
+	r.scorePenalties = scorePenalties;
+	r.arrivalTime = arrivalTime;
+	r.startReturningTime = startReturningTime;
+	r.returningTime = returningTime;
+	r.collisionCount = collisionCount;
+	r.nSensorsRequested = nSensorsRequested;
+	r.distAtArrival = distAtArrival;
+	r.distGridToBeacon = distGridToBeacon;
+	r.distHomeToTarget = distHomeToTarget;
+	r.cur[0] = curPos.X(); r.cur[1] = curPos.Y(); r.cur[2] = curPos.Direction();
+	r.next[0] = nextPos.X(); r.next[1] = nextPos.Y(); r.next[2] = nextPos.Direction();
+	r.vel = vel;
+	leftMotor.getState(r.motors[0]);
+	rightMotor.getState(r.motors[1]);
+	r.returningLed = returningLed;
+	r.visitingLed = visitingLed;
+	r.endLed = endLed;
+	r.removed = removed;
+	r.collisionWall = collisionWall;
+	r.collisionRobot = collisionRobot;
+	r.collisionPrevCycle = collisionPrevCycle;
+	r.nTargets = targetVisited.size();
+	r.nSensors = sensors.size();
+	QByteArray say = sayMessage.toLatin1();
+	r.sayLength = say.size();
+	st.put(r);
+
+	for (unsigned int t = 0; t < targetVisited.size(); t++) {
+		unsigned char v = targetVisited[t];
+		st.put(v);
+	}
+	st.put(say.constData(), say.size());
+	for (unsigned int s = 0; s < sensors.size(); s++)
+		sensors[s]->saveState(st);
+}
+
+/*!
+	Restore the state saved by saveState. Returns false if the robot
+	is not the one that was saved, sensors or targets differ.
+*/
+bool cbRobot::restoreState(cbSimState &st)
+{
+	cbRobotStateRecord r;
+	if (!st.get(r)) return false;
+	if (r.nTargets != targetVisited.size() || r.nSensors != sensors.size()) {
+		cerr << name << ": targets or sensors changed since the snapshot\n";
+		return false;
+	}
+
+	_state = (State) r.state;
+	_unstoppedState = (State) r.unstoppedState;
+	score = r.score;
+	scorePenalties = r.scorePenalties;
+	arrivalTime = r.arrivalTime;
+	startReturningTime = r.startReturningTime;
+	returningTime = r.returningTime;
+	collisionCount = r.collisionCount;
+	nSensorsRequested = r.nSensorsRequested;
+	distAtArrival = r.distAtArrival;
+	distGridToBeacon = r.distGridToBeacon;
+	distHomeToTarget = r.distHomeToTarget;
+	curPos.set(r.cur[0], r.cur[1], r.cur[2]);
+	nextPos.set(r.next[0], r.next[1], r.next[2]);
+	vel = r.vel;
+	leftMotor.setState(r.motors[0]);
+	rightMotor.setState(r.motors[1]);
+	returningLed = r.returningLed != 0;
+	visitingLed = r.visitingLed != 0;
+	endLed = r.endLed != 0;
+	removed = r.removed != 0;
+	collisionWall = r.collisionWall != 0;
+	collisionRobot = r.collisionRobot != 0;
+	collisionPrevCycle = r.collisionPrevCycle != 0;
+
+	for (unsigned int t = 0; t < targetVisited.size(); t++) {
+		unsigned char v;
+		if (!st.get(v)) return false;
+		targetVisited[t] = v != 0;
+	}
+	QByteArray say(r.sayLength, '\0');
+	if (!st.get(say.data(), r.sayLength)) return false;
+	sayMessage = QString::fromLatin1(say.constData(), say.size());
+	for (unsigned int s = 0; s < sensors.size(); s++)
+		if (!sensors[s]->restoreState(st)) return false;
+
+	emit robStateChanged(_state);
+	emit robStateChanged(QString(curStateAsString()));
+	return true;
+}
+
+bool cbRobot::checkState(cbSimState &st)
+{
+	cbRobotStateRecord r;
+	if (!st.get(r)) return false;
+	if (r.nTargets != targetVisited.size() || r.nSensors != sensors.size()) {
+		cerr << name << ": targets or sensors changed since the snapshot\n";
+		return false;
+	}
+
+	for (unsigned int t = 0; t < targetVisited.size(); t++) {
+		unsigned char v;
+		if (!st.get(v)) return false;
+	}
+	QByteArray say(r.sayLength, '\0');
+	if (!st.get(say.data(), r.sayLength)) return false;
+	for (unsigned int s = 0; s < sensors.size(); s++)
+		if (!sensors[s]->checkState(st)) return false;
+	return true;
+}
+
 #define LOGWITHMEASURES
 
-void cbRobot::Log(ostream &log, bool withActions)
+/*!
+	Capture the state of the robot that goes into the log.
+	Formatting is left to cbLogWriter, so that it may be done outside
+	the simulation thread.
+*/
+void cbRobot::logRecord(cbLogRobotRecord &rec, bool withActions)
 {
-	char visitedMask[256];
-    int  t;
-    log << "\t<Robot Name=\"" << Name() <<"\""
-		       << " Id=\"" << Id() << "\"" 
-		       << " State=\"" << StrState[_state] <<"\"" 
-		       << ">\n";
-	log << "\t\t<Pos X=\""<< X()
-	          << "\" Y=\"" << Y() 
-	          << "\" Dir=\"" << Degrees() << "\"/>\n";
+	int t;
+
+	rec.name = Name();
+	rec.id = Id();
+	rec.state = StrState[_state];
+
+	rec.x = X();
+	rec.y = Y();
+	rec.dir = Degrees();
+
+	rec.score = score;
+	rec.arrivalTime = arrivalTime;
+	rec.returningTime = returningTime;
+	rec.collisions = collisionCount;
+	rec.collision = hasCollide();
 
 	//determine visitedMask
+	rec.visitedMask.resize(simulator->Lab()->nTargets());
 	for(t = 0; t < (int) simulator->Lab()->nTargets(); t++) {
-	    visitedMask[t]= '0' + (targetVisited[t] ? 1: 0);
+	    rec.visitedMask[t]= '0' + (targetVisited[t] ? 1: 0);
 	}
-	visitedMask[t]='\0';
 
-	log << "\t\t<Scores Score=\"" << score << "\""
-		        <<" ArrivalTime=\"" << arrivalTime <<"\""
-		        <<" ReturningTime=\"" << returningTime <<"\""
-		        <<" Collisions=\"" << collisionCount <<"\""
-                <<" Collision=\"" << (hasCollide() ? "True" : "False") << "\""
-		        <<" VisitedMask=\"" << visitedMask << "\""
-		        << "/>\n";
-
-    if( withActions && receivedAction()  )
-    {
-        log << "\t\t<Action";
-	    if(receivedLeftMotor())
-	        log << " LeftMotor=\"" << LeftMotor().inPower() << "\"";
-	    if(receivedRightMotor())
-	        log << " RightMotor=\"" << RightMotor().inPower() << "\""; 
-	    if(receivedEndLed())
-	        log << " EndLed=\"" << (endLedOn()?"On":"Off") << "\"" ;
-	    if(receivedReturningLed())
-	        log << " ReturningLed=\"" << (returningLedOn()?"On":"Off") << "\"" ;
-	    if(receivedVisitingLed())
-	        log << " VisitingLed=\"" << (visitingLedOn()?"On":"Off") << "\"" ;
-	    log << " />\n";
+	rec.actions = 0;
+	if( withActions && receivedAction() )
+	{
+	    if(receivedLeftMotor())    rec.actions |= cbLogRobotRecord::LEFT_MOTOR;
+	    if(receivedRightMotor())   rec.actions |= cbLogRobotRecord::RIGHT_MOTOR;
+	    if(receivedEndLed())       rec.actions |= cbLogRobotRecord::END_LED;
+	    if(receivedReturningLed()) rec.actions |= cbLogRobotRecord::RETURNING_LED;
+	    if(receivedVisitingLed())  rec.actions |= cbLogRobotRecord::VISITING_LED;
+	    rec.leftMotor = LeftMotor().inPower();
+	    rec.rightMotor = RightMotor().inPower();
 	}
 
+	rec.endLed = endLed;
+	rec.returningLed = returningLed;
+	rec.visitingLed = visitingLed;
+
 #ifdef LOGWITHMEASURES
-	char xml[1024*16];
-	unsigned int n;
-	n = sprintf(xml, "<Measures Time=\"%u\">\n", simulator->curTime());
-	/* add sensor information */
-	n += sprintf(xml+n, "\t<Sensors");
-	n += sprintf(xml+n, " Compass=\"%g\"", compassSensor->Degrees());
+	rec.withMeasures = true;
+	rec.time = simulator->curTime();
 
-	n += sprintf(xml+n, " Collision=\"%s\"", collisionSensor->Value()?"Yes":"No");
-	n += sprintf(xml+n, " Ground=\"%d\">\n", groundSensor->Value());
+	rec.compass = compassSensor->Degrees();
+	rec.collisionSensor = collisionSensor->Value();
+	rec.ground = groundSensor->Value();
 
+	rec.irSensors.resize(NUM_IR_SENSORS);
 	for(int i=0; i < NUM_IR_SENSORS; i++)
-		n += sprintf(xml+n,"\t\t<IRSensor Id=\"%d\" Value=\"%g\"/>\n",
-				i, irSensors[i]->Value());
+		rec.irSensors[i] = irSensors[i]->Value();
 
+	rec.beacons.clear();
 	for(unsigned int b=0; b < beaconSensors.size(); b++) {
         if(beaconSensors[b]->Ready()){
-            n += sprintf(xml+n, "\t\t<BeaconSensor Id=\"%d\" Value=", b);
-	        if(beaconSensors[b]->BeaconVisible())
-	            n += sprintf(xml+n, "\"%g\"", beaconSensors[b]->Degrees());
-	        else
-                n += sprintf(xml+n, "\"NotVisible\"");
-            n += sprintf(xml+n, "/>\n");
+            cbLogBeaconRecord beacon;
+            beacon.id = b;
+            beacon.visible = beaconSensors[b]->BeaconVisible();
+            beacon.degrees = beacon.visible ? beaconSensors[b]->Degrees() : 0.0;
+            rec.beacons.push_back(beacon);
 	    }
 	}
 
-    if(GPSOn) {
-	   n += sprintf(xml+n, "\t\t<GPS X=\"%g\" Y=\"%g\" ", 
-                    GPSSensor->X(), GPSSensor->Y());
-       if(GPSDirOn) n += sprintf(xml+n, " Dir=\"%g\" ", GPSSensor->Degrees());
-       n += sprintf(xml+n, "/>\n");
+	rec.gps = conf->GPSOn;
+	rec.gpsDir = conf->GPSDirOn;
+    if(conf->GPSOn) {
+        rec.gpsX = GPSSensor->X();
+        rec.gpsY = GPSSensor->Y();
+        rec.gpsDegrees = conf->GPSDirOn ? GPSSensor->Degrees() : 0.0;
     }
 
-	n += sprintf(xml+n, "\t</Sensors>\n");
-	/* add end led information */
-	n += sprintf(xml+n, "\t<Leds EndLed=\"%s\" ReturningLed=\"%s\" VisitingLed=\"%s\"/>\n", 
-			    endLed?"On":"Off", returningLed?"On":"Off", visitingLed?"On":"Off");
-	/* add buttons information */
-	n += sprintf(xml+n, "\t<Buttons Start=\"%s\" Stop=\"%s\"/>\n",
-			simulator->getNextState()==cbSimulator::RUNNING?"On":"Off",
-                        simulator->getNextState()==cbSimulator::STOPPED?"On":"Off");
-	n += sprintf(xml+n, "</Measures>\n");
-
-	log << xml;
+	rec.startButton = simulator->getNextState()==cbSimulator::RUNNING;
+	rec.stopButton = simulator->getNextState()==cbSimulator::STOPPED;
+#else
+	rec.withMeasures = false;
 #endif
+}
+
+void cbRobot::Log(ostream &log, bool withActions)
+{
+	cbLogRobotRecord rec;
+	string xml;
 
-    log << "\t</Robot>\n";
+	logRecord(rec, withActions);
+	cbLogWriter::formatRobot(rec, xml);
+
+	log << xml;
 }
 
 // cbRobotBin
@@ -918,7 +1197,9 @@ void cbRobot::Log(ostream &log, bool withActions)
 #include "netif.h"
 
 
-bool cbRobotBin::Reply(QHostAddress &a, unsigned short &p, cbParameters *param)
+// the binary protocol has its own reply, the XML one is not used
+bool cbRobotBin::Reply(QHostAddress &a, unsigned short &p, cbParameters *param,
+                       const char *, int)
 {
 	//cout.form("Sending reply for client to %s:%hd\n", a.toString().latin1(), p);
 	/* set peer address and peer port */
@@ -942,9 +1223,10 @@ bool cbRobotBin::Reply(QHostAddress &a, unsigned short &p, cbParameters *param)
    if (writeDatagram((char *)&commMsg, sizeof(CommMessage), address, port) != sizeof(CommMessage))
 	{
         cerr << "Fail replying to client\n";
-        simulator->GUI()->appendMessage( "Fail replying to client", true);
+        if (simulator->GUI()) simulator->GUI()->appendMessage( "Fail replying to client", true);
 		return false;
 	}
+   cbProfiler::countOut(sizeof(CommMessage));
 
    //cout << "Reply sent\n" << reply;
 	return true;
@@ -967,11 +1249,13 @@ bool cbRobotBin::readAction(cbRobotAction *action)
         //cerr << "Error no. " << error() << " reading from robot socket\n";
 		return false;
 	}
+   cbProfiler::countIn(ret);
 
    // check message size
    if(ret!=sizeof(ActMessage)) {
+       cbProfiler::countParseFailure();
        cerr << "Received bad ActMessage from " << Name() << "\n";
-       simulator->GUI()->appendMessage( QString("Received bad ActMessage from ") + Name(), true );
+       if (simulator->GUI()) simulator->GUI()->appendMessage( QString("Received bad ActMessage from ") + Name(), true );
    }
 
    action->leftMotor=((short)ntohs(msg.lPow))/1000.0-2.0;
@@ -1009,7 +1293,10 @@ void cbRobotBin::sendSensors()
 
 
 	/* send XML message to client */
-	send((char *)&msg, sizeof(msg));
+	{
+		CB_TRACE_SPAN("Send", "robot", (int) id);
+		send((char *)&msg, sizeof(msg));
+	}
 #ifdef DEBUG_ROBOT
 	cerr << "Measures sent to robot (bin protocol)\n";
 #endif
@@ -28,6 +28,8 @@
 #include "cbposition.h"
 #include "cbmotor.h"
 #include "cbsensor.h"
+#include "cbrobotconfig.h"
+#include "cbrobotsize.h"
 
 using std::ostream;
 
@@ -35,10 +37,13 @@ using std::ostream;
   *@author Nuno Lau, Artur Pereira & Andreia Melo, Miguel Rodrigues
   */
 
-#define ROBOT_RADIUS 0.5
 #define NUM_IR_SENSORS 4
 
 class cbSimulator;
+struct cbLogRobotRecord;
+struct cbRobotStatus;
+struct cbcMeasures;
+class cbSimState;
 
 const double irSensorDefaultAngles[NUM_IR_SENSORS]={0, M_PI/3, -M_PI/3, M_PI};
 
@@ -62,8 +67,12 @@ public:
 	unsigned int Id();
 	void setIRSensorAngle(unsigned int irId, double irAngle);
 
+	/*! Registers the robot in s, its sensors are taken from the pool
+	    of s and given back when the robot is deleted. */
 	void setSimulator(cbSimulator *s);
 	inline cbSimulator *getSimulator() { return simulator; }
+	/*! Settings of the simulator, valid once the robot is registered. */
+	inline const cbRobotConfig &config() { return *conf; }
 
 	virtual bool readAction(cbRobotAction *);
 
@@ -148,6 +157,7 @@ public:
 	void updateSensors();
 
 	virtual void sendSensors();
+	void fillMeasures(cbcMeasures &m);
 
 	unsigned int toXml(char *, unsigned int);
 
@@ -156,13 +166,17 @@ public:
 
 	void showAllAttributes();
 	void Log(ostream &Log, bool withactions=true);
+	void logRecord(cbLogRobotRecord &rec, bool withactions=true);
+	void snapshot(cbRobotStatus &st);
+	/*! Save or restore the state of the robot, see cbsimstate.h. */
+	void saveState(cbSimState &st);
+	bool restoreState(cbSimState &st);
+	/*! Reads the state written by saveState without changing the
+	    robot, false if restoreState would fail. */
+	bool checkState(cbSimState &st);
 
 signals:
 
-    void robCollisionsChanged(int);
-    void robReturnTimeChanged(int);
-    void robArrivalTimeChanged(int);
-    void robScoreChanged(int);
     void robStateChanged(cbRobot::State);
     void robStateChanged(QString);
 
@@ -170,24 +184,7 @@ protected:
     unsigned int distFromInitScore(void);
     unsigned int returnTimeScore(void);
     unsigned int arrivalTimeScore(void);
-
-public:
-	// global robot parameters
-	
-	static unsigned int  maxSensorsRequested;
-	static bool GPSOn;
-	static bool GPSDirOn;
-	static bool scoreSensorOn;
-	static bool showActions;
-    static bool showMeasures;
-    static bool ignoreOthers;
-
-    static int returnTimePenalty;
-    static int arrivalTimePenalty;
-    static int collisionWallPenalty;
-    static int collisionRobotPenalty;
-    static int targetReward;
-    static int homeReward;
+    void releaseSensors(void);
 
 protected:  // class data members
 
@@ -212,6 +209,7 @@ protected:  // class data members
 	bool endLed;
 
     QString sayMessage;
+    vector<unsigned int> heardMessages;	// of the message board, reused every cycle
 
     bool recLeftMotor, recRightMotor, recVisitingLed, recReturningLed, recEndLed;
 
@@ -223,11 +221,13 @@ protected:  // class data members
 	vector<cbBeaconSensor *> beaconSensors;
 	cbIRSensor *irSensors[NUM_IR_SENSORS];
 	cbGPSSensor *GPSSensor;
+	double irAngles[NUM_IR_SENSORS];	// of the IR sensors, set up when registered
 
 	vector <cbSensor *> sensors;  // all robot sensors should have their pointer added to this vector
 
 
 	cbSimulator *simulator;
+	const cbRobotConfig *conf;
 
 	cbPosition curPos;	// current position of robot
 	cbPosition nextPos;	// next position of robot
@@ -251,7 +251,8 @@ public:
     virtual ~cbRobotBin() {}
 	virtual bool readAction(cbRobotAction *);
 	virtual void sendSensors();
-	virtual bool Reply(QHostAddress &addr, unsigned short &port, cbParameters *param);
+	virtual bool Reply(QHostAddress &addr, unsigned short &port, cbParameters *param,
+	                   const char *reply=0, int len=0);
 	virtual bool Refuse(QHostAddress &addr, unsigned short &port);
 
 };
@@ -0,0 +1,116 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "cbrobotconfig.h"
+#include "cbparameters.h"
+#include "cbposition.h"
+#include "cbutils.h"
+
+cbRobotConfig::cbRobotConfig()
+{
+	motorsNoise   = 0.0;
+	compassNoise  = 0.0;
+	beaconNoise   = 0.0;
+	obstacleNoise = 0.0;
+	gpsLinNoise   = 0.5;
+	gpsAngNoise   = 5.0;
+	gpsOffsetDeg  = 0.0;  // a different value would not be consistent with XY reference frame nor with compass
+	newGPSOffset();
+
+	maxSensorsRequested  = 4;
+	obstacleRequestable  = false;
+	beaconRequestable    = false;
+	compassRequestable   = false;
+	groundRequestable    = false;
+	collisionRequestable = false;
+	gpsRequestable       = false;
+
+	obstacleLatency  = 0;
+	beaconLatency    = 0;
+	compassLatency   = 0;
+	groundLatency    = 0;
+	collisionLatency = 0;
+	gpsLatency       = 0;
+
+	beaconAperture = M_PI;
+	maxMessageBytes = 4096;
+
+	GPSOn         = true;
+	GPSDirOn      = false;
+	scoreSensorOn = false;
+	showActions   = true;
+	showMeasures  = true;
+	ignoreOthers  = false;
+
+	returnTimePenalty     = 25;
+	arrivalTimePenalty    = 100;
+	collisionWallPenalty  = 2;
+	collisionRobotPenalty = 2;
+	targetReward          = 100;
+	homeReward            = 100;
+}
+
+void cbRobotConfig::setParameters(const cbParameters *param)
+{
+	//Noise
+	motorsNoise   = param->motorsNoise;
+	compassNoise  = param->compassNoise * M_PI / 180;	// noise must be in radians
+	beaconNoise   = param->beaconNoise * M_PI / 180;	// noise must be in radians
+	obstacleNoise = param->obstacleNoise;
+	gpsLinNoise   = param->gpsLinNoise;
+	gpsAngNoise   = param->gpsDirNoise;
+
+	//Requests
+	maxSensorsRequested  = param->nReqPerCycle;
+	obstacleRequestable  = param->obstacleRequestable;
+	beaconRequestable    = param->beaconRequestable;
+	compassRequestable   = param->compassRequestable;
+	groundRequestable    = param->groundRequestable;
+	collisionRequestable = param->collisionRequestable;
+	gpsRequestable       = param->gpsRequestable;
+
+	//Latencies
+	obstacleLatency  = param->obstacleLatency;
+	beaconLatency    = param->beaconLatency;
+	compassLatency   = param->compassLatency;
+	groundLatency    = param->groundLatency;
+	collisionLatency = param->collisionLatency;
+	gpsLatency       = param->gpsLatency;
+
+	beaconAperture = param->beaconAperture;
+	maxMessageBytes = param->maxMessageBytes;
+
+	GPSOn         = param->GPSOn;
+	scoreSensorOn = param->scoreSensorOn;
+
+	//Scores
+	returnTimePenalty     = param->returnTimePenalty;
+	arrivalTimePenalty    = param->arrivalTimePenalty;
+	collisionWallPenalty  = param->collisionWallPenalty;
+	collisionRobotPenalty = param->collisionRobotPenalty;
+	targetReward          = param->targetReward;
+	homeReward            = param->homeReward;
+}
+
+void cbRobotConfig::newGPSOffset()
+{
+	gpsOffsetX = randUniform(0.0,1000.0);
+	gpsOffsetY = randUniform(0.0,1000.0);
+}
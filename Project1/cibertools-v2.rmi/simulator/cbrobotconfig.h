@@ -0,0 +1,78 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef CB_ROBOT_CONFIG_H
+#define CB_ROBOT_CONFIG_H
+
+class cbParameters;
+
+/**
+ * Settings shared by all the robots of one simulator: sensor noise,
+ * latencies and requests, scoring and the switches of the control panel.
+ *
+ * They are derived from the simulation parameters by setParameters; each
+ * cbSimulator has its own, so that several simulations can run in the
+ * same process.
+ */
+class cbRobotConfig
+{
+public:
+	cbRobotConfig();
+
+	void setParameters(const cbParameters *param);
+	/*! Draws a new offset of the GPS reference frame. */
+	void newGPSOffset();
+
+public:
+	//Noise, angular noise in radians
+	double motorsNoise;
+	double compassNoise, beaconNoise, obstacleNoise;
+	double gpsLinNoise, gpsAngNoise;
+	double gpsOffsetX, gpsOffsetY, gpsOffsetDeg;
+
+	//Requests
+	unsigned int maxSensorsRequested;
+	bool obstacleRequestable, beaconRequestable, compassRequestable,
+	     groundRequestable, collisionRequestable, gpsRequestable;
+
+	//Latencies
+	int obstacleLatency, beaconLatency, compassLatency,
+	    groundLatency, collisionLatency, gpsLatency;
+
+	double beaconAperture;
+	unsigned int maxMessageBytes;	// of the Say messages in one measures message, 0 no limit
+
+	bool GPSOn;
+	bool GPSDirOn;
+	bool scoreSensorOn;
+	bool showActions;
+	bool showMeasures;
+	bool ignoreOthers;
+
+	//Scores
+	int returnTimePenalty;
+	int arrivalTimePenalty;
+	int collisionWallPenalty;
+	int collisionRobotPenalty;
+	int targetReward;
+	int homeReward;
+};
+
+#endif
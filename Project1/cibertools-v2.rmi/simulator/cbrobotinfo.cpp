@@ -21,13 +21,13 @@
 #include "cbrobotinfo.h"
 #include "ui_cbrobotinfo.h"
 
-cbRobotInfo::cbRobotInfo(cbRobot *rob, QWidget *parent) :
+cbRobotInfo::cbRobotInfo(unsigned int id, const QString &name, QWidget *parent) :
     QWidget(parent),
     ui(new Ui::cbRobotInfo)
 {
     ui->setupUi(this);
 
-    robot = rob;
+    state = cbRobot::STOPPED;
 
     QSize scale = ui->label_State->size();
     stopPix = QPixmap(":/images/robot/states/stopped").scaled(scale);
@@ -37,16 +37,10 @@ cbRobotInfo::cbRobotInfo(cbRobot *rob, QWidget *parent) :
     finishPix = QPixmap(":/images/robot/states/finished").scaled(scale);
     returnPix = QPixmap(":/images/robot/states/returning").scaled(scale);
 
-    ui->label_Name->setText(robot->Name());
-    ui->lcdNumber_ID->display((int) robot->Id());
+    ui->label_Name->setText(name);
+    ui->lcdNumber_ID->display((int) id);
     ui->label_State->setPixmap(stopPix);
     ui->label_State->setToolTip("Stopped");
-
-    connect(robot, SIGNAL(robCollisionsChanged(int)), ui->lcdNumber_Collisions, SLOT(display(int)));
-    connect(robot, SIGNAL(robScoreChanged(int)), ui->lcdNumber_Score, SLOT(display(int)));
-    connect(robot, SIGNAL(robArrivalTimeChanged(int)), ui->lcdNumber_Time, SLOT(display(int)));
-    connect(robot, SIGNAL(robStateChanged(cbRobot::State)), SLOT(updateState(cbRobot::State)));
-
 }
 
 cbRobotInfo::~cbRobotInfo()
@@ -54,6 +48,19 @@ cbRobotInfo::~cbRobotInfo()
     delete ui;
 }
 
+void cbRobotInfo::showStatus(const cbRobotStatus &st)
+{
+    ui->lcdNumber_Collisions->display((int) st.collisions);
+    ui->lcdNumber_Score->display((int) st.score);
+    ui->lcdNumber_Time->display((int) st.arrivalTime);
+
+    if (st.state != state)
+    {
+        state = st.state;
+        updateState((cbRobot::State) state);
+    }
+}
+
 void cbRobotInfo::updateState(cbRobot::State state)
 {
     switch (state)
@@ -27,6 +27,7 @@
 
 #include <QWidget>
 #include <cbrobot.h>
+#include <cbsnapshot.h>
 
 namespace Ui {
 class cbRobotInfo;
@@ -41,14 +42,17 @@ class cbRobotInfo : public QWidget
     Q_OBJECT
     
 public:
-    explicit cbRobotInfo(cbRobot *, QWidget *parent = 0);
+    explicit cbRobotInfo(unsigned int id, const QString &name, QWidget *parent = 0);
     ~cbRobotInfo();
 
+    /*! Shows the state of the robot in the last published cycle. */
+    void showStatus(const cbRobotStatus &st);
+
 private slots:
     void updateState(cbRobot::State state);
 
 private:
-    cbRobot *robot;
+    int state;
     QPixmap runPix;
     QPixmap waitPix;
     QPixmap stopPix;
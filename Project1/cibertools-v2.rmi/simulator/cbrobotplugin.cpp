@@ -0,0 +1,216 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "cbrobotplugin.h"
+#include "cbsimulator.h"
+#include "cbparameters.h"
+#include "cbtracer.h"
+
+#include <QLibrary>
+#include <QFileInfo>
+#include <QMap>
+
+#include <string.h>
+#include <iostream>
+
+using std::cerr;
+
+/*!
+	Load a controller library and resolve its functions. A library is
+	loaded once, later calls with the same file return the same object.
+	Returns 0 if the file can not be loaded or is not a controller of
+	this version of the interface.
+*/
+cbController *cbController::load(const QString &file)
+{
+	static QMap<QString, cbController *> loaded;
+
+	QString path = QFileInfo(file).absoluteFilePath();
+	if (loaded.contains(path)) return loaded[path];
+
+	QLibrary *lib = new QLibrary(path);
+	if (!lib->load()) {
+		cerr << "Could not load controller " << file.toStdString()
+		     << ": " << lib->errorString().toStdString() << "\n";
+		delete lib;
+		return 0;
+	}
+
+	cbcApiFunction api = (cbcApiFunction) lib->resolve("cb_controller_api");
+	cbController *c = new cbController;
+	c->create = (cbcCreateFunction) lib->resolve("cb_controller_create");
+	c->step = (cbcStepFunction) lib->resolve("cb_controller_step");
+	c->destroy = (cbcDestroyFunction) lib->resolve("cb_controller_destroy");
+
+	if (api == 0 || c->create == 0 || c->step == 0 || c->destroy == 0) {
+		cerr << file.toStdString() << " is not a controller, cb_controller_* functions missing\n";
+		delete c;
+		lib->unload();
+		delete lib;
+		return 0;
+	}
+	if (api() != CB_CONTROLLER_API) {
+		cerr << file.toStdString() << " was built for controller API " << api()
+		     << ", the simulator uses " << CB_CONTROLLER_API << "\n";
+		delete c;
+		lib->unload();
+		delete lib;
+		return 0;
+	}
+
+	c->library = lib;
+	c->fileName = path;
+	c->baseName = QFileInfo(file).baseName();
+	if (c->baseName.startsWith("lib") && c->baseName.length() > 3)
+		c->baseName = c->baseName.mid(3);
+
+	loaded[path] = c;
+	return c;
+}
+
+cbRobotPlugin::cbRobotPlugin(cbController *c) : cbRobot(irSensorDefaultAngles)
+{
+	ctrl = c;
+	state = 0;
+	hasPending = false;
+	memset(&measures, 0, sizeof(measures));
+}
+
+cbRobotPlugin::~cbRobotPlugin()
+{
+	if (state != 0) ctrl->destroy(state);
+}
+
+/*!
+	Create the controller state with the parameters a networked robot
+	receives in the registration reply. Returns false if the controller
+	refused to start.
+*/
+bool cbRobotPlugin::start(cbParameters *param)
+{
+	cbcParameters p;
+	p.simTime = param->simTime;
+	p.cycleTime = param->cycleTime;
+	p.keyTime = param->keyTime;
+	p.nBeacons = param->nBeacons;
+	p.compassNoise = param->compassNoise;
+	p.beaconNoise = param->beaconNoise;
+	p.obstacleNoise = param->obstacleNoise;
+	p.motorsNoise = param->motorsNoise;
+	p.nReqPerCycle = param->nReqPerCycle;
+	p.gpsOn = param->GPSOn;
+	p.scoreSensorOn = param->scoreSensorOn;
+
+	state = ctrl->create(name, (int) id, &p);
+	if (state == 0) {
+		cerr << "Controller " << name << " failed to start\n";
+		return false;
+	}
+	return true;
+}
+
+/*!
+	Hand over the actions of the last controller step, once.
+*/
+bool cbRobotPlugin::readAction(cbRobotAction *action)
+{
+	if (!hasPending) return false;
+	hasPending = false;
+
+	*action = pending;
+	return true;
+}
+
+/*!
+	Add the messages said in the last cycle by the robots in range, own
+	included, to the measures.
+*/
+void cbRobotPlugin::fillMessages()
+{
+	cbcMeasures &m = measures;
+
+	// the texts stay in the board until the next cycle posts its messages
+	const cbMessageBoard &board = simulator->messageBoard();
+	board.heard(curPos.Coord(), heardMessages, conf->maxMessageBytes);
+	m.nMessages = 0;
+	for (unsigned int i = 0; i < heardMessages.size() && m.nMessages < CBC_MAX_MESSAGES; i++) {
+		m.messages[m.nMessages].from = board.from(heardMessages[i]);
+		m.messages[m.nMessages].text = board.text(heardMessages[i]);
+		m.nMessages++;
+	}
+}
+
+/*!
+	Convert the controller actions in the action read next cycle.
+*/
+void cbRobotPlugin::takeActions()
+{
+	cbcActions &a = actions;
+
+	pending.reset();
+	pending.leftMotorChanged = a.leftMotorSet != 0;
+	pending.leftMotor = a.leftMotor;
+	pending.rightMotorChanged = a.rightMotorSet != 0;
+	pending.rightMotor = a.rightMotor;
+	pending.endLedChanged = a.endLedSet != 0;
+	pending.endLed = a.endLed != 0;
+	pending.returningLedChanged = a.returningLedSet != 0;
+	pending.returningLed = a.returningLed != 0;
+	pending.visitingLedChanged = a.visitingLedSet != 0;
+	pending.visitingLed = a.visitingLed != 0;
+
+	a.say[CBC_MAX_SAY-1] = '\0';
+	if (a.say[0] != '\0') {
+		pending.sayReceived = true;
+		pending.sayMessage = QString::fromLatin1(a.say);
+	}
+
+	int nReq = a.nRequests < CBC_MAX_REQUESTS ? a.nRequests : CBC_MAX_REQUESTS;
+	for (int r = 0; r < nReq; r++) {
+		a.requests[r][CBC_SENSOR_ID_LEN-1] = '\0';
+		pending.sensorRequests.push_back(QString::fromLatin1(a.requests[r]));
+	}
+
+	// a networked robot that sends nothing produces no action
+	hasPending = pending.leftMotorChanged || pending.rightMotorChanged
+	             || pending.endLedChanged || pending.returningLedChanged
+	             || pending.visitingLedChanged || pending.sayReceived
+	             || !pending.sensorRequests.empty();
+}
+
+/*!
+	Run one step of the controller with the measures of this cycle.
+*/
+void cbRobotPlugin::sendSensors()
+{
+	if (state == 0) return;
+
+	CB_TRACE_MARK(traceStart);
+	fillMeasures(measures);
+	fillMessages();
+	CB_TRACE_SINCE("FillMeasures", "robot", traceStart, (int) id);
+
+	memset(&actions, 0, sizeof(actions));
+	{
+		CB_TRACE_SPAN("ControllerStep", "robot", (int) id);
+		ctrl->step(state, &measures, &actions);
+	}
+	takeActions();
+}
@@ -0,0 +1,98 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef CBROBOTPLUGIN_H
+#define CBROBOTPLUGIN_H
+
+#include "cbrobot.h"
+#include "cbrobotaction.h"
+#include "cbcontroller.h"
+
+#include <QString>
+#include <vector>
+
+using std::vector;
+
+class QLibrary;
+class cbParameters;
+
+/**
+ * A controller library, see cbcontroller.h. Libraries are loaded once
+ * and stay loaded until the simulator exits.
+ */
+class cbController
+{
+public:
+	/*! Loads file, or returns the library already loaded from it.
+	    Returns 0 if it is not a valid controller. */
+	static cbController *load(const QString &file);
+
+	inline const QString &file() const { return fileName; }
+	/*! Default robot name, the file name without directory, lib prefix
+	    and extension. */
+	inline const QString &name() const { return baseName; }
+
+	cbcCreateFunction create;
+	cbcStepFunction step;
+	cbcDestroyFunction destroy;
+
+private:
+	cbController() {}
+
+	QLibrary *library;
+	QString fileName, baseName;
+};
+
+/**
+ * Robot driven by an in-process controller instead of a UDP client.
+ *
+ * sendSensors fills the measures exactly as cbRobot::sendSensors writes
+ * them in XML and runs one step of the controller; the actions returned
+ * are handed to the simulator by the next readAction.
+ */
+class cbRobotPlugin : public cbRobot
+{
+public:
+	cbRobotPlugin(cbController *c);
+	virtual ~cbRobotPlugin();
+
+	/*! Creates the controller state, after the robot was registered. */
+	bool start(cbParameters *param);
+
+	virtual bool readAction(cbRobotAction *);
+	virtual void sendSensors();
+
+	inline cbController *controller() { return ctrl; }
+
+private:
+	void fillMessages();
+	void takeActions();
+
+	cbController *ctrl;
+	void *state;
+
+	cbcMeasures measures;
+	cbcActions actions;
+
+	cbRobotAction pending;
+	bool hasPending;
+};
+
+#endif
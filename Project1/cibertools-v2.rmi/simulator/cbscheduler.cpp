@@ -0,0 +1,141 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+/*
+ * class cbScheduler
+ */
+
+#include "cbscheduler.h"
+
+#include <string.h>
+
+#ifndef MicWindows
+#include <time.h>
+#include <errno.h>
+#else
+#include <QElapsedTimer>
+#include <QThread>
+#endif
+
+#define NS_PER_S 1000000000LL
+
+cbScheduler::cbScheduler()
+{
+	periodNs = 50 * 1000000LL;
+	spinNs = 0;
+	catchUp = SKIP;
+	start();
+}
+
+void cbScheduler::setPeriod(unsigned int us)
+{
+	if (us == 0) us = 1;
+	periodNs = (long long) us * 1000;
+}
+
+/*!
+	Converts "skip" or "compress" into a catch up policy.
+	Returns false if the name is unknown.
+*/
+bool cbScheduler::parseCatchUp(const char *name, CatchUp &c)
+{
+	if (strcmp(name, "skip") == 0) c = SKIP;
+	else if (strcmp(name, "compress") == 0) c = COMPRESS;
+	else return false;
+	return true;
+}
+
+void cbScheduler::start()
+{
+	cycles = overruns = skipped = 0;
+	lastLateness = maxLateness = sumLateness = 0;
+	deadline = now() + periodNs;
+}
+
+long long cbScheduler::wait()
+{
+	if (now() < deadline - spinNs)
+		sleepUntil(deadline - spinNs);
+	long long t;
+	while ((t = now()) < deadline)
+		;   // busy wait tail
+
+	long long late = t - deadline;
+	if (late >= periodNs) {
+		overruns++;
+		if (catchUp == SKIP) {
+			// release the latest missed deadline now, keep the phase
+			long long missed = late / periodNs;
+			skipped += (unsigned int) missed;
+			deadline += missed * periodNs;
+		}
+		// COMPRESS: deadlines are kept, the next waits return at once
+	}
+	deadline += periodNs;
+
+	cycles++;
+	lastLateness = late;
+	sumLateness += late;
+	if (late > maxLateness) maxLateness = late;
+
+	return late;
+}
+
+#ifndef MicWindows
+
+long long cbScheduler::now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long) ts.tv_sec * NS_PER_S + ts.tv_nsec;
+}
+
+void cbScheduler::sleepUntil(long long t)
+{
+	struct timespec ts;
+	ts.tv_sec = t / NS_PER_S;
+	ts.tv_nsec = t % NS_PER_S;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0) == EINTR)
+		;
+}
+
+#else
+
+/* no absolute sleep, the deadlines are still absolute so nothing drifts */
+static QElapsedTimer monotonic;
+
+long long cbScheduler::now()
+{
+	if (!monotonic.isValid()) monotonic.start();
+	return monotonic.nsecsElapsed();
+}
+
+class cbSleeper : public QThread
+{
+public:
+	static void sleep(long long us) { QThread::usleep((unsigned long) us); }
+};
+
+void cbScheduler::sleepUntil(long long t)
+{
+	long long dt = t - now();
+	if (dt > 0) cbSleeper::sleep(dt / 1000);
+}
+
+#endif
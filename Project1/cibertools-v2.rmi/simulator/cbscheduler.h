@@ -0,0 +1,84 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef CBSCHEDULER_H
+#define CBSCHEDULER_H
+
+/*! \class cbScheduler
+	\brief Drift free cycle clock of the simulation kernel.
+
+	Cycles are released at absolute deadlines on a monotonic clock,
+	deadline n being start + n * period, so the time lost waking up or
+	running a cycle is never accumulated. The wait sleeps until the
+	deadline (clock_nanosleep with TIMER_ABSTIME) and, optionally, the
+	last microseconds are spent busy waiting, which brings the wake up
+	jitter well under 100 us at the cost of some cpu.
+
+	When a cycle runs late by a full period or more the missed deadlines
+	are either skipped, keeping the cycle phase, or compressed, running
+	the late cycles back to back until the schedule is caught up.
+*/
+
+class cbScheduler
+{
+public:
+	enum CatchUp { SKIP, COMPRESS };
+
+	cbScheduler();
+
+	/*! Cycle period; a change applies from the next deadline on. */
+	void setPeriod(unsigned int us);
+	inline unsigned int period() const { return periodNs / 1000; }
+
+	void setCatchUp(CatchUp c) { catchUp = c; }
+	inline CatchUp catchUpPolicy() const { return catchUp; }
+	static bool parseCatchUp(const char *name, CatchUp &c);
+
+	/*! Length of the busy wait before each deadline, 0 to always sleep. */
+	void setSpin(unsigned int us) { spinNs = (long long) us * 1000; }
+
+	/*! Sets the first deadline one period from now and clears the stats. */
+	void start();
+
+	/*! Waits for the next deadline.
+	    \return the lateness, in ns, of the wake up. */
+	long long wait();
+
+	/*! Monotonic time in ns. */
+	static long long now();
+
+	/* statistics since start() */
+	unsigned int cycles;        // deadlines waited for
+	unsigned int overruns;      // wake ups late by a period or more
+	unsigned int skipped;       // deadlines dropped by SKIP
+	long long lastLateness;     // ns
+	long long maxLateness;      // ns
+	long long sumLateness;      // ns
+
+private:
+	void sleepUntil(long long t);
+
+	long long periodNs;
+	long long spinNs;
+	long long deadline;
+	CatchUp catchUp;
+};
+
+#endif
@@ -23,6 +23,7 @@
 #include "cbbeacon.h"
 #include "cbrobot.h"
 #include "cblab.h"
+#include "cbsimstate.h"
 
 #include <stdlib.h>
 #include <iostream>
@@ -78,33 +79,94 @@ cbSensor::cbSensor(cbRobot *rob, QString sId)
 
 cbSensor::~cbSensor()
 {
+	for (unsigned int i = 0; i < measuresFIFO.size(); i++)
+		delete measuresFIFO[i];
 }
 
 void cbSensor::setFifoLatency(unsigned int fLatency) {
 	unsigned int fSize = fLatency + 1;
 	if(measuresFIFO.size()<fSize) {
 		for(unsigned int i=measuresFIFO.size(); i < fSize; i++)
-			measuresFIFO.push(0);
+			measuresFIFO.push_back(0);
 	}
 	else {
 		while(measuresFIFO.size() > fSize)
-			measuresFIFO.pop();
+			popMeasure();
 	}
 }
 
 void cbSensor::pushMeasure(cbMeasure *value) {
-	measuresFIFO.push(value);
+	measuresFIFO.push_back(value);
 }
 
 void cbSensor::popMeasure(void) {
 	delete readMeasure();
-	measuresFIFO.pop();
+	measuresFIFO.pop_front();
 }
 
 cbMeasure* cbSensor::readMeasure(void) {
 	return measuresFIFO.front();
 }
 
+/*!
+	Save the requested flag and the measures in the FIFO, oldest first;
+	the FIFO holds no measure (0) until it was filled once.
+*/
+void cbSensor::saveState(cbSimState &st)
+{
+	unsigned char req = requested;
+	unsigned short n = measuresFIFO.size();
+	st.put(req);
+	st.put(n);
+	for (unsigned int i = 0; i < n; i++) {
+		cbMeasure *m = measuresFIFO[i];
+		unsigned char valid = m != 0;
+		st.put(valid);
+		if (m != 0) {
+			double v[3] = {0, 0, 0};
+			m->values(v);
+			st.put(v);
+		}
+	}
+}
+
+bool cbSensor::restoreState(cbSimState &st)
+{
+	unsigned char req;
+	unsigned short n;
+	if (!st.get(req) || !st.get(n)) return false;
+	if (n != measuresFIFO.size()) {
+		cerr << strId.toStdString() << ": sensor latency changed since the snapshot\n";
+		return false;
+	}
+	requested = req != 0;
+	for (unsigned int i = 0; i < n; i++) {
+		unsigned char valid;
+		double v[3];
+		if (!st.get(valid) || (valid && !st.get(v))) return false;
+		delete measuresFIFO[i];
+		measuresFIFO[i] = valid ? newMeasure(v) : 0;
+	}
+	return true;
+}
+
+bool cbSensor::checkState(cbSimState &st)
+{
+	unsigned char req;
+	unsigned short n;
+	if (!st.get(req) || !st.get(n)) return false;
+	if (n != measuresFIFO.size()) {
+		cerr << strId.toStdString() << ": sensor latency changed since the snapshot\n";
+		return false;
+	}
+	for (unsigned int i = 0; i < n; i++) {
+		unsigned char valid;
+		double v[3];
+		if (!st.get(valid) || (valid && !st.get(v))) return false;
+	}
+	return true;
+}
+
 /*******************************************************/
 // cbcbollisionSensor
 
@@ -194,7 +256,7 @@ void cbCompassSensor::update(double orientation)
 	/* ideal value */
 	ideal = orientation;
 	/* noisy value */
-	double randNoise = randNormal(0.0,noise);
+	double randNoise = randNormal(0.0,robot->config().compassNoise);
 	value = orientation + randNoise;
 	if (value > M_PI) value -= (2*M_PI); else if (value < -M_PI) value += (2*M_PI);
 	/* noisy value in degrees round to integer */
@@ -221,6 +283,44 @@ cbBeaconSensor::~cbBeaconSensor()
 {
 }
 
+cbMeasure *cbBeaconSensor::newMeasure(const double v[3])
+{
+	struct beaconMeasure m;
+	m.beaconVisible = v[0] != 0;
+	m.beaconDir = v[1];
+	return new cbBeaconMeasure(m);
+}
+
+void cbBeaconSensor::saveState(cbSimState &st)
+{
+	cbSensor::saveState(st);
+	unsigned char r = ready, vis = measure.beaconVisible;
+	st.put(cycToMeasure);
+	st.put(r);
+	st.put(vis);
+	st.put(measure.beaconDir);
+}
+
+bool cbBeaconSensor::restoreState(cbSimState &st)
+{
+	unsigned char r, vis;
+	if (!cbSensor::restoreState(st) || !st.get(cycToMeasure) || !st.get(r)
+	    || !st.get(vis) || !st.get(measure.beaconDir))
+		return false;
+	ready = r != 0;
+	measure.beaconVisible = vis != 0;
+	return true;
+}
+
+bool cbBeaconSensor::checkState(cbSimState &st)
+{
+	int cyc;
+	unsigned char r, vis;
+	double dir;
+	return cbSensor::checkState(st) && st.get(cyc) && st.get(r)
+	       && st.get(vis) && st.get(dir);
+}
+
 /*!
 	update sensor measure based on real angular direction
 	of the beacon.
@@ -257,13 +357,13 @@ void cbBeaconSensor::update()
 	             /* ideal value */
 	             ideal = delta;
 	             /* noisy value */
-	             double randNoise = randNormal(0.0,noise);
+	             double randNoise = randNormal(0.0,robot->config().beaconNoise);
 	             value = delta + randNoise;
 	             if (value > M_PI) value -= 2*M_PI; else if (value < -M_PI) value += 2*M_PI;
 
 	             // check sensor aperture
                      //if(fabs(value) <= M_PI/3)
-                     if(fabs(value) <= sensorAperture)
+                     if(fabs(value) <= robot->config().beaconAperture)
 	                 /* noisy value in degrees round to integer */
 	                 measure.beaconDir = floor(value*180.0/M_PI + 0.5);
 	             else
@@ -303,7 +403,7 @@ void cbIRSensor::update(double distance)
 	if (distance > 0.01) ideal = 1.0 / distance;
 	else ideal = 100.0;
 	/* real output is ideal output plus random noise */
-	double randNoise = randNormal(0.0,noise);
+	double randNoise = randNormal(0.0,robot->config().obstacleNoise);
 	/* round to 0.1 precision */
 	value = floor(10.0*(ideal + randNoise)+0.5)/10.0;
 }
@@ -347,7 +447,7 @@ void cbIRSensor::update(void)
 
     /* check presence of other robots in sensor action cone */
     vector<cbRobot*> *others = &(robot->getSimulator()->Robots());
-    for (unsigned r=0; r<others->size() && !cbRobot::ignoreOthers; r++)
+    for (unsigned r=0; r<others->size() && !robot->config().ignoreOthers; r++)
 	{
 		cbRobot *other = (*others)[r];
 		if (other == 0) continue;
@@ -412,6 +512,15 @@ cbGPSSensor::~cbGPSSensor()
 {
 }
 
+cbMeasure *cbGPSSensor::newMeasure(const double v[3])
+{
+	GPSMeasure m;
+	m.x = v[0];
+	m.y = v[1];
+	m.degrees = v[2];
+	return new cbGPSMeasure(m);
+}
+
 void cbGPSSensor::update()
 {
         GPSMeasure ideal;
@@ -436,9 +545,10 @@ void cbGPSSensor::update()
 void cbGPSSensor::update(GPSMeasure ideal)
 {
 	/* noisy value */
-	value.x = ideal.x + randNormal(0.0,noiseLin) + offsetX;
-	value.y = ideal.y + randNormal(0.0,noiseLin) + offsetY;
-	value.degrees = ideal.degrees + randNormal(0.0,noiseAng) + offsetDeg;
+	const cbRobotConfig &conf = robot->config();
+	value.x = ideal.x + randNormal(0.0,conf.gpsLinNoise) + conf.gpsOffsetX;
+	value.y = ideal.y + randNormal(0.0,conf.gpsLinNoise) + conf.gpsOffsetY;
+	value.degrees = ideal.degrees + randNormal(0.0,conf.gpsAngNoise) + conf.gpsOffsetDeg;
 
     /* truncate to precision */
     value.x = floor(value.x*10.0+0.5)/10.0;
@@ -37,24 +37,29 @@
 
 #include <math.h>
 
-#include <queue>
+#include <deque>
 
-using std::queue;
+using std::deque;
 
 #include "cbsimulator.h"
 #include "cbpoint.h"
 
+class cbSimState;
+
 class cbMeasure
 {
 	public:
 	    cbMeasure(void);
         virtual ~cbMeasure(void) {}
+	    /*! Value as up to 3 numbers, to save it in a cbSimState. */
+	    virtual void values(double v[3]) const = 0;
 };
 
 class cbBoolMeasure : public cbMeasure
 {
 	public:
 	    cbBoolMeasure(bool val);
+	    void values(double v[3]) const { v[0] = value; }
 	    bool value;
 };
 
@@ -62,6 +67,7 @@ class cbIntMeasure : public cbMeasure
 {
 	public:
 	    cbIntMeasure(int val);
+	    void values(double v[3]) const { v[0] = value; }
 	    int value;
 };
 
@@ -69,6 +75,7 @@ class cbDoubleMeasure : public cbMeasure
 {
 	public:
 	    cbDoubleMeasure(double val);
+	    void values(double v[3]) const { v[0] = value; }
 	    double value;
 };
 
@@ -82,6 +89,7 @@ class cbBeaconMeasure : public cbMeasure
 {
 	public:
 	    cbBeaconMeasure(struct beaconMeasure val);
+	    void values(double v[3]) const { v[0] = value.beaconVisible; v[1] = value.beaconDir; }
 	    struct beaconMeasure value;
 };
 
@@ -93,6 +101,7 @@ class cbGPSMeasure : public cbMeasure
 {
 	public:
 	    cbGPSMeasure(struct GPSMeasure val);  
+	    void values(double v[3]) const { v[0] = value.x; v[1] = value.y; v[2] = value.degrees; }
             struct GPSMeasure value;
 };
 
@@ -112,14 +121,24 @@ public:
 	void        popMeasure  (void);
 	cbMeasure*  readMeasure (void);
 
+	/*! Save or restore the measures in the FIFO, see cbsimstate.h */
+	virtual void saveState(cbSimState &st);
+	virtual bool restoreState(cbSimState &st);
+	/*! Reads the state written by saveState without changing the
+	    sensor, false if restoreState would fail. */
+	virtual bool checkState(cbSimState &st);
+
 	bool    requested;     //it was requested this cycle
 	bool    requestable;   //it must be requested to be sent
 
 protected:
+	/*! Measure of this sensor with the given values. */
+	virtual cbMeasure *newMeasure(const double v[3]) = 0;
+
 	cbRobot *robot;
 	QString strId;
 	int fifoLatency;
-	queue <cbMeasure *> measuresFIFO;
+	deque <cbMeasure *> measuresFIFO;
 };
 
 /*! \class cbCollisionSensor
@@ -143,10 +162,9 @@ public:
 		   return false;
         }
 
-	static  int  sensorLatency;
-	static  bool sensorRequestable;
-
 //	cbArray<double> SensMeas;    // DEBUG only
+protected:
+	cbMeasure *newMeasure(const double v[3]) { return new cbBoolMeasure(v[0] != 0); }
 private:
 	inline void update(bool b) { value = b; }
 	bool value;
@@ -173,9 +191,8 @@ public:
 		else
 		   return -1;
         }
-	static  int  sensorLatency;
-	static  bool sensorRequestable;
-
+protected:
+	cbMeasure *newMeasure(const double v[3]) { return new cbIntMeasure((int) v[0]); }
 private:
 	int value;
 };
@@ -187,8 +204,6 @@ private:
 */
 class cbCompassSensor : public cbSensor
 {
-public: // static data members
-	static double noise;
 public:
 	cbCompassSensor(cbRobot *rob, QString sId);
 	virtual ~cbCompassSensor();
@@ -201,9 +216,8 @@ public:
 		else
 		   return 0.0;
         }
-	static  int  sensorLatency;
-	static  bool sensorRequestable;
-
+protected:
+	cbMeasure *newMeasure(const double v[3]) { return new cbDoubleMeasure(v[0]); }
 private:
 	void update(double orientation);
 	double ideal;	// real orientation of robot
@@ -219,8 +233,6 @@ private:
 */
 class cbBeaconSensor : public cbSensor
 {
-public: // static data members
-	static double noise;
 public:
 	cbBeaconSensor(cbRobot *rob, QString sId);
 	~cbBeaconSensor();
@@ -244,9 +256,13 @@ public:
 	inline bool   Ready()         { return ready; }    // this function is deprecated, BeaconSensors are always ready!!
 	inline void   setBeaconToFollow(int b) { beaconToFollow = b; }
 
-	static  int    sensorLatency;
-	static  bool   sensorRequestable;
-	static  double sensorAperture;
+	void saveState(cbSimState &st);
+	bool restoreState(cbSimState &st);
+	bool checkState(cbSimState &st);
+
+protected:
+	cbMeasure *newMeasure(const double v[3]);
+
 private:
 	void resetBeaconVisible(void) { measure.beaconVisible=false; } 
 
@@ -274,9 +290,6 @@ private:
 */
 class cbIRSensor : public cbSensor
 {
-public: // static data members
-    static double noise;
-
 public:
 	cbIRSensor(cbRobot *rob, QString sId);
 	virtual ~cbIRSensor();
@@ -294,9 +307,8 @@ public:
 		else
 		   return 0.0;
         }
-	static  int  sensorLatency;
-	static  bool sensorRequestable;
-
+protected:
+	cbMeasure *newMeasure(const double v[3]) { return new cbDoubleMeasure(v[0]); }
 private:
 	void update(double);
 	cbPolarPoint pos; // (relative) position of sensor
@@ -311,13 +323,6 @@ private:
 */
 class cbGPSSensor : public cbSensor
 {
-public: // static data members
-	static double noiseLin;
-	static double noiseAng;
-
-	static double offsetX;
-	static double offsetY;
-	static double offsetDeg;
 public:
 	cbGPSSensor(cbRobot *rob, QString sId);
 	virtual ~cbGPSSensor();
@@ -344,9 +349,8 @@ public:
 		else
 		   return 0.0;
         }
-	static  int  sensorLatency;
-	static  bool sensorRequestable;
-
+protected:
+	cbMeasure *newMeasure(const double v[3]);
 private:
 	void update(GPSMeasure ideal);
 	GPSMeasure value;
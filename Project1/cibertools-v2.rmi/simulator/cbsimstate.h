@@ -0,0 +1,83 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef CBSIMSTATE_H
+#define CBSIMSTATE_H
+
+/*! \file cbsimstate.h
+	\brief Complete state of a simulation, to rewind or branch it.
+
+	cbSimulator::snapshot writes the state of the simulation into a
+	cbSimState and cbSimulator::restore puts it back: cycle, states,
+	random generator, and for each robot its pose, motors, leds,
+	scores, visited targets and the measures queued in the latency
+	FIFOs of its sensors.
+
+	The state is a flat buffer of plain values, written in the order it
+	is read back, that can be copied or saved to a file as it is. It is
+	bound to the simulator that wrote it: lab, grid, parameters and the
+	robots registered must be the same when it is restored. The buffer
+	keeps its capacity when rewritten, so snapshots taken every cycle
+	do not allocate.
+*/
+
+#include <string.h>
+#include <vector>
+
+using std::vector;
+
+class cbSimState
+{
+public:
+	cbSimState() : pos(0) {}
+
+	inline unsigned int size() const { return data.size(); }
+	inline const char *bytes() const { return data.empty() ? 0 : &data[0]; }
+	inline void setBytes(const char *b, unsigned int n)
+	{ data.assign(b, b + n); pos = 0; }
+
+	/* used by the classes whose state is saved */
+	inline void clear() { data.clear(); pos = 0; }
+	inline void rewind() { pos = 0; }
+
+	inline void put(const void *v, unsigned int n)
+	{
+		unsigned int at = data.size();
+		data.resize(at + n);
+		memcpy(&data[at], v, n);
+	}
+	template <class T> inline void put(const T &v) { put(&v, sizeof(T)); }
+
+	/*! Reads the next n bytes, false if the state is shorter. */
+	inline bool get(void *v, unsigned int n)
+	{
+		if (pos + n > data.size()) return false;
+		memcpy(v, &data[pos], n);
+		pos += n;
+		return true;
+	}
+	template <class T> inline bool get(T &v) { return get(&v, sizeof(T)); }
+
+private:
+	vector<char> data;
+	unsigned int pos;	// read position
+};
+
+#endif
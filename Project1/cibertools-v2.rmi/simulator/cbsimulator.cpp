@@ -33,7 +33,9 @@
 #include "cbpanel.h"
 #include "cbrobot.h"
 #include "cbrobotbeacon.h"
+#include "cbrobotplugin.h"
 #include "cbgrid.h"
+#include "cbtarget.h"
 #include "cbgraph.h"
 #include "cbutils.h"
 #include "cblabhandler.h"
@@ -41,10 +43,12 @@
 #include "cbparamhandler.h"
 
 #include "cbsimulator.h"
+#include "cbtracer.h"
 
 #include <iostream>
 #include <fstream>
 #include <stdlib.h>
+#include <stdio.h>
 #include <assert.h>
 
 
@@ -109,7 +113,8 @@ static const char *SIMPARAM =
         "\t\tTargetReward=\"100\" HomeReward=\"100\"/>\n";
 
 
-cbSimulator::cbSimulator()
+cbSimulator::cbSimulator() : kernelThread(this), cycleMutex(QMutex::Recursive),
+    labXml("Lab"), gridXml("Grid")
 {
 	lab = 0;
 	curCycle = 0;
@@ -119,9 +124,16 @@ cbSimulator::cbSimulator()
 	curState = nextState = INIT;
 
     logging=false;
-    logStream=0;
 
 	distMaxToTarget=0.0;
+	snapshotCount=0;
+	rng.seed(0);
+	historyHead=historyCount=0;
+	autoStart=0;
+	capacity=0;
+	gridFileSize=0;
+	admission=16;
+	setHistory(200);
 
 	lab=0;grid=0;param=0;receptionist=0;
 	gui=0;
@@ -151,7 +163,7 @@ cbSimulator::cbSimulator()
         defaultParam = paramHandler->parsedParameters();
     else {
         cerr << "Error parsing DEFAULT parameters\n";
-        gui->appendMessage(QString("Error parsing DEFAULT parameters"), true);
+        if (gui) gui->appendMessage(QString("Error parsing DEFAULT parameters"), true);
         assert(0);
     }
 
@@ -159,7 +171,7 @@ cbSimulator::cbSimulator()
         defaultLab = labHandler->parsedLab();
     else {
         cerr << "Error parsing DEFAULT lab\n";
-        gui->appendMessage(QString("Error parsing DEFAULT lab"), true);
+        if (gui) gui->appendMessage(QString("Error parsing DEFAULT lab"), true);
         assert(0);
     }
 
@@ -167,7 +179,7 @@ cbSimulator::cbSimulator()
         defaultGrid = gridHandler->parsedGrid();
     else {
         cerr << "Error parsing DEFAULT grid\n";
-        gui->appendMessage(QString("Error parsing DEFAULT grid"), true);
+        if (gui) gui->appendMessage(QString("Error parsing DEFAULT grid"), true);
         assert(0);
     }
 
@@ -188,14 +200,19 @@ cbSimulator::cbSimulator()
 
 cbSimulator::~cbSimulator()
 {
-	if(logging && logStream != 0) {
-		*logStream << "</Log>\n";
-		delete logStream;
-		logStream=0;
+	stopKernel();
+
+	if(logging && logWriter.isOpen()) {
+		if(!logWriter.isBinary()) logWriter.writeText("</Log>\n");
+		logWriter.close();
 	}
 }
 
-void cbSimulator::reset()
+/*!
+	Restart the simulation. When logging, the GUI asks the name of the
+	new log before calling reset; a null name disables logging.
+*/
+void cbSimulator::reset(QString newLogFilename)
 {
     unsigned int j;
 
@@ -223,26 +240,26 @@ void cbSimulator::reset()
         deleteRobot(i+1);
 	}
 
-    gui->appendMessage( "RESETTING" );
+    if (gui) gui->appendMessage( "RESETTING" );
 	cout << "RESETTING\n";
 
     curCycle = 0;
     curState = nextState = INIT;
+    historyHead = historyCount = 0;
 
-    cbGPSSensor::offsetX   = randUniform(0.0,1000.0);
-    cbGPSSensor::offsetY   = randUniform(0.0,1000.0);
+    cbRandom::use(&rng);
+    robotConf.newGPSOffset();
 
 	// Open New Log
     if(logging) {
-        QString logFilename = QFileDialog::getSaveFileName(0, "Choose New Log Filename", ".","Logs (*.log)");
-        if(!logFilename.isNull()) {
-            setLogFilename(logFilename);
+        if(!newLogFilename.isNull()) {
+            setLogFilename(newLogFilename);
             //openLog(logFilename.toLatin1().constData());
-            gui->appendMessage( QString("Logfile changed to ")+ logFilename );
+            if (gui) gui->appendMessage( QString("Logfile changed to ")+ newLogFilename );
 		}
         else {
             logging=false;
-            gui->appendMessage( "Logging disabled" );
+            if (gui) gui->appendMessage( "Logging disabled" );
         }
     }
 
@@ -251,15 +268,34 @@ void cbSimulator::reset()
     emit simReady(false);
     emit simRunning(false);
     emit curTimeChanged(0);
+
+    // in-process robots do not register by themselves
+    for (j=0; j<plugins.size(); j++)
+        registerPlugin(plugins[j]);
 }
 
 void cbSimulator::setLab(cbLab *l)
 {
 	if(lab!=0) delete lab;
 	lab = l;
+	labXml.clear();
+
+	// the positions added for the previous lab may be in the new walls
+	if(grid!=0 && grid->size() > gridFileSize) {
+		bool used = false;
+		for (unsigned int i=0; i<robots.size(); i++)
+			if(robots[i] != 0) used = true;
+		if(!used) {
+			grid->resize(gridFileSize);
+			robots.resize(gridFileSize);
+			gridXml.clear();
+			emit gridChanged(grid->size());
+		}
+	}
 
 	//update parameters
     param->nBeacons= Lab()->nBeacons();
+    paramReply.clear();
 
     // emit signal
     emit labChanged ( Lab()->Name() );
@@ -268,13 +304,16 @@ void cbSimulator::setLab(cbLab *l)
 void cbSimulator::setGrid(cbGrid *g)
 {
     unsigned int i;
+	// robots are deleted by the kernel thread, which owns their sockets
 	for (i=0; i<robots.size(); i++)
-		if(robots[i] != 0) delete robots[i];
+		if(robots[i] != 0) robots[i]->deleteLater();
 
 	if(grid!=0) delete grid;
 	/* set the new grid */
 	grid = g;
+	gridXml.clear();
 	/* resize robot array to new grid size */
+	gridFileSize = grid->size();
 	robots.resize(grid->size());
     for (i=0; i<robots.size(); i++) robots[i] = 0;
 
@@ -322,10 +361,11 @@ void cbSimulator::setGPS(bool g)
     if (curState == INIT)
     {
         param->GPSOn = g;
-        cbRobot::GPSOn = g;
+        robotConf.GPSOn = g;
+        paramReply.clear();
     }
     else
-        gui->appendMessage(QString("Cannot Change Configuration After Start - Use Reset"), true);
+        if (gui) gui->appendMessage(QString("Cannot Change Configuration After Start - Use Reset"), true);
 
 
     emit toggleGPS(param->GPSOn);
@@ -344,10 +384,11 @@ void cbSimulator::setScoreSensor(bool g)
     if (curState == INIT)
     {
         param->scoreSensorOn = g;
-        cbRobot::scoreSensorOn = g;
+        robotConf.scoreSensorOn = g;
+        paramReply.clear();
     }
     else
-        gui->appendMessage(QString("Cannot Change Configuration After Start - Use Reset"), true);
+        if (gui) gui->appendMessage(QString("Cannot Change Configuration After Start - Use Reset"), true);
 
     emit toggleScoreSensor(param->scoreSensorOn);
 
@@ -375,15 +416,15 @@ bool cbSimulator::isTimed()
 
 void cbSimulator::setCollisions(bool collisions)
 {
-    if (cbRobot::ignoreOthers == !collisions) return;
+    if (robotConf.ignoreOthers == !collisions) return;
 
-    cbRobot::ignoreOthers = !collisions;
+    robotConf.ignoreOthers = !collisions;
     emit toggleCollisions(collisions);
 }
 
 bool cbSimulator::collisionsIgnored()
 {
-    return cbRobot::ignoreOthers;
+    return robotConf.ignoreOthers;
 }
 
 void cbSimulator::setRegistrations(bool allow)
@@ -401,13 +442,14 @@ bool cbSimulator::isRegistrationAllowed()
 
 void cbSimulator::setShowActions(bool s)
 {
-    cbRobot::showActions = s;
+    robotConf.showActions = s;
     param->showActions = s;
+    paramReply.clear();
 }
 
 void cbSimulator::setShowMeasures(bool s)
 {
-    cbRobot::showMeasures = s;
+    robotConf.showMeasures = s;
 }
 
 void cbSimulator::setShowPositions(bool s)
@@ -415,16 +457,39 @@ void cbSimulator::setShowPositions(bool s)
     showPositions = s;
 }
 
+/*!
+	Open the log. Logs with the .cblog extension are written in the
+	binary format (see cbbinlog.h), all others in XML.
+*/
 int cbSimulator::openLog(const char *logFilename)
 {
 	char buff[1024*128];
+	const char *date = 0;
+
+#ifndef MicWindows
+	char datestr[1024];
+	time_t datet=time(0);
+	strcpy(datestr,ctime(&datet));
+	datestr[strlen(datestr)-1] = '\0';  // discard '\n'
+	date = datestr;
+#endif
 
-	if (logFilename!=0) logStream=new ofstream(logFilename);
-	else logStream = 0;
+	string preamble;
+	param->toXml(buff,sizeof(buff));
+	preamble += buff;
+	preamble += labMessage().message();
+	preamble += gridMessage().message();
+
+	bool opened;
+	if(logFilename!=0 && QString(logFilename).endsWith(".cblog"))
+		opened = logWriter.openBinary(logFilename, date, preamble,
+		                              lab->nBeacons(), lab->nTargets());
+	else
+		opened = logFilename!=0 && logWriter.open(logFilename);
 
-        if(!logStream) {
+        if(!opened) {
             cerr << "ERROR: Could not open " << logFilename << " for writing\n";
-            gui->appendMessage( QString("ERROR: Could not open ") + logFilename + " for writing" , true);
+            if (gui) gui->appendMessage( QString("ERROR: Could not open ") + logFilename + " for writing" , true);
             logging=false;
             return -1;
         }
@@ -434,34 +499,29 @@ int cbSimulator::openLog(const char *logFilename)
 
     logging=true;
 
-#ifndef MicWindows
-	char datestr[1024];
-	time_t datet=time(0);
-	strcpy(datestr,ctime(&datet));
-	datestr[strlen(datestr)-1] = '\0';  // discard '\n'
-	*logStream << "<Log Date=\"" << datestr <<"\" >\n";
-#else
-	*logStream << "<Log>\n";
-#endif
-
-
-	param->toXml(buff,sizeof(buff));
-	*logStream << buff;
-	lab->toXml(buff,sizeof(buff));
-	*logStream << buff;
-	grid->toXml(buff,sizeof(buff));
-	*logStream << buff;
+	if(!logWriter.isBinary()) {
+		if(date != 0) {
+			sprintf(buff, "<Log Date=\"%s\" >\n", date);
+			logWriter.writeText(buff);
+		}
+		else logWriter.writeText("<Log>\n");
+		logWriter.writeText(preamble.c_str());
+	}
 
     return 0;
 }
 
 int cbSimulator::closeLog(void)
 {
-    if(logging && logStream!=0) {
-        gui->appendMessage( "Logfile  closed." );
-		*logStream << "</Log>\n";
-		delete logStream;
-		logStream=0;
+    if(logging && logWriter.isOpen()) {
+        if (gui) gui->appendMessage( "Logfile  closed." );
+		if(!logWriter.isBinary()) logWriter.writeText("</Log>\n");
+		logWriter.close();
+
+		cbLogWriterStats st = logWriter.stats();
+		cout << "Log writer: " << st.records << " records, " << st.bytes << " bytes in "
+		     << st.writes << " writes, max queued " << st.highWater << "/" << st.capacity
+		     << ", " << st.stalls << " stalls (" << st.stallTime << " ms)\n";
 	}
 
 	return 0;
@@ -497,13 +557,13 @@ bool cbSimulator::registerRobot(cbRobot *robot)
 	unsigned int id = robot->Id();
     if(id==0) {   // first available position in the grid is occupied
         for(i=1; i<robots.size()+1 && robots[i-1]!=0; i++);
-        if(i==robots.size()+1) return false;
+        if(i==robots.size()+1 && !addPositions(i)) return false;
         id=i;
         robot->setId(id);
 	}
 	else
     {
-        if (id > robots.size()) return false;
+        if (id > robots.size() && !addPositions(id)) return false;
 
         /* check existence of another robot with the same id */
         if (robots[id-1] != 0) return false;
@@ -511,6 +571,8 @@ bool cbSimulator::registerRobot(cbRobot *robot)
 	    /* add robot and set attributes */
 	}
     robots[id-1] = robot;
+    // room for the sensors of a full grid, taken once
+    pool.reserve(robots.size(), lab->nBeacons());
     robot->setSimulator(this);
     const cbPosition &pos = grid->at(id-1);
 	robot->setPosition(pos);
@@ -518,10 +580,106 @@ bool cbSimulator::registerRobot(cbRobot *robot)
     if(isRobotBeacon)
         lab->addBeacon(dynamic_cast<cbRobotBeacon *> (robot));
 
+    CB_TRACE_INSTANT("Registration", "robot", (int) id);
     emit robotRegistered((int) id);
 	return true;
 }
 
+/*!
+	Adds start positions, up to the capacity, until there are n.
+	Returns false if the capacity or the room in the lab is exceeded.
+*/
+bool cbSimulator::addPositions(unsigned int n)
+{
+    if (n > capacity) return false;
+
+    unsigned int old = robots.size();
+    while (robots.size() < n) {
+        cbPosition pos;
+        if (!spawnPosition(pos)) {
+            cerr << "No room left in the lab for robot " << robots.size()+1 << "\n";
+            break;
+        }
+        grid->append(pos);
+        gridXml.clear();
+        // the init points of the graph follow the grid
+        if (graph != 0) graph->addInitPoint(pos.Coord());
+        robots.push_back(0);
+    }
+    if (robots.size() > old) emit robotCapacityChanged(robots.size());
+    return robots.size() >= n;
+}
+
+/*!
+	Samples a position in the free space of the lab, out of the walls and
+	targets and away from the other start positions and from the robots.
+*/
+bool cbSimulator::spawnPosition(cbPosition &pos)
+{
+    const double clearance = 0.2;
+    double margin = ROBOT_RADIUS + clearance;
+    double w = lab->Width(), h = lab->Height();
+
+    for (int attempt=0; attempt<1000; attempt++) {
+        cbPoint p(margin + rng.uniform() * (w - 2*margin), margin + rng.uniform() * (h - 2*margin));
+        if (!lab->freeSpace(p, margin)) continue;
+
+        bool taken = false;
+        for (unsigned int t=0; t<lab->nTargets() && !taken; t++)
+            taken = p.distance(lab->Target(t)->Center()) < lab->Target(t)->Radius() + margin;
+        for (int g=0; g<grid->count() && !taken; g++) {
+            cbPosition gp = grid->at(g);
+            taken = p.distance(gp.Coord()) < 2*ROBOT_RADIUS + clearance;
+        }
+        for (unsigned int r=0; r<robots.size() && !taken; r++)
+            taken = robots[r] != 0 && p.distance(robots[r]->Center()) < 2*ROBOT_RADIUS + clearance;
+        if (taken) continue;
+
+        pos.set(p.X(), p.Y(), (rng.uniform() * 2 - 1) * M_PI);
+        return true;
+    }
+    return false;
+}
+
+bool cbSimulator::addPlugin(QString file, unsigned int count)
+{
+    cbController *c = cbController::load(file);
+    if (c == 0) return false;
+
+    for (unsigned int i=0; i<count; i++) {
+        plugins.push_back(c);
+        registerPlugin(c);
+    }
+    return true;
+}
+
+/*!
+	Create a robot driven by controller c and register it in the first
+	free grid position, named after the library and its position.
+*/
+bool cbSimulator::registerPlugin(cbController *c)
+{
+    cbRobotPlugin *robot = new cbRobotPlugin(c);
+    robot->setId(0);
+    if (!registerRobot(robot)) {
+        cout << c->name().toStdString() << " has been refused\n";
+        if (gui) gui->appendMessage( c->name()+" has been refused", true);
+        delete robot;
+        return false;
+    }
+
+    QString name = c->name() + QString::number(robot->Id());
+    robot->setName(name.toLatin1().constData());
+    if (!robot->start(param)) {
+        deleteRobot(robot->Id());
+        return false;
+    }
+
+    cout << robot->Name() << " has been registered\n";
+    if (gui) gui->appendMessage( QString(robot->Name())+" has been registered" );
+    return true;
+}
+
 unsigned int cbSimulator::curTime()
 {
 	return curCycle;
@@ -548,47 +706,118 @@ const char *cbSimulator::curStateAsString()
 	return sas[curState];
 }
 
+/*!
+	Queued slot calls, the GUI commands, run under the cycle lock so
+	they never overlap a cycle.
+*/
+bool cbSimulator::event(QEvent *e)
+{
+	QMutexLocker lock(&cycleMutex);
+	return QObject::event(e);
+}
+
 void cbSimulator::step()
 {
+	QMutexLocker lock(&cycleMutex);
+
+	// each phase is timed from the end of the previous one
+	long long cycleStart = cbScheduler::now(), t = cycleStart;
+
+	// the noise of this simulator comes from its own generator
+	cbRandom::use(&rng);
+
 	//cout.form("Reading robot actions (%u)\n", curCycle);
 	RobotActions();
-	if(logging) Log(*logStream);
+	t = prof.lap(cbProfiler::ROBOT_ACTIONS, t);
+	if(logging) {
+		Log();
+		t = prof.lap(cbProfiler::LOG, t);
+	}
 	//cout.form("Checking new registrations (%u)\n", curCycle);
 	CheckIn();
+	if (autoStart > 0 && curState == STOPPED && curCycle == 0) {
+		unsigned int n = 0;
+		for (unsigned int i=0; i<robots.size(); i++)
+			if (robots[i] != 0) n++;
+		if (n >= autoStart) start();
+	}
+	t = prof.lap(cbProfiler::CHECK_IN, t);
 	//cout.form("Reading view commands (%u)\n", curCycle);
 	ViewCommands();
+	t = prof.lap(cbProfiler::VIEW_COMMANDS, t);
 	PanelCommands();
+	t = prof.lap(cbProfiler::PANEL_COMMANDS, t);
 
 	if (curState == RUNNING)
 	{
 		//cout.form("Processing a RUNNING cycle (%u)\n", curCycle);
         curCycle++;
-        emit curTimeChanged(curCycle);
 		//cout.form("Computing next positions (%u)\n", curCycle);
 		NextPositions();
+		t = prof.lap(cbProfiler::NEXT_POSITIONS, t);
 		//cout.form("Check collisions (%u)\n", curCycle);
 		CheckCollisions();
+		t = prof.lap(cbProfiler::CHECK_COLLISIONS, t);
 		//cout.form("Commiting (%u)\n", curCycle);
 		Commit();
+		t = prof.lap(cbProfiler::COMMIT, t);
 		//cout.form("Updating sensors (%u)\n", curCycle);
 		UpdateSensors();
+		t = prof.lap(cbProfiler::UPDATE_SENSORS, t);
 		//cout.form("Updating scores (%u)\n", curCycle);
 		UpdateScores();
+		t = prof.lap(cbProfiler::UPDATE_SCORES, t);
 	}
 	else
 	{
 		//cout.form("Processing a STOPPING cycle (%u)\n", curCycle);
 		//cout.form("Updating sensors (%u)\n", curCycle);
 		UpdateSensors();
+		t = prof.lap(cbProfiler::UPDATE_SENSORS, t);
 	}
 
 	//cout.form("Sending sensors to robots(%u)\n", curCycle);
 	SendSensors();
+	t = prof.lap(cbProfiler::SEND_SENSORS, t);
 	//cout.form("Updating views (%u)\n", curCycle);
 	UpdateViews();
+	t = prof.lap(cbProfiler::UPDATE_VIEWS, t);
 	//cout.form("Updating state (%u)\n", curCycle);
 	UpdateState();
+	t = prof.lap(cbProfiler::UPDATE_STATE, t);
+	if (!history.empty() && curState == RUNNING) {
+		SaveHistory();
+		t = prof.lap(cbProfiler::HISTORY, t);
+	}
 
+	PublishSnapshot();
+	prof.lap(cbProfiler::PUBLISH, t);
+
+	prof.lap(cbProfiler::CYCLE, cycleStart);
+	prof.endCycle();
+}
+
+/*!
+	Copy the state shown by the GUI into the snapshot buffer.
+*/
+void cbSimulator::PublishSnapshot()
+{
+	cbSimSnapshot &snap = snapshots.writeBuffer();
+	snap.time = curCycle;
+	snap.simTime = endCycle;
+	snap.state = curState;
+	snap.cycle = ++snapshotCount;
+	snap.lateness = (unsigned int) (scheduler.lastLateness / 1000);
+	snap.maxLateness = (unsigned int) (scheduler.maxLateness / 1000);
+	snap.overruns = scheduler.overruns;
+	snap.skipped = scheduler.skipped;
+	snap.robots.resize(robots.size());
+	for (unsigned int i=0; i<robots.size(); i++)
+	{
+		if (robots[i] == 0) snap.robots[i].id = 0;
+		else robots[i]->snapshot(snap.robots[i]);
+	}
+	snapshots.publish();
 }
 
 /*
@@ -597,14 +826,26 @@ void cbSimulator::step()
 
 /*!
 	Process registration requests of all
-	clients waiting at reception.
+	clients waiting at reception, at most admission robots per cycle.
+	The clients come already constructed from the receptionist and all
+	get the same cached reply.
 */
 void cbSimulator::CheckIn()
 {
+	if (receptionist == 0) return;	// simulation without network
+
+	unsigned int admitted = 0;
 	while (receptionist->CheckIn())
 	{
 		cbClientForm &form = receptionist->Form();
 		int cnt;
+		if ((form.type == cbClientForm::ROBOT || form.type == cbClientForm::ROBOTBEACON)
+		    && admission > 0 && admitted == admission)
+		{
+			receptionist->putBack();	// next cycle
+			break;
+		}
+		const string &reply = parameterReply();
 		switch (form.type)
 		{
 			case cbClientForm::VIEW:
@@ -612,55 +853,101 @@ void cbSimulator::CheckIn()
 				cnt = views.size();
 				views.resize(cnt+1);
 				views[cnt] = form.client.view;
-                views[cnt]->Reply(form.addr, form.port, param);
+                views[cnt]->Reply(form.addr, form.port, param, reply.c_str(), reply.size()+1);
                 if (curState==INIT) {
 				    nextState=STOPPED;
                     if(logging)
                         openLog(logFilename.toLatin1().constData());
                 }
                 cout << "Viewer has been registered\n";
-                gui->appendMessage( "Viewer has been registered\n" );
+                if (gui) gui->appendMessage( "Viewer has been registered\n" );
 				break;
 			case cbClientForm::PANEL:
 				//cout << "Panel form is going to be processed\n";
 				cnt = panels.size();
 				panels.resize(cnt+1);
 				panels[cnt] = form.client.panel;
-				panels[cnt]->Reply(form.addr, form.port, param);
+				panels[cnt]->Reply(form.addr, form.port, param, reply.c_str(), reply.size()+1);
 				break;
 			case cbClientForm::ROBOT:
 			case cbClientForm::ROBOTBEACON:
 			{
 				//cout << "Robot form is going to be processed\n";
 				cbRobot *robot = form.client.robot;
+				admitted++;
 				if (registerRobot(robot))
 				{
-					robot->Reply(form.addr, form.port, param);
+					robot->Reply(form.addr, form.port, param, reply.c_str(), reply.size()+1);
                     cout << robot->Name() << " has been registered\n";
-                    gui->appendMessage( QString(robot->Name())+" has been registered" );
+                    if (gui) gui->appendMessage( QString(robot->Name())+" has been registered" );
 				}
 				else // robot was refused
 				{
 					robot->Refuse(form.addr, form.port);
                     cout << robot->Name() << " has been refused\n";
-                    gui->appendMessage( QString(robot->Name())+" has been refused", true);
+                    if (gui) gui->appendMessage( QString(robot->Name())+" has been refused", true);
 					delete robot;
 				}
 				break;
 			}
+			case cbClientForm::STATS:
+			{
+				// machine readable dump of the profiler, sent to whoever asked
+				char xml[8192];
+				int n = prof.toXml(xml, sizeof(xml));
+				if (n > 0) receptionist->Answer(xml, n+1);
+				break;
+			}
 			case cbClientForm::UNKNOWN:
                 cerr << "UNKNOWN form was received, and discarded\n";
-                gui->appendMessage( "UNKNOWN form was received, and discarded", true);
+                if (gui) gui->appendMessage( "UNKNOWN form was received, and discarded", true);
 				// a refused replied must be sent
 				break;
 			case cbClientForm::NOBODY:
                 cerr << "NOBODY form was received, and discarded\n";
-                gui->appendMessage( "NOBODY form was received, and discarded", true);
+                if (gui) gui->appendMessage( "NOBODY form was received, and discarded", true);
 				break;
 		}
 	}
 }
 
+/*!
+	The lab and the grid as sent to the viewers, serialized again only
+	after they changed.
+*/
+const cbChunkedXml &cbSimulator::labMessage()
+{
+	if (labXml.empty()) {
+		string xml;
+		lab->toXml(xml);
+		labXml.set(xml);
+	}
+	return labXml;
+}
+
+const cbChunkedXml &cbSimulator::gridMessage()
+{
+	if (gridXml.empty()) {
+		string xml;
+		grid->toXml(xml);
+		gridXml.set(xml);
+	}
+	return gridXml;
+}
+
+/*!
+	The OK reply sent to the clients, built again only after the
+	parameters changed.
+*/
+const string &cbSimulator::parameterReply()
+{
+	if (paramReply.empty()) {
+		char reply[REPLYMAXSIZE];
+		paramReply.assign(reply, cbClient::replyXml(reply, sizeof(reply), param));
+	}
+	return paramReply;
+}
+
 void cbSimulator::start()
 {
     if(curState==STOPPED)
@@ -686,8 +973,6 @@ void cbSimulator::stop()
 void cbSimulator::ViewCommands()
 {
 	cbCommand command;
-	char xml[4096*16];
-	unsigned int cnt;
 	for (unsigned int i=0; i<views.size(); i++)
 	{
 		while (views[i]->readCommand(&command))
@@ -704,15 +989,19 @@ void cbSimulator::ViewCommands()
 					break;
 				case cbCommand::LABRQ:
 					//cout << "View command = LabReq\n";
-					cnt = lab->toXml(xml, sizeof(xml)-1);
-					//cerr << xml;
-					views[i]->send(xml, cnt+1);
+					labMessage().sendTo(*views[i]);
 					break;
 				case cbCommand::GRIDRQ:
 					//cout << "View command = GridReq\n";
-					cnt = grid->toXml(xml, sizeof(xml)-1);
-					views[i]->send(xml, cnt+1);
+					gridMessage().sendTo(*views[i]);
 					break;
+				case cbCommand::CHUNKRQ:
+				{
+					const cbChunkedXml &xml = command.chunk.object == cbCommand::LAB
+					                          ? labMessage() : gridMessage();
+					xml.answerRequest(*views[i], command.chunk.version, command.chunk.seq);
+					break;
+				}
 				case cbCommand::ROBOTDEL:
 					{
 						//cout << "View command = RobotDel\n";
@@ -725,6 +1014,9 @@ void cbSimulator::ViewCommands()
                         }
 						break;
 					}
+				case cbCommand::REWIND:
+					rewind(command.rewind.cycles);
+					break;
 				case cbCommand::UNKNOWN:
 					//cout << "View command = Unknown\n";
 					break;
@@ -764,6 +1056,7 @@ void cbSimulator::RobotActions()
 			if (action.sayReceived)   robot->setSayMessage(action.sayMessage);
 
 			action.sensorRequests.clear();
+			CB_TRACE_INSTANT("Action", "robot", (int) robot->Id());
 		}
 	}
 }
@@ -825,6 +1118,7 @@ void cbSimulator::CheckCollisions()
 			//cout.form("Collision set (1)\n");
             //robot->setCollision();
             robot->setCollisionWall();
+            CB_TRACE_INSTANT("CollisionWall", "robot", (int) robot->Id());
 		}
 	}
 
@@ -859,6 +1153,7 @@ void cbSimulator::CheckCollisions()
 			if (robot->isMovingTowards(otherRobot->Center()))
 			{
                 robot->setCollisionRobot();
+                CB_TRACE_INSTANT("CollisionRobot", "robot", (int) robot->Id());
                 //robot->setCollision();
 				//cout.form("Collision set (2)\n");
 				//robot->showAllAttributes();
@@ -866,6 +1161,7 @@ void cbSimulator::CheckCollisions()
 			if (otherRobot->isMovingTowards(robot->Center()))
 			{
                 otherRobot->setCollisionRobot();
+                CB_TRACE_INSTANT("CollisionRobot", "robot", (int) otherRobot->Id());
                 //otherRobot->setCollision();
 				//cout.form("Collision set (3)\n");
 				//otherRobot->showAllAttributes();
@@ -914,6 +1210,7 @@ void cbSimulator::UpdateSensors()
 		cbRobot *robot = robots[i];
 		if (robot == 0) continue;
 		if (robot->state() == cbRobot::REMOVED) continue;
+		CB_TRACE_SPAN("SensorUpdate", "robot", (int) robot->Id());
 		robot->updateSensors();
 	}
 }
@@ -926,6 +1223,7 @@ void cbSimulator::SendSensors()
 {
 	unsigned int n = robots.size();
 	//cerr << "SEND Sensors " << curTime() << "\n";
+	board.post(robots);
 	for (unsigned int i=0; i<n; i++)
 	{
 		cbRobot *robot = robots[i];
@@ -954,8 +1252,8 @@ void cbSimulator::UpdateViews()
 			view->send(xml, n+1);
         }
 
-        if (showPositions)
-            gui->writeOnBoard("Position of " + QString(robot->Name()) + " (robot " + QString::number(robot->Id()) + ") sent to Viewer(s):\n" + xml, (int) robot->Id(), 2);
+        if (showPositions && diag.wanted(cbDiagnostics::POSITION, robot->Id()))
+            diag.record(cbDiagnostics::POSITION, curCycle, robot->Id(), robot->Name(), xml, n);
 	}
 }
 
@@ -968,7 +1266,7 @@ void cbSimulator::UpdateState()
 {
     if(simTime() <= curTime() && isTimed()) {
         nextState = FINISHED;
-	    if(logging) Log(*logStream, false); // last loginfo item - should not contain robot actions
+	    if(logging) Log(false); // last loginfo item - should not contain robot actions
 	    closeLog();
     }
 
@@ -976,7 +1274,10 @@ void cbSimulator::UpdateState()
         if (curState == INIT)
             emit simReady(true);
         curState = nextState;
+        CB_TRACE_INSTANT(curStateAsString(), "state", -1);
         emit stateChanged(curStateAsString());
+        if (curState == FINISHED)
+            emit simFinished();
     }
 
     for (unsigned int i=0; i<robots.size(); i++)
@@ -988,18 +1289,23 @@ void cbSimulator::UpdateState()
 
 }
 
-void cbSimulator::Log(ostream &log, bool withActions)
+/*!
+	Capture the state of every robot into the log writer queue.
+	The log is formatted and written by the writer thread.
+*/
+void cbSimulator::Log(bool withActions)
 {
 	unsigned int n = robots.size();
-	if(curState==RUNNING) {
-		log << "<LogInfo Time=\"" << curCycle << "\">\n";
+	if(curState==RUNNING && logWriter.isOpen()) {
+		cbLogRecord *rec = logWriter.acquire(cbLogRecord::LOGINFO);
+		rec->time = curCycle;
 		for (unsigned int i = 0; i<n; i++)
 		{
 			cbRobot *r = robots[i];
                 	if(r==0) continue;
-                	r->Log(log, withActions);
+                	r->logRecord(rec->addRobot(), withActions);
 		}
-        	log << "</LogInfo>\n";
+		logWriter.commit();
 	}
 }
 
@@ -1195,9 +1501,10 @@ void cbSimulator::showGraph(int id)
 
 bool cbSimulator::changeLab(QString labFilename)
 {
+	CB_TRACE_SPAN("changeLab", "config", -1);
 	if( curState != INIT ) {
         cerr << "Cannot open lab after start\n";
-        gui->appendMessage( "Cannot open lab after start", true);
+        if (gui) gui->appendMessage( "Cannot open lab after start", true);
 		return false;
 	}
 
@@ -1208,14 +1515,14 @@ bool cbSimulator::changeLab(QString labFilename)
 
     if(!srcFile.exists()) {
         cerr << "Could not open " << labFilename.toStdString() << "\n";
-        gui->appendMessage( QString( "Could not open " ) +
+        if (gui) gui->appendMessage( QString( "Could not open " ) +
                             labFilename, true) ;
         return false;
     }
     if ((source = new QXmlInputSource(&srcFile)) == 0)
 	{
         cerr << "Fail sourcing lab file\n";
-        gui->appendMessage("Fail sourcing lab file", true);
+        if (gui) gui->appendMessage("Fail sourcing lab file", true);
 		return false;
 	}
 
@@ -1229,7 +1536,7 @@ bool cbSimulator::changeLab(QString labFilename)
         labnew = labHandler->parsedLab();
     else {
         cerr << "Error parsing "<< labFilename.toStdString() <<"\n";
-        gui->appendMessage(QString("Error parsing ")+labFilename, true);
+        if (gui) gui->appendMessage(QString("Error parsing ")+labFilename, true);
 		return false;
 	}
 
@@ -1245,6 +1552,7 @@ bool cbSimulator::changeLab(QString labFilename)
 
 	// update parameters
     param->labFilename = labFilename;
+    paramReply.clear();
 
 	return true;
 	//cout << " done.\n";
@@ -1252,9 +1560,10 @@ bool cbSimulator::changeLab(QString labFilename)
 
 bool cbSimulator::changeGrid(QString gridFilename)
 {
+	CB_TRACE_SPAN("changeGrid", "config", -1);
 	if( curState!=INIT ) {
         cerr << "Cannot open grid after start\n";
-        gui->appendMessage("Cannot open grid after start", true);
+        if (gui) gui->appendMessage("Cannot open grid after start", true);
 		return false;
 	}
 
@@ -1264,14 +1573,14 @@ bool cbSimulator::changeGrid(QString gridFilename)
 
     if(!srcFile.exists()) {
         cerr << "Could not open " << gridFilename.toStdString() << "\n";
-        gui->appendMessage( QString( "Could not open " ) +
+        if (gui) gui->appendMessage( QString( "Could not open " ) +
                             gridFilename, true) ;
 		return false;
     }
     if ((source = new QXmlInputSource(&srcFile)) == 0)
 	{
         cerr << "Fail sourcing lab file\n";
-        gui->appendMessage("Fail sourcing lab file", true);
+        if (gui) gui->appendMessage("Fail sourcing lab file", true);
 		return false;
     }
 
@@ -1285,7 +1594,7 @@ bool cbSimulator::changeGrid(QString gridFilename)
         grid = gridHandler->parsedGrid();
     else {
         cerr << "Error parsing "<< gridFilename.toStdString() <<"\n";
-        gui->appendMessage(QString("Error parsing ")+gridFilename, true);
+        if (gui) gui->appendMessage(QString("Error parsing ")+gridFilename, true);
 		return false;
 	}
 
@@ -1299,6 +1608,7 @@ bool cbSimulator::changeGrid(QString gridFilename)
 
 	// update parameters
 	param->gridFilename = gridFilename;
+	paramReply.clear();
 
 	//cout << " done.\n";
 	return true;
@@ -1306,9 +1616,10 @@ bool cbSimulator::changeGrid(QString gridFilename)
 
 bool cbSimulator::changeParameters(QString paramFilename)
 {
+	CB_TRACE_SPAN("changeParameters", "config", -1);
 	if( curState!=INIT ) {
         cerr << "Cannot open parameters after start\n";
-        gui->appendMessage("Cannot open parameters after start", true);
+        if (gui) gui->appendMessage("Cannot open parameters after start", true);
 		return false;
 	}
 
@@ -1318,14 +1629,14 @@ bool cbSimulator::changeParameters(QString paramFilename)
 
     if(!srcFile.exists()) {
         cerr << "Could not open " << paramFilename.toStdString() << "\n";
-        gui->appendMessage( QString( "Could not open " ) +
+        if (gui) gui->appendMessage( QString( "Could not open " ) +
                             paramFilename, true) ;
 		return false;
     }
     if ((source = new QXmlInputSource(&srcFile)) == 0)
 	{
         cerr << "Fail sourcing lab file\n";
-        gui->appendMessage("Fail sourcing lab file", true);
+        if (gui) gui->appendMessage("Fail sourcing lab file", true);
 		return false;
 	}
 
@@ -1339,7 +1650,7 @@ bool cbSimulator::changeParameters(QString paramFilename)
 	    param = paramHandler->parsedParameters();
     else {
         cerr << "Error parsing "<< paramFilename.toStdString() <<"\n";
-        gui->appendMessage(QString("Error parsing ")+paramFilename, true);
+        if (gui) gui->appendMessage(QString("Error parsing ")+paramFilename, true);
 		return false;
 	}
 
@@ -1355,13 +1666,13 @@ void cbSimulator::saveConfiguration(QString paramFilename)
 {
 	if( curState!=INIT ) {
         cerr << "Cannot save after start\n";
-        gui->appendMessage("Cannot save after start", true);
+        if (gui) gui->appendMessage("Cannot save after start", true);
 	}
 
     FILE *fp = fopen(paramFilename.toLatin1().constData(),"wt");
     if(fp==0) {
         cerr << "Cannot open " << paramFilename.toStdString() << " for writing\n";
-        gui->appendMessage(QString("Cannot open ")+paramFilename+" for writing", true);
+        if (gui) gui->appendMessage(QString("Cannot open ")+paramFilename+" for writing", true);
 		return;
 	}
 
@@ -1378,45 +1689,8 @@ void cbSimulator::processEditParameters(void)
 	cycle           = param->cycleTime;
 	endCycle        = param->simTime;
 
-	//Noise
-	cbMotor::noise         = param->motorsNoise;
-	cbCompassSensor::noise = param->compassNoise * M_PI / 180;	// noise must be in radians
-	cbBeaconSensor::noise  = param->beaconNoise * M_PI / 180;	// noise must be in radians
-	cbIRSensor::noise      = param->obstacleNoise;
-	cbGPSSensor::noiseLin      = param->gpsLinNoise;
-	cbGPSSensor::noiseAng      = param->gpsDirNoise;
-
-	//Requests
-	cbRobot::maxSensorsRequested = param->nReqPerCycle;
-	cbIRSensor::sensorRequestable        = param->obstacleRequestable;
-	cbBeaconSensor::sensorRequestable    = param->beaconRequestable;
-	cbCompassSensor::sensorRequestable   = param->compassRequestable;
-	cbGroundSensor::sensorRequestable    = param->groundRequestable;
-	cbCollisionSensor::sensorRequestable = param->collisionRequestable;
-	cbGPSSensor::sensorRequestable       = param->gpsRequestable;
-
-	//Latencies
-	cbIRSensor::sensorLatency        = param->obstacleLatency;
-	cbBeaconSensor::sensorLatency    = param->beaconLatency;
-	cbCompassSensor::sensorLatency   = param->compassLatency;
-	cbGroundSensor::sensorLatency    = param->groundLatency;
-	cbCollisionSensor::sensorLatency = param->collisionLatency;
-	cbGPSSensor::sensorLatency       = param->gpsLatency;
-
-	cbBeaconSensor::sensorAperture   = param->beaconAperture;
-
-    cbRobot::GPSOn             = param->GPSOn;
-	cbRobot::scoreSensorOn     = param->scoreSensorOn;
-
-    //Scores
-    cbRobot::returnTimePenalty = param->returnTimePenalty;
-    cbRobot::arrivalTimePenalty = param->arrivalTimePenalty;
-    cbRobot::collisionWallPenalty = param->collisionWallPenalty;
-    cbRobot::collisionRobotPenalty = param->collisionRobotPenalty;
-    cbRobot::targetReward = param->targetReward;
-    cbRobot::homeReward = param->homeReward;
-
-    timer.setInterval(cycle);
+	robotConf.setParameters(param);
+	paramReply.clear();
 
     emit toggleGPS(param->GPSOn);
 
@@ -1446,7 +1720,7 @@ void cbSimulator::setDefaultLab(void)
         labnew = labHandler->parsedLab();
 	else {
         cerr << "Error parsing DEFAULT lab\n";
-        gui->appendMessage(QString("Error parsing DEFAULT lab"), true);
+        if (gui) gui->appendMessage(QString("Error parsing DEFAULT lab"), true);
 		assert(0);
 	}
 
@@ -1483,7 +1757,7 @@ void cbSimulator::setDefaultGrid(void)
         grid = gridHandler->parsedGrid();
 	else {
         cerr << "Error parsing DEFAULT grid\n";
-        gui->appendMessage(QString("Error parsing DEFAULT grid"), true);
+        if (gui) gui->appendMessage(QString("Error parsing DEFAULT grid"), true);
 		assert(0);
 	}
 
@@ -1518,7 +1792,7 @@ void cbSimulator::setDefaultParameters(void)
         param = paramHandler->parsedParameters();
 	else {
         cerr << "Error parsing DEFAULT parameters\n";
-        gui->appendMessage(QString("Error parsing DEFAULT parameters"), true);
+        if (gui) gui->appendMessage(QString("Error parsing DEFAULT parameters"), true);
 		assert(0);
 	}
 
@@ -1529,10 +1803,309 @@ void cbSimulator::setDefaultParameters(void)
 	//cout << " done.\n";
 }
 
+/*!
+	Start the simulation kernel on its own thread. The simulator is moved
+	to the kernel thread; the receptionist is served by a thread of its
+	own, that hands the sockets of the new clients over to the kernel.
+*/
 void cbSimulator::startTimer(void)
 {
-    timer.start(cycleTime());
-    QObject::connect(&timer,SIGNAL(timeout()),this,SLOT(step()));
+    if(receptionist!=0) receptionist->start(&kernelThread);
+    for (unsigned int i=0; i<robots.size(); i++)
+        if (robots[i] != 0) robots[i]->moveToThread(&kernelThread);
+    moveToThread(&kernelThread);
+
+    kernelStop = 0;
+    kernelThread.start(QThread::HighPriority);
+}
+
+/*!
+	Stop the kernel thread, it must be called before the GUI is destroyed.
+*/
+void cbSimulator::stopKernel(void)
+{
+    if(!kernelThread.isRunning()) return;
+
+    kernelStop = 1;
+    kernelThread.wait();
+    if(receptionist!=0) receptionist->stop();
+
+    cout << "Cycles: " << scheduler.cycles << ", overruns: " << scheduler.overruns
+         << ", skipped: " << scheduler.skipped
+         << ", lateness max: " << scheduler.maxLateness / 1000 << " us, mean: "
+         << (scheduler.cycles > 0 ? scheduler.sumLateness / scheduler.cycles / 1000 : 0) << " us\n";
+}
+
+/*!
+	Main loop of the kernel thread: one cycle at each scheduler deadline.
+	Between cycles the queued GUI commands and deferred deletes of the
+	thread are processed; the sockets are polled by the cycle itself.
+*/
+void cbSimulator::runKernel(void)
+{
+    cbTracer::setThread(cbTracer::KERNEL_THREAD);
+
+    scheduler.setPeriod(cycle * 1000);
+    scheduler.start();
+
+    while (!kernelStop) {
+        scheduler.wait();
+
+        QCoreApplication::processEvents();
+        QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+
+        // the cycle time may have been edited by the GUI
+        if (scheduler.period() != cycle * 1000)
+            scheduler.setPeriod(cycle * 1000);
+
+        if (scheduler.lastLateness >= (long long) cycle * 1000000)
+            cerr << "Cycle " << curCycle << " is late by " << scheduler.lastLateness / 1000 << " us\n";
+
+        step();
+    }
+}
+
+/*
+ * fixed part of a cbSimState, followed by the robots
+ */
+#define SIMSTATE_MAGIC 0x43425331	// "CBS1"
+
+struct cbSimStateHeader
+{
+	unsigned int magic;
+	unsigned int nPositions;	// size of the grid
+	unsigned int curCycle, endCycle;
+	int curState, nextState;
+	unsigned long long rng;
+	double gpsOffset[3];
+};
+
+void cbSimulator::snapshot(cbSimState &st)
+{
+	QMutexLocker lock(&cycleMutex);
+
+	cbSimStateHeader h;
+	h.magic = SIMSTATE_MAGIC;
+	h.nPositions = robots.size();
+	h.curCycle = curCycle;
+	h.endCycle = endCycle;
+	h.curState = curState;
+	h.nextState = nextState;
+	h.rng = rng.state;
+	h.gpsOffset[0] = robotConf.gpsOffsetX;
+	h.gpsOffset[1] = robotConf.gpsOffsetY;
+	h.gpsOffset[2] = robotConf.gpsOffsetDeg;
+
+	st.clear();
+	st.put(h);
+	for (unsigned int i=0; i<robots.size(); i++) {
+		unsigned char present = robots[i] != 0;
+		st.put(present);
+		if (present) robots[i]->saveState(st);
+	}
+}
+
+bool cbSimulator::restore(cbSimState &st)
+{
+	QMutexLocker lock(&cycleMutex);
+
+	cbSimStateHeader h;
+	st.rewind();
+	if (!st.get(h) || h.magic != SIMSTATE_MAGIC) {
+		cerr << "Not a simulation state\n";
+		return false;
+	}
+	if (h.nPositions != robots.size()) {
+		cerr << "Simulation state of a grid with " << h.nPositions << " positions\n";
+		return false;
+	}
+
+	/* check the whole state first, so that a state that does not fit
+	   leaves the simulation as it was */
+	for (unsigned int i=0; i<robots.size(); i++) {
+		unsigned char present;
+		if (!st.get(present)) {
+			cerr << "Simulation state is truncated\n";
+			return false;
+		}
+		if ((present != 0) != (robots[i] != 0)) {
+			cerr << "Robot " << i+1 << (present ? " missing" : " not in the simulation state") << "\n";
+			return false;
+		}
+		if (present && !robots[i]->checkState(st)) {
+			cerr << "Robot " << i+1 << " does not fit the simulation state\n";
+			return false;
+		}
+	}
+
+	/* checked above, restoring can not fail any more */
+	st.rewind();
+	st.get(h);
+	for (unsigned int i=0; i<robots.size(); i++) {
+		unsigned char present;
+		st.get(present);
+		if (present) robots[i]->restoreState(st);
+	}
+
+	curCycle = h.curCycle;
+	endCycle = h.endCycle;
+	curState = (State) h.curState;
+	nextState = (State) h.nextState;
+	rng.state = h.rng;
+	robotConf.gpsOffsetX = h.gpsOffset[0];
+	robotConf.gpsOffsetY = h.gpsOffset[1];
+	robotConf.gpsOffsetDeg = h.gpsOffset[2];
+
+	emit stateChanged(curStateAsString());
+	emit curTimeChanged(curCycle);
+	return true;
+}
+
+bool cbSimulator::writeResults(const char *file)
+{
+	QMutexLocker lock(&cycleMutex);
+
+	FILE *fp = fopen(file, "w");
+	if (fp == 0) {
+		cerr << "Could not open results file " << file << "\n";
+		return false;
+	}
+
+	char xml[1024];
+	fprintf(fp, "<Results Lab=\"%s\" Time=\"%u\" SimTime=\"%u\" State=\"%s\">\n",
+	        lab->Name(), curCycle, endCycle, curStateAsString());
+	for (unsigned int i=0; i<robots.size(); i++) {
+		if (robots[i] == 0) continue;
+		unsigned int n = robots[i]->toXml(xml, sizeof(xml));
+		fwrite(xml, 1, n, fp);
+	}
+	fprintf(fp, "</Results>\n");
+
+	bool ok = !ferror(fp);
+	ok = fclose(fp) == 0 && ok;
+	if (!ok) cerr << "Could not write results file " << file << "\n";
+	return ok;
+}
+
+void cbSimulator::setHistory(unsigned int cycles)
+{
+	QMutexLocker lock(&cycleMutex);
+
+	history.clear();
+	history.resize(cycles);
+	historyHead = historyCount = 0;
+}
+
+/*!
+	Keep the state after this running cycle, dropping the oldest one.
+*/
+void cbSimulator::SaveHistory()
+{
+	snapshot(history[historyHead]);
+	historyHead = (historyHead + 1) % history.size();
+	if (historyCount < history.size()) historyCount++;
+}
+
+void cbSimulator::rewind(uint cycles)
+{
+	QMutexLocker lock(&cycleMutex);
+
+	if (historyCount == 0) {
+		if (gui) gui->appendMessage("No cycles kept to rewind", true);
+		return;
+	}
+	// the last state kept is the current one
+	if (cycles > historyCount-1) cycles = historyCount-1;
+
+	unsigned int len = history.size();
+	unsigned int idx = (historyHead + len - 1 - cycles) % len;
+	if (!restore(history[idx])) {
+		if (gui) gui->appendMessage("Could not rewind, robots changed", true);
+		return;
+	}
+	// the states after it are gone
+	historyHead = (idx + 1) % len;
+	historyCount -= cycles;
+
+	curState = nextState = STOPPED;
+	emit stateChanged(curStateAsString());
+	emit simReady(true);
+	emit simRunning(false);
+
+	cout << "Rewound " << cycles << " cycles to cycle " << curCycle << "\n";
+	if (gui) gui->appendMessage(QString("Rewound %1 cycles to cycle %2").arg(cycles).arg(curCycle));
+}
+
+void cbSimulator::runBench(unsigned int cycles)
+{
+    cbTracer::setThread(cbTracer::KERNEL_THREAD);
+
+    unsigned int agents = 0;
+    for (unsigned int i=0; i<robots.size(); i++)
+        if (robots[i] != 0) agents++;
+
+    step();             // leave INIT
+    start();
+    setTime(false);
+    step();             // robots enter RUNNING
+
+    prof.reset();
+    long long begin = cbScheduler::now();
+    for (unsigned int c=0; c<cycles; c++)
+        step();
+    double secs = (cbScheduler::now() - begin) / 1e9;
+
+    cout << "Bench: " << agents << " agents, " << cycles << " cycles in " << secs << " s, "
+         << (secs > 0 ? cycles / secs : 0.0) << " cycles/s, "
+         << (cycles > 0 ? secs * 1e6 / cycles : 0.0) << " us/cycle\n";
+}
+
+void cbSimulator::runChurnBench(unsigned int rounds)
+{
+    vector<cbRobot *> batch;
+    batch.reserve(robots.size());
+    unsigned long created = 0, churned = 0;
+    unsigned int n = 0;
+
+    long long begin = cbScheduler::now();
+    for (unsigned int r=0; r<rounds; r++) {
+        unsigned long a = cbProfiler::allocations();
+        batch.clear();
+        for (unsigned int i=0; i<robots.size(); i++) {
+            if (robots[i] != 0) continue;
+            cbRobot *robot = new cbRobot(irSensorDefaultAngles);
+            robot->setId(i+1);
+            robot->setName("Churn");
+            batch.push_back(robot);
+        }
+        unsigned long b = cbProfiler::allocations();
+
+        for (unsigned int i=0; i<batch.size(); i++)
+            if (!registerRobot(batch[i])) {
+                delete batch[i];
+                batch[i] = 0;
+            }
+        for (unsigned int i=0; i<batch.size(); i++)
+            if (batch[i] != 0) {
+                deleteRobot(batch[i]->Id());
+                n++;
+            }
+
+        created += b - a;
+        churned += cbProfiler::allocations() - b;
+    }
+    double secs = (cbScheduler::now() - begin) / 1e9;
+
+    cout << "Churn: " << n << " robots registered and deleted in " << rounds << " rounds, "
+         << (n > 0 ? secs * 1e6 / n : 0.0) << " us/robot\n"
+         << "Allocations per robot: " << (n > 0 ? (double) created / n : 0.0) << " to create, "
+         << (n > 0 ? (double) churned / n : 0.0) << " to register and delete\n"
+         << "Sensor pool: " << pool.size() << " in use, room for " << pool.capacity() << "\n";
+}
+
+void cbKernelThread::run()
+{
+    simulator->runKernel();
 }
 
 bool cbSimulator::allRobotsVisitedOrVisitingTarget(int targId)
@@ -1575,10 +2148,10 @@ void cbSimulator::deleteRobot(uint id)
     assert (id >= 1 && id <= robots.size());
 
     if (robots[id-1] != 0) {
-        const char *name = ((cbRobot *) robots[id-1])->Name();
+        QString name(robots[id-1]->Name());	// freed with the robot
         delete robots[id-1];
         robots[id-1] = 0;
-        gui->appendMessage(QString(name) + " has been deleted from position " + QString::number(id));
+        if (gui) gui->appendMessage(QString(name) + " has been deleted from position " + QString::number(id));
 
         emit robotDeleted((int) id);
     }
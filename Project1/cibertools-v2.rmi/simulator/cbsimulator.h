@@ -26,14 +26,29 @@
 */
 
 #include "cbsimulatorGUI.h"
+#include "cblogwriter.h"
+#include "cbsnapshot.h"
+#include "cbscheduler.h"
+#include "cbprofiler.h"
+#include "cbrobotconfig.h"
+#include "cbsimstate.h"
+#include "cbmessageboard.h"
+#include "cbchunk.h"
+#include "cbpool.h"
+#include "cbdiagnostics.h"
+#include "cbutils.h"
 
 #include <QObject>
 #include <QVector>
-#include <QTimer>
+#include <QThread>
+#include <QMutex>
+#include <QAtomicInt>
 #include <iostream>
 #include <vector>
+#include <string>
 
 using std::vector;
+using std::string;
 using std::ostream;
 
 class cbPoint;
@@ -47,14 +62,34 @@ class cbRobot;
 class cbView;
 class cbPanel;
 class cbReceptionist;
+class cbController;
 
 class cbGraph;
 
 class QGraphicsView;
 class QGraphicsScene;
+class cbSimulator;
+
+/**
+ * Thread of the simulation kernel, runs cbSimulator::runKernel.
+ */
+class cbKernelThread : public QThread
+{
+public:
+	cbKernelThread(cbSimulator *s) : simulator(s) {}
+protected:
+	void run();
+private:
+	cbSimulator *simulator;
+};
 
 /**
  * Simulation kernel of the application.
+ *
+ * The kernel runs on its own thread (see startTimer), one cycle per
+ * deadline of a cbScheduler. The GUI follows the simulation through the
+ * snapshots published at the end of every cycle; its commands are queued slot calls, or direct calls made while
+ * holding cycleLock(), so they always take effect between two cycles.
  */
 class cbSimulator : public QObject
 {
@@ -81,12 +116,16 @@ public:
     bool isRegistrationAllowed(void);
 
     cbParameters * getParameters(void) {return param;}
+    /*! Settings of the robots, derived from the parameters. */
+    inline cbRobotConfig &robotConfig() { return robotConf; }
     inline cbParameters * getDefaultParameters() {return defaultParam;}
     inline cbLab * getDefaultLab () {return defaultLab;}
     inline cbGrid * getDefaultGrid () {return defaultGrid;}
 
     int openLog(const char *logFilename); // returns -1 in case of error
     int closeLog(void);
+    inline cbLogWriterStats logStats() { return logWriter.stats(); }
+    inline bool isLogging() { return logging; }
 
     inline cbLab *Lab() { return lab;}
     inline cbGrid *Grid() { return grid; }
@@ -95,6 +134,11 @@ public:
 
     bool registerRobot(cbRobot *);
 
+	/*! Loads a controller library (see cbcontroller.h) and registers count
+	    robots driven by it; they are registered again after each reset.
+	    Returns false if the library is not a valid controller. */
+	bool addPlugin(QString file, unsigned int count=1);
+
 	unsigned int curTime();
 	unsigned int simTime();
     unsigned int cycleTime();
@@ -138,10 +182,81 @@ public:
 	unsigned int labCanvasWidth,labCanvasHeight;
 
 	void startTimer(void);
+	void stopKernel(void);
+	void runKernel(void);
+	/*! Runs the given number of cycles back to back on the calling
+	    thread, without the GUI, and prints the cycle rate. */
+	void runBench(unsigned int cycles);
+	/*! Registers robots in the free positions of the grid and deletes
+	    them, the given number of rounds, and prints the allocations made
+	    per robot. */
+	void runChurnBench(unsigned int rounds);
+
+	/*! Catch up policy and busy wait tail of the cycle scheduler, to be
+	    set before startTimer. */
+	inline void setCatchUp(cbScheduler::CatchUp c) { scheduler.setCatchUp(c); }
+	inline void setSpin(unsigned int us) { scheduler.setSpin(us); }
+
+	/*! Starts the simulation as soon as the given number of robots is
+	    registered, 0 waits for the start command. */
+	inline void setAutoStart(unsigned int nRobots) { autoStart = nRobots; }
+
+	/*! Number of robots that can be registered, 0 for as many as the
+	    grid has positions. The robots beyond the grid start at positions
+	    sampled in the free space of the lab, which are then added to the
+	    grid. */
+	inline void setCapacity(unsigned int nRobots) { capacity = nRobots; }
+
+	/*! Robots registered per cycle at most, 0 for no limit. The others
+	    stay queued in the receptionist for the next cycles. */
+	inline void setAdmission(unsigned int nRobots) { admission = nRobots; }
+
+	/*! Writes the final state of the robots, as sent to the viewers,
+	    in a <Results> element. Returns false if it can not be written. */
+	bool writeResults(const char *file);
+
+	/*! Held by the kernel thread while it runs a cycle or a queued
+	    command. GUI code that reads or changes the kernel objects directly
+	    must hold it too. */
+	inline QMutex *cycleLock() { return &cycleMutex; }
+
+	/*! Snapshot of the last published cycle, to be used only by the GUI
+	    thread. newSnapshot() picks the latest one and returns false if
+	    no cycle was published since the previous call. */
+	inline bool newSnapshot() { return snapshots.acquire(); }
+	inline const cbSimSnapshot &snapshot() { return snapshots.read(); }
+
+	/*! Phase timings and counters of the kernel, hold cycleLock() to
+	    read or reset them from another thread. */
+	inline cbProfiler &profiler() { return prof; }
+
+	/*! Writes the complete state of the simulation, see cbsimstate.h.
+	    Hold cycleLock() when the kernel thread runs. */
+	void snapshot(cbSimState &st);
+	/*! Puts back a state written by snapshot, simulation states
+	    included. Returns false if it does not fit the lab, grid or
+	    robots of the simulator. */
+	bool restore(cbSimState &st);
+
+	/*! Number of cycles kept to rewind, 0 keeps none. */
+	void setHistory(unsigned int cycles);
+	inline unsigned int historySize() const { return historyCount; }
+
+	/*! Say messages of the cycle, posted before the measures are sent. */
+	inline const cbMessageBoard &messageBoard() const { return board; }
+
+	/*! Generator of the sensor and motor noise. */
+	inline cbRandom &randomGenerator() { return rng; }
+
+	/*! Storage of the sensors of the robots, see cbpool.h. */
+	inline cbSensorPool &sensorPool() { return pool; }
+
+	/*! Messages of the robots for the board of the GUI. */
+	inline cbDiagnostics &diagnostics() { return diag; }
 
 public slots:
 	void step();
-	void reset();
+	void reset(QString newLogFilename = QString());
 	void start();
 	void stop();
 
@@ -156,6 +271,10 @@ public slots:
     void setShowMeasures(bool);
     void setShowPositions(bool);
 
+    /*! Goes back the given number of running cycles, at most the ones
+        kept in the history, and stops the simulation. */
+    void rewind(uint cycles);
+
 signals:
     void toggleGPS(bool);
     void toggleScoreSensor(bool);
@@ -178,6 +297,10 @@ signals:
     void robotRegistered(int);
     void robotDeleted(int);
 
+    void simFinished();
+    /*! The robot ids go now up to size, start positions were added. */
+    void robotCapacityChanged(int size);
+
 
 protected: // data members
 	unsigned int curCycle;		// current simulation cycle
@@ -187,6 +310,7 @@ protected: // data members
 	cbLab *lab;					// the lab
 	cbGrid *grid;				// the grid
 	cbParameters *param;		// global simulation parameters
+	cbRobotConfig robotConf;	// robot settings derived from param
 
     cbLab *defaultLab;          // default lab
     cbGrid *defaultGrid;        // default grid
@@ -203,23 +327,51 @@ protected: // data members
 	State curState, nextState;	// current and next states
 
     bool logging;
-    ostream *logStream;
+    cbLogWriter logWriter;
 	QString logFilename;
 	
 	cbGraph *graph;
 	double distMaxToTarget;
 
-    QTimer timer;
+    cbScheduler scheduler;
+    cbKernelThread kernelThread;
+    QAtomicInt kernelStop;
+    QMutex cycleMutex;
+    cbSnapshotBuffer<cbSimSnapshot> snapshots;
+    unsigned int snapshotCount;
+    cbProfiler prof;
+    vector<cbController *> plugins;	// one entry per plugin robot
+    cbRandom rng;
+    cbMessageBoard board;
+    cbSensorPool pool;		// sensors of the robots
+    cbDiagnostics diag;
+
+    vector<cbSimState> history;	// ring of the states after the last running cycles
+    unsigned int historyHead, historyCount;
 
     bool allowRegistrations;
     bool showPositions;
+    unsigned int autoStart;
+    unsigned int capacity;
+    int gridFileSize;	// positions of the grid not added by addPositions
+    unsigned int admission;
+    string paramReply;	// OK reply to the clients, empty when the parameters changed
+    cbChunkedXml labXml, gridXml;	// lab and grid sent to the viewers, empty when changed
 
 protected: // member functions
+	bool event(QEvent *);
+
+	bool registerPlugin(cbController *);
+	const string &parameterReply();
+	const cbChunkedXml &labMessage();
+	const cbChunkedXml &gridMessage();
+	bool addPositions(unsigned int n);
+	bool spawnPosition(cbPosition &pos);
 	void CheckIn();
 	void ViewCommands();
 	void PanelCommands();
 	void RobotActions();
-	void Log(ostream &, bool withactions=true);
+	void Log(bool withactions=true);
 	void NextPositions();
 	void CheckCollisions();
 	void Commit();
@@ -228,6 +380,8 @@ protected: // member functions
 	void UpdateSensors();
 	void SendSensors();
 	void UpdateState();
+	void SaveHistory();
+	void PublishSnapshot();
 };
 
 #endif
@@ -32,6 +32,8 @@
 #include "cblabdialog.h"
 #include "cblab.h"
 #include "cbrobotinfo.h"
+#include "cbprofilerpanel.h"
+#include "cbtracer.h"
 
 /**
  * cbSimulatorGUI contructor.
@@ -52,7 +54,7 @@ cbSimulatorGUI::cbSimulatorGUI( cbSimulator *sim, QWidget* parent, Qt::WFlags fl
     connect(simulator, SIGNAL(simTimeChanged(int)), SLOT(setSimTime(int)));
     connect(simulator, SIGNAL(curTimeChanged(int)), SLOT(setRemainTime(int)));
 
-    ui->actionGPS_Enabled->setChecked(cbRobot::GPSOn);
+    ui->actionGPS_Enabled->setChecked(simulator->robotConfig().GPSOn);
     ui->actionScore_Sensor_Enabled->setChecked(simulator->getScoreSensor());
     ui->actionTime_Enabled->setChecked(simulator->isTimed());
     ui->actionRegistrations_Open->setChecked(simulator->isRegistrationAllowed());
@@ -75,7 +77,7 @@ cbSimulatorGUI::cbSimulatorGUI( cbSimulator *sim, QWidget* parent, Qt::WFlags fl
     actionStop = new QAction(this);
     connect(actionStart, SIGNAL(triggered()), simulator, SLOT(start()));
     connect(actionStop, SIGNAL(triggered()), simulator, SLOT(stop()));
-    connect(ui->actionReset, SIGNAL(triggered()), simulator, SLOT(reset()));
+    connect(ui->actionReset, SIGNAL(triggered()), SLOT(resetSimulator()));
 
     connect(ui->actionGPS_Enabled, SIGNAL(toggled(bool)), simulator, SLOT(setGPS(bool)));
     connect(ui->actionScore_Sensor_Enabled, SIGNAL(toggled(bool)), simulator, SLOT(setScoreSensor(bool)));
@@ -95,11 +97,14 @@ cbSimulatorGUI::cbSimulatorGUI( cbSimulator *sim, QWidget* parent, Qt::WFlags fl
     controlPanel = new cbControlPanel(simulator, agentModel, 0, Qt::Tool | Qt::WindowStaysOnTopHint | Qt::WindowCloseButtonHint | Qt::WindowMinimizeButtonHint);
     connect(ui->actionControl_Panel, SIGNAL(toggled(bool)), controlPanel, SLOT(setVisible(bool)));
     connect(controlPanel, SIGNAL(closed()), ui->actionControl_Panel, SLOT(toggle()));
+    connect(controlPanel, SIGNAL(resetRequested()), SLOT(resetSimulator()));
 
+    selectedRobotId = 0;
     nRobots = simulator->Robots().size();
     robotScores.resize(nRobots);
     resetRobWidgets(nRobots);
     connect(simulator, SIGNAL(gridChanged(int)), SLOT(resetRobWidgets(int)));
+    connect(simulator, SIGNAL(robotCapacityChanged(int)), SLOT(growRobWidgets(int)));
     connect(simulator, SIGNAL(robotRegistered(int)), SLOT(addRobWidget(int)));
     connect(simulator, SIGNAL(robotDeleted(int)), SLOT(removeRobWidget(int)));
 
@@ -107,6 +112,15 @@ cbSimulatorGUI::cbSimulatorGUI( cbSimulator *sim, QWidget* parent, Qt::WFlags fl
     connect(ui->checkBox_Measures, SIGNAL(toggled(bool)), simulator, SLOT(setShowMeasures(bool)));
     connect(ui->checkBox_Positions, SIGNAL(toggled(bool)), simulator, SLOT(setShowPositions(bool)));
 
+    // the kernel records the messages only while the board shows them
+    boardNext = 0;
+    ui->textEdit_Mailbox->document()->setMaximumBlockCount(5000);
+    connect(ui->checkBox_Actions, SIGNAL(toggled(bool)), SLOT(subscribeBoard()));
+    connect(ui->checkBox_Measures, SIGNAL(toggled(bool)), SLOT(subscribeBoard()));
+    connect(ui->checkBox_Positions, SIGNAL(toggled(bool)), SLOT(subscribeBoard()));
+    connect(ui->dockWidget_Mailbox, SIGNAL(visibilityChanged(bool)), SLOT(subscribeBoard()));
+    subscribeBoard();
+
 
     connect(ui->pushButton_ClearMailBox, SIGNAL(clicked()), ui->textEdit_Mailbox, SLOT(clear()));
 
@@ -114,6 +128,26 @@ cbSimulatorGUI::cbSimulatorGUI( cbSimulator *sim, QWidget* parent, Qt::WFlags fl
 
     labDialog = new cbLabDialog(simulator, this);
 
+    profilerPanel = new cbProfilerPanel(simulator, this, Qt::Tool);
+    QAction *actionProfiler = new QAction("Cycle Profiler", this);
+    ui->menuFile->insertAction(ui->actionLaunch_Viewer, actionProfiler);
+    connect(actionProfiler, SIGNAL(triggered()), profilerPanel, SLOT(show()));
+
+    QAction *actionRewind = new QAction("Rewind...", this);
+    ui->menuFile->insertAction(ui->actionLaunch_Viewer, actionRewind);
+    connect(actionRewind, SIGNAL(triggered()), SLOT(rewindSimulator()));
+
+    // only when the simulator was built and started with tracing
+    if (cbTracer::enabled()) {
+        QAction *actionTrace = new QAction("Dump Trace...", this);
+        ui->menuFile->insertAction(ui->actionLaunch_Viewer, actionTrace);
+        connect(actionTrace, SIGNAL(triggered()), SLOT(dumpTrace()));
+    }
+
+    // the kernel runs on its own thread, its state is shown at the GUI pace
+    connect(&refreshTimer, SIGNAL(timeout()), SLOT(refresh()));
+    refreshTimer.start(40);
+
     this->adjustSize();
 
 }
@@ -125,6 +159,13 @@ cbSimulatorGUI::~cbSimulatorGUI()
 
 void cbSimulatorGUI::appendMessage(const QString msg, const bool isErr)
 {
+    if (QThread::currentThread() != thread())
+    {
+        QMetaObject::invokeMethod(this, "appendMessage", Qt::QueuedConnection,
+                                  Q_ARG(QString, msg), Q_ARG(bool, isErr));
+        return;
+    }
+
     if (isErr)
         ui->messages->setTextColor(Qt::red);
     else
@@ -133,34 +174,68 @@ void cbSimulatorGUI::appendMessage(const QString msg, const bool isErr)
     ui->messages->append(msg);
 }
 
-void cbSimulatorGUI::writeOnBoard(const QString msg, int id, int type)
+/**
+ * Asks the kernel for the messages of the checked types and selected
+ * robot, none while the board is hidden.
+ */
+void cbSimulatorGUI::subscribeBoard()
+{
+    unsigned int types = 0;
+    if (ui->dockWidget_Mailbox->isVisible() && selectedRobotId >= 0)
+    {
+        if (ui->checkBox_Measures->isChecked())
+            types |= 1 << cbDiagnostics::MEASURES;
+        if (ui->checkBox_Actions->isChecked())
+            types |= 1 << cbDiagnostics::ACTION;
+        if (ui->checkBox_Positions->isChecked())
+            types |= 1 << cbDiagnostics::POSITION;
+    }
+    simulator->diagnostics().subscribe(types, selectedRobotId > 0 ? selectedRobotId : 0);
+}
+
+/**
+ * Shows the messages recorded since the last refresh, those recorded
+ * before a change of the subscription may not match it and are skipped.
+ */
+void cbSimulatorGUI::readBoard()
 {
-    QColor c;
-    if (selectedRobotId == 0 || selectedRobotId == id)
+    unsigned int dropped = simulator->diagnostics().read(boardNext, boardEvents, boardTexts, 256);
+    if (dropped > 0)
+    {
+        ui->textEdit_Mailbox->setTextColor(Qt::red);
+        ui->textEdit_Mailbox->append(QString("... %1 messages dropped").arg(dropped));
+    }
+
+    for (unsigned int i = 0; i < boardEvents.size(); i++)
     {
-        switch (type)
+        const cbDiagEvent &e = boardEvents[i];
+        if (selectedRobotId < 0 || (selectedRobotId != 0 && selectedRobotId != e.robot))
+            continue;
+
+        QColor c;
+        switch (e.type)
         {
-        case 0:
+        case cbDiagnostics::MEASURES:
             if (!ui->checkBox_Measures->isChecked())
-                return;
+                continue;
             c = Qt::blue;
             break;
-        case 1:
+        case cbDiagnostics::ACTION:
             if (!ui->checkBox_Actions->isChecked())
-                return;
+                continue;
             c = Qt::magenta;
             break;
-        case 2:
+        case cbDiagnostics::POSITION:
             if (!ui->checkBox_Positions->isChecked())
-                return;
+                continue;
             c = Qt::darkGreen;
             break;
         default:
-            return;
+            continue;
         }
 
         ui->textEdit_Mailbox->setTextColor(c);
-        ui->textEdit_Mailbox->append(msg);
+        ui->textEdit_Mailbox->append(cbDiagnostics::format(e, &boardTexts[e.pos]));
     }
 }
 
@@ -181,10 +256,14 @@ void cbSimulatorGUI::buildStatusBar()
     simTimeLabel = new QLabel(QString::number(simulator->simTime()));
     simTimeLabel->setToolTip("Time limit");
 
+    latenessLabel = new QLabel("0 us");
+    latenessLabel->setToolTip("Cycle lateness");
+
     ui->statusbar->addPermanentWidget(stateLabel,5);
     ui->statusbar->addPermanentWidget(labLabel,15);
     ui->statusbar->addPermanentWidget(curTimeLabel);
     ui->statusbar->addPermanentWidget(simTimeLabel);
+    ui->statusbar->addPermanentWidget(latenessLabel);
 }
 
 void cbSimulatorGUI::setSimTime(int time)
@@ -202,7 +281,7 @@ void cbSimulatorGUI::setSimTime(int time)
     {
         simTimeLabel->setNum(simTime);
         simTimeLabel->setToolTip("Time limit");
-        ui->lcdNumber_TimeRemain->display(simTime - (int) simulator->curTime());
+        ui->lcdNumber_TimeRemain->display(simTime - (int) simulator->snapshot().time);
         connect (simulator, SIGNAL(curTimeChanged(int)), SLOT(setRemainTime(int)));
     }
 }
@@ -212,6 +291,85 @@ void cbSimulatorGUI::setRemainTime(int time)
     ui->lcdNumber_TimeRemain->display(simTime - time);
 }
 
+/**
+ * Shows the last cycle published by the kernel thread.
+ */
+void cbSimulatorGUI::refresh()
+{
+    readBoard();
+
+    if (!simulator->newSnapshot())
+        return;
+
+    const cbSimSnapshot &snap = simulator->snapshot();
+    curTimeLabel->setNum((int) snap.time);
+    if (simTime)
+        setRemainTime((int) snap.time);
+
+    // overruns are shown in red, the tooltip has the totals
+    latenessLabel->setText(QString("%1 us").arg(snap.lateness));
+    latenessLabel->setStyleSheet(snap.overruns > 0 ? "color: red" : "");
+    latenessLabel->setToolTip(QString("Cycle lateness, max %1 us, %2 overruns, %3 cycles skipped")
+                              .arg(snap.maxLateness).arg(snap.overruns).arg(snap.skipped));
+
+    for (int i = 0; i < nRobots && i < (int) snap.robots.size(); i++)
+        if (robotScores[i] != 0 && snap.robots[i].id == (unsigned int) i + 1)
+            robotScores[i]->showStatus(snap.robots[i]);
+}
+
+/**
+ * Asks the name of the new log, if logging, and resets the simulator.
+ */
+void cbSimulatorGUI::resetSimulator()
+{
+    QString logFilename;
+    if (simulator->isLogging())
+        logFilename = QFileDialog::getSaveFileName(this, "Choose New Log Filename", ".", "Logs (*.log *.cblog)");
+
+    QMetaObject::invokeMethod(simulator, "reset", Qt::QueuedConnection, Q_ARG(QString, logFilename));
+}
+
+/**
+ * Asks how many cycles to go back and rewinds the simulator, which stops.
+ */
+void cbSimulatorGUI::rewindSimulator()
+{
+    int kept;
+    {
+        QMutexLocker lock(simulator->cycleLock());
+        kept = (int) simulator->historySize();
+    }
+    if (kept < 2) {
+        appendMessage("No cycles kept to rewind", true);
+        return;
+    }
+
+    bool ok;
+    int cycles = QInputDialog::getInt(this, "Rewind", "Cycles to go back:", 10, 1, kept-1, 1, &ok);
+    if (!ok) return;
+
+    QMetaObject::invokeMethod(simulator, "rewind", Qt::QueuedConnection, Q_ARG(uint, (uint) cycles));
+}
+
+/**
+ * Writes the events recorded so far by the tracer.
+ */
+void cbSimulatorGUI::dumpTrace()
+{
+    QString f = QFileDialog::getSaveFileName(this, "Dump Trace", "trace.json", "Chrome trace (*.json)");
+    if (f.isNull()) return;
+
+    vector<cbTraceEvent> events;
+    {
+        QMutexLocker lock(simulator->cycleLock());
+        cbTracer::copyEvents(events);
+    }
+    if (cbTracer::writeJson(f.toLocal8Bit().constData(), events))
+        appendMessage(QString("Trace with %1 events written to %2").arg(events.size()).arg(f));
+    else
+        appendMessage("Could not write the trace to " + f, true);
+}
+
 void cbSimulatorGUI::on_actionOpen_Lab_triggered()
 {
     if(simulator->state()==cbSimulator::INIT)
@@ -227,6 +385,7 @@ void cbSimulatorGUI::on_actionEdit_Configuration_triggered()
 
         paramDlg.exec();
 
+        QMutexLocker lock(simulator->cycleLock());
         simulator->processEditParameters();
     }
     else {
@@ -241,6 +400,7 @@ void cbSimulatorGUI::on_actionOpen_Configuration_triggered()
         //QString f = QFileDialog::getOpenFileName( QString::null, "*.xml", this );
         QString f = QFileDialog::getOpenFileName(this, "Open Configuration", QString::null, "*.xml");
         if ( !f.isEmpty() ) {
+            QMutexLocker lock(simulator->cycleLock());
             if(simulator->changeParameters(f))
                 appendMessage( QString("Parameters Changed to ")+f );
             else
@@ -258,8 +418,10 @@ void cbSimulatorGUI::on_actionSave_Configuration_triggered()
 
         QString f = QFileDialog::getSaveFileName(this, "Save Configuration", QString::null, "*.xml" );
 
-        if (!f.isNull())
+        if (!f.isNull()) {
+            QMutexLocker lock(simulator->cycleLock());
             simulator->saveConfiguration(f);
+        }
     }
     else {
         appendMessage(QString("Cannot Save Configuration After Start - Use Reset"), true);
@@ -369,11 +531,24 @@ void cbSimulatorGUI::resetRobWidgets(int size)
     refreshRobComboBox();
 }
 
+/*!
+	Makes room for the robots of the positions added beyond the grid,
+	keeping the widgets of the ones registered.
+*/
+void cbSimulatorGUI::growRobWidgets(int size)
+{
+    if (size <= nRobots) return;
+    robotScores.resize(size, 0);
+    nRobots = size;
+}
+
 void cbSimulatorGUI::addRobWidget(int id)
 {
-    if (id >= 1 && id <= nRobots && robotScores[id-1] == 0)
+    QMutexLocker lock(simulator->cycleLock());
+    if (id >= 1 && id <= nRobots && robotScores[id-1] == 0 && simulator->Robots()[id-1] != 0)
     {
-        robotScores[id-1] = new cbRobotInfo(simulator->Robots()[id-1]);
+        cbRobot *robot = simulator->Robots()[id-1];
+        robotScores[id-1] = new cbRobotInfo(robot->Id(), robot->Name());
         ui->gridLayout_Scores->addWidget(robotScores[id-1],id-1,0, Qt::AlignTop);
 
         refreshRobComboBox();
@@ -404,6 +579,7 @@ void cbSimulatorGUI::refreshRobComboBox()
 {
     ui->comboBox_Robot->clear();
     ui->comboBox_Robot->addItem("everyone", QVariant(0));
+    QMutexLocker lock(simulator->cycleLock());
     for (int i = 0; i < nRobots; i++)
     {
         cbRobot *robot = simulator->Robots()[i];
@@ -418,6 +594,7 @@ void cbSimulatorGUI::on_comboBox_Robot_currentIndexChanged(int index)
         selectedRobotId = ui->comboBox_Robot->itemData(index).toInt();
     else
         selectedRobotId = -1;
+    subscribeBoard();
 }
 
 void cbSimulatorGUI::on_actionSimulator_Help_triggered()
@@ -430,6 +607,7 @@ void cbSimulatorGUI::on_actionLoad_Defaults_triggered()
 {
     if(simulator->state()==cbSimulator::INIT)
     {
+        QMutexLocker lock(simulator->cycleLock());
         simulator->setDefaultParameters();
         simulator->setDefaultGrid();
         simulator->setDefaultLab();
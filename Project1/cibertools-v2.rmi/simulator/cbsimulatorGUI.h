@@ -32,6 +32,9 @@
 #include <QMainWindow>
 #include <QProcess>
 #include <QStringListModel>
+#include <QTimer>
+
+#include "cbdiagnostics.h"
 
 using std::vector;
 
@@ -39,6 +42,7 @@ class cbSimulator;
 class cbManageRobots;
 class cbControlPanel;
 class cbLabDialog;
+class cbProfilerPanel;
 class cbRobotInfo;
 class QLabel;
 class QLCDNumber;
@@ -59,8 +63,9 @@ public:
     explicit cbSimulatorGUI( cbSimulator *sim, QWidget* parent = 0, Qt::WFlags fl = 0 );
     ~cbSimulatorGUI();
 
+public slots:
+    // may be called from the kernel thread, the text is added by the GUI thread
     void appendMessage(const QString msg, const bool isErr = 0);
-    void writeOnBoard(const QString msg, int id, int type);
 
 private:
     cbSimulator *simulator;
@@ -69,11 +74,13 @@ private:
     cbManageRobots *manRobDialog;
     cbControlPanel *controlPanel;
     cbLabDialog *labDialog;
+    cbProfilerPanel *profilerPanel;
 
     QLabel *stateLabel;
     QLabel *labLabel;
     QLabel *curTimeLabel;
     QLabel *simTimeLabel;
+    QLabel *latenessLabel;
     void buildStatusBar();
 
     int simTime;
@@ -82,9 +89,20 @@ private:
     int selectedRobotId;
     int nRobots;
     vector< cbRobotInfo *> robotScores;
+    QTimer refreshTimer;
+    unsigned int boardNext;           // next message of the diagnostics to show
+    vector<cbDiagEvent> boardEvents;
+    vector<char> boardTexts;
+    void readBoard();
     Ui::cbSimulatorGUI *ui;
 
 private slots:
+    void refresh();
+    void subscribeBoard();
+    void resetSimulator();
+    void rewindSimulator();
+    void dumpTrace();
+
     void setSimTime(int);
     void setRemainTime(int);
 
@@ -102,6 +120,7 @@ private slots:
     void handleViewerExit(int, QProcess::ExitStatus);
 
     void resetRobWidgets(int);
+    void growRobWidgets(int);
     void addRobWidget(int);
     void removeRobWidget(int);
     void refreshRobComboBox();
@@ -0,0 +1,112 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef CBSNAPSHOT_H
+#define CBSNAPSHOT_H
+
+/*! \file cbsnapshot.h
+	\brief Per cycle state published by the simulation thread.
+
+	The simulation kernel runs on its own thread. At the end of each
+	cycle it copies what the GUI shows into a cbSimSnapshot and publishes
+	it through a cbSnapshotBuffer; the GUI picks the newest one whenever
+	it repaints, without ever blocking the kernel.
+*/
+
+#include <QAtomicInt>
+
+#include <vector>
+
+using std::vector;
+
+#define SNAPSHOT_NAME_LEN 64
+
+/**
+ * State of one robot as shown by the GUI.
+ */
+struct cbRobotStatus
+{
+	unsigned int id;                 // 0 for a free grid position
+	char name[SNAPSHOT_NAME_LEN];
+	int state;                       // cbRobot::State
+	unsigned int score, collisions;
+	unsigned int arrivalTime, returningTime;
+	bool collision;
+	double x, y, dir;
+};
+
+/**
+ * State of the simulation at the end of one cycle.
+ */
+struct cbSimSnapshot
+{
+	unsigned int time;               // current cycle
+	unsigned int simTime;            // last cycle, 0 if not timed
+	int state;                       // cbSimulator::State
+	unsigned int cycle;              // publication counter
+	unsigned int lateness;           // us, start of this cycle
+	unsigned int maxLateness;        // us
+	unsigned int overruns;           // cycles late by a period or more
+	unsigned int skipped;            // cycles dropped to catch up
+	vector<cbRobotStatus> robots;    // one entry per grid position
+
+	cbSimSnapshot() : time(0), simTime(0), state(0), cycle(0),
+		lateness(0), maxLateness(0), overruns(0), skipped(0) {}
+};
+
+/**
+ * Lock free single producer / single consumer snapshot exchange.
+ *
+ * This is a double buffer with a spare slot: the producer fills its
+ * back buffer and swaps it with the spare one, the consumer swaps its
+ * front buffer with the spare one when a fresher snapshot is there.
+ * The swaps are single atomic exchanges, so neither side waits and each
+ * buffer is only touched by one thread at a time. Buffers are reused,
+ * so no memory is allocated once they have grown to the robot count.
+ */
+template <class T>
+class cbSnapshotBuffer
+{
+public:
+	cbSnapshotBuffer() : spare(1), back(0), front(2) {}
+
+	/* producer side */
+	inline T &writeBuffer() { return buffers[back]; }
+	inline void publish() { back = spare.fetchAndStoreOrdered(back | FRESH) & INDEX; }
+
+	/* consumer side, returns false if nothing was published since the last call */
+	inline bool acquire()
+	{
+		if ((spare.fetchAndAddRelaxed(0) & FRESH) == 0) return false;
+		front = spare.fetchAndStoreOrdered(front) & INDEX;
+		return true;
+	}
+	inline const T &read() const { return buffers[front]; }
+
+private:
+	enum { INDEX = 3, FRESH = 4 };
+
+	T buffers[3];
+	QAtomicInt spare;   // index of the spare buffer, FRESH if newer than front
+	int back;           // owned by the producer
+	int front;          // owned by the consumer
+};
+
+#endif
@@ -0,0 +1,139 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+/*
+ * class cbTracer
+ */
+
+#include "cbtracer.h"
+#include "cbscheduler.h"
+#include "cbutils.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+
+using std::cerr;
+
+cbTraceEvent *cbTracer::ring = 0;
+unsigned int cbTracer::capacity = 0;
+unsigned long long cbTracer::recorded = 0;
+long long cbTracer::origin = 0;
+
+static CB_THREAD_LOCAL char traceThread = cbTracer::OTHER_THREAD;
+static const char *threadNames[] = { "other", "kernel", "gui" };
+
+bool cbTracer::enable(unsigned int cap)
+{
+	if (ring != 0 || cap == 0) return false;
+	ring = new cbTraceEvent[cap];
+	capacity = cap;
+	recorded = 0;
+	origin = now();
+	return true;
+}
+
+void cbTracer::setThread(Thread t)
+{
+	traceThread = (char) t;
+}
+
+long long cbTracer::now()
+{
+	return cbScheduler::now();
+}
+
+inline cbTraceEvent &cbTracer::next()
+{
+	cbTraceEvent &e = ring[recorded % capacity];
+	recorded++;
+	e.tid = traceThread;
+	return e;
+}
+
+void cbTracer::complete(const char *name, const char *cat, long long start, long long end, int arg)
+{
+	cbTraceEvent &e = next();
+	e.ts = start;
+	e.dur = end - start;
+	e.name = name;
+	e.cat = cat;
+	e.arg = arg;
+	e.ph = 'X';
+}
+
+void cbTracer::instant(const char *name, const char *cat, int arg)
+{
+	cbTraceEvent &e = next();
+	e.ts = now();
+	e.dur = 0;
+	e.name = name;
+	e.cat = cat;
+	e.arg = arg;
+	e.ph = 'i';
+}
+
+void cbTracer::copyEvents(vector<cbTraceEvent> &events)
+{
+	events.clear();
+	if (ring == 0) return;
+
+	unsigned int n = recorded < capacity ? (unsigned int) recorded : capacity;
+	unsigned int first = (unsigned int) ((recorded - n) % capacity);
+	events.resize(n);
+	unsigned int tail = capacity - first < n ? capacity - first : n;
+	memcpy(&events[0], ring + first, tail * sizeof(cbTraceEvent));
+	if (tail < n)
+		memcpy(&events[tail], ring, (n - tail) * sizeof(cbTraceEvent));
+}
+
+/*!
+	Writes the events in Chrome Trace Event JSON format, times in us
+	from the start of the trace. Returns false on error.
+*/
+bool cbTracer::writeJson(const char *filename, const vector<cbTraceEvent> &events)
+{
+	FILE *f = fopen(filename, "w");
+	if (f == 0) {
+		cerr << "Could not open trace file " << filename << "\n";
+		return false;
+	}
+
+	fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	for (int t = OTHER_THREAD; t <= GUI_THREAD; t++)
+		fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}},\n",
+		        t, threadNames[t]);
+
+	for (unsigned int i = 0; i < events.size(); i++) {
+		const cbTraceEvent &e = events[i];
+		fprintf(f, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,",
+		        e.name, e.cat, e.ph, (e.ts - origin) / 1000.0);
+		if (e.ph == 'X') fprintf(f, "\"dur\":%.3f,", e.dur / 1000.0);
+		else fprintf(f, "\"s\":\"t\",");
+		fprintf(f, "\"pid\":1,\"tid\":%d", e.tid);
+		if (e.arg >= 0) fprintf(f, ",\"args\":{\"robot\":%d}", e.arg);
+		fprintf(f, i + 1 < events.size() ? "},\n" : "}\n");
+	}
+	fprintf(f, "]}\n");
+
+	bool ok = !ferror(f);
+	ok = fclose(f) == 0 && ok;
+	if (!ok) cerr << "Could not write trace file " << filename << "\n";
+	return ok;
+}
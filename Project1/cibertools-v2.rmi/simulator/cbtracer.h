@@ -0,0 +1,121 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef CBTRACER_H
+#define CBTRACER_H
+
+/*! \file cbtracer.h
+	\brief Timeline of the simulation kernel in Chrome trace format.
+
+	When the simulator is built with CONFIG+=trace (CB_TRACE defined) and
+	run with -trace, the phases of every cycle, per robot work and events
+	such as registrations, collisions and state changes are recorded into
+	a ring buffer of fixed size; the oldest events are overwritten. The
+	buffer is written as Chrome Trace Event JSON, to be opened in
+	chrome://tracing or Perfetto, at exit or on demand from the GUI.
+
+	Events are recorded by whoever holds the cycle lock, so the buffer has
+	a single writer at a time; copyEvents must be called under the lock
+	too. Recording an event is a few stores into the ring. Without
+	CB_TRACE the CB_TRACE_ macros expand to nothing.
+*/
+
+#include <vector>
+
+using std::vector;
+
+struct cbTraceEvent
+{
+	long long ts;           // ns, monotonic clock
+	long long dur;          // ns, complete events only
+	const char *name;       // static strings only
+	const char *cat;
+	int arg;                // robot id, -1 if none
+	char ph;                // 'X' complete, 'i' instant
+	char tid;               // cbTracer::Thread
+};
+
+class cbTracer
+{
+public:
+	enum Thread { OTHER_THREAD, KERNEL_THREAD, GUI_THREAD };
+
+	/*! Starts recording into a ring buffer of capacity events. */
+	static bool enable(unsigned int capacity);
+	static inline bool enabled() { return ring != 0; }
+
+	/*! Tags the events recorded by the calling thread. */
+	static void setThread(Thread t);
+
+	static long long now();
+	static void complete(const char *name, const char *cat, long long start, long long end, int arg);
+	static void instant(const char *name, const char *cat, int arg);
+
+	/*! Copies the recorded events, oldest first. */
+	static void copyEvents(vector<cbTraceEvent> &events);
+	static bool writeJson(const char *filename, const vector<cbTraceEvent> &events);
+
+private:
+	static inline cbTraceEvent &next();
+
+	static cbTraceEvent *ring;
+	static unsigned int capacity;
+	static unsigned long long recorded;
+	static long long origin;
+};
+
+/**
+ * Records the lifetime of the object as a complete event.
+ */
+class cbTraceSpan
+{
+public:
+	cbTraceSpan(const char *n, const char *c, int a) : name(n), cat(c), arg(a)
+	{ start = cbTracer::enabled() ? cbTracer::now() : 0; }
+	~cbTraceSpan()
+	{ if (cbTracer::enabled()) cbTracer::complete(name, cat, start, cbTracer::now(), arg); }
+private:
+	const char *name, *cat;
+	int arg;
+	long long start;
+};
+
+#ifdef CB_TRACE
+#define CB_TRACE_CONCAT2(a, b) a##b
+#define CB_TRACE_CONCAT(a, b) CB_TRACE_CONCAT2(a, b)
+#define CB_TRACE_SPAN(name, cat, arg) \
+	cbTraceSpan CB_TRACE_CONCAT(traceSpan, __LINE__)(name, cat, arg)
+#define CB_TRACE_COMPLETE(name, cat, start, end, arg) \
+	do { if (cbTracer::enabled()) cbTracer::complete(name, cat, start, end, arg); } while (0)
+#define CB_TRACE_INSTANT(name, cat, arg) \
+	do { if (cbTracer::enabled()) cbTracer::instant(name, cat, arg); } while (0)
+#define CB_TRACE_MARK(var) \
+	long long var = cbTracer::enabled() ? cbTracer::now() : 0
+#define CB_TRACE_SINCE(name, cat, var, arg) \
+	do { if (cbTracer::enabled()) cbTracer::complete(name, cat, var, cbTracer::now(), arg); } while (0)
+#else
+#define CB_TRACE_SPAN(name, cat, arg)
+#define CB_TRACE_COMPLETE(name, cat, start, end, arg) do {} while (0)
+#define CB_TRACE_INSTANT(name, cat, arg) do {} while (0)
+#define CB_TRACE_MARK(var)
+#define CB_TRACE_SINCE(name, cat, var, arg) do {} while (0)
+#endif
+
+#endif
@@ -18,6 +18,8 @@
     Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
+#include "cbutils.h"
+
 #include <stdlib.h>
 #include <math.h>
 
@@ -27,6 +29,17 @@
 #endif
 #endif
 
+/*
+ * generator used by the thread, and the one of threads that use none
+ */
+static CB_THREAD_LOCAL cbRandom *threadRandom = 0;
+static CB_THREAD_LOCAL cbRandom defaultRandom;
+
+static inline cbRandom *currentRandom()
+{
+	return threadRandom != 0 ? threadRandom : &defaultRandom;
+}
+
 /*! 
  * Returns a random number with a normal distribution (in successive calls)
  * of mean mean and standard deviation stddev.
@@ -35,10 +48,11 @@
 double randNormal(double mean, double stddev)
 {
 	double x,y,r;
+	cbRandom *rng = currentRandom();
 	
 	do {
-	        x = 2.0 * ((double)rand() / ((double)RAND_MAX + 1.0)) - 1.0;
-	        y = 2.0 * ((double)rand() / ((double)RAND_MAX + 1.0)) - 1.0;
+	        x = 2.0 * rng->uniform() - 1.0;
+	        y = 2.0 * rng->uniform() - 1.0;
 		r = x*x + y*y;
 	} while( r > 1.0 );
 
@@ -48,6 +62,32 @@ double randNormal(double mean, double stddev)
 double randUniform(double min, double max)
 {
 
-	return min + ((double)rand() / ((double)RAND_MAX + 1.0)) * (max - min) ;
+	return min + currentRandom()->uniform() * (max - min) ;
+}
+
+void cbRandom::seed(unsigned long long s)
+{
+	// the state must not be 0, spread small seeds over all bits
+	state = (s + 1) * 0x9E3779B97F4A7C15ULL;
+	if (state == 0) state = 1;
+}
+
+unsigned long long cbRandom::next()
+{
+	if (state == 0) seed(0);
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 0x2545F4914F6CDD1DULL;
+}
+
+double cbRandom::uniform()
+{
+	return (next() >> 11) * (1.0 / 9007199254740992.0);    // 53 bits
+}
+
+void cbRandom::use(cbRandom *r)
+{
+	threadRandom = r;
 }
 
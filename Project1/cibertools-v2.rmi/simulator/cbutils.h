@@ -18,6 +18,9 @@
     Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
+#ifndef CB_UTILS_H
+#define CB_UTILS_H
+
 /**
  * return a random number.
  * repeated calls to this function with the same mean and stddev
@@ -33,3 +36,36 @@ double randNormal(double mean, double stddev);
  */
 double randUniform(double min, double max);
 
+/**
+ * State of a random generator (xorshift64*). randNormal and randUniform
+ * draw from the generator in use by the calling thread; a simulator uses
+ * its own one while it runs, so that simulators do not share a sequence
+ * and the state can be saved and restored with the simulation.
+ * Threads that use none draw from a generator of their own.
+ */
+struct cbRandom
+{
+	unsigned long long state;
+
+	void seed(unsigned long long s);
+	unsigned long long next();
+	/*! Uniform in [0, 1). */
+	double uniform();
+
+	/*! Makes r the generator of the calling thread, 0 for the default. */
+	static void use(cbRandom *r);
+};
+
+
+/**
+ * storage class of per thread variables
+ */
+#ifndef CB_THREAD_LOCAL
+#if defined(_MSC_VER)
+#define CB_THREAD_LOCAL __declspec(thread)
+#else
+#define CB_THREAD_LOCAL __thread
+#endif
+#endif
+
+#endif
@@ -19,6 +19,7 @@
 */
 
 #include "cbview.h"
+#include "cbprofiler.h"
 
 #include <QUdpSocket>
 #include <QHostAddress>
@@ -58,6 +59,7 @@ bool cbView::readCommand(cbCommand *command)
 		return false;
 	}
 	else xmlBuff[xmlSize]='\0';
+	cbProfiler::countIn(xmlSize);
 
 #ifdef DEBUG_VIEW
 	cerr << "cbView: " << xmlBuff << endl;
@@ -69,6 +71,7 @@ bool cbView::readCommand(cbCommand *command)
 	if (!parser.parse(source))
 	{
 		cerr << "cbView::Fail parsing xml view message\n";
+		cbProfiler::countParseFailure();
 		return false;
 	}
 	
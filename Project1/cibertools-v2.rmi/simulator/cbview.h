@@ -24,6 +24,7 @@
 #include "cbclient.h"
 #include "cbviewhandler.h"
 #include "cbviewcommand.h"
+#include "cbchunk.h"
 
 /**
   *@author Nuno Lau, Artur Pereira & Andreia Melo, Miguel Rodrigues
@@ -32,7 +33,7 @@
 /**
  * This is the representation of each viewer from the point of view of the simulator
  */
-class cbView : public cbClient
+class cbView : public cbClient, public cbDatagramSink
 {
 public:
 	cbView();
@@ -40,6 +41,9 @@ public:
 
 	bool readCommand(cbCommand *command);
 
+	/*! Datagrams of the lab and grid messages, see cbchunk.h. */
+	bool sendDatagram(const char *data, unsigned int len) { return send(data, len); }
+
 protected: // class data members
 	cbViewHandler handler;
 
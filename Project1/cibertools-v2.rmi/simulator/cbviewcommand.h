@@ -22,10 +22,13 @@
 
 struct cbCommand
 {
-	enum {UNKNOWN, START, STOP, LABRQ, GRIDRQ, ROBOTDEL} type;
+	enum {UNKNOWN, START, STOP, LABRQ, GRIDRQ, ROBOTDEL, REWIND, CHUNKRQ} type;
+	enum Object {LAB, GRID};
 	union 
 	{
 		struct { int id; } robot;
+		struct { unsigned int cycles; } rewind;
+		struct { Object object; unsigned int version, seq; } chunk;
 	};
 };
 
@@ -71,6 +71,19 @@ bool cbViewHandler::startElement( const QString&, const QString&, const QString&
 	{
 		command.type = cbCommand::GRIDRQ;
 	}
+	else if (tag == "Rewind")
+	{
+		command.type = cbCommand::REWIND;
+		const QString &cycles = attr.value(QString("Cycles"));
+		command.rewind.cycles = cycles.isNull() ? 1 : cycles.toUInt();
+	}
+	else if (tag == "ChunkReq")
+	{
+		command.type = cbCommand::CHUNKRQ;
+		command.chunk.object = attr.value(QString("Object")) == "Grid" ? cbCommand::GRID : cbCommand::LAB;
+		command.chunk.version = attr.value(QString("Version")).toUInt();
+		command.chunk.seq = attr.value(QString("Seq")).toUInt();
+	}
 	else
 	{
 		command.type = cbCommand::UNKNOWN;
@@ -116,6 +129,22 @@ bool cbViewHandler::endElement( const QString&, const QString&, const QString& q
 			return false;
 		}
 	}
+	else if (tag == "Rewind")
+	{
+		if (command.type != cbCommand::REWIND)
+		{
+			cerr << "Missmatched end Rewind tag\n";
+			return false;
+		}
+	}
+	else if (tag == "ChunkReq")
+	{
+		if (command.type != cbCommand::CHUNKRQ)
+		{
+			cerr << "Missmatched end ChunkReq tag\n";
+			return false;
+		}
+	}
 	else if (tag == "Robot")
 	{
 		if (command.type != cbCommand::ROBOTDEL)
@@ -120,6 +120,24 @@ double cbWall::distance(cbPoint &p)
 	return min;
 }
 
+/*!
+	Even-odd rule: p is inside if a ray from it crosses the faces of the
+	wall an odd number of times.
+*/
+bool cbWall::contains(cbPoint &p)
+{
+	bool inside = false;
+	unsigned int n = corners.size();
+	for (unsigned int i=0, j=n-1; i<n; j=i++)
+	{
+		cbPoint &a = corners[i], &b = corners[j];
+		if ((a.y > p.y) != (b.y > p.y)
+		    && p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x)
+			inside = !inside;
+	}
+	return inside;
+}
+
 /*!
 	Determine and return the minimum distance from the given
 	point, in the given direction to any of the wall faces.
@@ -49,6 +49,8 @@ public:
 	bool    convexCorner(unsigned int c);
 
 	double distance(cbPoint &);
+	/*! True if p is inside the polygon of the wall. */
+	bool contains(cbPoint &p);
 	double distance(cbPoint &, double theta);
 	double cornerDistance(cbPoint &, double, double);
 
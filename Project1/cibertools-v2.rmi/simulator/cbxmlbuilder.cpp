@@ -0,0 +1,150 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "cbxmlbuilder.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdarg.h>
+
+static const double pow10Table[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/*
+	Scales a by 10^k, |k| <= 22. The power is exact, so the result has
+	a single rounding, less than 1e-10 for the values below 1e6.
+*/
+static inline double scale(double a, int k)
+{
+	return k >= 0 ? a * pow10Table[k] : a / pow10Table[-k];
+}
+
+int cbFormatUInt(char *out, unsigned int v)
+{
+	char tmp[12];
+	int len = 0;
+	do {
+		tmp[len++] = (char) ('0' + v % 10);
+		v /= 10;
+	} while (v != 0);
+	for (int i = 0; i < len; i++)
+		out[i] = tmp[len - 1 - i];
+	return len;
+}
+
+int cbFormatInt(char *out, int v)
+{
+	if (v >= 0) return cbFormatUInt(out, (unsigned int) v);
+	out[0] = '-';
+	return 1 + cbFormatUInt(out + 1, 0u - (unsigned int) v);
+}
+
+/*!
+	%g of printf: the value rounded to 6 significant digits, d.ddddde+X,
+	written in fixed notation when -4 <= X < 6 and in exponential notation
+	otherwise, without the trailing zeros.
+*/
+int cbFormatDouble(char *out, double v)
+{
+	if (v != v || v - v != 0)	// nan, inf
+		return snprintf(out, 32, "%g", v);
+
+	double value = v;
+	char *p = out;
+	if (signbit(v)) { *p++ = '-'; v = -v; }
+	if (v == 0) {
+		*p++ = '0';
+		*p = '\0';
+		return (int) (p - out);
+	}
+
+	/* decimal exponent X and the 6 digits N = round(v * 10^(5-X)) */
+	int e;
+	frexp(v, &e);
+	int x = (int) floor((e - 1) * 0.30102999566398120);
+	double s = 0;
+	int tries;
+	for (tries = 0; tries < 3; tries++) {
+		if (x < -17 || x > 27) break;
+		s = scale(v, 5 - x);
+		if (s < 1e5) x--;
+		else if (s >= 1e6) x++;
+		else break;
+	}
+	if (tries == 3 || x < -17 || x > 27)
+		return snprintf(out, 32, "%g", value);
+
+	double whole = floor(s);
+	double frac = s - whole;
+	if (fabs(frac - 0.5) < 1e-8)	// too close to call, let the C library round it
+		return snprintf(out, 32, "%g", value);
+	unsigned int N = (unsigned int) whole + (frac > 0.5 ? 1 : 0);
+	if (N >= 1000000) { N /= 10; x++; }
+
+	char d[6];
+	for (int i = 5; i >= 0; i--) { d[i] = (char) ('0' + N % 10); N /= 10; }
+	int last = 5;
+	while (last > 0 && d[last] == '0') last--;
+
+	if (x < -4 || x >= 6) {
+		*p++ = d[0];
+		if (last > 0) {
+			*p++ = '.';
+			for (int i = 1; i <= last; i++) *p++ = d[i];
+		}
+		*p++ = 'e';
+		if (x < 0) { *p++ = '-'; x = -x; }
+		else *p++ = '+';
+		if (x < 10) *p++ = '0';
+		p += cbFormatUInt(p, (unsigned int) x);
+	}
+	else if (x >= 0) {
+		for (int i = 0; i <= x; i++) *p++ = d[i];
+		if (last > x) {
+			*p++ = '.';
+			for (int i = x + 1; i <= last; i++) *p++ = d[i];
+		}
+	}
+	else {
+		*p++ = '0';
+		*p++ = '.';
+		for (int i = -1; i > x; i--) *p++ = '0';
+		for (int i = 0; i <= last; i++) *p++ = d[i];
+	}
+	*p = '\0';
+	return (int) (p - out);
+}
+
+cbXmlBuilder &cbXmlBuilder::format(const char *fmt, ...)
+{
+	if (full) return *this;
+	va_list ap;
+	va_start(ap, fmt);
+	int len = vsnprintf(buf + n, cap - n, fmt, ap);
+	va_end(ap);
+	if (len < 0 || n + len >= cap) {
+		full = true;
+		n = cap - 1;
+	}
+	else n += len;
+	return *this;
+}
@@ -0,0 +1,106 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef CBXMLBUILDER_H
+#define CBXMLBUILDER_H
+
+/*! \file cbxmlbuilder.h
+	\brief Append only builder of the XML messages of the simulator.
+
+	The sensor measures, robot states, lab, grid, parameters and log
+	entries were written with one sprintf per attribute; parsing the
+	format string and the generic double conversion of the C library
+	took most of the time of sendSensors.
+
+	cbXmlBuilder appends text and numbers into a buffer given by the
+	caller, with no allocation. Integers are written with a digit
+	loop. Doubles are written as %g, that is with 6 significant
+	digits, so that the messages are the same bytes as before: the
+	digits are taken from the value scaled by an exact power of ten,
+	and the few values that fall too close to a rounding tie, or out
+	of the range of the table, go through snprintf.
+
+	The buffer is always null terminated. When it is full the text
+	that does not fit is dropped and overflow() returns true.
+*/
+
+#include <string.h>
+
+/*! Writes v as printf("%g") does into out, which must hold 32 chars.
+    Returns the length written, not counting the null terminator. */
+int cbFormatDouble(char *out, double v);
+/*! Writes v in decimal into out, which must hold 12 chars. */
+int cbFormatInt(char *out, int v);
+int cbFormatUInt(char *out, unsigned int v);
+
+class cbXmlBuilder
+{
+public:
+	cbXmlBuilder(char *buff, unsigned int len)
+		: buf(buff), cap(len), n(0), full(len == 0)
+	{ if (len > 0) buf[0] = '\0'; }
+
+	inline unsigned int length() const { return n; }
+	inline const char *data() const { return buf; }
+	inline bool overflow() const { return full; }
+	/*! Starts again at the beginning of the buffer. */
+	inline void clear() { n = 0; full = (cap == 0); if (cap > 0) buf[0] = '\0'; }
+
+	inline cbXmlBuilder &append(const char *s, unsigned int len)
+	{
+		if (n + len >= cap) { full = true; len = (cap > n) ? cap - n - 1 : 0; }
+		memcpy(buf + n, s, len);
+		n += len;
+		if (cap > 0) buf[n] = '\0';
+		return *this;
+	}
+
+	inline cbXmlBuilder &operator<<(const char *s) { return append(s, strlen(s)); }
+	inline cbXmlBuilder &operator<<(char c) { return append(&c, 1); }
+	inline cbXmlBuilder &operator<<(int v)
+	{
+		if (n + 12 < cap) { n += cbFormatInt(buf + n, v); buf[n] = '\0'; return *this; }
+		char tmp[12];
+		return append(tmp, cbFormatInt(tmp, v));
+	}
+	inline cbXmlBuilder &operator<<(unsigned int v)
+	{
+		if (n + 12 < cap) { n += cbFormatUInt(buf + n, v); buf[n] = '\0'; return *this; }
+		char tmp[12];
+		return append(tmp, cbFormatUInt(tmp, v));
+	}
+	inline cbXmlBuilder &operator<<(double v)
+	{
+		if (n + 32 < cap) { n += cbFormatDouble(buf + n, v); return *this; }
+		char tmp[32];
+		return append(tmp, cbFormatDouble(tmp, v));
+	}
+
+	/*! printf like append, for the formats the builder does not cover. */
+	cbXmlBuilder &format(const char *fmt, ...);
+
+private:
+	char *buf;
+	unsigned int cap;	// size of buf
+	unsigned int n;		// length of the text, buf[n] is '\0'
+	bool full;
+};
+
+#endif
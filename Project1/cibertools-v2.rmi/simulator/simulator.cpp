@@ -61,6 +61,7 @@
 #include "cbsensor.h"
 #include "cbrobot.h"
 #include "cbutils.h"
+#include "cbtracer.h"
 
 
 #include "cbsimulatorGUI.h"
@@ -80,78 +81,64 @@ static cbSimulator simulator;
 //static QXmlSimpleReader xmlParser;	// parser for xml data
 
 
-
-/*
- * This is necessary in order the static data member becomes
- * real before the existence of any object of the class.
- */
-
-//Noise
-double  cbMotor::noise = 0.0;
-double  cbCompassSensor::noise = 0.0;
-double  cbBeaconSensor::noise = 0.0;
-double  cbIRSensor::noise = 0.0;
-double  cbGPSSensor::noiseLin = 0.5;
-double  cbGPSSensor::noiseAng = 5.0;
-double  cbGPSSensor::offsetX   = randUniform(0.0,1000.0);
-double  cbGPSSensor::offsetY   = randUniform(0.0,1000.0);
-double  cbGPSSensor::offsetDeg = 0.0;  // a different value would not be consistent with XY reference frame nor with compass
-
-bool    cbRobot::GPSOn = true;
-bool    cbRobot::GPSDirOn = false;
-bool    cbRobot::scoreSensorOn = false;
-bool    cbRobot::showActions = true;
-bool    cbRobot::showMeasures = true;
-bool    cbRobot::ignoreOthers = false;
-
-//Scores
-int     cbRobot::returnTimePenalty = 25;
-int     cbRobot::arrivalTimePenalty = 100;
-int     cbRobot::collisionWallPenalty = 2;
-int     cbRobot::collisionRobotPenalty = 2;
-int     cbRobot::targetReward = 100;
-int     cbRobot::homeReward = 100;
-
-//Requests
-unsigned int    cbRobot::maxSensorsRequested = 4;
-
-bool    cbIRSensor::sensorRequestable        = false;
-bool    cbBeaconSensor::sensorRequestable    = false;
-bool    cbCompassSensor::sensorRequestable   = false;
-bool    cbGroundSensor::sensorRequestable    = false;
-bool    cbCollisionSensor::sensorRequestable = false;
-bool    cbGPSSensor::sensorRequestable       = false;
-
-//Latencies
-int     cbIRSensor::sensorLatency        =  0;
-int     cbBeaconSensor::sensorLatency    =  0;
-int     cbCompassSensor::sensorLatency   =  0;
-int     cbGroundSensor::sensorLatency    =  0;
-int     cbCollisionSensor::sensorLatency =  0;
-int     cbGPSSensor::sensorLatency       =  0;
-
-double  cbBeaconSensor::sensorAperture    = M_PI;
-
 void CommandLineError()
 {
-    QMessageBox::critical(0,"Error", 
-		    "SYNOPSIS: simulator [-lab file] [-grid file] [-log file] [-param file] [-port portnumber] [-showgraph id] [-gps]",
+    const char *synopsis =
+		    "SYNOPSIS: simulator [-lab file] [-grid file] [-log file] [-param file] [-port portnumber] [-showgraph id] [-gps] [-catchup skip|compress] [-spin us] [-trace file] [-tracesize n] [-plugin file[@count]] [-bench cycles] [-churn rounds] [-history cycles] [-nogui] [-autostart robots] [-results file] [-capacity robots] [-admit robots]";
+    if (QApplication::type() == QApplication::Tty)
+        cerr << synopsis << "\n";
+    else
+        QMessageBox::critical(0,"Error", synopsis,
 		    QMessageBox::Ok, Qt::NoButton, Qt::NoButton);
     exit(1);
 }
 
+static void writeTrace(const char *file)
+{
+	vector<cbTraceEvent> events;
+	cbTracer::copyEvents(events);
+	cbTracer::writeJson(file, events);
+}
 
 /*
  * This program accepts the following command line options
  * -lab string: name of file with lab description (default, stdin);
  * -grid string: name of file with start position grid (default, stdin);
  * -log string: name of log file (default, server.log);
+ *              logs named *.cblog are written in the binary format;
  * -nc real: compass noise coeficient (default, 0.0);
  * -nb real: beacon noise coeficient (default, 0.0);
  * -ni real: infrared noise coeficient (default, 0.0);
  * -nm real: motors noise coeficient (default, 0.0);
  * -st integer: simulation time, in number of cycle time units (default, 3000);
- * -ct integer: cycle time, in miliseconds (default, 75).
+ * -ct integer: cycle time, in miliseconds (default, 75);
+ * -catchup skip|compress: what to do with the cycles missed after an
+ *              overrun, drop them or run them back to back (default, skip);
+ * -spin integer: busy wait the last microseconds before each cycle
+ *              deadline, for sub 100 us accuracy (default, 0);
+ * -trace string: record a timeline of the cycles and write it to the
+ *              given file, as Chrome trace JSON, at exit (only when built
+ *              with CONFIG+=trace);
+ * -tracesize integer: events kept by the trace (default, 262144).
+ * -plugin string[@integer]: register robots driven by the controller
+ *              library in the given file, one or count of them (may be
+ *              repeated), see cbcontroller.h;
+ * -bench integer: run the given number of cycles as fast as possible,
+ *              without GUI, print the cycle rate and exit;
+ * -churn integer: register robots in the free grid positions and delete
+ *              them again, the given number of rounds, print the
+ *              allocations made per robot and exit;
+ * -history integer: running cycles kept to rewind the simulation
+ *              (default, 200, 0 keeps none);
+ * -nogui: run without GUI, exit when the simulation finishes;
+ * -autostart integer: start the simulation as soon as the given number
+ *              of robots is registered;
+ * -results string: write the final state of the robots to the given
+ *              file, at exit;
+ * -capacity integer: number of robots accepted, the ones beyond the grid
+ *              start at free positions sampled in the lab;
+ * -admit integer: robots registered per cycle at most, the others wait
+ *              for the next cycles (default, 16, 0 for no limit).
  */
 int main(int argc, char *argv[])
 {
@@ -169,7 +156,23 @@ int main(int argc, char *argv[])
 	bool showGraph=false;
 	int showGraphId=0;
 
-    QApplication app(argc,argv);
+	char *traceFilename = 0;
+	unsigned int traceSize = 1 << 18;
+
+	vector<QString> pluginFiles;
+	vector<unsigned int> pluginCounts;
+	unsigned int benchCycles = 0;
+	unsigned int churnRounds = 0;
+
+	bool noGUI = false;
+	unsigned int autoStart = 0;
+	char *resultsFilename = 0;
+
+	// the application needs no display when there is no GUI
+	for (int a=1; a<argc; a++)
+		if (strcmp(argv[a], "-nogui") == 0) noGUI = true;
+
+    QApplication app(argc,argv,!noGUI);
 
     setlocale(LC_ALL,"C");
 
@@ -222,6 +225,67 @@ int main(int argc, char *argv[])
             // wait until second pass of command line parsing
             p+=1;
 		}
+        else if (strcmp(argv[p], "-trace") == 0) {
+            if (p+1 < argc) {
+                traceFilename = argv[p+1];
+                p+=2;
+            }
+            else CommandLineError();
+		}
+        else if (strcmp(argv[p], "-tracesize") == 0) {
+            if (p+1 < argc && sscanf(argv[p+1], "%u", &traceSize) == 1 && traceSize > 0)
+                p+=2;
+            else CommandLineError();
+		}
+        else if (strcmp(argv[p], "-plugin") == 0) {
+            if (p+1 < argc) {
+                QString file = argv[p+1];
+                unsigned int count = 1;
+                int at = file.lastIndexOf('@');
+                if (at > 0) {
+                    bool ok;
+                    count = file.mid(at+1).toUInt(&ok);
+                    if (!ok || count == 0) CommandLineError();
+                    file.truncate(at);
+                }
+                pluginFiles.push_back(file);
+                pluginCounts.push_back(count);
+                p+=2;
+            }
+            else CommandLineError();
+		}
+        else if (strcmp(argv[p], "-bench") == 0) {
+            if (p+1 < argc && sscanf(argv[p+1], "%u", &benchCycles) == 1 && benchCycles > 0)
+                p+=2;
+            else CommandLineError();
+		}
+        else if (strcmp(argv[p], "-churn") == 0) {
+            if (p+1 < argc && sscanf(argv[p+1], "%u", &churnRounds) == 1 && churnRounds > 0)
+                p+=2;
+            else CommandLineError();
+		}
+        else if (strcmp(argv[p], "-nogui") == 0) {
+            p+=1;
+		}
+        else if (strcmp(argv[p], "-autostart") == 0) {
+            if (p+1 < argc && sscanf(argv[p+1], "%u", &autoStart) == 1)
+                p+=2;
+            else CommandLineError();
+		}
+        else if (strcmp(argv[p], "-results") == 0) {
+            if (p+1 < argc) {
+                resultsFilename = argv[p+1];
+                p+=2;
+            }
+            else CommandLineError();
+		}
+        else if (strcmp(argv[p], "-catchup") == 0 || strcmp(argv[p], "-spin") == 0
+                 || strcmp(argv[p], "-history") == 0 || strcmp(argv[p], "-capacity") == 0
+                 || strcmp(argv[p], "-admit") == 0) {
+            // wait until second pass of command line parsing
+            if (p+1 < argc) p+=2;
+            else CommandLineError();
+		}
         else if (strcmp(argv[p], "-showgraph") == 0)	{
             if (p+1 < argc) {
                 showGraph=true;
@@ -234,6 +298,17 @@ int main(int argc, char *argv[])
             CommandLineError();
 		}
 	}
+
+	/* the main thread is also the GUI thread */
+	cbTracer::setThread(cbTracer::GUI_THREAD);
+	if (traceFilename) {
+#ifdef CB_TRACE
+		cbTracer::enable(traceSize);
+#else
+		cerr << "Tracing is not compiled in, build with CONFIG+=trace\n";
+		traceFilename = 0;
+#endif
+	}
 	
 	/* change parameteres object */
 	if (paramFilename) // a parameters file is given
@@ -281,12 +356,61 @@ int main(int argc, char *argv[])
             else CommandLineError();
 		}
         else if (strcmp(argv[p], "-gps") == 0)	{
-            cbRobot::GPSOn = true;
             simulator.setGPS(true);
             p+=1;
 		}
         else if (strcmp(argv[p], "-showactions") == 0)	{
-            cbRobot::showActions=true;
+            simulator.robotConfig().showActions=true;
+            p+=1;
+		}
+        else if (strcmp(argv[p], "-catchup") == 0) {
+            cbScheduler::CatchUp catchUp;
+            if (p+1 < argc && cbScheduler::parseCatchUp(argv[p+1], catchUp)) {
+                simulator.setCatchUp(catchUp);
+                p+=2;
+            }
+            else CommandLineError();
+		}
+        else if (strcmp(argv[p], "-spin") == 0) {
+            unsigned int spin;
+            if (p+1 < argc && sscanf(argv[p+1], "%u", &spin) == 1) {
+                simulator.setSpin(spin);
+                p+=2;
+            }
+            else CommandLineError();
+		}
+        else if (strcmp(argv[p], "-capacity") == 0) {
+            unsigned int robots;
+            if (p+1 < argc && sscanf(argv[p+1], "%u", &robots) == 1) {
+                simulator.setCapacity(robots);
+                p+=2;
+            }
+            else CommandLineError();
+		}
+        else if (strcmp(argv[p], "-admit") == 0) {
+            unsigned int robots;
+            if (p+1 < argc && sscanf(argv[p+1], "%u", &robots) == 1) {
+                simulator.setAdmission(robots);
+                p+=2;
+            }
+            else CommandLineError();
+		}
+        else if (strcmp(argv[p], "-history") == 0) {
+            unsigned int cycles;
+            if (p+1 < argc && sscanf(argv[p+1], "%u", &cycles) == 1) {
+                simulator.setHistory(cycles);
+                p+=2;
+            }
+            else CommandLineError();
+		}
+        else if (strcmp(argv[p], "-trace") == 0 || strcmp(argv[p], "-tracesize") == 0
+                 || strcmp(argv[p], "-plugin") == 0 || strcmp(argv[p], "-bench") == 0
+                 || strcmp(argv[p], "-churn") == 0
+                 || strcmp(argv[p], "-autostart") == 0 || strcmp(argv[p], "-results") == 0) {
+            // already handled in the first pass
+            p+=2;
+		}
+        else if (strcmp(argv[p], "-nogui") == 0) {
             p+=1;
 		}
         else if (strcmp(argv[p], "-showgraph") == 0)	{
@@ -318,10 +442,14 @@ int main(int argc, char *argv[])
 
 	simulator.setReceptionistAt(port);
 
+	for (unsigned int i=0; i<pluginFiles.size(); i++)
+		if (!simulator.addPlugin(pluginFiles[i], pluginCounts[i]))
+			exit(1);
+
     simulator.buildGraph();
     simulator.setDistMaxFromGridToTarget();
 
-    if(showGraph) {
+    if(showGraph && !noGUI) {
         simulator.showGraph(showGraphId);
         if(simulator.labView)
             simulator.labView->show();
@@ -329,11 +457,42 @@ int main(int argc, char *argv[])
 
 	/* preparing the random generator */
 #ifndef MicWindows
-	srand(getpid());
+	simulator.randomGenerator().seed(getpid());
 #else
-	srand(_getpid());
+	simulator.randomGenerator().seed(_getpid());
 #endif
 
+	if (benchCycles > 0) {
+		simulator.runBench(benchCycles);
+		if (traceFilename) writeTrace(traceFilename);
+		return 0;
+	}
+
+	if (churnRounds > 0) {
+		simulator.runChurnBench(churnRounds);
+		return 0;
+	}
+
+	simulator.setAutoStart(autoStart);
+
+	if (noGUI) {
+		// nowhere to show them
+		simulator.robotConfig().showActions = false;
+		simulator.robotConfig().showMeasures = false;
+		QObject::connect(&simulator, SIGNAL(simFinished()), &app, SLOT(quit()));
+
+		simulator.startTimer();
+		printf("Ready on port %d\n", port);
+		fflush(stdout);
+
+		app.exec();
+		simulator.stopKernel();
+
+		if (resultsFilename && !simulator.writeResults(resultsFilename)) return 1;
+		if (traceFilename) writeTrace(traceFilename);
+		return 0;
+	}
+
         /* start simulator timer */
 	simulator.startTimer();
 
@@ -347,5 +506,12 @@ int main(int argc, char *argv[])
 
 	app.exec();
 
+	/* the kernel thread uses the GUI, stop it first */
+	simulator.stopKernel();
+
+	if (resultsFilename) simulator.writeResults(resultsFilename);
+
+	if (traceFilename) writeTrace(traceFilename);
+
 	return 0;
 }
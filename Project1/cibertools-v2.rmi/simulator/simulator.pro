@@ -7,6 +7,16 @@ win32 {
         LIBS    += -lws2_32
 }
 
+# timeline of the cycles, see cbtracer.h
+trace {
+        DEFINES += CB_TRACE
+}
+
+# clock_nanosleep of the cycle scheduler
+unix:!macx {
+        LIBS    += -lrt
+}
+
 HEADERS = \
     cbactionhandler.h cbbeacon.h cbbutton.h cbclient.h\
     cbgrid.h cbgridhandler.h cblab.h cblabhandler.h\
@@ -18,7 +28,24 @@ HEADERS = \
     cbutils.h cbparamdialog.h cbsimulatorGUI.h cbcontrolpanel.h \
     cbmanagerobots.h \
     cbrobotinfo.h \
-    cblabdialog.h
+    cblabdialog.h \
+    cblogwriter.h \
+    cbsnapshot.h \
+    cbscheduler.h \
+    cbprofiler.h \
+    cbprofilerpanel.h \
+    cbtracer.h \
+    cbcontroller.h \
+    cbrobotplugin.h \
+    cbrobotconfig.h \
+    cbrobotsize.h \
+    cbsimstate.h \
+    cbxmlbuilder.h \
+    cbmessageboard.h \
+    cbchunk.h \
+    cbpool.h \
+    cbdiagnostics.h \
+    cbbinlog.h
 
 SOURCES = \
     cbactionhandler.cpp cbbeacon.cpp cbbutton.cpp cbclient.cpp\
@@ -31,7 +58,20 @@ SOURCES = \
     cbutils.cpp cbparamdialog.cpp cbsimulatorGUI.cpp cbcontrolpanel.cpp \
     cbmanagerobots.cpp \
     cbrobotinfo.cpp \
-    cblabdialog.cpp
+    cblabdialog.cpp \
+    cblogwriter.cpp \
+    cbscheduler.cpp \
+    cbprofiler.cpp \
+    cbprofilerpanel.cpp \
+    cbtracer.cpp \
+    cbrobotplugin.cpp \
+    cbrobotconfig.cpp \
+    cbxmlbuilder.cpp \
+    cbmessageboard.cpp \
+    cbchunk.cpp \
+    cbpool.cpp \
+    cbdiagnostics.cpp \
+    cbbinlog.cpp
 
 TARGET  = simulator
 QT      += network  xml
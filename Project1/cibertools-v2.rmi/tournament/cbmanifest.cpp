@@ -0,0 +1,117 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "cbmanifest.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+
+#include <iostream>
+
+using std::cerr;
+
+bool cbManifest::load(const QString &file)
+{
+	QFile srcFile(file);
+	if (!srcFile.exists()) {
+		cerr << "Could not open " << file.toStdString() << "\n";
+		return false;
+	}
+	dir = QFileInfo(file).absolutePath();
+
+	QXmlInputSource source(&srcFile);
+	QXmlSimpleReader xmlParser;
+	cbManifestHandler handler(*this);
+	xmlParser.setContentHandler(&handler);
+	if (!xmlParser.parse(source)) {
+		cerr << "Error parsing " << file.toStdString() << "\n";
+		return false;
+	}
+
+	if (simulator.isEmpty()) {
+		cerr << "The manifest gives no Simulator\n";
+		return false;
+	}
+	if (labs.empty() || teams.empty()) {
+		cerr << "The manifest has no Lab or no Team\n";
+		return false;
+	}
+	for (unsigned int t = 0; t < teams.size(); t++)
+		if (teams[t].agents.empty()) {
+			cerr << "Team " << teams[t].name.toStdString() << " has no Agent\n";
+			return false;
+		}
+	if (logs.isEmpty()) logs = "logs";
+	return true;
+}
+
+bool cbManifestHandler::startElement(const QString&, const QString&, const QString& qName, const QXmlAttributes& attr)
+{
+	const QString &tag = qName;
+	if (tag == "Tournament") {
+		inTeam = false;
+		manifest.simulator = attr.value("Simulator");
+		manifest.simulatorArgs = attr.value("SimulatorArgs");
+		manifest.logs = attr.value("Logs");
+		if (!attr.value("Port").isNull()) manifest.port = attr.value("Port").toInt();
+		if (!attr.value("Timeout").isNull()) manifest.timeout = attr.value("Timeout").toInt();
+		if (!attr.value("Rounds").isNull()) manifest.rounds = attr.value("Rounds").toInt();
+		if (manifest.port <= 0 || manifest.timeout <= 0 || manifest.rounds <= 0) {
+			cerr << "Port, Timeout and Rounds must be positive\n";
+			return false;
+		}
+	}
+	else if (tag == "Lab") {
+		cbManifestLab l;
+		l.lab = attr.value("Lab");
+		l.grid = attr.value("Grid");
+		l.param = attr.value("Param");
+		l.name = attr.value("Name");
+		if (l.name.isEmpty()) l.name = QFileInfo(l.lab).baseName();
+		if (l.name.isEmpty()) l.name = QString("lab%1").arg(manifest.labs.size()+1);
+		manifest.labs.push_back(l);
+	}
+	else if (tag == "Team") {
+		cbManifestTeam t;
+		t.name = attr.value("Name");
+		if (t.name.isEmpty()) t.name = QString("team%1").arg(manifest.teams.size()+1);
+		manifest.teams.push_back(t);
+		inTeam = true;
+	}
+	else if (tag == "Agent") {
+		if (!inTeam || attr.value("Command").isEmpty()) {
+			cerr << "Agent without Command or outside a Team\n";
+			return false;
+		}
+		manifest.teams.back().agents.push_back(attr.value("Command"));
+	}
+	else {
+		cerr << "Unknown tag " << tag.toStdString() << " in manifest\n";
+		return false;
+	}
+	return true;
+}
+
+bool cbManifestHandler::endElement(const QString&, const QString&, const QString& qName)
+{
+	if (qName == "Team") inTeam = false;
+	return true;
+}
@@ -0,0 +1,96 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef _CB_MANIFEST_
+#define _CB_MANIFEST_
+
+#include <qxml.h>
+#include <QString>
+
+#include <vector>
+
+using std::vector;
+
+/**
+ * A lab of the tournament, with its grid and parameters; empty file
+ * names are the defaults of the simulator.
+ */
+struct cbManifestLab
+{
+	QString name;
+	QString lab, grid, param;
+};
+
+/**
+ * A team: the commands that start its agents, one robot each. In a
+ * command %host is replaced by the simulator address (localhost:port),
+ * %pos by the grid position of the robot and %name by its name.
+ */
+struct cbManifestTeam
+{
+	QString name;
+	vector<QString> agents;
+};
+
+/**
+ * Description of a tournament, every team plays every lab Rounds times:
+ *
+ *   <Tournament Simulator="simulator/simulator" Port="6000" Timeout="600"
+ *               Rounds="1" Logs="logs" SimulatorArgs="">
+ *     <Lab Name="Final2008" Lab="Labs/CiberRato2008/Ciber2008_FinalLab.xml"
+ *          Grid="Labs/CiberRato2008/Ciber2008_FinalGrid.xml" Param=""/>
+ *     <Team Name="sample">
+ *       <Agent Command="robsample/robsample -host %host -pos %pos -robname %name"/>
+ *     </Team>
+ *   </Tournament>
+ *
+ * Files and commands are relative to the directory of the manifest.
+ */
+struct cbManifest
+{
+	cbManifest() : port(6000), timeout(600), rounds(1) {}
+
+	QString dir;			// directory of the manifest
+	QString simulator, simulatorArgs, logs;
+	int port;				// port of the first simulator
+	int timeout;			// seconds a match may last
+	int rounds;
+
+	vector<cbManifestLab> labs;
+	vector<cbManifestTeam> teams;
+
+	/*! Reads the manifest, returns false if it is not valid. */
+	bool load(const QString &file);
+};
+
+class cbManifestHandler : public QXmlDefaultHandler
+{
+public:
+	cbManifestHandler(cbManifest &m) : manifest(m), inTeam(false) {}
+
+	bool startElement(const QString&, const QString&, const QString&, const QXmlAttributes&);
+	bool endElement(const QString&, const QString&, const QString&);
+
+private:
+	cbManifest &manifest;
+	bool inTeam;
+};
+
+#endif
@@ -0,0 +1,215 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "cbmatchrunner.h"
+
+#include <QProcess>
+#include <QFile>
+#include <QDir>
+#include <QTime>
+#include <QStringList>
+#include <qxml.h>
+
+#include <stdio.h>
+
+const char *cbMatchStatus(cbMatch::Status s)
+{
+	static const char *names[] = { "Pending", "Finished", "Timeout", "Failed" };
+	return names[s];
+}
+
+/**
+ * Reads the robots of a <Results> element.
+ */
+class cbResultsHandler : public QXmlDefaultHandler
+{
+public:
+	cbResultsHandler(cbMatch &m) : match(m) {}
+
+	bool startElement(const QString&, const QString&, const QString& qName, const QXmlAttributes& attr)
+	{
+		if (qName == "Results") {
+			match.cycles = attr.value("Time").toUInt();
+			match.robots.clear();
+		}
+		else if (qName == "Robot") {
+			cbMatchRobot r;
+			r.id = attr.value("Id").toUInt();
+			r.name = attr.value("Name");
+			r.state = attr.value("State");
+			r.score = attr.value("Score").toUInt();
+			r.collisions = attr.value("Collisions").toUInt();
+			r.arrivalTime = attr.value("ArrivalTime").toUInt();
+			r.returningTime = attr.value("ReturningTime").toUInt();
+			match.robots.push_back(r);
+		}
+		return true;
+	}
+
+private:
+	cbMatch &match;
+};
+
+bool cbReadResults(const QString &file, cbMatch &match)
+{
+	QFile srcFile(file);
+	if (!srcFile.exists()) return false;
+
+	QXmlInputSource source(&srcFile);
+	QXmlSimpleReader xmlParser;
+	cbResultsHandler handler(match);
+	xmlParser.setContentHandler(&handler);
+	return xmlParser.parse(source);
+}
+
+/* asks a process to finish, kills it if it does not */
+static void stopProcess(QProcess &p)
+{
+	if (p.state() == QProcess::NotRunning) return;
+	p.terminate();
+	if (!p.waitForFinished(2000)) {
+		p.kill();
+		p.waitForFinished(2000);
+	}
+}
+
+cbMatchRunner::cbMatchRunner(const cbManifest &m, vector<cbMatch> &ms,
+                             QAtomicInt &n, QAtomicInt &d, int p)
+	: manifest(m), matches(ms), next(n), done(d)
+{
+	port = p;
+}
+
+void cbMatchRunner::run()
+{
+	for (;;) {
+		int i = next.fetchAndAddOrdered(1);
+		if (i >= (int) matches.size()) break;
+
+		cbMatch &match = matches[i];
+		play(match);
+
+		int n = done.fetchAndAddOrdered(1) + 1;
+		printf("[%d/%d] %s: %s in %.1f s%s%s\n", n, (int) matches.size(),
+		       match.name.toLocal8Bit().constData(), cbMatchStatus(match.status), match.seconds,
+		       match.error.isEmpty() ? "" : ", ", match.error.toLocal8Bit().constData());
+		fflush(stdout);
+	}
+}
+
+/*!
+	The simulator prints a line when it accepts registrations; its output
+	goes to a file, so that it can never block on a full pipe.
+*/
+bool cbMatchRunner::waitReady(QProcess &sim, const QString &outFile)
+{
+	QTime clock;
+	clock.start();
+	while (clock.elapsed() < 10000) {
+		if (sim.state() == QProcess::NotRunning) return false;
+		QFile out(outFile);
+		if (out.open(QIODevice::ReadOnly) && out.readAll().contains("Ready on port"))
+			return true;
+		msleep(20);
+	}
+	return false;
+}
+
+/*!
+	Run the simulator of the match, start the agents when it is ready
+	and wait for the end of the simulation, at most the timeout.
+*/
+void cbMatchRunner::play(cbMatch &match)
+{
+	QTime clock;
+	clock.start();
+
+	const cbManifestLab &lab = manifest.labs[match.lab];
+	const cbManifestTeam &team = manifest.teams[match.team];
+	QString base = QDir(QDir(manifest.dir).absoluteFilePath(manifest.logs)).absoluteFilePath(match.name);
+	QString results = base + ".xml";
+	QFile::remove(results);
+
+	match.port = port;
+	match.cycles = 0;
+	match.robots.clear();
+
+	QStringList args;
+	if (!lab.lab.isEmpty()) args << "-lab" << lab.lab;
+	if (!lab.grid.isEmpty()) args << "-grid" << lab.grid;
+	if (!lab.param.isEmpty()) args << "-param" << lab.param;
+	args << "-port" << QString::number(port) << "-nogui"
+	     << "-autostart" << QString::number(team.agents.size())
+	     << "-log" << base + ".log" << "-results" << results;
+	args += manifest.simulatorArgs.split(' ', QString::SkipEmptyParts);
+
+	QProcess sim;
+	sim.setWorkingDirectory(manifest.dir);
+	sim.setProcessChannelMode(QProcess::MergedChannels);
+	sim.setStandardOutputFile(base + "_sim.out");
+	sim.start(QDir(manifest.dir).absoluteFilePath(manifest.simulator), args);
+	if (!sim.waitForStarted() || !waitReady(sim, base + "_sim.out")) {
+		stopProcess(sim);
+		match.status = cbMatch::FAILED;
+		match.error = "simulator did not start";
+		match.seconds = clock.elapsed() / 1000.0;
+		return;
+	}
+
+	vector<QProcess *> agents;
+	for (unsigned int a = 0; a < team.agents.size(); a++) {
+		QString cmd = team.agents[a];
+		cmd.replace("%host", QString("localhost:%1").arg(port));
+		cmd.replace("%pos", QString::number(a+1));
+		cmd.replace("%name", team.name + QString::number(a+1));
+
+		QProcess *agent = new QProcess;
+		agent->setWorkingDirectory(manifest.dir);
+		agent->setProcessChannelMode(QProcess::MergedChannels);
+		agent->setStandardOutputFile(base + QString("_agent%1.out").arg(a+1));
+		agent->start(cmd);
+		agents.push_back(agent);
+	}
+
+	int left = manifest.timeout * 1000 - clock.elapsed();
+	bool finished = sim.waitForFinished(left > 0 ? left : 1);
+	if (!finished) stopProcess(sim);
+
+	for (unsigned int a = 0; a < agents.size(); a++) {
+		stopProcess(*agents[a]);
+		delete agents[a];
+	}
+
+	if (!finished) {
+		match.status = cbMatch::TIMEOUT;
+		match.error = QString("still running after %1 s").arg(manifest.timeout);
+	}
+	else if (sim.exitStatus() != QProcess::NormalExit || sim.exitCode() != 0) {
+		match.status = cbMatch::FAILED;
+		match.error = QString("simulator exited with %1").arg(sim.exitCode());
+	}
+	else if (!cbReadResults(results, match)) {
+		match.status = cbMatch::FAILED;
+		match.error = "no results";
+	}
+	else match.status = cbMatch::FINISHED;
+
+	match.seconds = clock.elapsed() / 1000.0;
+}
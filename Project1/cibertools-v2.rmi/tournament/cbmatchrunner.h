@@ -0,0 +1,93 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef _CB_MATCH_RUNNER_
+#define _CB_MATCH_RUNNER_
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QString>
+
+#include <vector>
+
+#include "cbmanifest.h"
+
+using std::vector;
+
+class QProcess;
+
+/**
+ * Final state of a robot, as written by the simulator with -results.
+ */
+struct cbMatchRobot
+{
+	unsigned int id;
+	QString name, state;
+	unsigned int score, collisions, arrivalTime, returningTime;
+};
+
+/**
+ * One team on one lab.
+ */
+struct cbMatch
+{
+	enum Status { PENDING, FINISHED, TIMEOUT, FAILED };
+
+	int lab, team, round;
+	QString name;			// names the files in the logs directory
+
+	Status status;
+	QString error;
+	int port;
+	unsigned int cycles;	// cycles simulated
+	double seconds;			// wall clock time of the match
+	vector<cbMatchRobot> robots;
+};
+
+const char *cbMatchStatus(cbMatch::Status s);
+
+/*! Reads the <Results> written by the simulator. */
+bool cbReadResults(const QString &file, cbMatch &match);
+
+/**
+ * Worker thread: plays matches from a shared list until none is left,
+ * each one with a headless simulator on the port of the worker. Matches
+ * are claimed with an atomic counter, results are stored by index.
+ */
+class cbMatchRunner : public QThread
+{
+public:
+	cbMatchRunner(const cbManifest &m, vector<cbMatch> &matches,
+	              QAtomicInt &next, QAtomicInt &done, int port);
+
+protected:
+	void run();
+
+private:
+	void play(cbMatch &match);
+	bool waitReady(QProcess &sim, const QString &outFile);
+
+	const cbManifest &manifest;
+	vector<cbMatch> &matches;
+	QAtomicInt &next, &done;
+	int port;
+};
+
+#endif
@@ -0,0 +1,182 @@
+/*
+    This file is part of ciberRatoToolsSrc.
+
+    Copyright (C) 2001-2011 Universidade de Aveiro
+
+    ciberRatoToolsSrc is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    ciberRatoToolsSrc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Foobar; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+ * tournament - plays every team of a manifest on every lab, many
+ * matches at a time, each with a headless simulator on its own port.
+ *
+ * Results are written to two CSV files:
+ *   <prefix>_matches.csv  one line per match: status, cycles, duration
+ *   <prefix>_robots.csv   one line per robot and match: final scores
+ * and the logs of the simulators and agents to the Logs directory of
+ * the manifest (see cbmanifest.h).
+ */
+
+#include <iostream>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QTime>
+
+#include "cbmanifest.h"
+#include "cbmatchrunner.h"
+
+using std::cerr;
+
+void CommandLineError()
+{
+	cerr << "SYNOPSIS: tournament [-j matches] [-o prefix] manifest\n"
+	        "  plays the matches of the manifest, at most the given number at a time\n"
+	        "  (default, one per core)\n";
+	exit(1);
+}
+
+/* CSV field, quoted when needed */
+static QString csv(const QString &s)
+{
+	if (!s.contains(',') && !s.contains('"') && !s.contains('\n')) return s;
+	QString q = s;
+	q.replace("\"", "\"\"");
+	return "\"" + q + "\"";
+}
+
+static bool writeResults(const QString &prefix, const cbManifest &manifest, const vector<cbMatch> &matches)
+{
+	QString matchesName = prefix + "_matches.csv";
+	QString robotsName = prefix + "_robots.csv";
+	FILE *fm = fopen(matchesName.toLocal8Bit().constData(), "w");
+	FILE *fr = fopen(robotsName.toLocal8Bit().constData(), "w");
+	if (fm == 0 || fr == 0) {
+		cerr << "ERROR: Could not open output files " << prefix.toStdString() << "_*.csv\n";
+		return false;
+	}
+
+	fprintf(fm, "match,lab,team,round,port,status,cycles,seconds,error\n");
+	fprintf(fr, "match,lab,team,round,robot_id,name,score,collisions,arrival_time,returning_time,state\n");
+	for (unsigned int m = 0; m < matches.size(); m++) {
+		const cbMatch &match = matches[m];
+		QString lab = csv(manifest.labs[match.lab].name);
+		QString team = csv(manifest.teams[match.team].name);
+
+		fprintf(fm, "%s,%s,%s,%d,%d,%s,%u,%.3f,%s\n", csv(match.name).toLocal8Bit().constData(),
+		        lab.toLocal8Bit().constData(), team.toLocal8Bit().constData(), match.round,
+		        match.port, cbMatchStatus(match.status), match.cycles, match.seconds,
+		        csv(match.error).toLocal8Bit().constData());
+
+		for (unsigned int r = 0; r < match.robots.size(); r++) {
+			const cbMatchRobot &rob = match.robots[r];
+			fprintf(fr, "%s,%s,%s,%d,%u,%s,%u,%u,%u,%u,%s\n", csv(match.name).toLocal8Bit().constData(),
+			        lab.toLocal8Bit().constData(), team.toLocal8Bit().constData(), match.round,
+			        rob.id, csv(rob.name).toLocal8Bit().constData(), rob.score, rob.collisions,
+			        rob.arrivalTime, rob.returningTime, rob.state.toLocal8Bit().constData());
+		}
+	}
+
+	bool ok = !ferror(fm) && !ferror(fr);
+	ok = fclose(fm) == 0 && ok;
+	ok = fclose(fr) == 0 && ok;
+	if (!ok) cerr << "ERROR: Could not write output files " << prefix.toStdString() << "_*.csv\n";
+	return ok;
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+
+	QString prefix = "tournament";
+	QString manifestFile;
+	int nRunners = QThread::idealThreadCount();
+
+	for (int p = 1; p < argc; p++) {
+		if (strcmp(argv[p], "-j") == 0) {
+			if (p+1 < argc && sscanf(argv[p+1], "%d", &nRunners) == 1 && nRunners > 0) p++;
+			else CommandLineError();
+		}
+		else if (strcmp(argv[p], "-o") == 0) {
+			if (p+1 < argc) prefix = argv[++p];
+			else CommandLineError();
+		}
+		else if (argv[p][0] != '-' && manifestFile.isNull()) manifestFile = argv[p];
+		else CommandLineError();
+	}
+	if (manifestFile.isNull()) CommandLineError();
+
+	cbManifest manifest;
+	if (!manifest.load(manifestFile)) return 1;
+	if (!QDir(manifest.dir).mkpath(manifest.logs)) {
+		cerr << "ERROR: Could not create " << manifest.logs.toStdString() << "\n";
+		return 1;
+	}
+
+	vector<cbMatch> matches;
+	for (int round = 1; round <= manifest.rounds; round++)
+		for (unsigned int l = 0; l < manifest.labs.size(); l++)
+			for (unsigned int t = 0; t < manifest.teams.size(); t++) {
+				cbMatch m;
+				m.lab = l;
+				m.team = t;
+				m.round = round;
+				m.name = QString("%1_%2_%3").arg(manifest.labs[l].name)
+				         .arg(manifest.teams[t].name).arg(round);
+				m.status = cbMatch::PENDING;
+				m.port = 0;
+				m.cycles = 0;
+				m.seconds = 0.0;
+				matches.push_back(m);
+			}
+	if (nRunners < 1) nRunners = 1;
+	if (nRunners > (int) matches.size()) nRunners = matches.size();
+
+	QAtomicInt next(0), done(0);
+
+	QTime elapsed;
+	elapsed.start();
+
+	// one simulator port per runner, so the ones running never clash
+	vector<cbMatchRunner *> runners;
+	for (int r = 0; r < nRunners; r++) {
+		runners.push_back(new cbMatchRunner(manifest, matches, next, done, manifest.port + r));
+		runners.back()->start();
+	}
+	for (int r = 0; r < nRunners; r++) {
+		runners[r]->wait();
+		delete runners[r];
+	}
+
+	double seconds = elapsed.elapsed() / 1000.0;
+	if (seconds <= 0.0) seconds = 0.001;
+
+	unsigned int nFinished = 0, nTimeout = 0;
+	for (unsigned int m = 0; m < matches.size(); m++) {
+		if (matches[m].status == cbMatch::FINISHED) nFinished++;
+		else if (matches[m].status == cbMatch::TIMEOUT) nTimeout++;
+	}
+
+	if (!writeResults(prefix, manifest, matches)) return 1;
+
+	printf("%u of %u matches finished (%u timed out) in %.1f s with %d simulators\n",
+	       nFinished, (unsigned int) matches.size(), nTimeout, seconds, nRunners);
+	printf("%.1f matches/hour\n", nFinished * 3600.0 / seconds);
+
+	return nFinished == matches.size() ? 0 : 1;
+}
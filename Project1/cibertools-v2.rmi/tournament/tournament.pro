@@ -0,0 +1,14 @@
+TEMPLATE	= app
+CONFIG		+= qt warn_on release thread console
+
+win32 {
+    DEFINES     += MicWindows
+}
+
+HEADERS		= cbmanifest.h cbmatchrunner.h
+SOURCES		= cbmanifest.cpp cbmatchrunner.cpp tournament.cpp
+
+TARGET		= tournament
+
+QT		-= gui
+QT		+= xml